@@ -0,0 +1,8 @@
+// shadow.frag
+// Depth-only fragment shader for shadow casters: the shadow map stores depth and nothing else.
+
+#version 330 core
+
+void main()
+{
+}
@@ -0,0 +1,18 @@
+// shadow.vert
+// Depth-only vertex shader for shadow casters (Renderer::renderShadowCascade()).
+// Transforms each instance's vertices into the light space of the cascade being drawn. Uses the
+// same vertex and per-instance attribute locations as triangle.vert, so casters draw from the
+// shared mesh arenas and the flush's instance buffer without any extra setup.
+
+#version 330 core
+
+layout (location = 0) in vec3 aPos;      // Vertex position in model space
+layout (location = 3) in mat4 aModel;    // Per-instance model matrix (locations 3-6)
+layout (location = 9) in vec4 aDequantize; // Per-draw position dequantization (see triangle.vert)
+
+uniform mat4 lightViewProjection; // World space to the cascade's clip space, set per cascade
+
+void main()
+{
+    gl_Position = lightViewProjection * (aModel * vec4(aPos * aDequantize.w + aDequantize.xyz, 1.0));
+}
@@ -1,24 +1,179 @@
 // triangle.frag
-// Fragment Shader using interpolated vertex color.
-// This shader receives the interpolated color from the vertex shader
-// and sets the final color of the fragment (pixel).
+// Fragment Shader using interpolated vertex color, lit by clustered forward lighting.
+// This shader receives the interpolated color from the vertex shader, multiplies it by the
+// ambient term plus the directional light plus every light of the fragment's cluster, and sets
+// the final color of the fragment (pixel). See LightClusterer.h for how the clusters are built.
+// Features (see ShaderLibrary.h): without LIGHTING the vertex color is output as is; without
+// LOD_FADE there is no dithered discard, which keeps early depth testing available. TEXTURE
+// multiplies the vertex color by the material's streamed albedo texture. SHADOWS (with LIGHTING)
+// shadows the directional light with the cascaded shadow map (see ShadowCascades.h).
 
 #version 330 core // Specify GLSL version 3.30, core profile
+#pragma feature LIGHTING
+#pragma feature LOD_FADE
+#pragma feature TEXTURE
+#pragma feature SHADOWS
 
 // Input variable from the vertex shader (interpolated color)
 // The 'in' keyword signifies that this variable receives its value from the
 // corresponding 'out' variable in the vertex shader.
 // The name 'vertexColor' must match the 'out' variable in triangle.vert.
 in vec3 vertexColor; 
+#ifdef LIGHTING
+in vec3 worldPosition;
+in vec3 worldNormal;
+in float viewDepth;
+#endif
+#ifdef LOD_FADE
+flat in float lodFade; // LOD cross-fade from the vertex shader
+#endif
+#ifdef TEXTURE
+in vec2 texCoord;
+uniform sampler2D albedoTexture; // Bound by the Renderer (ALBEDO_TEXTURE_UNIT)
+#endif
+
+#ifdef LIGHTING
+// Clustered lighting: written once per frame by the Renderer. Must match
+// Renderer::LightUniforms (std140 layout).
+layout (std140) uniform Lights {
+    uvec4 clusterGrid;  // Clusters in x, y, z; w = light count (0 = unlit, ambient only)
+    vec4 clusterScale;  // xy = clusters per pixel; slice = log(viewDepth) * z + w
+    vec4 ambientColor;
+    uvec4 texelBases;   // First texel of the lights, clusters and indices below
+    vec4 sunDirection;  // xyz = unit direction towards the directional light
+    vec4 sunColor;      // rgb = color * intensity (0 = no directional light)
+};
+uniform samplerBuffer lightData;      // 3 texels per light: position/range, color/cos outer, direction/cos inner
+uniform usamplerBuffer lightClusters; // (offset, count) per cluster
+uniform usamplerBuffer lightIndices;  // Light indices, grouped by cluster
+#endif
+
+#if defined(LIGHTING) && defined(SHADOWS)
+// Cascaded shadow map of the directional light: written once per frame by the Renderer. Must
+// match Renderer::ShadowUniforms (std140 layout).
+layout (std140) uniform Shadows {
+    mat4 shadowMatrices[4]; // World space to each cascade's map: xy = texture coordinate, z = depth
+    vec4 cascadeSplits;     // Far view depth of each cascade
+    vec4 cascadeTexelSizes; // World size of one texel of each cascade
+    vec4 shadowParams;      // x = cascade count (0 = no shadows), y = normal offset in texels, z = 1 / resolution
+};
+uniform sampler2DArrayShadow shadowMap; // One layer per cascade, depth comparison on
+#endif
+
+#ifdef LOD_FADE
+// 4x4 ordered-dither thresholds in [0,1).
+const float DITHER[16] = float[16](
+     0.0 / 16.0,  8.0 / 16.0,  2.0 / 16.0, 10.0 / 16.0,
+    12.0 / 16.0,  4.0 / 16.0, 14.0 / 16.0,  6.0 / 16.0,
+     3.0 / 16.0, 11.0 / 16.0,  1.0 / 16.0,  9.0 / 16.0,
+    15.0 / 16.0,  7.0 / 16.0, 13.0 / 16.0,  5.0 / 16.0);
+#endif
 
 // Output data for the fragment shader
 // FragColor is a built-in output variable (though often user-defined 'out vec4 outColor;')
 // that determines the final color of the pixel being rendered.
 out vec4 FragColor; 
 
+#if defined(LIGHTING) && defined(SHADOWS)
+// Fraction of the directional light reaching this fragment: 1 = lit, 0 = in shadow. The cascade
+// is the first whose split lies beyond the fragment; beyond the last there is no shadow.
+float sunShadow(vec3 normal)
+{
+    int count = int(shadowParams.x);
+    if (count == 0 || viewDepth > cascadeSplits[count - 1]) return 1.0;
+    int cascade = 0;
+    while (cascade < count - 1 && viewDepth > cascadeSplits[cascade]) ++cascade;
+
+    // Normal offset: looking up a point a texel or so off the surface keeps it from shadowing
+    // itself (acne) without the light leaks a large depth bias causes.
+    vec3 position = worldPosition + normal * (cascadeTexelSizes[cascade] * shadowParams.y);
+    vec3 coord = (shadowMatrices[cascade] * vec4(position, 1.0)).xyz;
+
+    // Four bilinear comparisons half a texel apart: a 3x3-texel tent filter.
+    float texel = shadowParams.z;
+    float lit = texture(shadowMap, vec4(coord.xy + vec2(-0.5, -0.5) * texel, float(cascade), coord.z));
+    lit += texture(shadowMap, vec4(coord.xy + vec2(0.5, -0.5) * texel, float(cascade), coord.z));
+    lit += texture(shadowMap, vec4(coord.xy + vec2(-0.5, 0.5) * texel, float(cascade), coord.z));
+    lit += texture(shadowMap, vec4(coord.xy + vec2(0.5, 0.5) * texel, float(cascade), coord.z));
+    return lit * 0.25;
+}
+#endif
+
+#ifdef LIGHTING
+// Ambient plus the diffuse contribution of the directional light and the lights in this
+// fragment's cluster.
+vec3 shadeLights()
+{
+    vec3 result = ambientColor.rgb;
+    if (clusterGrid.w == 0u && sunColor.rgb == vec3(0.0)) return result;
+
+    // Meshes without normals get the face normal, which always faces the viewer.
+    vec3 normal;
+    if (dot(worldNormal, worldNormal) > 1e-8) {
+        normal = normalize(worldNormal) * (gl_FrontFacing ? 1.0 : -1.0);
+    } else {
+        normal = normalize(cross(dFdx(worldPosition), dFdy(worldPosition)));
+    }
+
+    float sunLight = max(dot(normal, sunDirection.xyz), 0.0);
+#ifdef SHADOWS
+    sunLight *= sunShadow(normal);
+#endif
+    result += sunColor.rgb * sunLight;
+    if (clusterGrid.w == 0u) return result;
+
+    ivec3 cell = ivec3(ivec2(gl_FragCoord.xy * clusterScale.xy),
+                       int(floor(log(max(viewDepth, 1e-4)) * clusterScale.z + clusterScale.w)));
+    cell = clamp(cell, ivec3(0), ivec3(clusterGrid.xyz) - 1);
+    int cluster = (cell.z * int(clusterGrid.y) + cell.y) * int(clusterGrid.x) + cell.x;
+    uvec2 range = texelFetch(lightClusters, int(texelBases.y) + cluster).xy;
+
+    for (uint i = 0u; i < range.y; ++i) {
+        int light = int(texelFetch(lightIndices, int(texelBases.z + range.x + i)).r);
+        int base = int(texelBases.x) + light * 3;
+        vec4 positionRange = texelFetch(lightData, base);
+        vec3 toLight = positionRange.xyz - worldPosition;
+        float distanceSq = dot(toLight, toLight);
+        if (distanceSq >= positionRange.w * positionRange.w) continue;
+        vec4 colorCosOuter = texelFetch(lightData, base + 1);
+        float distance = sqrt(distanceSq);
+        toLight /= max(distance, 1e-4);
+
+        // Inverse-square falloff, windowed so it reaches exactly zero at the range.
+        float ratio = distance / positionRange.w;
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        float attenuation = window * window / (1.0 + distanceSq);
+        if (colorCosOuter.w > -1.5) { // Spot light
+            vec4 directionCosInner = texelFetch(lightData, base + 2);
+            attenuation *= smoothstep(colorCosOuter.w, directionCosInner.w, dot(-toLight, directionCosInner.xyz));
+        }
+        result += colorCosOuter.rgb * (max(dot(normal, toLight), 0.0) * attenuation);
+    }
+    return result;
+}
+#endif
+
 void main()
 {
-    // Set the fragment's color to the interpolated color received from the vertex shader.
-    // The alpha component is set to 1.0 (fully opaque).
-    FragColor = vec4(vertexColor, 1.0f); 
+#ifdef LOD_FADE
+    // LOD cross-fade: an incoming level (fade in [0,1)) keeps the pixels whose threshold is below
+    // the fade, an outgoing level (fade in [-1,0)) keeps the others, so the two levels together
+    // cover every pixel exactly once. A fade of 1 draws everything.
+    if (lodFade < 1.0) {
+        ivec2 cell = ivec2(gl_FragCoord.xy) & 3;
+        float threshold = DITHER[cell.y * 4 + cell.x];
+        if (lodFade >= 0.0 ? threshold >= lodFade : threshold < lodFade + 1.0) discard;
+    }
+#endif
+    // Set the fragment's color to the interpolated color received from the vertex shader,
+    // scaled by the lighting. The alpha component is set to 1.0 (fully opaque).
+    vec3 albedo = vertexColor;
+#ifdef TEXTURE
+    albedo *= texture(albedoTexture, texCoord).rgb;
+#endif
+#ifdef LIGHTING
+    FragColor = vec4(albedo * shadeLights(), 1.0f);
+#else
+    FragColor = vec4(albedo, 1.0f);
+#endif
 }
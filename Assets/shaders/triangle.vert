@@ -2,25 +2,66 @@
 // Vertex Shader with MVP matrices for 3D camera.
 // This shader takes vertex positions and colors, and transformation matrices
 // (model, view, projection) to calculate the final screen position of each vertex.
+// The model matrix is a per-instance attribute so the Renderer can draw many objects in one call.
+// World-space position and normal and the view depth are passed on for clustered lighting.
+// Features (see ShaderLibrary.h): LIGHTING outputs what triangle.frag needs for clustered
+// lighting, LOD_FADE passes the per-instance LOD cross-fade on, TEXTURE the texture coordinate.
 
 #version 330 core // Specify GLSL version 3.30, core profile
+#pragma feature LIGHTING
+#pragma feature LOD_FADE
+#pragma feature TEXTURE
 
 // Input vertex attributes from the VBO
 // layout (location = 0) links this to the first attribute pointer (positions)
 layout (location = 0) in vec3 aPos;   // Vertex position in model space (local coordinates)
 // layout (location = 1) links this to the second attribute pointer (colors)
 layout (location = 1) in vec3 aColor; // Vertex color
+// Vertex normal; (0,0,0) for meshes without one (triangle.frag then uses the face normal). w is 1
+// for plain normals (the default for a missing fourth component) and negative for octahedral
+// normals in xy (quantized meshes, see VertexFormat::quantizedPositionColorNormalUV()).
+layout (location = 2) in vec4 aNormal;
+layout (location = 3) in mat4 aModel; // Per-instance model matrix (uses locations 3-6, one per column)
+layout (location = 7) in vec2 aTexCoord; // Texture coordinate; (0,0) for meshes without one
+layout (location = 8) in float aFade; // Per-instance LOD cross-fade (1 = fully drawn, see triangle.frag)
+// Per-draw constant: object position = aPos * w + xyz (the identity unless the mesh is quantized)
+layout (location = 9) in vec4 aDequantize;
 
-// Uniforms: values passed from the C++ application to the shader
-// These matrices transform the vertex positions.
-uniform mat4 model;       // Model matrix: transforms from model space to world space
-uniform mat4 view;        // View matrix: transforms from world space to view (camera) space
-uniform mat4 projection;  // Projection matrix: transforms from view space to clip space (adds perspective)
+// Camera uniform block: shared by all shaders and written once per frame by the Renderer.
+// Must match Renderer::CameraUniforms (std140 layout).
+layout (std140) uniform Camera {
+    mat4 view;            // View matrix: transforms from world space to view (camera) space
+    mat4 projection;      // Projection matrix: transforms from view space to clip space (adds perspective)
+    mat4 viewProjection;  // projection * view, precomputed on the CPU
+    vec4 cameraPosition;  // World-space eye position (w = 1)
+};
 
 // Output variable to pass color to the fragment shader
 // The 'out' keyword means this variable's value will be interpolated
 // for each fragment between the vertices.
 out vec3 vertexColor;
+#ifdef LIGHTING
+out vec3 worldPosition;
+out vec3 worldNormal;   // Not normalized
+out float viewDepth;    // Distance along the view axis, selects the cluster depth slice
+#endif
+#ifdef LOD_FADE
+flat out float lodFade; // Constant per instance, so no interpolation
+#endif
+#ifdef TEXTURE
+out vec2 texCoord;
+#endif
+
+#ifdef LIGHTING
+// Octahedral normal decode: the unit octahedron unfolded onto [-1,1]^2.
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+#endif
 
 void main()
 {
@@ -30,9 +71,24 @@ void main()
     // 2. View: Transform the vertex from world space to the camera's view space.
     // 3. Projection: Transform the vertex from view space to clip space (ready for rasterization).
     // gl_Position is a special built-in variable that must be set by the vertex shader.
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    // (projection * view is precomputed as viewProjection.)
+    vec4 world = aModel * vec4(aPos * aDequantize.w + aDequantize.xyz, 1.0);
+    gl_Position = viewProjection * world;
+#ifdef LIGHTING
+    worldPosition = world.xyz;
+    // Inverse-transpose keeps normals perpendicular under non-uniform scale.
+    vec3 normal = aNormal.w < 0.0 ? octahedralDecode(aNormal.xy) : aNormal.xyz;
+    worldNormal = transpose(inverse(mat3(aModel))) * normal;
+    viewDepth = -(view * world).z;
+#endif
     
     // Pass the input color (aColor) to the fragment shader via vertexColor.
     // This color will be interpolated across the triangle's surface.
     vertexColor = aColor;
+#ifdef LOD_FADE
+    lodFade = aFade;
+#endif
+#ifdef TEXTURE
+    texCoord = aTexCoord;
+#endif
 }
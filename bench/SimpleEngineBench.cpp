@@ -0,0 +1,617 @@
+// SimpleEngineBench.cpp
+// Microbenchmarks for SimpleMath and the scene hot paths.
+//
+// Every benchmark runs once per scene size (1k to 1M items by default) and reports the time
+// per item. Results are written as JSON so runs can be diffed against each other to catch
+// regressions. The benchmark only links the GL-free core library, so it runs on headless machines.
+//
+// Usage:
+//   SimpleEngineBench [--out=results.json] [--filter=substring] [--sizes=1000,10000]
+//                     [--min-time=0.05] [--samples=5]
+//   --min-time is the minimum duration of one sample, in seconds.
+
+#include "SimpleMath.h"
+#include "MyFirstEngine/Camera.h"
+#include "MyFirstEngine/ECS.h"
+#include "MyFirstEngine/FrustumCuller.h"
+#include "MyFirstEngine/LightClusterer.h"
+#include "MyFirstEngine/MeshOptimizer.h"
+#include "MyFirstEngine/Meshlet.h"
+#include "MyFirstEngine/OcclusionCuller.h"
+#include "MyFirstEngine/RenderQueue.h"
+#include "MyFirstEngine/SceneGraph.h"
+#include "MyFirstEngine/ShadowCascades.h"
+#include "MyFirstEngine/TextureCompressor.h"
+#include "MyFirstEngine/Transform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// --- Harness ---
+
+struct BenchOptions {
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    std::string filter;
+    std::string outPath;
+    double minSampleSeconds = 0.05;
+    int samples = 5;
+};
+
+struct BenchResult {
+    std::string name;
+    size_t size;
+    size_t iterationsPerSample;
+    int samples;
+    double meanNsPerItem;
+    double medianNsPerItem;
+    double minNsPerItem;
+};
+
+// Results feed into this so the optimizer cannot discard the measured work.
+static volatile float g_sink = 0.0f;
+
+static double nowSeconds() {
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(Clock::now().time_since_epoch()).count();
+}
+
+// Runs 'fn' (which processes 'size' items per call) until each sample lasts at least
+// options.minSampleSeconds, then reports per-item statistics over options.samples samples.
+static BenchResult measure(const std::string& name, size_t size, const BenchOptions& options,
+                           const std::function<void()>& fn) {
+    fn(); // Warm-up: page in data, fill caches and branch predictors
+
+    size_t iterations = 1;
+    for (;;) {
+        double start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i) fn();
+        double elapsed = nowSeconds() - start;
+        if (elapsed >= options.minSampleSeconds || iterations >= (size_t(1) << 30)) break;
+        // Aim slightly past the target so the next try usually succeeds.
+        double scale = elapsed > 0.0 ? (options.minSampleSeconds * 1.2) / elapsed : 10.0;
+        iterations = std::max(iterations * 2, static_cast<size_t>(static_cast<double>(iterations) * std::min(scale, 100.0)));
+    }
+
+    std::vector<double> perItem;
+    for (int s = 0; s < options.samples; ++s) {
+        double start = nowSeconds();
+        for (size_t i = 0; i < iterations; ++i) fn();
+        double elapsed = nowSeconds() - start;
+        perItem.push_back(elapsed * 1e9 / (static_cast<double>(iterations) * static_cast<double>(size)));
+    }
+    std::sort(perItem.begin(), perItem.end());
+
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.iterationsPerSample = iterations;
+    result.samples = options.samples;
+    double sum = 0.0;
+    for (double v : perItem) sum += v;
+    result.meanNsPerItem = sum / static_cast<double>(perItem.size());
+    result.medianNsPerItem = perItem[perItem.size() / 2];
+    result.minNsPerItem = perItem.front();
+    return result;
+}
+
+// --- Test data ---
+
+static std::mt19937 g_rng(12345); // Fixed seed: every run benchmarks the same data
+
+static float randomFloat(float lo, float hi) {
+    return std::uniform_real_distribution<float>(lo, hi)(g_rng);
+}
+
+static Vec3 randomVec3(float lo, float hi) {
+    return Vec3(randomFloat(lo, hi), randomFloat(lo, hi), randomFloat(lo, hi));
+}
+
+static Mat4 randomTRS() {
+    return Mat4::fromTRS(randomVec3(-50.0f, 50.0f),
+                         Quat::fromEuler(randomVec3(-180.0f, 180.0f)),
+                         randomVec3(0.5f, 2.0f));
+}
+
+static Transform randomTransform() {
+    Transform t;
+    t.position = randomVec3(-100.0f, 100.0f);
+    t.rotation = Quat::fromEuler(randomVec3(-180.0f, 180.0f));
+    t.scale = randomVec3(0.5f, 2.0f);
+    return t;
+}
+
+// --- Benchmarks ---
+// Each benchmark builds its data for 'size' items and returns the measured callable.
+
+using BenchFactory = std::function<std::function<void()>(size_t size)>;
+
+struct BenchDef {
+    std::string name;
+    BenchFactory factory;
+};
+
+static std::vector<BenchDef> makeBenchmarks() {
+    std::vector<BenchDef> benches;
+
+    benches.push_back({ "Mat4::operator*", [](size_t n) {
+        auto a = std::make_shared<std::vector<Mat4>>(n), b = std::make_shared<std::vector<Mat4>>(n);
+        auto out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) { (*a)[i] = randomTRS(); (*b)[i] = randomTRS(); }
+        return [a, b, out, n]() {
+            for (size_t i = 0; i < n; ++i) (*out)[i] = (*a)[i] * (*b)[i];
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "Mat4::multiplyScalar", [](size_t n) {
+        auto a = std::make_shared<std::vector<Mat4>>(n), b = std::make_shared<std::vector<Mat4>>(n);
+        auto out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) { (*a)[i] = randomTRS(); (*b)[i] = randomTRS(); }
+        return [a, b, out, n]() {
+            for (size_t i = 0; i < n; ++i) (*out)[i] = (*a)[i].multiplyScalar((*b)[i]);
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "multiplyMatrices(viewProj*model)", [](size_t n) {
+        auto models = std::make_shared<std::vector<Mat4>>(n), out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) (*models)[i] = randomTRS();
+        Mat4 viewProj = Mat4::perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f) *
+                        Mat4::lookAt(Vec3(0.0f, 5.0f, 20.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+        return [models, out, viewProj, n]() {
+            multiplyMatrices(viewProj, models->data(), out->data(), n);
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "Mat4::inverse", [](size_t n) {
+        auto m = std::make_shared<std::vector<Mat4>>(n), out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) (*m)[i] = randomTRS();
+        return [m, out, n]() {
+            for (size_t i = 0; i < n; ++i) (*out)[i] = (*m)[i].inverse();
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "Mat4::inverseScalar", [](size_t n) {
+        auto m = std::make_shared<std::vector<Mat4>>(n), out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) (*m)[i] = randomTRS();
+        return [m, out, n]() {
+            for (size_t i = 0; i < n; ++i) (*out)[i] = (*m)[i].inverseScalar();
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "Mat4::lookAt", [](size_t n) {
+        auto eyes = std::make_shared<std::vector<Vec3>>(n), targets = std::make_shared<std::vector<Vec3>>(n);
+        auto out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) { (*eyes)[i] = randomVec3(-50.0f, 50.0f); (*targets)[i] = randomVec3(-5.0f, 5.0f); }
+        return [eyes, targets, out, n]() {
+            const Vec3 up(0.0f, 1.0f, 0.0f);
+            for (size_t i = 0; i < n; ++i) (*out)[i] = Mat4::lookAt((*eyes)[i], (*targets)[i], up);
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    benches.push_back({ "transformPoints", [](size_t n) {
+        auto in = std::make_shared<std::vector<Vec3>>(n), out = std::make_shared<std::vector<Vec3>>(n);
+        for (size_t i = 0; i < n; ++i) (*in)[i] = randomVec3(-10.0f, 10.0f);
+        Mat4 m = randomTRS();
+        return [in, out, m, n]() {
+            transformPoints(m, in->data(), out->data(), n);
+            g_sink = g_sink + (*out)[n / 2].y;
+        };
+    } });
+
+    benches.push_back({ "intersectRayAABB", [](size_t n) {
+        auto boxes = std::make_shared<std::vector<AABB>>(n);
+        for (size_t i = 0; i < n; ++i) (*boxes)[i] = AABB(randomVec3(-100.0f, 100.0f), randomVec3(0.1f, 2.0f));
+        Ray ray(Vec3(0.0f, 0.0f, -150.0f), Vec3(0.05f, 0.02f, 1.0f));
+        return [boxes, ray, n]() {
+            int hits = 0;
+            for (size_t i = 0; i < n; ++i) {
+                float t;
+                if (intersectRayAABB(ray, (*boxes)[i], t)) ++hits;
+            }
+            g_sink = g_sink + static_cast<float>(hits);
+        };
+    } });
+
+    benches.push_back({ "Camera::getViewMatrix", [](size_t n) {
+        // A small pool of cameras cycled through: realistic cache footprint, varied inputs.
+        auto cameras = std::make_shared<std::vector<Camera>>();
+        for (int i = 0; i < 256; ++i) cameras->emplace_back(randomVec3(-20.0f, 20.0f), randomVec3(-2.0f, 2.0f));
+        return [cameras, n]() {
+            float acc = 0.0f;
+            for (size_t i = 0; i < n; ++i) acc += (*cameras)[i & 255].getViewMatrix().elements[14];
+            g_sink = g_sink + acc;
+        };
+    } });
+
+    // The per-object model-matrix loop from main() before the quaternion/scene-graph work:
+    // translate * rotateEuler * scale built from scratch for every object, every frame.
+    benches.push_back({ "modelMatrix/eulerProducts", [](size_t n) {
+        auto positions = std::make_shared<std::vector<Vec3>>(n), rotations = std::make_shared<std::vector<Vec3>>(n);
+        auto scales = std::make_shared<std::vector<Vec3>>(n);
+        auto out = std::make_shared<std::vector<Mat4>>(n);
+        for (size_t i = 0; i < n; ++i) {
+            (*positions)[i] = randomVec3(-100.0f, 100.0f);
+            (*rotations)[i] = randomVec3(-180.0f, 180.0f);
+            (*scales)[i] = randomVec3(0.5f, 2.0f);
+        }
+        return [positions, rotations, scales, out, n]() {
+            for (size_t i = 0; i < n; ++i) {
+                (*out)[i] = Mat4::translate((*positions)[i]) * Mat4::rotateEuler((*rotations)[i]) * Mat4::scale((*scales)[i]);
+            }
+            g_sink = g_sink + (*out)[n / 2].elements[5];
+        };
+    } });
+
+    // Current per-object path: closed-form TRS over the ECS Transform columns.
+    benches.push_back({ "modelMatrix/ecsFromTRS", [](size_t n) {
+        auto world = std::make_shared<World>();
+        for (size_t i = 0; i < n; ++i) world->add<Transform>(world->create(), randomTransform());
+        auto out = std::make_shared<std::vector<Mat4>>(n);
+        return [world, out]() {
+            Mat4* dst = out->data();
+            world->eachChunk<Transform>([&dst](size_t count, const Entity*, const Transform* transforms) {
+                for (size_t i = 0; i < count; ++i) *dst++ = transforms[i].getLocalMatrix();
+            });
+            g_sink = g_sink + (*out)[0].elements[5];
+        };
+    } });
+
+    // Raw ECS iteration cost: read every Transform once (memory-bandwidth bound at large sizes).
+    benches.push_back({ "ecs/iterateTransforms", [](size_t n) {
+        auto world = std::make_shared<World>();
+        for (size_t i = 0; i < n; ++i) world->add<Transform>(world->create(), randomTransform());
+        return [world]() {
+            float acc = 0.0f;
+            world->eachChunk<Transform>([&acc](size_t count, const Entity*, const Transform* transforms) {
+                for (size_t i = 0; i < count; ++i) acc += transforms[i].position.x + transforms[i].scale.y;
+            });
+            g_sink = g_sink + acc;
+        };
+    } });
+
+    // Scene graph with every node dirty (worst case, e.g. first frame after load).
+    // Hierarchy: chains of 8 nodes, so world matrices involve parent products.
+    benches.push_back({ "sceneGraph/updateAllDirty", [](size_t n) {
+        auto world = std::make_shared<World>();
+        auto graph = std::make_shared<SceneGraph>();
+        Entity parent;
+        for (size_t i = 0; i < n; ++i) {
+            Entity e = world->create();
+            world->add<Transform>(e, randomTransform());
+            graph->addNode(e, (i % 8 == 0) ? Entity::null() : parent);
+            parent = e;
+        }
+        return [world, graph]() {
+            graph->markAllDirty();
+            graph->update(*world);
+            g_sink = g_sink + graph->getWorldMatrixAt(0).elements[5];
+        };
+    } });
+
+    // Mostly static scene: 1% of the nodes change per frame.
+    benches.push_back({ "sceneGraph/update1PercentDirty", [](size_t n) {
+        auto world = std::make_shared<World>();
+        auto graph = std::make_shared<SceneGraph>();
+        auto entities = std::make_shared<std::vector<Entity>>();
+        Entity parent;
+        for (size_t i = 0; i < n; ++i) {
+            Entity e = world->create();
+            world->add<Transform>(e, randomTransform());
+            graph->addNode(e, (i % 8 == 0) ? Entity::null() : parent);
+            entities->push_back(e);
+            parent = e;
+        }
+        graph->update(*world);
+        return [world, graph, entities]() {
+            const size_t count = entities->size();
+            const size_t step = 100;
+            for (size_t i = 0; i < count; i += step) graph->markDirty((*entities)[i]);
+            g_sink = g_sink + static_cast<float>(graph->update(*world));
+        };
+    } });
+
+    // Radix sort of render keys: a few shaders/materials/meshes with random depths, as a frame would produce.
+    benches.push_back({ "renderQueue/radixSort", [](size_t n) {
+        auto source = std::make_shared<std::vector<uint64_t>>(n);
+        auto keys = std::make_shared<std::vector<uint64_t>>(n);
+        auto refs = std::make_shared<std::vector<uint32_t>>(n);
+        auto tmpKeys = std::make_shared<std::vector<uint64_t>>(n);
+        auto tmpRefs = std::make_shared<std::vector<uint32_t>>(n);
+        for (size_t i = 0; i < n; ++i) {
+            const bool translucent = (i % 16) == 0;
+            (*source)[i] = SortKey::make(translucent ? RenderPass::Translucent : RenderPass::Opaque, translucent,
+                                         static_cast<uint32_t>(g_rng() % 4), static_cast<uint32_t>(g_rng() % 32),
+                                         static_cast<uint32_t>(g_rng() % 64), randomFloat(0.0f, 1.0f));
+        }
+        return [source, keys, refs, tmpKeys, tmpRefs]() {
+            const size_t count = source->size();
+            std::copy(source->begin(), source->end(), keys->begin());
+            for (size_t i = 0; i < count; ++i) (*refs)[i] = static_cast<uint32_t>(i);
+            radixSortKeys(keys->data(), refs->data(), tmpKeys->data(), tmpRefs->data(), count);
+            g_sink = g_sink + static_cast<float>((*refs)[0]);
+        };
+    } });
+
+    // Frustum test only (bounds already in SoA form): objects spread over a large outdoor area,
+    // camera looking along it, so most of them are rejected.
+    for (int simd = 1; simd >= 0; --simd) {
+        benches.push_back({ simd ? "culling/frustum" : "culling/frustumScalar", [simd](size_t n) {
+            auto culler = std::make_shared<FrustumCuller>();
+            auto out = std::make_shared<std::vector<uint32_t>>(n);
+            culler->resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                AABB box(Vec3(randomFloat(-500.0f, 500.0f), randomFloat(0.0f, 20.0f), randomFloat(-500.0f, 500.0f)),
+                         randomVec3(0.5f, 4.0f));
+                culler->setBounds(i, box);
+            }
+            Mat4 view = Mat4::lookAt(Vec3(0.0f, 10.0f, 0.0f), Vec3(0.0f, 10.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f));
+            Frustum frustum = Frustum::fromMatrix(Mat4::perspective(0.785f, 16.0f / 9.0f, 0.1f, 300.0f) * view);
+            return [culler, out, frustum, simd]() {
+                size_t visible = simd ? culler->cullRange(frustum, 0, culler->size(), out->data())
+                                      : culler->cullRangeScalar(frustum, 0, culler->size(), out->data());
+                g_sink = g_sink + static_cast<float>(visible);
+            };
+        } });
+    }
+
+    // Occlusion: rasterize 32 wall occluders, then test n boxes behind and between them.
+    benches.push_back({ "culling/occlusion", [](size_t n) {
+        auto culler = std::make_shared<OcclusionCuller>();
+        auto boxes = std::make_shared<std::vector<AABB>>(n);
+        const uint32_t wall = culler->addOccluderMesh(MeshData::cube());
+        culler->beginFrame(Mat4::perspective(0.785f, 2.0f, 0.1f, 300.0f) *
+                           Mat4::lookAt(Vec3(0.0f, 2.0f, 0.0f), Vec3(0.0f, 2.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f)));
+        for (int i = 0; i < 32; ++i) {
+            Vec3 position(randomFloat(-60.0f, 60.0f), 2.0f, randomFloat(-150.0f, -10.0f));
+            culler->addOccluder(wall, Mat4::translate(position) * Mat4::scale(Vec3(randomFloat(5.0f, 20.0f), 4.0f, 0.5f)));
+        }
+        culler->render();
+        for (AABB& box : *boxes) {
+            Vec3 center(randomFloat(-100.0f, 100.0f), randomFloat(0.0f, 4.0f), randomFloat(-200.0f, -5.0f));
+            Vec3 extents = randomVec3(0.25f, 2.0f);
+            box = AABB(center - extents, center + extents);
+        }
+        return [culler, boxes]() {
+            size_t visible = 0;
+            for (const AABB& box : *boxes) visible += culler->isVisible(box) ? 1 : 0;
+            g_sink = g_sink + static_cast<float>(visible);
+        };
+    } });
+
+    // Meshlet culling: test about n meshlets of a dense sphere, instanced at random positions and
+    // scales in front of the camera (frustum and normal cone tests, ranges merged).
+    benches.push_back({ "culling/meshlets", [](size_t n) {
+        MeshData sphere = MeshData::sphere(256, 128);
+        MeshOptimizer::optimize(sphere);
+        auto meshlets = std::make_shared<std::vector<Meshlet>>();
+        MeshletBuilder::build(MeshDataView(sphere), *meshlets);
+        auto ranges = std::make_shared<std::vector<MeshletRange>>(meshlets->size());
+        auto models = std::make_shared<std::vector<Mat4>>((n + meshlets->size() - 1) / meshlets->size());
+        for (Mat4& model : *models) {
+            model = Mat4::translate(Vec3(randomFloat(-30.0f, 30.0f), randomFloat(0.0f, 4.0f), randomFloat(-60.0f, 0.0f))) *
+                    Mat4::scale(Vec3(1.0f, 1.0f, 1.0f) * randomFloat(1.0f, 8.0f));
+        }
+        auto culler = std::make_shared<MeshletCuller>();
+        const Mat4 view = Mat4::lookAt(Vec3(0.0f, 2.0f, 0.0f), Vec3(0.0f, 2.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f));
+        culler->setView(Frustum::fromMatrix(Mat4::perspective(0.785f, 16.0f / 9.0f, 0.1f, 300.0f) * view), Vec3(0.0f, 2.0f, 0.0f));
+        const bool singleSided = sphere.singleSided; // Closed: the cone test runs
+        return [culler, meshlets, ranges, models, singleSided]() {
+            size_t total = 0;
+            for (const Mat4& model : *models) total += culler->cull(meshlets->data(), meshlets->size(), model, singleSided, ranges->data());
+            g_sink = g_sink + static_cast<float>(total);
+        };
+    } });
+
+    // Shadow caster culling: fit four cascades to an orbiting camera, then cull n objects spread
+    // over a 200 x 200 area to each cascade's caster volume (what a frame's shadow setup costs).
+    benches.push_back({ "culling/shadow_cascades", [](size_t n) {
+        auto culler = std::make_shared<FrustumCuller>();
+        culler->resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            culler->setBounds(i, BoundingSphere(Vec3(randomFloat(-100.0f, 100.0f), randomFloat(0.0f, 4.0f), randomFloat(-100.0f, 100.0f)),
+                                                randomFloat(0.5f, 2.0f)));
+        }
+        auto cascades = std::make_shared<ShadowCascades>();
+        cascades->setLightDirection(Vec3(-0.45f, -1.0f, -0.35f));
+        auto visible = std::make_shared<std::vector<uint32_t>>();
+        auto angle = std::make_shared<float>(0.0f);
+        const Mat4 projection = Mat4::perspective(0.785f, 16.0f / 9.0f, 0.1f, 1000.0f);
+        return [culler, cascades, visible, angle, projection]() {
+            *angle += 0.01f;
+            const Vec3 eye(std::cos(*angle) * 20.0f, 3.0f, std::sin(*angle) * 20.0f);
+            cascades->update(Mat4::lookAt(eye, Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f)), projection);
+            size_t total = 0;
+            for (uint32_t c = 0; c < cascades->getCascadeCount(); ++c) total += culler->cull(cascades->getCascade(c).casterFrustum, *visible);
+            g_sink = g_sink + static_cast<float>(total);
+        };
+    } });
+
+    // Clustered lighting: bin n point/spot lights spread in front of the camera (in chunks of
+    // MAX_LIGHTS, the most one build takes).
+    benches.push_back({ "lighting/cluster_build", [](size_t n) {
+        const size_t perBuild = std::min<size_t>(n, LightClusterer::MAX_LIGHTS);
+        auto clusterer = std::make_shared<LightClusterer>();
+        clusterer->setView(Mat4::lookAt(Vec3(0.0f, 2.0f, 0.0f), Vec3(0.0f, 2.0f, -1.0f), Vec3(0.0f, 1.0f, 0.0f)),
+                           Mat4::perspective(0.785f, 16.0f / 9.0f, 0.1f, 1000.0f), 1280, 720);
+        for (size_t i = 0; i < perBuild; ++i) {
+            const Mat4 world = Mat4::translate(Vec3(randomFloat(-60.0f, 60.0f), randomFloat(0.0f, 6.0f), randomFloat(-120.0f, 0.0f)));
+            const Vec3 color = randomVec3(0.2f, 1.0f);
+            clusterer->addLight(i % 4 == 3 ? Light::spot(color, 5.0f, randomFloat(2.0f, 6.0f), Vec3(0.0f, -1.0f, 0.0f), 20.0f, 35.0f)
+                                           : Light::point(color, 3.0f, randomFloat(1.0f, 4.0f)), world);
+        }
+        const size_t builds = (n + perBuild - 1) / perBuild;
+        return [clusterer, builds]() {
+            for (size_t b = 0; b < builds; ++b) clusterer->build();
+            g_sink = g_sink + static_cast<float>(clusterer->getLightIndices().size());
+        };
+    } });
+
+    // Mesh cooking: Forsyth-reorder about n triangles of a grid whose triangles were shuffled
+    // (the worst case for the cache, like a mesh exported in material or random order).
+    benches.push_back({ "mesh/optimize_vertex_cache", [](size_t n) {
+        uint32_t side = 1;
+        while (static_cast<size_t>(side) * side * 2 < n) ++side;
+        auto shuffled = std::make_shared<std::vector<uint32_t>>();
+        for (uint32_t y = 0; y < side; ++y) {
+            for (uint32_t x = 0; x < side; ++x) {
+                const uint32_t a = y * (side + 1) + x, b = a + side + 1;
+                shuffled->insert(shuffled->end(), { a, a + 1, b + 1, a, b + 1, b });
+            }
+        }
+        for (size_t t = shuffled->size() / 3; t > 1; --t) {
+            const size_t other = g_rng() % t;
+            for (size_t k = 0; k < 3; ++k) std::swap((*shuffled)[(t - 1) * 3 + k], (*shuffled)[other * 3 + k]);
+        }
+        auto work = std::make_shared<std::vector<uint32_t>>(shuffled->size());
+        const size_t vertexCount = static_cast<size_t>(side + 1) * (side + 1);
+        return [shuffled, work, vertexCount]() {
+            std::copy(shuffled->begin(), shuffled->end(), work->begin());
+            MeshOptimizer::optimizeVertexCache(work->data(), work->size(), vertexCount);
+            g_sink = g_sink + static_cast<float>((*work)[0]);
+        };
+    } });
+
+    // Texture cooking: encode n 4x4 blocks (single-threaded) of a smooth gradient with noise,
+    // like photographic content; the block data cycles through 4096 precomputed blocks.
+    const ImageFormat encodeFormats[] = { ImageFormat::BC1, ImageFormat::BC3, ImageFormat::BC5, ImageFormat::BC7 };
+    for (ImageFormat format : encodeFormats) {
+        benches.push_back({ std::string("texture/encode_") + Image::getFormatName(format), [format](size_t n) {
+            auto texels = std::make_shared<std::vector<uint8_t>>(4096 * 64);
+            for (size_t b = 0; b < 4096; ++b) {
+                const float base = randomFloat(0.0f, 200.0f), slope = randomFloat(-8.0f, 8.0f);
+                for (size_t i = 0; i < 64; ++i) {
+                    const float value = base + slope * static_cast<float>((i / 4) % 4 + i / 16) + randomFloat(0.0f, 24.0f);
+                    (*texels)[b * 64 + i] = static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f));
+                }
+            }
+            return [texels, format, n]() {
+                uint8_t block[16];
+                for (size_t b = 0; b < n; ++b) TextureCompressor::encodeBlock(format, &(*texels)[(b % 4096) * 64], block);
+                g_sink = g_sink + static_cast<float>(block[0]);
+            };
+        } });
+    }
+
+    return benches;
+}
+
+// --- Output ---
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void writeJson(std::FILE* f, const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::time_t now = std::time(nullptr);
+    char timeBuf[64];
+    std::strftime(timeBuf, sizeof(timeBuf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::fprintf(f, "    \"date\": \"%s\",\n", timeBuf);
+    std::fprintf(f, "    \"simd\": \"%s\",\n", SIMPLEMATH_SIMD_NAME);
+#if defined(__clang__)
+    std::fprintf(f, "    \"compiler\": \"clang %s\",\n", __clang_version__);
+#elif defined(__GNUC__)
+    std::fprintf(f, "    \"compiler\": \"gcc %s\",\n", __VERSION__);
+#elif defined(_MSC_VER)
+    std::fprintf(f, "    \"compiler\": \"msvc %d\",\n", _MSC_VER);
+#else
+    std::fprintf(f, "    \"compiler\": \"unknown\",\n");
+#endif
+#ifdef NDEBUG
+    std::fprintf(f, "    \"build\": \"release\",\n");
+#else
+    std::fprintf(f, "    \"build\": \"debug\",\n");
+#endif
+    std::fprintf(f, "    \"min_sample_seconds\": %g,\n", options.minSampleSeconds);
+    std::fprintf(f, "    \"samples\": %d\n  },\n", options.samples);
+
+    std::fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"size\": %zu, \"iterations\": %zu, \"samples\": %d, "
+                        "\"mean_ns_per_item\": %.4f, \"median_ns_per_item\": %.4f, \"min_ns_per_item\": %.4f, "
+                        "\"items_per_second\": %.1f}%s\n",
+                     jsonEscape(r.name).c_str(), r.size, r.iterationsPerSample, r.samples,
+                     r.meanNsPerItem, r.medianNsPerItem, r.minNsPerItem,
+                     r.medianNsPerItem > 0.0 ? 1e9 / r.medianNsPerItem : 0.0,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+static bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--out") options.outPath = value;
+        else if (key == "--filter") options.filter = value;
+        else if (key == "--min-time") options.minSampleSeconds = std::atof(value.c_str());
+        else if (key == "--samples") options.samples = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--sizes") {
+            options.sizes.clear();
+            size_t start = 0;
+            while (start < value.size()) {
+                size_t comma = value.find(',', start);
+                if (comma == std::string::npos) comma = value.size();
+                size_t n = static_cast<size_t>(std::atoll(value.substr(start, comma - start).c_str()));
+                if (n > 0) options.sizes.push_back(n);
+                start = comma + 1;
+            }
+            if (options.sizes.empty()) { std::cerr << "ERROR::BENCH: --sizes needs at least one positive size" << std::endl; return false; }
+        } else {
+            std::cerr << "Usage: SimpleEngineBench [--out=file.json] [--filter=substring] [--sizes=1000,10000]"
+                         " [--min-time=seconds] [--samples=n]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    std::vector<BenchResult> results;
+    for (const BenchDef& bench : makeBenchmarks()) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) continue;
+        for (size_t size : options.sizes) {
+            std::function<void()> fn = bench.factory(size); // Data is freed before the next size is built
+            BenchResult r = measure(bench.name, size, options, fn);
+            std::cerr << bench.name << " [" << size << "]: " << r.medianNsPerItem << " ns/item (min "
+                      << r.minNsPerItem << ")" << std::endl;
+            results.push_back(r);
+        }
+    }
+
+    if (options.outPath.empty()) {
+        writeJson(stdout, options, results);
+    } else {
+        std::FILE* f = std::fopen(options.outPath.c_str(), "w");
+        if (!f) { std::cerr << "ERROR::BENCH: Could not open output file " << options.outPath << std::endl; return 1; }
+        writeJson(f, options, results);
+        std::fclose(f);
+    }
+    return 0;
+}
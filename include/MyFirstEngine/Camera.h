@@ -43,6 +43,10 @@ public:
 
     Mat4 getViewMatrix();
     Mat4 getProjectionMatrix(float aspectRatio);
+    // projection * view: world space to clip space.
+    Mat4 getViewProjectionMatrix(float aspectRatio);
+    // World-space view frustum, for visibility culling.
+    Frustum getFrustum(float aspectRatio);
 
     // FPS-style movement (for free-look when scene view is focused)
     void processKeyboardFPS(const char* direction, float deltaTime);
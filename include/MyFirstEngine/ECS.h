@@ -0,0 +1,261 @@
+// ECS.h
+// Archetype-based entity/component storage.
+//
+// Every distinct set of component types gets its own Archetype. An archetype stores its
+// entities in fixed-size Chunks, and inside a chunk each component type has its own tightly
+// packed column (structure-of-arrays). A query over Transform therefore streams through
+// contiguous Transform data only; cold components (names, editor data) never enter the cache.
+//
+// Entities are referred to by generational handles (index + generation). A handle stays valid
+// while its entity lives, even though the entity's data moves between chunks and archetypes;
+// once the entity is destroyed the slot's generation is bumped and stale handles stop resolving.
+
+#ifndef ECS_H
+#define ECS_H
+
+#include <cassert>     // For assert
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <new>         // For placement new
+#include <type_traits>
+#include <utility>     // For std::move, std::forward
+
+// --- Entity handle ---
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+
+    Entity() : index(0xFFFFFFFFu), generation(0) {}
+    Entity(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+    static Entity null() { return Entity(); }
+    bool isNull() const { return index == 0xFFFFFFFFu; }
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// --- Component type registry ---
+// Component types are plain structs. Each type is assigned a small integer ID the first time it
+// is used; the ID doubles as its bit in an archetype's ComponentMask.
+using ComponentTypeID = uint32_t;
+using ComponentMask = uint64_t;
+static const uint32_t MAX_COMPONENT_TYPES = 64;
+
+struct ComponentInfo {
+    size_t size;
+    size_t alignment;
+    void (*defaultConstruct)(void* dst);
+    void (*moveConstruct)(void* dst, void* src); // Move-constructs dst from src, then destroys src
+    void (*destroy)(void* ptr);
+};
+
+// Registers a component type and returns its ID. Use componentTypeID<T>() instead of calling this.
+ComponentTypeID registerComponentType(const ComponentInfo& info);
+const ComponentInfo& getComponentInfo(ComponentTypeID id);
+
+template <typename T>
+struct ComponentOps {
+    static void defaultConstruct(void* dst) { new (dst) T(); }
+    static void moveConstruct(void* dst, void* src) {
+        T* s = static_cast<T*>(src);
+        new (dst) T(std::move(*s));
+        s->~T();
+    }
+    static void destroy(void* ptr) { static_cast<T*>(ptr)->~T(); }
+};
+
+template <typename T>
+ComponentTypeID componentTypeID() {
+    static const ComponentTypeID id = registerComponentType(ComponentInfo{
+        sizeof(T), alignof(T),
+        &ComponentOps<T>::defaultConstruct, &ComponentOps<T>::moveConstruct, &ComponentOps<T>::destroy });
+    return id;
+}
+
+template <typename T>
+ComponentMask componentBit() { return ComponentMask(1) << componentTypeID<T>(); }
+
+// --- Chunk ---
+// A fixed-size block of memory holding up to Archetype::capacity entities.
+// Layout: [Entity handles][column 0][column 1]...; each column is aligned for its type.
+static const size_t ECS_CHUNK_SIZE = 16 * 1024;
+
+struct Chunk {
+    uint8_t* data;
+    uint32_t count;
+};
+
+// --- Archetype ---
+struct Archetype {
+    ComponentMask mask;
+    std::vector<ComponentTypeID> types;  // Component types in this archetype, ascending by ID
+    int columnOf[MAX_COMPONENT_TYPES];   // Maps ComponentTypeID -> index into types/columnOffsets, or -1
+    std::vector<size_t> columnOffsets;   // Byte offset of each column inside a chunk
+    uint32_t capacity;                   // Entities per chunk
+    size_t chunkBytes;                   // Allocation size of each chunk
+    std::vector<Chunk> chunks;           // All chunks are full except possibly the last one
+
+    // Cached archetype transitions when adding/removing a single component type.
+    Archetype* addEdge[MAX_COMPONENT_TYPES];
+    Archetype* removeEdge[MAX_COMPONENT_TYPES];
+
+    Entity* entities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data); }
+    void* column(const Chunk& chunk, ComponentTypeID type) const {
+        return chunk.data + columnOffsets[columnOf[type]];
+    }
+    void* component(const Chunk& chunk, ComponentTypeID type, uint32_t row) const {
+        return static_cast<uint8_t*>(column(chunk, type)) + row * getComponentInfo(type).size;
+    }
+    size_t entityCount() const {
+        return chunks.empty() ? 0 : (chunks.size() - 1) * capacity + chunks.back().count;
+    }
+};
+
+// --- World ---
+// Owns all entities and archetypes.
+// Structural changes (create/destroy/add/remove) must not happen inside each()/eachChunk():
+// they move entities between chunks and would invalidate the arrays being iterated.
+class World {
+public:
+    World();
+    ~World();
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // Creates an entity with no components.
+    Entity create();
+    // Destroys an entity and all of its components. Stale handles stop resolving afterwards.
+    void destroy(Entity entity);
+    // True if the handle refers to a living entity.
+    bool isAlive(Entity entity) const;
+    // Number of living entities.
+    size_t entityCount() const { return aliveCount; }
+
+    // Adds component T (constructed from args) to the entity and returns a reference to it.
+    // If the entity already has T, the existing component is overwritten. A stale or destroyed
+    // handle asserts; in release builds nothing is added and the returned component is a
+    // per-thread scratch value that belongs to no entity.
+    template <typename T, typename... Args>
+    T& add(Entity entity, Args&&... args);
+
+    // Removes component T from the entity, if present.
+    template <typename T>
+    void remove(Entity entity);
+
+    // Returns a pointer to the entity's component T, or nullptr if the entity is dead or lacks T.
+    // The pointer is invalidated by any structural change to the world.
+    template <typename T>
+    T* get(Entity entity);
+
+    template <typename T>
+    bool has(Entity entity) const;
+
+    // Calls fn(count, entities, columnA, columnB, ...) once per chunk of every archetype that has
+    // all of Ts. This is the fast path: the column pointers are plain arrays of length 'count'.
+    template <typename... Ts, typename Fn>
+    void eachChunk(Fn&& fn);
+
+    // Calls fn(entity, a, b, ...) for every entity that has all of Ts.
+    template <typename... Ts, typename Fn>
+    void each(Fn&& fn);
+
+private:
+    struct EntityRecord {
+        uint32_t generation;
+        Archetype* archetype; // nullptr when the slot is free
+        uint32_t chunk;
+        uint32_t row;
+    };
+
+    Archetype* getOrCreateArchetype(ComponentMask mask);
+    Archetype* archetypeWith(Archetype* from, ComponentTypeID type);
+    Archetype* archetypeWithout(Archetype* from, ComponentTypeID type);
+
+    // Appends a row to 'archetype' for 'entity' (components left unconstructed) and returns its location.
+    void allocateRow(Archetype* archetype, Entity entity, uint32_t& chunkIndex, uint32_t& row);
+    // Moves the entity to 'target', carrying over shared components. Components only present in the
+    // old archetype are destroyed; components only in the target are left unconstructed.
+    void moveEntity(Entity entity, Archetype* target);
+    // Removes the row at (chunkIndex,row), filling the hole with the archetype's last row.
+    // Does not destroy components; callers have already moved or destroyed them.
+    void removeRow(Archetype* archetype, uint32_t chunkIndex, uint32_t row);
+
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    std::vector<Archetype*> archetypes;
+    size_t aliveCount;
+};
+
+// --- Template implementations ---
+
+template <typename T, typename... Args>
+T& World::add(Entity entity, Args&&... args) {
+    assert(isAlive(entity) && "World::add on a stale or destroyed entity");
+    if (!isAlive(entity)) {
+        static thread_local T discarded;
+        discarded = T(std::forward<Args>(args)...);
+        return discarded;
+    }
+    ComponentTypeID type = componentTypeID<T>();
+    EntityRecord& rec = records[entity.index];
+    Archetype* arch = rec.archetype;
+    if (arch->mask & (ComponentMask(1) << type)) {
+        T* existing = static_cast<T*>(arch->component(arch->chunks[rec.chunk], type, rec.row));
+        *existing = T(std::forward<Args>(args)...);
+        return *existing;
+    }
+    moveEntity(entity, archetypeWith(arch, type));
+    const EntityRecord& moved = records[entity.index];
+    void* slot = moved.archetype->component(moved.archetype->chunks[moved.chunk], type, moved.row);
+    return *new (slot) T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void World::remove(Entity entity) {
+    if (!isAlive(entity)) return;
+    ComponentTypeID type = componentTypeID<T>();
+    Archetype* arch = records[entity.index].archetype;
+    if (!(arch->mask & (ComponentMask(1) << type))) return;
+    moveEntity(entity, archetypeWithout(arch, type));
+}
+
+template <typename T>
+T* World::get(Entity entity) {
+    if (!isAlive(entity)) return nullptr;
+    ComponentTypeID type = componentTypeID<T>();
+    const EntityRecord& rec = records[entity.index];
+    if (!(rec.archetype->mask & (ComponentMask(1) << type))) return nullptr;
+    return static_cast<T*>(rec.archetype->component(rec.archetype->chunks[rec.chunk], type, rec.row));
+}
+
+template <typename T>
+bool World::has(Entity entity) const {
+    if (!isAlive(entity)) return false;
+    return (records[entity.index].archetype->mask & componentBit<T>()) != 0;
+}
+
+template <typename... Ts, typename Fn>
+void World::eachChunk(Fn&& fn) {
+    const ComponentMask required = (ComponentMask(0) | ... | componentBit<Ts>());
+    for (Archetype* arch : archetypes) {
+        if ((arch->mask & required) != required) continue;
+        for (const Chunk& chunk : arch->chunks) {
+            if (chunk.count == 0) continue;
+            fn(static_cast<size_t>(chunk.count), arch->entities(chunk),
+               static_cast<Ts*>(arch->column(chunk, componentTypeID<Ts>()))...);
+        }
+    }
+}
+
+template <typename... Ts, typename Fn>
+void World::each(Fn&& fn) {
+    eachChunk<Ts...>([&fn](size_t count, Entity* entities, Ts*... columns) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(entities[i], columns[i]...);
+        }
+    });
+}
+
+#endif // ECS_H
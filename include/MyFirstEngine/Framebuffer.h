@@ -2,35 +2,66 @@
 #define FRAMEBUFFER_H
 
 #include "glad/glad.h" // For GLuint
+#include <chrono>
 
+// Off-screen render target whose attachments (capacity) can be larger than the area rendered
+// into (logical size). Growing rounds the capacity up to RESIZE_BUCKET pixels with extra
+// headroom, so dragging a dock splitter reallocates a handful of times instead of every frame;
+// shrinking only happens once the logical size has needed much less than the capacity for
+// SHRINK_DELAY_SECONDS. bind() sets the viewport to the logical size at the bottom-left corner of
+// the attachments; use getUVMax() to sample just that sub-rect (e.g. in ImGui::Image).
 class Framebuffer {
 public:
-    // Constructor: width and height of the framebuffer
+    static constexpr int RESIZE_BUCKET = 128;            // Capacity is a multiple of this (when grown)
+    static constexpr float RESIZE_HEADROOM = 0.25f;      // Extra room added on growth
+    static constexpr double SHRINK_DELAY_SECONDS = 2.0;  // How long an oversized capacity is kept
+
+    // Constructor: width and height of the framebuffer (allocated exactly, without headroom)
     Framebuffer(int width, int height);
     ~Framebuffer();
 
-    // Bind this FBO for rendering
+    // Bind this FBO for rendering, with the viewport set to the logical size
     void bind();
     // Unbind FBO, reverting to default framebuffer (0)
     void unbind();
 
-    // Resize the framebuffer and its attachments
+    // Set the logical size. Only reallocates when the capacity is too small, or when it has been
+    // far too large for a while: cheap enough to call every frame (which also lets the lazy
+    // shrink happen).
     void resize(int width, int height);
 
     GLuint getColorTexture() const { return colorTextureID; }
+    // Logical size (the rendered area)
     int getWidth() const { return fboWidth; }
     int getHeight() const { return fboHeight; }
+    // Size of the attachments
+    int getCapacityWidth() const { return capacityWidth; }
+    int getCapacityHeight() const { return capacityHeight; }
+    // Texture coordinates of the top-right corner of the logical area (bottom-left is 0,0)
+    float getUVMaxX() const { return capacityWidth > 0 ? static_cast<float>(fboWidth) / capacityWidth : 1.0f; }
+    float getUVMaxY() const { return capacityHeight > 0 ? static_cast<float>(fboHeight) / capacityHeight : 1.0f; }
+    // Number of times the attachments have been (re)created
+    unsigned int getAllocationCount() const { return allocations; }
 
 private:
-    void createAttachments(); // Helper to create/recreate texture and depth buffer
+    void createAttachments(); // Helper to create/recreate texture and depth buffer at the capacity
     void deleteAttachments(); // Helper to delete texture and depth buffer
+    // Capacity for a logical size: rounded up to RESIZE_BUCKET with RESIZE_HEADROOM
+    int grownCapacity(int size) const;
 
     GLuint fboID;             // Framebuffer object ID
     GLuint colorTextureID;    // ID of the texture used as color attachment
     GLuint depthRenderbufferID; // ID of the renderbuffer used as depth/stencil attachment
 
-    int fboWidth;
+    int fboWidth;       // Logical size
     int fboHeight;
+    int capacityWidth;  // Attachment size
+    int capacityHeight;
+    int maxSize;        // GL_MAX_TEXTURE_SIZE / GL_MAX_RENDERBUFFER_SIZE, whichever is smaller
+    unsigned int allocations;
+
+    bool shrinkPending; // The capacity is oversized for the logical size since shrinkSince
+    std::chrono::steady_clock::time_point shrinkSince;
 };
 
-#endif // FRAMEBUFFER_H
\ No newline at end of file
+#endif // FRAMEBUFFER_H
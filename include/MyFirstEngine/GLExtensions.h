@@ -0,0 +1,88 @@
+// GLExtensions.h
+// Optional OpenGL features beyond the 3.3 core profile that glad was generated for.
+//
+// The engine only requires GL 3.3. Newer functionality is used when the driver offers it
+// (either through a core version or the matching ARB/KHR extension) and falls back otherwise.
+// Call GLExtensions::load() once, right after gladLoadGLLoader(), with the same loader.
+// Before load() (or when a feature is missing) every flag is false and every pointer null.
+
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
+
+#include "glad/glad.h" // For GL types and GLADloadproc
+
+// Tokens not present in the 3.3 glad header.
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+typedef void (APIENTRYP PFN_GLBUFFERSTORAGE)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PFN_GLGETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFN_GLPROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFN_GLPROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFN_GLMAXSHADERCOMPILERTHREADS)(GLuint count);
+
+struct GLExtensions {
+    // Queries the context version and extension list and loads the entry points of the
+    // features that are available. Returns false only if no context is current.
+    static bool load(GLADloadproc loader);
+    // True if the context advertises the named extension (e.g. "GL_ARB_buffer_storage").
+    static bool has(const char* name);
+
+    static int majorVersion;
+    static int minorVersion;
+
+    // GL 4.4 / ARB_buffer_storage: immutable storage, persistent and coherent mappings.
+    static bool hasBufferStorage;
+    static PFN_GLBUFFERSTORAGE bufferStorage;
+
+    // GL 4.1 / ARB_get_program_binary: save linked programs and reload them without compiling.
+    // Only usable if the driver also reports at least one binary format.
+    static bool hasProgramBinary;
+    static PFN_GLGETPROGRAMBINARY getProgramBinary;
+    static PFN_GLPROGRAMBINARY programBinary;
+    static PFN_GLPROGRAMPARAMETERI programParameteri;
+
+    // KHR_parallel_shader_compile (or the ARB version): compiles and links run on driver threads,
+    // and GL_COMPLETION_STATUS_KHR can be polled without blocking.
+    static bool hasParallelShaderCompile;
+    static PFN_GLMAXSHADERCOMPILERTHREADS maxShaderCompilerThreads;
+
+    // Block-compressed texture formats (BC5/RGTC is GL 3.0 core and needs no flag).
+    // EXT_texture_compression_s3tc: BC1 and BC3 (DXT1/DXT5).
+    static bool hasTextureCompressionS3TC;
+    // GL 4.2 / ARB_texture_compression_bptc: BC7.
+    static bool hasTextureCompressionBPTC;
+};
+
+#endif // GLEXTENSIONS_H
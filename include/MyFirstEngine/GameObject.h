@@ -2,13 +2,14 @@
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
-#include "Transform.h"
 #include <string>
 
+// Editor-facing metadata for a scene entity: a stable display ID and a name.
+// This is cold data. It is stored as its own ECS component (its own SoA column),
+// so per-frame loops over Transform never pull names through the cache.
 struct GameObject {
     unsigned int id;
     std::string name;
-    Transform transform;
 
     static unsigned int nextID; // Static counter for unique IDs
 
@@ -24,10 +25,6 @@ struct GameObject {
             nextID = specific_id + 1;
         }
     }
-    // You might want a constructor that takes an ID and a name if you need to initialize both explicitly during creation
-    // For instance, the one I used in main.cpp : sceneGameObjects.emplace_back(0, "Triangle Alpha");
-    // Needs to be handled or use a different way to initialize in main. For simplicity, I'll remove specific ID for emplace_back now.
-    // So, let's simplify the emplace_back in main for now, or add another constructor.
 };
 
-#endif // GAMEOBJECT_H
\ No newline at end of file
+#endif // GAMEOBJECT_H
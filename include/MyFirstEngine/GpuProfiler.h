@@ -0,0 +1,84 @@
+// GpuProfiler.h
+// GPU scope timing with GL_TIMESTAMP queries, read back without stalling the CPU.
+//
+// beginScope()/endScope() record a glQueryCounter(GL_TIMESTAMP) at each end of a scope, so scopes
+// can nest (GL_TIME_ELAPSED queries cannot, and the headless runner already wraps whole frames
+// in one). Queries live in per-frame pools and are double-buffered: frame N's results are read
+// when its pool comes round again at frame N + 2, by which time the GPU has normally finished
+// them. If not, the read waits and getStallCount() goes up. Results are passed on to the
+// Profiler as GPU events of frame N.
+//
+// Usage, once per frame:
+//   gpuProfiler.beginFrame(Profiler::get().getFrameIndex());
+//   { GpuProfileScope scope(gpuProfiler, "Scene Pass"); ... draw ... }
+//   gpuProfiler.endFrame();
+
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "MyFirstEngine/Profiler.h"
+#include <cstdint>
+#include <vector>
+
+class GpuProfiler {
+public:
+    static constexpr int FRAME_BUFFERS = 2;
+    static constexpr uint32_t MAX_SCOPES = 64; // Per frame; extra scopes are ignored
+
+    GpuProfiler();
+    // Deletes the query objects (the GL context must still be current).
+    ~GpuProfiler();
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Creates the query pools. Requires a current GL 3.3 context.
+    bool init();
+
+    // Collects the results of the frame that last used this pool, then starts recording 'frame'.
+    void beginFrame(uint64_t frame);
+    void endFrame();
+    // 'name' must be a string literal (it is kept until the results are read).
+    void beginScope(const char* name);
+    void endScope();
+
+    // Times the readback had to wait for the GPU.
+    unsigned int getStallCount() const { return stalls; }
+
+private:
+    struct Scope {
+        const char* name;
+        uint32_t depth;
+        uint32_t beginQuery; // Indices into FramePool::queries
+        uint32_t endQuery;
+    };
+    struct FramePool {
+        std::vector<unsigned int> queries; // 2 * MAX_SCOPES GL_TIMESTAMP queries
+        std::vector<Scope> scopes;
+        uint32_t usedQueries;
+        uint64_t frame;
+        bool pending; // Issued and not read back yet
+    };
+
+    void collect(FramePool& pool);
+
+    FramePool pools[FRAME_BUFFERS];
+    int currentPool;
+    bool recording;
+    std::vector<uint32_t> openScopes; // Stack of indices into the current pool's scopes
+    std::vector<Profiler::Event> resultScratch;
+    unsigned int stalls;
+};
+
+// Times the enclosing block on the GPU.
+class GpuProfileScope {
+public:
+    GpuProfileScope(GpuProfiler& profiler, const char* name) : profiler(profiler) { profiler.beginScope(name); }
+    ~GpuProfileScope() { profiler.endScope(); }
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    GpuProfiler& profiler;
+};
+
+#endif // GPUPROFILER_H
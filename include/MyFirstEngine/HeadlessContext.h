@@ -0,0 +1,37 @@
+// HeadlessContext.h
+// Window-less OpenGL 3.3 core context created through EGL.
+//
+// Used by the headless runner on CI/render-farm machines without a display. The context is
+// made current without a window: surfaceless if the driver supports EGL_KHR_surfaceless_context,
+// otherwise with a tiny pbuffer. All rendering goes into Framebuffer objects anyway, so the
+// default framebuffer is never drawn to. On GPU-less machines Mesa's llvmpipe provides the context.
+
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+class HeadlessContext {
+public:
+    HeadlessContext();
+    // Destroys the context and terminates the EGL display.
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates the context, makes it current on this thread and loads GL functions through glad.
+    // Returns true on success, false otherwise (errors are printed).
+    bool init();
+
+    // GL function lookup, usable as a GLADloadproc.
+    static void* getProcAddress(const char* name);
+
+    // Human-readable description of how the context was created ("surfaceless", "pbuffer").
+    const char* getSurfaceMode() const { return surfaceMode; }
+
+private:
+    void* display; // EGLDisplay
+    void* context; // EGLContext
+    void* surface; // EGLSurface, EGL_NO_SURFACE in surfaceless mode
+    const char* surfaceMode;
+};
+
+#endif // HEADLESSCONTEXT_H
@@ -0,0 +1,77 @@
+// Image.h
+// CPU-side images with a full mip chain, as decoded for the texture streamer.
+//
+// Image::load() decodes binary PPM/PGM (P6/P5, 8-bit) and uncompressed or RLE TGA (24/32-bit
+// color, 8-bit gray) files to tightly packed RGBA8; generateMips() then adds every level down
+// to 1x1 with a 2x2 box filter. Nothing here touches OpenGL, so decoding can run on any thread;
+// TextureStreamer.h uploads the levels.
+//
+// load() also reads cooked textures (.setex, written by saveCooked() and the texture cooker):
+// the mip chain is stored ready to upload, in RGBA8 or one of the block-compressed formats
+// (TextureCompressor.h), so loading one is a file read with nothing to decode or filter.
+//   FileHeader (24 bytes: magic "SETX", version, format, width, height, level count), then each
+//   level's data in order, level 0 first; sizes follow from the format and the level sizes.
+// For block formats 'pixels' holds 4x4 blocks, row by row, and a "row" is a row of blocks.
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class ImageFormat : uint32_t {
+    RGBA8 = 0, // 4 bytes per pixel, rows tightly packed
+    BC1 = 1,   // RGB, 8 bytes per 4x4 block (alpha ignored)
+    BC3 = 2,   // RGBA, 16 bytes per block: BC4 alpha + BC1 color
+    BC5 = 3,   // RG, 16 bytes per block: two BC4 channels (normal maps); B reads 0
+    BC7 = 4    // RGBA, 16 bytes per block, highest quality
+};
+
+struct ImageLevel {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct Image {
+    ImageFormat format = ImageFormat::RGBA8;
+    std::vector<ImageLevel> levels; // Level 0 is the full-size image
+
+    uint32_t getWidth() const { return levels.empty() ? 0 : levels[0].width; }
+    uint32_t getHeight() const { return levels.empty() ? 0 : levels[0].height; }
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levels.size()); }
+    bool isCompressed() const { return format != ImageFormat::RGBA8; }
+    // Rows of 'level' (block rows for compressed formats), bytes of one row, and bytes of the
+    // levels [firstLevel, getLevelCount()).
+    uint32_t getRowCount(uint32_t level) const { return (levels[level].height + getBlockSize(format) - 1) / getBlockSize(format); }
+    size_t getRowBytes(uint32_t level) const {
+        return static_cast<size_t>((levels[level].width + getBlockSize(format) - 1) / getBlockSize(format)) * getBlockBytes(format);
+    }
+    size_t getByteSize(uint32_t firstLevel = 0) const;
+
+    // Replaces the image with level 0 of the file at 'path', or with every level of a cooked
+    // texture. Prints an error and returns false for unreadable files and unsupported formats.
+    bool load(const std::string& path);
+    // Writes level 'level' of an RGBA8 image as a binary PPM (alpha is dropped).
+    bool savePPM(const std::string& path, uint32_t level = 0) const;
+    // Writes every level as a cooked texture, through a temporary file renamed into place.
+    bool saveCooked(const std::string& path) const;
+    // Replaces levels 1.. of an RGBA8 image with box-filtered reductions of level 0, down to 1x1.
+    void generateMips();
+
+    // Number of levels of a full chain for a width x height image.
+    static uint32_t fullLevelCount(uint32_t width, uint32_t height);
+    // Texels per block side (1 for RGBA8, else 4) and bytes per block (per texel for RGBA8).
+    static uint32_t getBlockSize(ImageFormat format) { return format == ImageFormat::RGBA8 ? 1 : 4; }
+    static uint32_t getBlockBytes(ImageFormat format) {
+        return format == ImageFormat::RGBA8 ? 4 : (format == ImageFormat::BC1 ? 8 : 16);
+    }
+    // Lower-case name ("rgba8", "bc1", ...) and the reverse; parseFormat() returns false for
+    // unknown names.
+    static const char* getFormatName(ImageFormat format);
+    static bool parseFormat(const std::string& name, ImageFormat& format);
+};
+
+#endif // IMAGE_H
@@ -0,0 +1,104 @@
+// LOD.h
+// Level-of-detail selection by projected screen-space error.
+//
+// An LODGroup component lists up to MAX_LEVELS meshes of the same object, finest first, each with
+// its geometric error: how far (in object units) the simplified surface may deviate from the
+// original. Each frame LODSelector projects that error to pixels,
+//   pixels = error * scale / distance * viewportHeight / (2 * tan(fov / 2)),
+// and picks the coarsest level whose error stays below LODSettings::maxPixelError. The chosen
+// mesh is written into the entity's MeshRenderer, so culling and recording code need no changes.
+//
+// Hysteresis: a coarser level is only taken once its error drops below
+// maxPixelError * (1 - hysteresis), while the current level is kept until its own error exceeds
+// maxPixelError. Objects sitting on a threshold therefore do not switch back and forth.
+//
+// Cross-fade: with fadeDuration > 0 a switch does not pop. For fadeDuration seconds the object is
+// drawn with both levels using complementary dither patterns (see triangle.frag): the
+// incoming level is submitted with incomingFade() and the outgoing one with outgoingFade().
+// No new switch starts until the current fade has finished.
+
+#ifndef LOD_H
+#define LOD_H
+
+#include "../SimpleMath.h"
+#include "MyFirstEngine/Mesh.h"
+#include <cstdint>
+#include <vector>
+
+class World;
+class SceneGraph;
+class ThreadPool;
+
+// ECS component: the LOD levels of an entity that also has a MeshRenderer.
+struct LODGroup {
+    static constexpr uint32_t MAX_LEVELS = 4;
+
+    struct Level {
+        MeshHandle mesh;
+        float geometricError; // Object units; 0 for the full-detail mesh
+    };
+    Level levels[MAX_LEVELS];
+    uint32_t levelCount;
+
+    // Selection state, maintained by LODSelector.
+    uint32_t currentLevel;
+    uint32_t previousLevel; // Level being faded out while fadeProgress < 1
+    float fadeProgress;     // 0 at the start of a switch, 1 when done
+
+    LODGroup() : levelCount(0), currentLevel(0), previousLevel(0), fadeProgress(1.0f) {
+        for (Level& level : levels) level = Level{ INVALID_RENDER_HANDLE, 0.0f };
+    }
+
+    // Appends a level; call from finest to coarsest. Returns false when full.
+    bool addLevel(MeshHandle mesh, float geometricError) {
+        if (levelCount >= MAX_LEVELS) return false;
+        levels[levelCount++] = Level{ mesh, geometricError };
+        return true;
+    }
+
+    MeshHandle currentMesh() const { return levels[currentLevel].mesh; }
+    MeshHandle previousMesh() const { return levels[previousLevel].mesh; }
+    bool isFading() const { return fadeProgress < 1.0f; }
+    // Fade values for Renderer::submit() / RenderBucket::push() during a cross-fade.
+    float incomingFade() const { return fadeProgress; }
+    float outgoingFade() const { return fadeProgress - 1.0f; }
+};
+
+struct LODSettings {
+    float maxPixelError = 1.0f;  // Largest acceptable projected error, in pixels
+    float hysteresis = 0.25f;    // Fraction below maxPixelError required before coarsening
+    float fadeDuration = 0.25f;  // Cross-fade length in seconds; 0 switches instantly
+};
+
+class LODSelector {
+public:
+    LODSelector();
+
+    // Camera for the following selections. 'fovDegrees' is the vertical field of view
+    // (Camera::fov) and 'viewportHeight' the height of the target framebuffer in pixels.
+    void setView(const Vec3& cameraPosition, float fovDegrees, int viewportHeight);
+    void setSettings(const LODSettings& newSettings) { settings = newSettings; }
+    const LODSettings& getSettings() const { return settings; }
+
+    // Projected size in pixels of 'worldError' at 'distance' from the camera.
+    float projectedError(float worldError, float distance) const {
+        return worldError * pixelsPerUnitAtUnitDistance / (distance > 1e-4f ? distance : 1e-4f);
+    }
+    // Level to use for 'group' drawn with 'model', applying hysteresis against its current level.
+    uint32_t selectLevel(const LODGroup& group, const Mat4& model) const;
+    // Advances the cross-fade by 'deltaTime' seconds, then selects and possibly starts a switch.
+    void update(LODGroup& group, const Mat4& model, float deltaTime) const;
+
+    // Batch pass over the scene graph slots that survived culling: updates every LODGroup among
+    // them and writes its selected mesh into the MeshRenderer. Runs on 'pool' when given (each
+    // entity is only touched by one thread). Returns the number of objects that are cross-fading.
+    size_t updateVisible(World& world, const SceneGraph& graph, const std::vector<uint32_t>& slots,
+                         float deltaTime, ThreadPool* pool = nullptr) const;
+
+private:
+    LODSettings settings;
+    Vec3 cameraPosition;
+    float pixelsPerUnitAtUnitDistance; // viewportHeight / (2 * tan(fov / 2))
+};
+
+#endif // LOD_H
@@ -0,0 +1,47 @@
+// Light.h
+// ECS component for dynamic point and spot lights.
+//
+// A light is positioned by its entity's SceneGraph world matrix; spot lights also turn with it
+// (their 'direction' is in the entity's local space). Lights have a finite range: the falloff
+// reaches exactly zero at 'range', which is what lets LightClusterer bin them into a bounded set
+// of clusters. See LightClusterer.h for how they reach the shaders.
+
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "../SimpleMath.h"
+#include <cstdint>
+
+enum class LightType : uint32_t {
+    Point = 0,
+    Spot
+};
+
+struct Light {
+    LightType type;
+    Vec3 color;
+    float intensity;
+    float range;            // World units; no light beyond this distance
+    Vec3 direction;         // Spot only: local-space axis of the cone
+    float innerConeDegrees; // Spot only: full intensity inside this half-angle
+    float outerConeDegrees; // Spot only: zero outside this half-angle
+
+    Light(LightType type = LightType::Point, const Vec3& color = Vec3(1.0f, 1.0f, 1.0f), float intensity = 1.0f,
+          float range = 5.0f)
+        : type(type), color(color), intensity(intensity), range(range), direction(0.0f, -1.0f, 0.0f),
+          innerConeDegrees(20.0f), outerConeDegrees(30.0f) {}
+
+    static Light point(const Vec3& color, float intensity, float range) {
+        return Light(LightType::Point, color, intensity, range);
+    }
+    static Light spot(const Vec3& color, float intensity, float range, const Vec3& direction,
+                      float innerConeDegrees, float outerConeDegrees) {
+        Light light(LightType::Spot, color, intensity, range);
+        light.direction = direction;
+        light.innerConeDegrees = innerConeDegrees;
+        light.outerConeDegrees = outerConeDegrees;
+        return light;
+    }
+};
+
+#endif // LIGHT_H
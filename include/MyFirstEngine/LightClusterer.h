@@ -0,0 +1,121 @@
+// LightClusterer.h
+// CPU light binning for clustered forward shading.
+//
+// The view frustum is divided into CLUSTERS_X x CLUSTERS_Y screen tiles and CLUSTERS_Z depth
+// slices (froxels). Slices are spaced exponentially between the near and far planes,
+//   slice = floor(log(viewDepth) * sliceScale + sliceBias),
+// so clusters stay roughly cube-shaped at every distance. build() bounds every light with a
+// view-space sphere (spot lights with the tightest sphere around their cone) and records, per
+// cluster, the indices of the lights that may touch it. The fragment shader finds its cluster
+// from gl_FragCoord and its view depth, and only walks that cluster's list, so shading cost
+// follows the number of lights affecting each pixel rather than the number in the scene.
+//
+// Binning runs one depth slice per task on a ThreadPool. Within a slice, lights are first
+// filtered by depth range and then tested against the tile planes (which pass through the eye)
+// 4 at a time with SSE/NEON; each light is added to the tile range it overlaps. A second pass
+// turns the per-slice bins into one flat index list.
+//
+// Output (uploaded by Renderer::setLights()):
+//   getLights()       : GpuLight per light, in world space
+//   getClusters()     : (offset, count) into getLightIndices() per cluster,
+//                       cluster = (z * CLUSTERS_Y + y) * CLUSTERS_X + x, y = 0 at the bottom
+//   getLightIndices() : 16-bit light indices, grouped by cluster
+
+#ifndef LIGHTCLUSTERER_H
+#define LIGHTCLUSTERER_H
+
+#include "../SimpleMath.h"
+#include "MyFirstEngine/Light.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class World;
+class SceneGraph;
+class ThreadPool;
+
+class LightClusterer {
+public:
+    static constexpr uint32_t CLUSTERS_X = 16;
+    static constexpr uint32_t CLUSTERS_Y = 9;
+    static constexpr uint32_t CLUSTERS_Z = 24;
+    static constexpr uint32_t CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+    static constexpr uint32_t MAX_LIGHTS = 65535; // Light indices are 16-bit
+
+    // One light as the shaders read it: three RGBA32F texels.
+    struct GpuLight {
+        float positionRange[4];     // World position, range
+        float colorCosOuter[4];     // color * intensity, cos(outer cone) (-2 for point lights)
+        float directionCosInner[4]; // World spot direction, cos(inner cone)
+    };
+    struct Cluster {
+        uint32_t offset; // Into getLightIndices()
+        uint32_t count;
+    };
+
+    LightClusterer();
+
+    // Camera for the next build(). 'projection' must be a perspective matrix (near/far and the
+    // field of view are read from it); the viewport is the size of the target in pixels.
+    void setView(const Mat4& view, const Mat4& projection, int viewportWidth, int viewportHeight);
+
+    // Removes all lights.
+    void clearLights();
+    // Adds a light placed by 'world' (the entity's world matrix). Returns false once MAX_LIGHTS
+    // lights have been added.
+    bool addLight(const Light& light, const Mat4& world);
+    // Replaces the lights with every entity that has a Light component and a scene graph node.
+    // Returns the number of lights.
+    size_t gatherLights(World& world, const SceneGraph& graph);
+
+    // Bins the lights into clusters for the current view. Runs on 'pool' when given.
+    void build(ThreadPool* pool = nullptr);
+
+    const std::vector<GpuLight>& getLights() const { return lights; }
+    const std::vector<Cluster>& getClusters() const { return clusters; }
+    const std::vector<uint16_t>& getLightIndices() const { return lightIndices; }
+    size_t getLightCount() const { return lights.size(); }
+    // Slice mapping for the shader (see above).
+    float getSliceScale() const { return sliceScale; }
+    float getSliceBias() const { return sliceBias; }
+    int getViewportWidth() const { return viewportWidth; }
+    int getViewportHeight() const { return viewportHeight; }
+    // Longest cluster list of the last build().
+    uint32_t getMaxLightsPerCluster() const { return maxLightsPerCluster; }
+
+private:
+    // Bins of one depth slice, owned by the thread that builds it.
+    struct SliceBins {
+        std::vector<uint32_t> candidates; // Lights overlapping the slice's depth range
+        std::vector<uint32_t> entries;    // (tile << 16) | light
+        uint32_t tileCounts[CLUSTERS_X * CLUSTERS_Y];
+    };
+
+    // Fills slice 'z' of 'slices'.
+    void binSlice(uint32_t z);
+    // Tile range overlapped by one light sphere, as bit masks of columns and rows.
+    void tileMasks(float x, float y, float depth, float radius, uint32_t& columns, uint32_t& rows) const;
+    // Moves slice 'z''s entries into lightIndices at the offsets in 'clusters'.
+    void scatterSlice(uint32_t z);
+
+    Mat4 viewMatrix;
+    float nearPlane, farPlane;
+    float sliceScale, sliceBias;
+    float sliceDepths[CLUSTERS_Z + 1]; // View depth of each slice boundary
+    // Tile boundary planes through the eye: x = columnSlopes[i] * depth (likewise for rows),
+    // with 1 / sqrt(1 + slope^2) to turn the plane equation into a distance.
+    float columnSlopes[CLUSTERS_X + 1], columnScales[CLUSTERS_X + 1];
+    float rowSlopes[CLUSTERS_Y + 1], rowScales[CLUSTERS_Y + 1];
+    int viewportWidth, viewportHeight;
+
+    std::vector<GpuLight> lights;
+    // View-space bounding spheres, structure-of-arrays (depth is -z, positive in front).
+    std::vector<float> boundsX, boundsY, boundsDepth, boundsRadius;
+
+    SliceBins slices[CLUSTERS_Z];
+    std::vector<Cluster> clusters;
+    std::vector<uint16_t> lightIndices;
+    uint32_t maxLightsPerCluster;
+};
+
+#endif // LIGHTCLUSTERER_H
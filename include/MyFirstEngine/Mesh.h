@@ -0,0 +1,227 @@
+// Mesh.h
+// CPU-side mesh description: vertex formats, indexed vertex data and bounds.
+//
+// A VertexFormat lists the attributes of one interleaved vertex, their component types and the
+// shader location each one feeds. MeshData is what gets handed to MeshManager::createMesh():
+// interleaved float vertices plus 32-bit triangle indices. PackedMeshData holds vertices in any
+// format as raw bytes (e.g. quantized by MeshOptimizer::quantize()), and MeshDataView is either
+// without owning the arrays (e.g. pointing into a memory-mapped cooked mesh, see MeshFile.h).
+// Packed meshes and views may also carry meshlets, which the Renderer culls per cluster.
+// All three record whether the mesh is single-sided (closed, or authored to be seen from the front
+// only), which allows culling clusters that face away (see Meshlet.h).
+// Nothing here touches OpenGL; the GPU side lives in MeshManager.h.
+//
+// Attribute locations are shared by every material shader:
+//   0 = position, 1 = color, 2 = normal, 3-6 = per-instance model matrix, 7 = texture coordinate,
+//   8 = per-instance LOD fade (float, see LOD.h), 9 = per-draw position dequantization (a constant
+//   attribute, see PositionDequantization).
+
+#ifndef MESH_H
+#define MESH_H
+
+#include "../SimpleMath.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Handles to meshes and materials owned by the Renderer (indices into its internal tables).
+using MeshHandle = unsigned int;
+using MaterialHandle = unsigned int;
+static const unsigned int INVALID_RENDER_HANDLE = 0xFFFFFFFFu;
+
+enum class VertexAttribute : uint32_t {
+    Position = 0,
+    Color = 1,
+    Normal = 2,
+    TexCoord0 = 7
+};
+// First of the four locations (one per column) holding the per-instance model matrix.
+static const uint32_t INSTANCE_MODEL_LOCATION = 3;
+// Per-instance dither fade for LOD cross-fades (1 = fully drawn). Shaders may ignore it.
+static const uint32_t INSTANCE_FADE_LOCATION = 8;
+// Not an array: the Renderer sets it per draw with glVertexAttrib4f (offset xyz, scale w).
+static const uint32_t MESH_DEQUANTIZATION_LOCATION = 9;
+
+// How the components of an attribute are stored. All but Float32 are converted to floats by the
+// vertex fetch, so shaders declare every attribute as float vectors.
+enum class VertexComponentType : uint32_t {
+    Float32 = 0,
+    Float16 = 1,       // Half float
+    SNorm16 = 2,       // Signed 16-bit, [-32767, 32767] read as [-1, 1]
+    UNorm8 = 3,        // Unsigned 8-bit, [0, 255] read as [0, 1]
+    SNorm10_10_10_2 = 4 // Four signed normalized components packed into 32 bits (x in the low bits)
+};
+
+struct VertexFormat {
+    static constexpr uint32_t MAX_ATTRIBUTES = 8;
+
+    struct Element {
+        VertexAttribute attribute;
+        uint32_t components; // 1-4 (always 4 for SNorm10_10_10_2)
+        uint32_t offset;     // In bytes from the start of the vertex
+        VertexComponentType type;
+    };
+
+    Element elements[MAX_ATTRIBUTES];
+    uint32_t elementCount;
+    uint32_t stride; // In bytes
+
+    VertexFormat() : elementCount(0), stride(0) {}
+
+    // Appends an attribute after the existing ones. Elements are padded to 4 bytes, the
+    // alignment GL wants for vertex attributes.
+    VertexFormat& add(VertexAttribute attribute, uint32_t components, VertexComponentType type = VertexComponentType::Float32) {
+        if (elementCount < MAX_ATTRIBUTES) {
+            elements[elementCount++] = Element{ attribute, components, stride, type };
+            stride += (elementBytes(components, type) + 3) & ~3u;
+        }
+        return *this;
+    }
+    static uint32_t elementBytes(uint32_t components, VertexComponentType type) {
+        switch (type) {
+        case VertexComponentType::Float16: case VertexComponentType::SNorm16: return components * 2;
+        case VertexComponentType::UNorm8: return components;
+        case VertexComponentType::SNorm10_10_10_2: return 4;
+        default: return components * 4;
+        }
+    }
+    // Returns the element for 'attribute', or nullptr if the format does not have it.
+    const Element* find(VertexAttribute attribute) const {
+        for (uint32_t i = 0; i < elementCount; ++i)
+            if (elements[i].attribute == attribute) return &elements[i];
+        return nullptr;
+    }
+    // Only meaningful when every element is Float32 (the formats MeshData holds).
+    uint32_t floatsPerVertex() const { return stride / static_cast<uint32_t>(sizeof(float)); }
+
+    bool operator==(const VertexFormat& other) const {
+        if (elementCount != other.elementCount || stride != other.stride) return false;
+        for (uint32_t i = 0; i < elementCount; ++i) {
+            if (elements[i].attribute != other.elements[i].attribute ||
+                elements[i].components != other.elements[i].components || elements[i].type != other.elements[i].type) return false;
+        }
+        return true;
+    }
+    bool operator!=(const VertexFormat& other) const { return !(*this == other); }
+
+    // Position (3) + color (3): the original format of triangle.vert (lit with face normals).
+    static VertexFormat positionColor() {
+        return VertexFormat().add(VertexAttribute::Position, 3).add(VertexAttribute::Color, 3);
+    }
+    // Position (3) + color (3) + normal (3).
+    static VertexFormat positionColorNormal() {
+        return positionColor().add(VertexAttribute::Normal, 3);
+    }
+    // Position (3) + color (3) + normal (3) + texture coordinate (2): the format of the built-in meshes.
+    static VertexFormat positionColorNormalUV() {
+        return positionColorNormal().add(VertexAttribute::TexCoord0, 2);
+    }
+    // positionColorNormalUV() quantized to 20 bytes (MeshOptimizer::quantize()): SNORM16 position
+    // (padded to 4), UNORM8 color (with alpha), octahedral normal in SNORM 10:10:10:2 (w = -1
+    // marks the encoding, see triangle.vert) and half-float texture coordinate.
+    static VertexFormat quantizedPositionColorNormalUV() {
+        return VertexFormat()
+            .add(VertexAttribute::Position, 4, VertexComponentType::SNorm16)
+            .add(VertexAttribute::Color, 4, VertexComponentType::UNorm8)
+            .add(VertexAttribute::Normal, 4, VertexComponentType::SNorm10_10_10_2)
+            .add(VertexAttribute::TexCoord0, 2, VertexComponentType::Float16);
+    }
+};
+
+// Maps stored positions to object space: position * scale + offset. The identity for float
+// positions; quantized meshes store them as SNORM16 relative to their bounds.
+struct PositionDequantization {
+    Vec3 offset = Vec3(0.0f, 0.0f, 0.0f);
+    float scale = 1.0f;
+};
+
+// Object-space bounds, used for culling and depth sorting.
+struct MeshBounds {
+    AABB box;
+    BoundingSphere sphere; // Centered on box.center()
+};
+
+// A cluster of at most 124 consecutive triangles, for per-cluster culling (see Meshlet.h). In the
+// object space of its mesh (after position dequantization); plain floats, so cooked mesh files
+// store and map an array of them as it is.
+struct Meshlet {
+    uint32_t firstIndex; // Into the mesh's index array
+    uint32_t indexCount; // Three per triangle
+    Vec3 center;         // Bounding sphere
+    float radius;
+    Vec3 coneAxis;       // Unit average of the triangle normals
+    float coneCutoff;    // Sine of the cone's half angle; > 1 when the cluster can face the camera from anywhere
+};
+
+
+struct MeshData {
+    VertexFormat format;
+    std::vector<float> vertices;   // Interleaved, format.floatsPerVertex() floats per vertex
+    std::vector<uint32_t> indices; // Triangle list, relative to the mesh's first vertex
+    bool singleSided = false;      // Back faces are never seen (closed or front-only)
+
+    size_t vertexCount() const {
+        const uint32_t floats = format.floatsPerVertex();
+        return floats > 0 ? vertices.size() / floats : 0;
+    }
+    // Computes bounds from the Position attribute (zero bounds if there is none).
+    MeshBounds computeBounds() const;
+
+    // Built-in primitives in the positionColorNormalUV() format, centered on the origin.
+    // Unit triangle in the XY plane (the original demo triangle), UVs from its XY position.
+    static MeshData triangle();
+    // Unit cube, one color per face, each face mapped to the whole [0,1] UV square. Closed, so
+    // single-sided; the triangle and the plane are not.
+    static MeshData cube();
+    // Unit square in the XZ plane, facing +Y, mapped to the [0,1] UV square.
+    static MeshData plane();
+    // UV sphere of diameter 1 with 'segments' slices around Y and 'rings' stacks, colored by normal.
+    // Closed, so single-sided.
+    // U runs once around the equator, V from the north pole (0) to the south pole (1).
+    // Lower counts make cheaper LOD levels of the same shape (see sphereError()).
+    static MeshData sphere(uint32_t segments = 32, uint32_t rings = 16);
+    // Largest distance between sphere(segments, rings) and the true sphere, in object units.
+    static float sphereError(uint32_t segments, uint32_t rings);
+};
+
+// Mesh data in any vertex format, as bytes, with its bounds (in object space, i.e. after
+// dequantization).
+struct PackedMeshData {
+    VertexFormat format;
+    std::vector<uint8_t> vertices; // Interleaved, format.stride bytes per vertex
+    std::vector<uint32_t> indices;
+    MeshBounds bounds;
+    PositionDequantization dequantization;
+    std::vector<Meshlet> meshlets; // Optional (MeshletBuilder::build())
+    bool singleSided = false;
+
+    size_t vertexCount() const { return format.stride > 0 ? vertices.size() / format.stride : 0; }
+};
+
+// Non-owning mesh data with precomputed bounds; the arrays must outlive the createMesh() call.
+struct MeshDataView {
+    VertexFormat format;
+    const void* vertices = nullptr; // Interleaved, vertexCount * format.stride bytes
+    size_t vertexCount = 0;
+    const uint32_t* indices = nullptr;
+    size_t indexCount = 0;
+    MeshBounds bounds;
+    PositionDequantization dequantization;
+    const Meshlet* meshlets = nullptr; // Optional; meshes without them are drawn whole
+    size_t meshletCount = 0;
+    bool singleSided = false;
+
+    MeshDataView() = default;
+    // View of 'data', computing its bounds.
+    explicit MeshDataView(const MeshData& data)
+        : format(data.format), vertices(data.vertices.data()), vertexCount(data.vertexCount()),
+          indices(data.indices.data()), indexCount(data.indices.size()), bounds(data.computeBounds()),
+          singleSided(data.singleSided) {}
+    explicit MeshDataView(const PackedMeshData& data)
+        : format(data.format), vertices(data.vertices.data()), vertexCount(data.vertexCount()),
+          indices(data.indices.data()), indexCount(data.indices.size()), bounds(data.bounds),
+          dequantization(data.dequantization), meshlets(data.meshlets.data()), meshletCount(data.meshlets.size()),
+          singleSided(data.singleSided) {}
+};
+
+#endif // MESH_H
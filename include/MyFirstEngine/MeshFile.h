@@ -0,0 +1,84 @@
+// MeshFile.h
+// Cooked meshes (.semesh): MeshData laid out on disk exactly as MeshManager uploads it.
+//
+// MeshFile::save() writes a fixed header, then the interleaved vertex array, then the 32-bit
+// index array, each starting on a DATA_ALIGNMENT boundary. open() memory-maps the file and
+// returns a MeshDataView pointing into the mapping, so loading does no parsing and no copying:
+// the pages go from the file cache straight into glBufferSubData (Renderer::loadMesh()), and
+// the load time is the time to read the file. Bounds are stored in the header, so not even
+// the vertices are walked.
+//
+// Layout (little-endian, FORMAT_VERSION 4):
+//   Header      magic "SEMS", version, vertex format (element count, stride, attribute, component
+//               type and count per element), vertex, index and meshlet counts, array offsets,
+//               bounds, position dequantization, flags (FLAG_SINGLE_SIDED)
+//   Vertices    vertexCount * stride bytes at vertexOffset
+//   Indices     indexCount * 4 bytes at indexOffset
+//   Meshlets    meshletCount Meshlet structs (40 bytes) at meshletOffset; none when the mesh was
+//               cooked without them
+// Files are produced by the mesh cooker (MeshImporter.h) and are not meant to be portable
+// across endianness.
+
+#ifndef MESHFILE_H
+#define MESHFILE_H
+
+#include "MyFirstEngine/Mesh.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+class MeshFile {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 4; // 2: component types and dequantization, 3: meshlets, 4: flags
+    static constexpr size_t DATA_ALIGNMENT = 64;
+
+    MeshFile();
+    // Unmaps the file.
+    ~MeshFile();
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    // Writes 'data' (with its bounds and meshlets) as a cooked mesh, through a temporary file renamed into place.
+    // Pass MeshDataView(meshData) or MeshDataView(packedMeshData).
+    static bool save(const std::string& path, const MeshDataView& data);
+
+    // Maps 'path' read-only and checks the header and sizes. Prints an error and returns false
+    // if the file cannot be mapped or is not a valid cooked mesh.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+    // Points into the mapping; valid until close().
+    const MeshDataView& getView() const { return view; }
+    size_t getFileSize() const { return mappingSize; }
+
+private:
+    struct FileHeader {
+        uint32_t magic;   // FILE_MAGIC
+        uint32_t version; // FORMAT_VERSION
+        uint32_t elementCount;
+        uint32_t stride;
+        uint32_t elements[VertexFormat::MAX_ATTRIBUTES]; // type << 16 | attribute << 8 | components
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t vertexOffset; // From the start of the file
+        uint64_t indexOffset;
+        uint64_t meshletCount;
+        uint64_t meshletOffset; // 0 without meshlets
+        float boxMin[3], boxMax[3];
+        float sphereCenter[3], sphereRadius;
+        float positionOffset[3], positionScale;
+        uint32_t flags;
+    };
+    static constexpr uint32_t FILE_MAGIC = 0x534D4553; // "SEMS"
+    static constexpr uint32_t FLAG_SINGLE_SIDED = 1u; // MeshDataView::singleSided
+
+    void* mapping;
+    size_t mappingSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+    MeshDataView view;
+};
+
+#endif // MESHFILE_H
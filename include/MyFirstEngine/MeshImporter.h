@@ -0,0 +1,44 @@
+// MeshImporter.h
+// OBJ and glTF 2.0 import into MeshData, for the mesh cooker (see MeshFile.h).
+//
+// Every importer produces one MeshData in VertexFormat::positionColorNormalUV(), the format of
+// the built-in meshes, so imported meshes draw with the default materials. Missing attributes
+// get defaults: white color, (0, 0) texture coordinates, and smooth normals computed from the
+// triangles (area-weighted over the vertices sharing a position).
+//
+// OBJ (.obj): v (with optional r g b), vt, vn and f lines; polygons are fanned into triangles
+// and negative (relative) indices are supported. Groups, objects and materials are ignored, so
+// the whole file becomes one mesh. The file is cut into chunks at line boundaries and parsed on
+// a ThreadPool in two passes: the first counts the v/vt/vn lines of every chunk, so the second
+// knows each chunk's global index base and resolves every face index as it parses. Corners are
+// then welded into unique vertices, and V is flipped (OBJ's origin is the bottom-left, images
+// here are stored top row first). OBJ says nothing about sidedness, so the mesh is single-sided
+// (MeshData::singleSided) only if it is closed: every edge shared by two opposite triangles.
+//
+// glTF (.gltf with external or base64 data: buffers, or binary .glb): every triangle primitive
+// of every mesh instanced by the default scene's node tree, transformed to world space by its
+// node (meshes not referenced by any scene are imported untransformed when there is no scene).
+// Reads POSITION, NORMAL, TEXCOORD_0 and COLOR_0 in any component type glTF allows, and 8/16/
+// 32-bit or absent indices. Primitives are converted in parallel, each into its own range. The
+// mesh is single-sided unless some primitive's material is doubleSided.
+// Sparse accessors, morph targets, skins and non-triangle modes are not supported.
+//
+// All importers print an error and return false on malformed input.
+
+#ifndef MESHIMPORTER_H
+#define MESHIMPORTER_H
+
+#include "MyFirstEngine/Mesh.h"
+#include <string>
+
+class ThreadPool;
+
+class MeshImporter {
+public:
+    // Picks the importer from the extension (.obj, .gltf, .glb; case-insensitive).
+    static bool importFile(const std::string& path, MeshData& out, ThreadPool* pool = nullptr);
+    static bool importOBJ(const std::string& path, MeshData& out, ThreadPool* pool = nullptr);
+    static bool importGLTF(const std::string& path, MeshData& out, ThreadPool* pool = nullptr);
+};
+
+#endif // MESHIMPORTER_H
@@ -0,0 +1,98 @@
+// MeshManager.h
+// GPU storage for all meshes, sub-allocated from a few large shared buffers.
+//
+// Meshes are not given their own VAO/VBO. Instead every vertex format gets one or more arenas:
+// a VAO with one big vertex buffer and one big index buffer. createMesh() carves a vertex range
+// and an index range out of an arena with a free-list RangeAllocator and uploads into them;
+// destroyMesh() returns the ranges. A mesh is then just (arena, baseVertex, firstIndex,
+// indexCount), drawn with glDrawElements*BaseVertex, so switching between meshes of the same
+// format costs no VAO or buffer binds at all. A new arena is only opened when the current ones
+// are full (or a single mesh is larger than the default arena size).
+//
+// Each arena VAO also has the per-instance model matrix attributes (INSTANCE_MODEL_LOCATION) and
+// the LOD fade attribute (INSTANCE_FADE_LOCATION) enabled with divisor 1; the Renderer points them
+// into its instance buffer before drawing.
+
+#ifndef MESHMANAGER_H
+#define MESHMANAGER_H
+
+#include "MyFirstEngine/Mesh.h"
+#include "MyFirstEngine/RangeAllocator.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Everything needed to draw one mesh.
+struct MeshDrawInfo {
+    uint32_t arena;      // Index of the arena holding the mesh
+    int32_t baseVertex;  // Added to every index by the draw
+    uint32_t firstIndex; // Offset into the arena's index buffer, in indices
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    MeshBounds bounds;
+    PositionDequantization dequantization; // Set by the Renderer per draw
+};
+
+class MeshManager {
+public:
+    // Sizes of a regular arena. Meshes larger than this get an arena of their own.
+    static constexpr size_t DEFAULT_ARENA_VERTICES = 1u << 18; // 256K vertices
+    static constexpr size_t DEFAULT_ARENA_INDICES = 1u << 20;  // 1M indices (4 MB)
+
+    MeshManager();
+    // Deletes all arena VAOs and buffers.
+    ~MeshManager();
+    MeshManager(const MeshManager&) = delete;
+    MeshManager& operator=(const MeshManager&) = delete;
+
+    // Uploads the mesh into an arena for its vertex format. Requires a current GL context.
+    // Returns INVALID_RENDER_HANDLE if the data is empty, indices or meshlets are out of range or
+    // the handle limit ('maxMeshes') is reached.
+    MeshHandle createMesh(const MeshData& data);
+    // Same, from data owned elsewhere; the vertex and index arrays go to glBufferSubData as they are.
+    MeshHandle createMesh(const MeshDataView& data);
+    // Frees the mesh's arena ranges; the handle may be reused by a later createMesh().
+    // The mesh must not be referenced by commands that have not been flushed yet.
+    void destroyMesh(MeshHandle mesh);
+
+    bool isValid(MeshHandle mesh) const { return mesh < meshes.size() && meshes[mesh].live; }
+    const MeshDrawInfo& getDrawInfo(MeshHandle mesh) const { return meshes[mesh].info; }
+    const MeshBounds& getBounds(MeshHandle mesh) const { return meshes[mesh].info.bounds; }
+    // The mesh's meshlets (Meshlet.h), relative to its firstIndex; empty if it was created without.
+    const std::vector<Meshlet>& getMeshlets(MeshHandle mesh) const { return meshes[mesh].meshlets; }
+    // Whether the mesh was created single-sided (MeshData::singleSided): only then may its
+    // meshlets be culled by normal cone.
+    bool isSingleSided(MeshHandle mesh) const { return meshes[mesh].singleSided; }
+
+    size_t getArenaCount() const { return arenas.size(); }
+    unsigned int getArenaVAO(uint32_t arena) const { return arenas[arena].VAO; }
+    // Handles are limited by the sort key's mesh field.
+    void setMaxMeshes(size_t count) { maxMeshes = count; }
+
+private:
+    struct Arena {
+        VertexFormat format;
+        unsigned int VAO;
+        unsigned int vertexBuffer;
+        unsigned int indexBuffer;
+        RangeAllocator vertexRanges; // In vertices
+        RangeAllocator indexRanges;  // In indices
+    };
+    struct MeshRecord {
+        MeshDrawInfo info;
+        std::vector<Meshlet> meshlets; // Copied from the data: views may point into a mapping that goes away
+        bool singleSided;
+        bool live;
+    };
+
+    // Returns an arena of 'format' with room for the given counts, creating one if needed.
+    uint32_t findArena(const VertexFormat& format, size_t vertexCount, size_t indexCount);
+    uint32_t createArena(const VertexFormat& format, size_t vertexCapacity, size_t indexCapacity);
+
+    std::vector<Arena> arenas;
+    std::vector<MeshRecord> meshes;
+    std::vector<MeshHandle> freeHandles; // Slots of destroyed meshes
+    size_t maxMeshes;
+};
+
+#endif // MESHMANAGER_H
@@ -0,0 +1,60 @@
+// MeshOptimizer.h
+// Offline mesh optimization for the mesh cooker: GPU-friendly triangle and vertex order, and
+// vertex quantization.
+//
+// optimize() runs three passes over a MeshData, each keeping the mesh identical on screen:
+//  1. optimizeVertexCache() reorders triangles for the post-transform vertex cache with Forsyth's
+//     greedy algorithm: vertices are scored by their position in a simulated LRU cache of
+//     VERTEX_CACHE_SIZE entries and by how few triangles still use them, and the next triangle
+//     is the best-scoring one around the cache. Imported meshes typically go from an ACMR (vertex
+//     shader runs per triangle) of 1.0-1.5 down to about 0.7.
+//  2. optimizeOverdraw() (the overdraw half of Tipsify) cuts that order into clusters where the
+//     cache starts over anyway, or where a cut would cost less than 'threshold' times the
+//     cluster's ACMR, and draws clusters facing outward from the mesh center first, so
+//     self-occluding meshes reject more of their own hidden fragments by depth test.
+//  3. optimizeVertexFetch() renumbers vertices in first-use order (dropping unused ones), so
+//     vertex fetch walks the vertex buffer front to back.
+//
+// quantize() then packs a float mesh into VertexFormat::quantizedPositionColorNormalUV() (the
+// subset of it the mesh has): 20 bytes per vertex instead of 44. Positions become SNORM16
+// relative to the bounding box, with one uniform scale so normals are unaffected; the Renderer
+// undoes it per draw (PositionDequantization). Normals become octahedral in 10:10:10:2, colors
+// UNORM8 and texture coordinates half floats.
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include "MyFirstEngine/Mesh.h"
+#include <cstdint>
+#include <cstddef>
+
+class MeshOptimizer {
+public:
+    // Size of the LRU cache Forsyth's scoring assumes (larger than real caches on purpose: it
+    // also rewards reuse in the next few dozen triangles).
+    static constexpr uint32_t VERTEX_CACHE_SIZE = 32;
+    // FIFO cache size for computeACMR() and optimizeOverdraw()'s cluster cuts.
+    static constexpr uint32_t FIFO_CACHE_SIZE = 16;
+    static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+    // All three passes below. 'mesh' must be in a float format with a 3-component position.
+    static void optimize(MeshData& mesh, float overdrawThreshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+    // Reorders the triangles of 'indices' (indexCount / 3 of them, indices < vertexCount) in place.
+    static void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+    // Reorders clusters of 'mesh.indices', which should already be cache-optimized. 'threshold'
+    // is the ACMR increase allowed for extra cuts (1 = only cut where the cache starts over).
+    static void optimizeOverdraw(MeshData& mesh, float threshold = DEFAULT_OVERDRAW_THRESHOLD);
+    // Renumbers vertices in first-use order and drops unreferenced ones. Returns the new vertex count.
+    static size_t optimizeVertexFetch(MeshData& mesh);
+
+    // Quantizes 'mesh' into 'out' (with its bounds and dequantization). Returns false and prints
+    // an error if the mesh has no 3-component float position.
+    static bool quantize(const MeshData& mesh, PackedMeshData& out);
+
+    // Average vertex shader invocations per triangle with a FIFO cache of 'cacheSize' entries
+    // (0.5 is the ideal for large regular meshes, 3 is no reuse at all).
+    static float computeACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = FIFO_CACHE_SIZE);
+};
+
+#endif // MESHOPTIMIZER_H
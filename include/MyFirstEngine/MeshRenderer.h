@@ -0,0 +1,26 @@
+// MeshRenderer.h
+#ifndef MESHRENDERER_H
+#define MESHRENDERER_H
+
+#include "MyFirstEngine/Mesh.h"
+
+// How an entity's mesh takes part in directional shadows (see ShadowCascades.h).
+enum class ShadowCasting {
+    None,    // Casts no shadow
+    Dynamic, // Redrawn into every shadow cascade each frame
+    Static   // Cached in distant cascades; moving it or changing its mesh (e.g. by LOD) requires ShadowCascades::invalidateStatic()
+};
+
+// ECS component: which mesh and material the Renderer draws for an entity.
+// Entities without one are not drawn. The model matrix comes from the SceneGraph.
+struct MeshRenderer {
+    MeshHandle mesh;
+    MaterialHandle material;
+    ShadowCasting shadowCasting;
+
+    MeshRenderer(MeshHandle mesh = INVALID_RENDER_HANDLE, MaterialHandle material = INVALID_RENDER_HANDLE,
+                 ShadowCasting shadowCasting = ShadowCasting::Dynamic)
+        : mesh(mesh), material(material), shadowCasting(shadowCasting) {}
+};
+
+#endif // MESHRENDERER_H
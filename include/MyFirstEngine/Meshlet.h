@@ -0,0 +1,80 @@
+// Meshlet.h
+// Meshlets: small clusters of a mesh's triangles, culled one by one on the CPU.
+//
+// Object-level culling keeps or drops a whole mesh; for a dense mesh that is mostly off screen
+// or facing away, most of its triangles still reach the GPU. MeshletBuilder cuts a mesh's index
+// buffer into meshlets of at most MAX_VERTICES unique vertices and MAX_TRIANGLES triangles
+// (the sizes mesh-shader hardware works in) and gives each one
+//  - a bounding sphere, for the frustum test, and
+//  - a normal cone (the average triangle normal plus the spread around it), for a back-face
+//    test of the whole cluster: if every triangle faces away from the camera, so does the cluster.
+// Meshlets (struct Meshlet, in Mesh.h) are contiguous ranges of the index buffer in its existing
+// order, so building them does not change the mesh: run it after MeshOptimizer::optimize(),
+// whose cache-friendly order already keeps consecutive triangles close together.
+//
+// MeshletCuller runs per instance per frame: it tests every meshlet of a mesh against the
+// camera set with setView() and writes the survivors as index ranges, merging neighbours, for
+// one glMultiDrawElementsBaseVertex (Renderer::flush()). Both tests run in object space, which
+// costs one matrix inverse per instance and no per-meshlet transform: the frustum planes are
+// moved into object space (with spheres scaled by the model's largest axis scale, as
+// BoundingSphere::transformed() does), and back-facing is invariant under any affine transform,
+// mirrors included.
+//
+// The cone test is only valid for single-sided meshes (MeshData::singleSided: closed, or only
+// ever seen from the front): the Renderer draws both sides of every triangle, so on an open or
+// double-sided mesh a back-facing cluster may be visible. cull() skips it for other meshes.
+
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include "../SimpleMath.h"
+#include "MyFirstEngine/Mesh.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// A range of a mesh's index array that survived culling.
+struct MeshletRange {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+class MeshletBuilder {
+public:
+    static constexpr uint32_t MAX_VERTICES = 64;
+    static constexpr uint32_t MAX_TRIANGLES = 124;
+    // coneCutoff of a cluster whose normals spread over a hemisphere or more: never back-facing.
+    static constexpr float NO_CONE = 2.0f;
+
+    // Cuts 'mesh' into meshlets, in index order, replacing 'out'. Positions may be 3- or
+    // 4-component Float32 or SNorm16 (dequantized with mesh.dequantization). Bounds and cones
+    // are computed on 'pool' when given. Prints an error and returns false if the mesh has no
+    // usable position attribute.
+    static bool build(const MeshDataView& mesh, std::vector<Meshlet>& out, ThreadPool* pool = nullptr);
+};
+
+class MeshletCuller {
+public:
+    MeshletCuller();
+
+    // World-space view for the following cull() calls. 'coneCulling' enables the back-face test
+    // for single-sided meshes.
+    void setView(const Frustum& frustum, const Vec3& cameraPosition, bool coneCulling = true);
+
+    // Tests 'count' meshlets of a mesh drawn with 'model' and writes the visible ones to 'out' as
+    // index ranges, adjacent meshlets merged into one. 'out' must have room for 'count' ranges.
+    // The cone test runs only if the mesh is 'singleSided'. Returns the number of ranges;
+    // 'visibleMeshlets' (optional) receives the number of meshlets in them. Thread-safe: one
+    // culler serves any number of threads.
+    size_t cull(const Meshlet* meshlets, size_t count, const Mat4& model, bool singleSided, MeshletRange* out,
+                size_t* visibleMeshlets = nullptr) const;
+
+private:
+    Frustum frustum;
+    Vec3 cameraPosition;
+    bool coneCulling;
+};
+
+#endif // MESHLET_H
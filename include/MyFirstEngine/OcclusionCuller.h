@@ -0,0 +1,104 @@
+// OcclusionCuller.h
+// CPU occlusion culling against a software-rasterized depth buffer.
+//
+// Each frame a small set of occluders (large, simple, closed meshes: walls, floors, terrain
+// chunks) is rasterized into a low-resolution depth buffer, by default 256x128. Candidate
+// objects then test their world AABB against that buffer and are dropped when every pixel their
+// screen rectangle covers already holds a nearer occluder. Everything runs on the CPU, so it
+// works without a GPU and never waits for a GPU readback.
+//
+// Pipeline (render()):
+//   1. Occluder vertices are transformed to clip space, triangles are clipped against the near
+//      plane and back faces are dropped.
+//   2. Triangles are binned into screen tiles (64x32 pixels). Tiles are independent, so they are
+//      rasterized in parallel on a ThreadPool; within a tile 4 pixels are shaded per SSE/NEON
+//      step (edge functions + interpolated depth, keeping the nearest depth).
+//   3. A min/max depth pyramid is built on top of the buffer. isVisible() starts at the coarse
+//      level where the object's rectangle covers about 2x2 texels and only descends while the
+//      answer is ambiguous ("nearer than some occluder" vs. "behind all of them").
+//
+// Depth is NDC z remapped to [0,1] (1 = far plane), which interpolates linearly in screen space.
+// Occluders are rasterized conservatively inward: only pixels a triangle covers completely get its
+// depth, so the buffer never claims more coverage than the occluders have and culling stays
+// conservative. Occluders thinner than a low-resolution pixel therefore hide nothing, and pixels on
+// the diagonal shared by two triangles of a quad stay empty (objects seen only there are kept).
+
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include "../SimpleMath.h"
+#include "MyFirstEngine/Mesh.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+class OcclusionCuller {
+public:
+    static constexpr int TILE_WIDTH = 64;  // Multiple of 4 (one SIMD group)
+    static constexpr int TILE_HEIGHT = 32;
+
+    // Width is rounded up to a multiple of 4.
+    explicit OcclusionCuller(int width = 256, int height = 128);
+
+    // Registers CPU-side occluder geometry (positions and triangle indices of 'mesh').
+    // Returns the id to pass to addOccluder(). Keep occluders to a few hundred triangles.
+    uint32_t addOccluderMesh(const MeshData& mesh);
+
+    // Starts a frame: stores the camera and forgets last frame's occluders.
+    void beginFrame(const Mat4& viewProjection);
+    // Adds an occluder instance for this frame.
+    void addOccluder(uint32_t occluderMesh, const Mat4& model);
+    // Rasterizes all occluders and builds the depth pyramid. Tiles run on 'pool' when given.
+    void render(ThreadPool* pool = nullptr);
+
+    // True if any part of the world-space box may be visible. Thread-safe after render().
+    bool isVisible(const AABB& worldBox) const;
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    // Level 0 of the depth buffer, row-major, bottom row first (as in OpenGL).
+    const float* getDepthBuffer() const { return depth.data(); }
+    size_t getRasterizedTriangleCount() const { return triangles.size(); }
+
+private:
+    struct OccluderMesh {
+        std::vector<Vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+    struct OccluderInstance {
+        uint32_t mesh;
+        Mat4 model;
+    };
+    // A screen-space triangle ready for rasterization.
+    struct ScreenTriangle {
+        float edgeA[3], edgeB[3], edgeC[3]; // Edge functions A*x + B*y + C, >= 0 inside
+        float zBase, zDx, zDy;              // Depth plane z = zBase + zDx*x + zDy*y
+        int minX, minY, maxX, maxY;         // Inclusive pixel bounds, clamped to the screen
+    };
+    // One pyramid level: per texel the nearest and farthest depth of the 2^k x 2^k pixels below it.
+    struct PyramidLevel {
+        int width, height;
+        std::vector<float> minDepth, maxDepth;
+    };
+
+    // Clips a clip-space triangle against the near plane and queues the result.
+    void setupTriangle(const Vec4& a, const Vec4& b, const Vec4& c);
+    void addScreenTriangle(const Vec4& a, const Vec4& b, const Vec4& c);
+    void rasterizeTile(int tile);
+    void buildPyramid();
+
+    int width, height;
+    int tilesX, tilesY;
+    Mat4 viewProjection;
+    std::vector<OccluderMesh> occluderMeshes;
+    std::vector<OccluderInstance> instances;
+    std::vector<Vec4> clipVertices; // Scratch for transforming one occluder
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<uint32_t>> tileBins; // Triangle indices per tile
+    std::vector<float> depth;
+    std::vector<PyramidLevel> pyramid; // pyramid[0] is half resolution
+};
+
+#endif // OCCLUSIONCULLER_H
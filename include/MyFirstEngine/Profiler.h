@@ -0,0 +1,168 @@
+// Profiler.h
+// Frame profiler: nestable CPU scopes plus GPU scope results, with per-scope statistics.
+//
+// Mark code with PROFILE_SCOPE("Name") (a string literal); the scope is timed until the end of
+// the enclosing block. Scopes nest, and can be used from any thread: every thread gets its own
+// track in the timeline. Between beginFrame() and endFrame() the completed scopes are collected
+// into a Frame; endFrame() appends it to a history of HISTORY_FRAMES frames (the scrolling
+// timeline) and folds each scope's total time per frame into rolling statistics (average, p95,
+// p99, max over the same window).
+//
+// A scope's total is CPU time: the durations of all its runs, summed over every thread. A scope
+// that runs on pool workers in parallel (a parallelFor job body, say) can therefore total more
+// than the wall time of the scope around it. The statistics also carry the scope's wall-clock
+// time (the union of its runs across threads) and how many threads it ran on, so the two can be
+// told apart.
+//
+// GPU timings come from GpuProfiler (Render library), which reads its queries back a few frames
+// late and hands them over with addGpuFrame(); they are attached to the frame they belong to and
+// reported as separate "GPU" scopes.
+//
+// The profiler is GL- and ImGui-free; the editor draws it with drawProfilerWindow().
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Profiler {
+public:
+    static constexpr size_t HISTORY_FRAMES = 240; // About 4 s at 60 Hz
+    static constexpr uint32_t GPU_TRACK = 0xFFFFFFFFu;
+
+    // One completed scope. Times are in ms since the profiler was created (GPU scopes are
+    // placed relative to the start of their CPU frame; see GpuProfiler.h).
+    struct Event {
+        const char* name;
+        uint32_t track; // Thread track (0 = first thread that recorded), or GPU_TRACK
+        uint32_t depth; // Nesting level within the track
+        double startMs;
+        double endMs;
+    };
+    struct Frame {
+        uint64_t index;
+        double startMs;
+        double endMs;
+        std::vector<Event> events;    // CPU scopes, by track then start time
+        std::vector<Event> gpuEvents; // Filled in later by addGpuFrame()
+    };
+    struct ScopeStats {
+        std::string name;
+        bool gpu;
+        uint32_t depth;   // Nesting level of the first occurrence (for indentation)
+        double lastMs;    // Total CPU time in the scope during the most recent frame that had it
+        double averageMs; // CPU time statistics: summed over threads
+        double p95Ms;
+        double p99Ms;
+        double maxMs;
+        double averageWallMs; // Wall-clock time: overlapping runs on different threads count once
+        uint32_t threads;     // Threads it ran on in the most recent frame that had it
+    };
+
+    // The process-wide profiler used by PROFILE_SCOPE.
+    static Profiler& get();
+
+    Profiler();
+
+    // Disabled profilers ignore scopes and frames (PROFILE_SCOPE then costs one branch).
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+
+    // Frame boundaries, called once per frame from the main thread.
+    void beginFrame();
+    void endFrame();
+    // Index of the current (or next) frame, to tag GPU queries with.
+    uint64_t getFrameIndex() const { return frameIndex; }
+
+    // Milliseconds since the profiler was created.
+    double nowMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch).count();
+    }
+    // Records a completed CPU scope for the calling thread (used by ProfileScope).
+    void addEvent(const char* name, uint32_t depth, double startMs, double endMs);
+    // Attaches GPU scopes of an earlier frame. Events for frames already out of the history are
+    // still counted in the statistics.
+    void addGpuFrame(uint64_t frame, const std::vector<Event>& events);
+
+    // Completed frames, oldest first (at most HISTORY_FRAMES). Main thread only.
+    size_t getHistorySize() const { return history.size(); }
+    const Frame& getHistoryFrame(size_t i) const { return history[(historyStart + i) % history.size()]; }
+    // Per-scope statistics, CPU scopes first, in order of first appearance. Updated by endFrame().
+    const std::vector<ScopeStats>& getStats() const { return stats; }
+    // Number of thread tracks seen so far.
+    uint32_t getTrackCount() const { return trackCount; }
+
+    // Calling thread's track and current nesting depth (for ProfileScope).
+    static uint32_t& threadDepth();
+    uint32_t threadTrack();
+
+private:
+    // Rolling per-frame totals of one scope.
+    struct ScopeSamples {
+        std::string name;
+        bool gpu;
+        uint32_t depth;
+        std::vector<double> samples;     // Ring of HISTORY_FRAMES per-frame totals (CPU time)
+        std::vector<double> wallSamples; // Same ring, wall-clock time
+        size_t next;
+        double last;
+        uint32_t lastThreads;
+    };
+    // Index into 'scopes', creating the entry on first use.
+    size_t samplesFor(const char* name, bool gpu, uint32_t depth);
+    // Adds each scope's total CPU and wall-clock time in 'events' as one sample.
+    void accumulate(const std::vector<Event>& events, bool gpu);
+    void updateStats();
+
+    bool enabled;
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t frameIndex;
+    bool inFrame;
+
+    std::mutex eventMutex; // Guards current.events and trackCount (scopes may end on any thread)
+    Frame current;
+    uint32_t trackCount;
+
+    std::vector<Frame> history; // Ring buffer
+    size_t historyStart;        // Oldest frame once the ring is full
+    std::vector<ScopeSamples> scopes;
+    std::vector<ScopeStats> stats;
+    std::vector<double> sortScratch;
+};
+
+// Times the enclosing block (see PROFILE_SCOPE).
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* scopeName) : name(nullptr) {
+        Profiler& profiler = Profiler::get();
+        if (!profiler.isEnabled()) return;
+        name = scopeName;
+        depth = Profiler::threadDepth()++;
+        startMs = profiler.nowMs();
+    }
+    ~ProfileScope() {
+        if (!name) return;
+        Profiler& profiler = Profiler::get();
+        --Profiler::threadDepth();
+        profiler.addEvent(name, depth, startMs, profiler.nowMs());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint32_t depth;
+    double startMs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// Times the rest of the enclosing block under 'name' (a string literal).
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+#endif // PROFILER_H
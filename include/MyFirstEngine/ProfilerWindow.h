@@ -0,0 +1,17 @@
+// ProfilerWindow.h
+// ImGui "Profiler" window for the editor.
+//
+// Shows a frame-time graph, a table of per-scope statistics (last, average, p95, p99 and max
+// over Profiler::HISTORY_FRAMES frames; GPU scopes marked) and a scrolling flame chart of the
+// most recent frames: one lane per thread track plus one for the GPU, nested scopes stacked
+// below their parents. Pausing freezes the chart so a spike can be inspected.
+
+#ifndef PROFILERWINDOW_H
+#define PROFILERWINDOW_H
+
+class Profiler;
+
+// Draws the window; must be called between ImGui::NewFrame() and ImGui::Render().
+void drawProfilerWindow(const Profiler& profiler, bool* open = nullptr);
+
+#endif // PROFILERWINDOW_H
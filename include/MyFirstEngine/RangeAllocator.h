@@ -0,0 +1,45 @@
+// RangeAllocator.h
+// Free-list allocator for ranges of elements inside one large buffer.
+//
+// The allocator only does bookkeeping: it hands out [offset, offset + size) ranges of a buffer
+// it never touches, so it works for GPU vertex/index buffers (MeshManager) as well as CPU arrays.
+// Free ranges are kept sorted by offset; allocate() is first-fit and free() merges a range with
+// its free neighbours, so freeing everything always returns to a single free range.
+
+#ifndef RANGEALLOCATOR_H
+#define RANGEALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+
+class RangeAllocator {
+public:
+    static constexpr size_t INVALID_OFFSET = static_cast<size_t>(-1);
+
+    explicit RangeAllocator(size_t capacity = 0);
+
+    // Returns the offset of a free range of 'size' elements, or INVALID_OFFSET if none fits.
+    size_t allocate(size_t size);
+    // Returns a range obtained from allocate(). Sizes must match.
+    void free(size_t offset, size_t size);
+    // Extends the managed range to 'newCapacity' (e.g. after the backing buffer was grown).
+    void grow(size_t newCapacity);
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    // Largest single allocation that would currently succeed.
+    size_t getLargestFreeRange() const;
+    size_t getFreeRangeCount() const { return freeRanges.size(); }
+
+private:
+    struct Range {
+        size_t offset;
+        size_t size;
+    };
+
+    std::vector<Range> freeRanges; // Sorted by offset, never adjacent (always merged)
+    size_t capacity;
+    size_t used;
+};
+
+#endif // RANGEALLOCATOR_H
@@ -0,0 +1,137 @@
+// RenderQueue.h
+// Sortable queue of draw commands.
+//
+// Each command is a 64-bit sort key plus the object's model matrix and a dither fade value
+// (1 = fully drawn; see LOD.h for the cross-fade encoding). The key packs everything
+// that decides draw order, most significant first, so sorting the keys as plain integers gives:
+//   - passes in order (shadow, opaque, translucent, overlay),
+//   - opaque commands grouped by shader, then material, then mesh (fewest state changes),
+//     then front-to-back inside a group (best early-Z rejection),
+//   - translucent commands back-to-front (required for correct blending).
+//
+// Commands are recorded into per-thread RenderBuckets, so workers can fill the queue in parallel
+// without locks. sort() merges the buckets and LSD radix-sorts the keys.
+// The queue is GL-free; the Renderer turns sorted runs of equal state into instanced draws.
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "../SimpleMath.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+enum class RenderPass : uint32_t {
+    Shadow = 0,
+    Opaque = 1,
+    Translucent = 2,
+    Overlay = 3
+};
+
+// Key layouts (bit 63 on the left):
+//   opaque:      pass:4 | translucent=0:1 | shader:11 | material:12 | mesh:16 | depth:20
+//   translucent: pass:4 | translucent=1:1 | ~depth:20 | shader:11 | material:12 | mesh:16
+// 'depth' is view distance normalized to [0,1] and quantized; translucent keys store it inverted.
+struct SortKey {
+    static constexpr uint32_t PASS_BITS = 4, SHADER_BITS = 11, MATERIAL_BITS = 12, MESH_BITS = 16, DEPTH_BITS = 20;
+    static constexpr uint32_t MAX_SHADERS = 1u << SHADER_BITS;
+    static constexpr uint32_t MAX_MATERIALS = 1u << MATERIAL_BITS;
+    static constexpr uint32_t MAX_MESHES = 1u << MESH_BITS;
+
+    // Quantizes a normalized depth (clamped to [0,1]) to DEPTH_BITS.
+    static uint64_t quantizeDepth(float depth01) {
+        depth01 = depth01 < 0.0f ? 0.0f : (depth01 > 1.0f ? 1.0f : depth01);
+        return static_cast<uint64_t>(depth01 * static_cast<float>((1u << DEPTH_BITS) - 1));
+    }
+
+    static uint64_t make(RenderPass pass, bool translucent, uint32_t shader, uint32_t material, uint32_t mesh, float depth01) {
+        const uint64_t state = (static_cast<uint64_t>(shader & (MAX_SHADERS - 1)) << (MATERIAL_BITS + MESH_BITS)) |
+                               (static_cast<uint64_t>(material & (MAX_MATERIALS - 1)) << MESH_BITS) |
+                               static_cast<uint64_t>(mesh & (MAX_MESHES - 1));
+        const uint64_t depth = quantizeDepth(depth01);
+        uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(pass) & 0xFu) << 60;
+        if (!translucent) {
+            key |= (state << DEPTH_BITS) | depth;
+        } else {
+            const uint64_t invertedDepth = ((1u << DEPTH_BITS) - 1) - depth; // Far first
+            key |= (uint64_t(1) << 59) | (invertedDepth << (SHADER_BITS + MATERIAL_BITS + MESH_BITS)) | state;
+        }
+        return key;
+    }
+
+    static RenderPass pass(uint64_t key) { return static_cast<RenderPass>(key >> 60); }
+    static bool isTranslucent(uint64_t key) { return ((key >> 59) & 1u) != 0; }
+    // shader | material | mesh, identical for both layouts.
+    static uint64_t stateBits(uint64_t key) {
+        const uint32_t stateWidth = SHADER_BITS + MATERIAL_BITS + MESH_BITS;
+        return isTranslucent(key) ? (key & ((uint64_t(1) << stateWidth) - 1))
+                                  : ((key >> DEPTH_BITS) & ((uint64_t(1) << stateWidth) - 1));
+    }
+    // Everything except depth: commands with equal batch bits can share one instanced draw.
+    static uint64_t batchBits(uint64_t key) { return (key >> 59) << 39 | stateBits(key); }
+    static uint32_t shader(uint64_t key) { return static_cast<uint32_t>(stateBits(key) >> (MATERIAL_BITS + MESH_BITS)); }
+    static uint32_t material(uint64_t key) { return static_cast<uint32_t>((stateBits(key) >> MESH_BITS) & (MAX_MATERIALS - 1)); }
+    static uint32_t mesh(uint64_t key) { return static_cast<uint32_t>(stateBits(key) & (MAX_MESHES - 1)); }
+};
+
+// Commands recorded by one thread. Aligned to a cache line so neighbouring buckets written by
+// different threads never share one.
+struct alignas(64) RenderBucket {
+    std::vector<uint64_t> keys;
+    std::vector<Mat4> models;
+    std::vector<float> fades;
+
+    void push(uint64_t key, const Mat4& model, float fade = 1.0f) {
+        keys.push_back(key);
+        models.push_back(model);
+        fades.push_back(fade);
+    }
+    size_t size() const { return keys.size(); }
+    void clear() { keys.clear(); models.clear(); fades.clear(); }
+};
+
+class RenderQueue {
+public:
+    explicit RenderQueue(size_t bucketCount = 1);
+
+    // One bucket per recording thread (e.g. ThreadPool::getThreadCount()). Clears the queue.
+    void setBucketCount(size_t count);
+    size_t getBucketCount() const { return buckets.size(); }
+    RenderBucket& getBucket(size_t index) { return buckets[index]; }
+
+    // Removes all commands (keeps allocations for the next frame).
+    void clear();
+
+    // Merges all buckets and sorts the commands by key. Must not run while threads are recording.
+    void sort();
+
+    // Sorted access, valid after sort() until the next clear()/push.
+    size_t size() const { return sortedKeys.size(); }
+    uint64_t getKey(size_t i) const { return sortedKeys[i]; }
+    const Mat4& getModel(size_t i) const {
+        const uint32_t ref = sortedRefs[i];
+        return buckets[ref >> BUCKET_SHIFT].models[ref & INDEX_MASK];
+    }
+    float getFade(size_t i) const {
+        const uint32_t ref = sortedRefs[i];
+        return buckets[ref >> BUCKET_SHIFT].fades[ref & INDEX_MASK];
+    }
+
+private:
+    // A command's origin, packed as bucket << BUCKET_SHIFT | index in bucket.
+    static constexpr uint32_t BUCKET_SHIFT = 24;
+    static constexpr uint32_t INDEX_MASK = (1u << BUCKET_SHIFT) - 1;
+
+    std::vector<RenderBucket> buckets;
+    std::vector<uint64_t> sortedKeys;
+    std::vector<uint32_t> sortedRefs;
+    std::vector<uint64_t> scratchKeys; // Radix sort ping-pong buffers
+    std::vector<uint32_t> scratchRefs;
+};
+
+// LSD radix sort of keys (8 bits per pass) carrying 'values' along. Passes where every key has
+// the same digit are skipped, which is common for the pass/shader bytes.
+// tmpKeys/tmpValues must hold n elements. Exposed for benchmarks.
+void radixSortKeys(uint64_t* keys, uint32_t* values, uint64_t* tmpKeys, uint32_t* tmpValues, size_t n);
+
+#endif // RENDERQUEUE_H
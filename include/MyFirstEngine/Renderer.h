@@ -2,53 +2,344 @@
 // Renderer class declaration.
 // Responsible for initializing OpenGL rendering state, managing shader programs,
 // vertex buffers, and drawing objects.
-// Now updated to accept Model, View, and Projection matrices for 3D rendering.
+//
+// Drawing is batched: during a frame, call beginFrame() with the camera matrices, then
+// submit(mesh, material, model) once per object, then flush(). Every object becomes a command
+// with a 64-bit sort key (pass, translucency, shader, material, mesh, depth; see RenderQueue.h).
+// flush() sorts the commands, uploads all model matrices into one per-instance vertex buffer and
+// issues a single instanced draw per run of equal state, so the draw-call count scales with the
+// number of unique mesh/material pairs rather than the number of objects.
+//
+// Meshes live in MeshManager's shared vertex/index arenas (see MeshManager.h), so consecutive
+// draws of different meshes only rebind the VAO when they come from different arenas.
+//
+// LOD cross-fades draw an object twice with complementary dither patterns; the per-instance fade
+// value (INSTANCE_FADE_LOCATION) travels with the model matrix, so both levels still batch.
+//
+// All per-frame data (camera uniforms, instance matrices) is written into a triple-buffered
+// StreamBuffer, so the CPU fills frame N+1 while the GPU still reads frame N. Other per-frame
+// producers (debug lines, particles) can allocate from it too through allocateFrameData().
+//
+// Lighting is clustered forward: each frame the caller bins its lights with a LightClusterer and
+// hands the result to setLights(), which uploads the lights, the per-cluster (offset, count)
+// table and the light index list into the frame stream as three buffer textures, plus the
+// 'Lights' uniform block (cluster grid, slice mapping, ambient). A frame without setLights()
+// is drawn unlit (ambient 1, no lights), as before lighting existed. One directional light
+// (setDirectionalLight()) is shaded along with the clustered lights.
+//
+// The directional light casts cascaded shadows (ShadowCascades.h). After beginFrame(), the caller
+// fits a ShadowCascades to the camera, culls casters to each cascade's casterFrustum into two
+// queues (static and dynamic, keys from makeShadowSortKey()) and calls renderShadowCascade() per
+// cascade, then setShadows() to bind the maps for SHADOWS variants. Cached cascades keep their
+// static casters in a second depth array and only redraw them when the ShadowCascades asks; on
+// other frames their layer is copied and only the dynamic casters are drawn over it, or the layer
+// is left alone if it had none and still has none. Callers can skip culling static casters for a
+// cascade whose needsStaticRender() is false.
+//
+// Meshes created with meshlets (Meshlet.h, e.g. cooked by the mesh cooker) are culled per
+// cluster as well: flush() tests every meshlet of every such instance against the camera from
+// beginFrame(), on the caller's ThreadPool when one is passed, and draws each instance with one
+// glMultiDrawElementsBaseVertex over the surviving index ranges instead of joining the instanced
+// draw of its run. Dense meshes then only pay for their on-screen, camera-facing clusters.
+//
+// Worker threads can record into their own buckets of a caller-owned RenderQueue instead:
+// each builds keys with makeSortKey() and pushes into queue.getBucket(threadIndex), then the
+// render thread calls flush(queue).
 
 #ifndef RENDERER_H
 #define RENDERER_H
 
 #include "MyFirstEngine/Shader.h" // Path to Shader.h, assuming it's in include/MyFirstEngine/
+#include "MyFirstEngine/ShaderCache.h"
+#include "MyFirstEngine/ShaderLibrary.h"
+#include "MyFirstEngine/TextureStreamer.h"
+#include "MyFirstEngine/RenderQueue.h"
+#include "MyFirstEngine/MeshManager.h"
+#include "MyFirstEngine/StreamBuffer.h"
+#include "MyFirstEngine/LightClusterer.h"
+#include "MyFirstEngine/Meshlet.h"
+#include "MyFirstEngine/ShadowCascades.h"
 #include "../SimpleMath.h"        // Path to SimpleMath.h for Mat4 and Vec3 definitions,
                                   // assuming Renderer.h is in include/MyFirstEngine/
                                   // and SimpleMath.h is in the parent include/ directory.
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// Counters for the most recent flush().
+struct RenderStats {
+    unsigned int drawCalls = 0;
+    unsigned int instances = 0;
+    unsigned int vaoBinds = 0; // Arena switches
+    size_t triangles = 0;      // Over all instances
+    size_t meshletsTested = 0; // Over all instances of meshes with meshlets
+    size_t meshletsVisible = 0;
+};
+
+// Shadow work of the current frame, over every renderShadowCascade() call since beginFrame().
+struct ShadowStats {
+    unsigned int cascadesRendered = 0; // Cascades whose static casters were drawn
+    unsigned int cascadesCopied = 0;   // Cached cascades restored from their static layer
+    unsigned int cascadesKept = 0;     // Cached cascades left untouched (nothing changed)
+    unsigned int drawCalls = 0;
+    unsigned int casters = 0;          // Instances drawn
+    size_t triangles = 0;
+};
+
+// Per-cluster culling of meshes with meshlets (see Meshlet.h).
+enum class MeshletCulling {
+    Off,           // Draw meshes with meshlets whole, instanced like any other mesh
+    Frustum,       // Drop clusters outside the view frustum
+    FrustumAndCone // Also drop back-facing clusters of single-sided meshes (MeshManager::isSingleSided())
+};
+
+// Primitive meshes created by init().
+enum class BuiltinMesh {
+    Triangle = 0,
+    Cube,
+    Plane,
+    Count
+};
 
 class Renderer {
 public:
     // Constructor
     Renderer();
-    // Destructor: cleans up OpenGL resources (VAO, VBO, shader program)
+    // Destructor: cleans up OpenGL resources (mesh arenas, instance buffer, shader programs, shadow maps)
     ~Renderer();
 
     // Initializes the renderer:
-    // - Loads and compiles shaders.
-    // - Sets up Vertex Array Object (VAO) and Vertex Buffer Object (VBO) for a triangle.
-    // - Configures vertex attributes (position and color).
+    // - Opens the shader program cache (see setShaderCacheDirectory()).
+    // - Registers shaders/triangle.vert and shaders/triangle.frag as DEFAULT_SHADER, prewarms the
+    //   variants listed in shaders/variants.txt (if present) and creates the default material
+    //   with every feature of DEFAULT_SHADER.
+    // - Registers shaders/shadow.vert and shaders/shadow.frag as SHADOW_SHADER (if they fail to
+    //   build, init() still succeeds and shadows are disabled).
+    // - Creates the built-in triangle, cube and plane meshes.
+    // - Creates the per-instance model-matrix buffer.
     // - Enables depth testing for 3D.
     // Returns true on successful initialization, false otherwise.
     bool init();
 
-    // Draws the scene (currently a single triangle).
-    // model: The model matrix for the object being drawn (transforms from model to world space).
-    // view: The view matrix (transforms from world to camera/view space).
-    // projection: The projection matrix (transforms from camera/view to clip space, adds perspective).
-    void draw(const Mat4& model, const Mat4& view, const Mat4& projection);
+    // Uploads an indexed mesh into the shared arenas. Returns INVALID_RENDER_HANDLE on failure.
+    MeshHandle createMesh(const MeshData& data);
+    MeshHandle createMesh(const MeshDataView& data);
+    // Maps a cooked mesh file (MeshFile.h) and uploads it straight from the mapping. Prints an
+    // error and returns INVALID_RENDER_HANDLE if the file cannot be opened or is not a cooked mesh.
+    MeshHandle loadMesh(const std::string& path);
+    // Releases a mesh's arena space. Must not be called between submit() and flush() for that mesh.
+    void destroyMesh(MeshHandle mesh);
+    // Name of the built-in shader in the shader library (features: LIGHTING, LOD_FADE, TEXTURE, SHADOWS).
+    static constexpr const char* DEFAULT_SHADER = "triangle";
+    // Depth-only shader that draws shadow casters (shaders/shadow.vert and shadow.frag).
+    static constexpr const char* SHADOW_SHADER = "shadow";
+
+    // Compiles a material's shader program. The vertex shader must read the model matrix from the
+    // per-instance attribute at location 3 (locations 3-6, one column each) and the camera
+    // matrices from the std140 'Camera' uniform block. Translucent materials are drawn after all
+    // opaque ones, back-to-front, with alpha blending and depth writes off.
+    // The program builds in the background (or comes from the shader cache): create all materials
+    // first, then do other loading, then call finishShaderCompiles(). A material is also finished
+    // the first time it is drawn; one that fails to compile or link draws nothing.
+    // The files are added to the shader library under "vertexPath / fragmentPath" and built with
+    // no features enabled. Returns INVALID_RENDER_HANDLE if the shader files cannot be read.
+    MaterialHandle createMaterial(const char* vertexPath, const char* fragmentPath, bool translucent = false);
+    // Creates a material from a shader library entry, built with the features in 'featureMask'
+    // (ShaderLibrary::getFeatureBit()). Materials with the same shader and features share one
+    // program and batch together in the sort order.
+    MaterialHandle createMaterialVariant(const std::string& shaderName, uint32_t featureMask, bool translucent = false);
+    // Waits for every shader variant still compiling and reports errors. Returns the number that failed.
+    size_t finishShaderCompiles();
+    // Named shaders and their variants; add shaders here before creating materials from them.
+    ShaderLibrary& getShaderLibrary() { return shaderLibrary; }
+
+    // Streamed textures (see TextureStreamer.h). beginFrame() runs its update(), and flush()
+    // reports the screen size of every textured draw, so textures only need to be loaded and
+    // attached to materials.
+    TextureStreamer& getTextureStreamer() { return textureStreamer; }
+    // Binds 'texture' to ALBEDO_TEXTURE_UNIT ('albedoTexture') whenever 'material' is drawn.
+    // The material's shader should be a TEXTURE variant; INVALID_RENDER_HANDLE detaches it.
+    void setMaterialTexture(MaterialHandle material, TextureHandle texture);
+
+    // Directory of the program binary cache, relative to the working directory (default
+    // "shader_cache"; empty disables it). Must be set before init().
+    void setShaderCacheDirectory(const std::string& directory) { shaderCacheDirectory = directory; }
+    const ShaderCache& getShaderCache() const { return shaderCache; }
+
+    // The triangle, kept for callers that predate the built-in meshes.
+    MeshHandle getDefaultMesh() const { return builtinMeshes[static_cast<int>(BuiltinMesh::Triangle)]; }
+    MeshHandle getBuiltinMesh(BuiltinMesh mesh) const { return builtinMeshes[static_cast<int>(mesh)]; }
+    MaterialHandle getDefaultMaterial() const { return defaultMaterial; }
+
+    // Starts a frame: advances the frame stream (waiting only if the GPU is FRAME_COUNT frames
+    // behind) and writes view/projection into the camera uniform block, which every material
+    // reads, so no per-draw or per-material camera uniforms are set. Also advances texture
+    // streaming; call it after binding the render target (its viewport sizes texture requests).
+    // Does not clear: the caller owns the render target and clears it.
+    void beginFrame(const Mat4& view, const Mat4& projection);
+    // Uploads this frame's lights, binned for the camera passed to beginFrame(). Call between
+    // beginFrame() and flush(). Returns false (and draws unlit) if the data cannot be uploaded.
+    bool setLights(const LightClusterer& clusterer);
+    // Ambient term used with setLights().
+    void setAmbientLight(const Vec3& color) { ambientLight = color; }
+    // Directional light used with setLights(): 'direction' is the way the light travels, 'color'
+    // includes the intensity (black, the default, turns it off). Shadowed in SHADOWS variants
+    // once setShadows() is called; keep the ShadowCascades' light direction the same.
+    void setDirectionalLight(const Vec3& direction, const Vec3& color);
+
+    // Draws one cascade of the directional light's shadow map from two queues of shadow casters
+    // (keys from makeShadowSortKey(), culled to the cascade's casterFrustum) and clears them.
+    // 'staticCasters' is only drawn, and only needs to be filled, when
+    // cascades.needsStaticRender(cascade); this call then marks it rendered. Creates or resizes
+    // the shadow maps to the cascades' settings (invalidating them) as needed. Call between
+    // beginFrame() and setShadows(); the bound framebuffer and viewport are restored.
+    void renderShadowCascade(ShadowCascades& cascades, uint32_t cascade, RenderQueue& staticCasters,
+                             RenderQueue& dynamicCasters, ThreadPool* pool = nullptr);
+    // Binds this frame's shadow maps and cascade data for SHADOWS variants. Call after the
+    // cascades are rendered and before flush(); without it, the frame has no shadows.
+    void setShadows(const ShadowCascades& cascades);
+    // Sort key of a shadow caster: mesh only, since every caster draws with the shadow shader.
+    uint64_t makeShadowSortKey(MeshHandle mesh) const { return SortKey::make(RenderPass::Shadow, false, 0, 0, mesh, 0.0f); }
+    const ShadowStats& getShadowStats() const { return shadowStats; }
+    // Queues one object for drawing. Cheap: records a sort key and copies the matrix.
+    // 'fade' is the dither fade of an LOD transition (LODGroup::incomingFade()/outgoingFade()).
+    void submit(MeshHandle mesh, MaterialHandle material, const Mat4& model, float fade = 1.0f);
+    // Draws everything submitted since beginFrame(), one instanced draw per mesh/material group.
+    // Meshlet culling runs on 'pool' when given.
+    void flush(ThreadPool* pool = nullptr);
+
+    // Builds the sort key for an object. Uses the camera from beginFrame() for the depth field.
+    // Thread-safe between beginFrame() and flush(); handles must be valid.
+    // Opaque-pass commands with a translucent material are moved to the translucent pass.
+    uint64_t makeSortKey(MeshHandle mesh, MaterialHandle material, const Mat4& model,
+                         RenderPass pass = RenderPass::Opaque) const;
+    // Sorts and draws a queue recorded by the caller (e.g. from several threads), then clears it.
+    // Meshlet culling runs on 'pool' when given.
+    void flush(RenderQueue& queue, ThreadPool* pool = nullptr);
+
+    // How meshes with meshlets are culled (default FrustumAndCone). Takes effect at the next beginFrame().
+    void setMeshletCulling(MeshletCulling mode) { meshletCulling = mode; }
+    MeshletCulling getMeshletCulling() const { return meshletCulling; }
+
+    const RenderStats& getLastFlushStats() const { return lastFlushStats; }
+    const MeshManager& getMeshManager() const { return meshManager; }
+
+    // Reserves transient GPU memory valid for the current frame (see StreamBuffer.h).
+    // Write the data, call commitFrameData(), then reference allocation.buffer/offset in draws.
+    StreamAllocation allocateFrameData(size_t size, size_t alignment = 16) { return frameStream.allocate(size, alignment); }
+    void commitFrameData(const StreamAllocation& allocation) { frameStream.commit(allocation); }
+    const StreamBuffer& getFrameStream() const { return frameStream; }
 
 private:
-    unsigned int VAO;         // Vertex Array Object ID
-    unsigned int VBO;         // Vertex Buffer Object ID
-    Shader* shaderProgram;    // Pointer to the Shader object managing our GLSL program
-
-    // Vertex data for a triangle. Each vertex has 3 position floats (x,y,z)
-    // and 3 color floats (r,g,b). Total 6 floats per vertex.
-    // Stored as: PosX, PosY, PosZ, ColR, ColG, ColB, ...
-    float vertices[18] = {
-        // Positions          // Colors
-        -0.5f, -0.5f, 0.0f,   1.0f, 0.0f, 0.0f, // Vertex 1: Bottom-left (Red)
-         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f, // Vertex 2: Bottom-right (Green)
-         0.0f,  0.5f, 0.0f,   0.0f, 0.0f, 1.0f  // Vertex 3: Top-center (Blue)
+    struct Material {
+        Shader* shader;     // Owned by shaderLibrary
+        uint32_t shaderKey; // Shader field of the sort key: the variant index
+        bool translucent;
+        bool finalized;     // finalizeMaterial() has run
+        TextureHandle texture; // Streamed albedo texture, or INVALID_RENDER_HANDLE
+    };
+    // CPU mirror of the 'Camera' uniform block (std140: mat4s and vec4 need no padding).
+    struct CameraUniforms {
+        Mat4 view;
+        Mat4 projection;
+        Mat4 viewProjection;
+        float cameraPosition[4]; // xyz = world-space eye position, w = 1
     };
-    // Note: For a 3D scene, you might want to define vertices with non-zero Z values
-    // or load them from a model file. This triangle lies on the Z=0 plane.
+
+    // CPU mirror of the 'Lights' uniform block (std140, six 16-byte rows).
+    struct LightUniforms {
+        uint32_t clusterGrid[4];   // CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z, light count
+        float clusterScale[4];     // Clusters per pixel in x and y, slice scale, slice bias
+        float ambientColor[4];
+        uint32_t texelBases[4];    // First texel of the lights, clusters and indices in the buffer textures
+        float sunDirection[4];     // Towards the directional light
+        float sunColor[4];
+    };
+    // CPU mirror of the 'Shadows' uniform block (std140: mat4s and vec4s need no padding).
+    struct ShadowUniforms {
+        Mat4 shadowMatrices[ShadowCascades::MAX_CASCADES]; // World to [0,1] map coordinates and depth
+        float cascadeSplits[4];
+        float cascadeTexelSizes[4];
+        float shadowParams[4];     // Cascade count, normal offset in texels, 1 / resolution, unused
+    };
+    // Offset applied along the normal before the shadow lookup, in texels of the cascade.
+    static constexpr float SHADOW_NORMAL_OFFSET = 1.5f;
+    // glPolygonOffset() of shadow casters: slope factor and constant units.
+    static constexpr float SHADOW_SLOPE_BIAS = 2.0f;
+    static constexpr float SHADOW_CONSTANT_BIAS = 4.0f;
+
+    // Writes the 'Lights' block (and, with a clusterer, the light buffers) into the frame stream
+    // and binds them. Without one, binds an unlit block: ambient 1 and no lights.
+    bool uploadLights(const LightClusterer* clusterer);
+    // Writes and binds the 'Shadows' block; without cascades, one with no cascades (no shadows).
+    void uploadShadows(const ShadowCascades* cascades);
+    // (Re)creates the shadow map arrays and their framebuffers for 'settings'. Returns false on failure.
+    bool createShadowMaps(const ShadowSettings& settings);
+    // Draws a queue of shadow casters into the bound shadow framebuffer and adds its stats to shadowStats.
+    void flushShadowCasters(RenderQueue& casters, ThreadPool* pool);
+
+    // Finishes a material's program on first use and checks it reads the 'Camera' block.
+    // Returns false if the program failed to build.
+    bool finalizeMaterial(Material& material);
+
+    // Reports to the texture streamer how large sorted instances [begin, end) of 'queue' (all
+    // the same mesh) appear on screen: the largest projected bounding-sphere diameter, in pixels.
+    // Models come from the queue, not the stream copy, which may be write-combined memory.
+    void requestTextureSize(TextureHandle texture, MeshHandle mesh, const RenderQueue& queue, size_t begin, size_t end);
+
+    // Points the bound arena VAO's instance attributes (model matrix at locations 3-6, fade at 8)
+    // at 'firstInstance' in the flush's instance allocation, whose fades start at 'fadeOffset'.
+    // GL 3.3 has no base-instance draw, so each group re-points the attributes instead.
+    void bindInstanceAttributes(const StreamAllocation& instances, size_t fadeOffset, size_t firstInstance);
+
+    MeshManager meshManager;
+    std::vector<Material> materials;
+    MeshHandle builtinMeshes[static_cast<int>(BuiltinMesh::Count)];
+    MaterialHandle defaultMaterial;
+
+    StreamBuffer frameStream;       // Camera uniforms and instance matrices, per frame
+    size_t uniformAlignment;        // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    Mat4 frameView;
+    float frameInvDepthRange;       // 1 / far plane: maps view depth to the key's [0,1] range
+    RenderQueue frameQueue;         // Commands from submit()
+    unsigned int lightTextures[3];  // Buffer textures over the frame stream: lights, clusters, indices
+    size_t maxTextureBufferTexels;  // GL_MAX_TEXTURE_BUFFER_SIZE
+    Vec3 ambientLight;
+    Vec3 sunDirection;              // Direction the light travels, normalized
+    Vec3 sunColor;
+    ShaderCache shaderCache;
+    std::string shaderCacheDirectory;
+    ShaderLibrary shaderLibrary;    // Owns every material's program
+    TextureStreamer textureStreamer;
+    float framePixelsPerUnit;       // Viewport pixels per world unit at view depth 1, from beginFrame()
+    RenderStats lastFlushStats;
+
+    // Cascaded shadow maps: one depth layer per cascade, plus the cached cascades' static casters.
+    Shader* shadowShader;           // Owned by shaderLibrary; null if shaders/shadow.* failed to load
+    UniformHandle shadowViewProjectionUniform;
+    unsigned int shadowMaps;        // GL_TEXTURE_2D_ARRAY, compared in the lit shaders
+    unsigned int staticShadowMaps;  // GL_TEXTURE_2D_ARRAY, copied into shadowMaps
+    unsigned int shadowFramebuffers[2]; // Draw and read targets; layers are attached per pass
+    uint32_t shadowResolution;      // Of the current arrays (0 = none)
+    uint32_t shadowLayers;
+    bool shadowLayerHasDynamic[ShadowCascades::MAX_CASCADES]; // Final layer holds dynamic casters
+    MeshletCuller shadowMeshletCuller; // Set to the cascade being drawn, frustum only
+    ShadowStats shadowStats;
+
+    MeshletCulling meshletCulling;
+    MeshletCulling frameMeshletCulling; // meshletCulling as of beginFrame(), used until the next one
+    MeshletCuller meshletCuller;    // Set to the camera in beginFrame()
+    // Per flush: the visible ranges of command i are meshletRanges[meshletRangeOffsets[i]] onwards
+    // (meshletRangeCounts[i] of them), and the multi-draw arguments of one instance (GLsizei, GLint).
+    std::vector<size_t> meshletRangeOffsets;
+    std::vector<uint32_t> meshletRangeCounts;
+    std::vector<MeshletRange> meshletRanges;
+    std::vector<int> multiDrawCounts;
+    std::vector<const void*> multiDrawOffsets;
+    std::vector<int> multiDrawBaseVertices;
 };
 
 #endif // RENDERER_H
@@ -0,0 +1,84 @@
+// SceneGraph.h
+// Parent/child transform hierarchy with cached local and world matrices.
+//
+// Nodes are stored in depth-first order in flat arrays: a node's subtree is the contiguous
+// range [slot, slot + subtreeSize). Because every parent precedes its children, world matrices
+// can be recomputed with a single forward pass over a range, and a dirty node only costs the
+// size of its own subtree. Clean parts of the scene are never touched by update().
+//
+// Each node belongs to an ECS entity whose Transform component holds the local TRS values.
+// After changing a Transform, call markDirty(entity); update() then rebuilds the matrices of
+// that entity's subtree only.
+
+#ifndef SCENEGRAPH_H
+#define SCENEGRAPH_H
+
+#include "MyFirstEngine/ECS.h"
+#include "../SimpleMath.h"
+#include <vector>
+#include <cstdint>
+
+class SceneGraph {
+public:
+    SceneGraph();
+
+    // Adds 'entity' as the last child of 'parent' (or as a root if parent is null).
+    // Appending a root is O(1); inserting under an existing parent shifts later slots.
+    void addNode(Entity entity, Entity parent = Entity::null());
+    // Removes 'entity' and its whole subtree from the graph (the entities themselves are untouched).
+    void removeNode(Entity entity);
+    // Moves 'entity' (with its subtree) under 'newParent'. Local transforms are kept as-is.
+    // Returns false if the move would create a cycle.
+    bool setParent(Entity entity, Entity newParent);
+
+    bool contains(Entity entity) const;
+    Entity getParent(Entity entity) const;
+
+    // Flags the entity's local transform as changed. Its subtree is recomputed on the next update().
+    void markDirty(Entity entity);
+    // Flags every node dirty (e.g. after loading a scene).
+    void markAllDirty();
+
+    // Recomputes local and world matrices for all dirty subtrees.
+    // Returns the number of nodes whose world matrix was recomputed.
+    size_t update(World& world);
+
+    const Mat4& getLocalMatrix(Entity entity) const { return localMatrices[slotOf(entity)]; }
+    const Mat4& getWorldMatrix(Entity entity) const { return worldMatrices[slotOf(entity)]; }
+
+    // Depth-first traversal access. Slots are only stable until the next structural change.
+    size_t size() const { return nodeEntities.size(); }
+    Entity getEntityAt(size_t slot) const { return nodeEntities[slot]; }
+    uint32_t getDepthAt(size_t slot) const { return depths[slot]; }
+    uint32_t getSubtreeSizeAt(size_t slot) const { return subtreeSizes[slot]; }
+    const Mat4& getWorldMatrixAt(size_t slot) const { return worldMatrices[slot]; }
+    const Mat4* getWorldMatrices() const { return worldMatrices.data(); }
+
+private:
+    static constexpr uint32_t INVALID_SLOT = 0xFFFFFFFFu;
+
+    uint32_t slotOf(Entity entity) const;
+    // Inserts a block of nodes at 'pos' whose first node becomes a child of 'parentSlot' (or root).
+    void insertBlock(uint32_t pos, int32_t parentSlot, const std::vector<Entity>& entities,
+                     const std::vector<Entity>& parents, const std::vector<uint32_t>& sizes,
+                     const std::vector<Mat4>& locals, const std::vector<uint8_t>& dirty);
+    // Adds 'delta' to the subtree size of 'slot' and all of its ancestors.
+    void adjustAncestorSizes(int32_t slot, int32_t delta);
+    // Recomputes slot lookups, parent slots and depths from parentEntities (O(n)).
+    void rebuildIndices();
+
+    // Per-node data, depth-first order
+    std::vector<Entity> nodeEntities;
+    std::vector<Entity> parentEntities;
+    std::vector<int32_t> parentSlots;   // -1 for roots
+    std::vector<uint32_t> subtreeSizes; // Including the node itself
+    std::vector<uint32_t> depths;
+    std::vector<Mat4> localMatrices;
+    std::vector<Mat4> worldMatrices;
+    std::vector<uint8_t> dirtyFlags;
+
+    std::vector<uint32_t> slotOfEntity; // Indexed by Entity::index
+    std::vector<uint32_t> dirtyEntities; // Entity indices marked dirty since the last update
+};
+
+#endif // SCENEGRAPH_H
@@ -2,55 +2,182 @@
 // Declaration of the Shader class.
 // Handles loading, compiling, and linking GLSL shaders from files.
 // Includes methods for setting various uniform types, including 4x4 matrices.
+//
+// After linking, the program is reflected (glGetActiveUniform / glGetActiveUniformBlock) into a
+// table keyed by a hash of each uniform's name. Setters then never call glGetUniformLocation:
+// either resolve a UniformHandle once with getUniform() and keep it, or pass a name and pay only
+// for a hash plus a binary search. Uniform blocks named in the engine's shared-block list are
+// bound to their fixed binding points at link time (e.g. 'Camera' -> CAMERA_UNIFORM_BINDING), and
+// the engine's shared samplers to their fixed texture units.
+//
+// Compilation is asynchronous: the constructor submits the sources and links without asking for
+// any status, so the driver (with KHR_parallel_shader_compile, on its own threads) can work on
+// several programs while the caller creates more of them or uploads meshes. The status is only
+// read by finalize(), which use() calls the first time the program is needed; finalize() also
+// runs the reflection and stores the program in the ShaderCache, if one was given. With a cache
+// hit the constructor loads the linked binary instead of compiling at all.
 
 #ifndef SHADER_H
 #define SHADER_H
 
 #include <string>      // For std::string (used for uniform names and file paths)
+#include <vector>
+#include <cstdint>
 #include "glad/glad.h" // For OpenGL types (GLuint, GLenum, etc.)
                        // GLAD must be included before any other OpenGL headers if not already handled.
 
+class ShaderCache;
+
+// Uniform buffer binding points shared by every shader program.
+// The 'Camera' block (std140: view, projection, viewProjection, cameraPosition) is written once
+// per frame by Renderer::beginFrame.
+static const GLuint CAMERA_UNIFORM_BINDING = 0;
+// The 'Lights' block (std140: cluster grid, slice mapping, ambient; see triangle.frag) is written
+// by Renderer::beginFrame/setLights.
+static const GLuint LIGHTS_UNIFORM_BINDING = 1;
+// The 'Shadows' block (std140: cascade matrices, splits, texel sizes; see triangle.frag) is written
+// by Renderer::beginFrame/setShadows.
+static const GLuint SHADOWS_UNIFORM_BINDING = 2;
+
+// Texture units of the clustered-lighting buffer textures, assigned at link time to the samplers
+// named 'lightData', 'lightClusters' and 'lightIndices'. Kept at the top of the GL 3.3 minimum
+// of 16 units so materials can use the low ones freely.
+static const GLint LIGHT_DATA_TEXTURE_UNIT = 13;
+static const GLint LIGHT_CLUSTERS_TEXTURE_UNIT = 14;
+static const GLint LIGHT_INDICES_TEXTURE_UNIT = 15;
+// Texture unit of the cascaded shadow map array (sampler 'shadowMap'), bound by Renderer::setShadows.
+static const GLint SHADOW_MAP_TEXTURE_UNIT = 12;
+// Texture unit of a material's streamed texture (sampler 'albedoTexture'), bound by the Renderer.
+static const GLint ALBEDO_TEXTURE_UNIT = 0;
+
+// 32-bit FNV-1a hash of a uniform name. constexpr, so literal names can be hashed at compile time.
+constexpr uint32_t hashUniformName(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= static_cast<uint8_t>(*name++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Precomputed uniform location. Invalid (location -1) if the uniform does not exist or was
+// optimized out; setters ignore invalid handles, like glUniform* does for location -1.
+struct UniformHandle {
+    GLint location = -1;
+    bool isValid() const { return location >= 0; }
+};
+
 // The Shader class encapsulates the creation and management of an OpenGL shader program.
 class Shader {
 public:
-    // The program ID of the linked shader program.
+    // The program ID of the shader program.
     // This ID is used when activating the shader or setting uniforms.
-    // It will be 0 if shader creation or linking failed.
+    // It will be 0 if the files could not be read or, after finalize(), if compiling or linking
+    // failed. Before finalize() a nonzero ID may still turn out not to link.
     unsigned int ID;
 
     // Constructor:
-    // Reads GLSL shader source code from the specified vertex and fragment shader files.
-    // Compiles and links the shaders into a shader program.
-    // Stores the program ID in the 'ID' member.
+    // Reads GLSL shader source code from the specified vertex and fragment shader files and
+    // starts compiling and linking them (or loads the program from 'cache'). Does not wait for
+    // the driver; see finalize().
     // vertexPath: file path to the vertex shader source code.
     // fragmentPath: file path to the fragment shader source code.
-    Shader(const char* vertexPath, const char* fragmentPath);
+    // cache: optional program binary cache, used for loading and, after linking, for storing.
+    Shader(const char* vertexPath, const char* fragmentPath, ShaderCache* cache = nullptr);
+    // Builds a program from source text, with 'defines' ("#define NAME 1" lines) inserted after
+    // each stage's #version line (see ShaderLibrary). 'label' names the program in error messages.
+    Shader(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines,
+           const std::string& label, ShaderCache* cache = nullptr);
 
     // Destructor:
     // Cleans up by deleting the shader program from OpenGL if it was created.
     ~Shader();
 
-    // Activates the shader program for use in rendering.
-    // This is equivalent to calling glUseProgram(ID).
-    void use();
+    // Activates the shader program for use in rendering (glUseProgram(ID)), finalizing it first
+    // if needed. Returns false, and binds nothing, if the program failed to build.
+    bool use();
+
+    // Waits for the compile and link if they are still running, prints the logs on failure (and
+    // sets ID to 0), otherwise reflects the program and stores it in the cache. Cheap after the
+    // first call. Returns true if the program is usable.
+    bool finalize();
+    // True once finalize() would not block: always with a cache hit or after finalize(), and
+    // otherwise only if the driver reports completion (KHR_parallel_shader_compile). Without
+    // that extension it returns true, since there is no way to ask without waiting.
+    bool isCompileComplete() const;
+    bool isReady() const { return status == Status::Ready; }
+
+    // Reads a whole source file into 'source'. Prints an error and returns false if it cannot.
+    static bool loadSource(const char* path, std::string& source);
+
+    // Looks up a uniform in the reflection table, which is filled by finalize(). Resolve handles
+    // once (e.g. after the first use()) and reuse them every frame. Array uniforms can be found
+    // with or without "[0]".
+    UniformHandle getUniform(const char* name) const { return getUniform(hashUniformName(name)); }
+    UniformHandle getUniform(uint32_t nameHash) const;
+    bool hasUniformBlock(const char* name) const;
 
     // Utility functions for setting uniform values in the shader program.
-    // These functions find the uniform location by name and then set its value.
     // They should be called after 'use()' has been called for this shader program.
 
     // Sets a boolean uniform.
-    void setBool(const std::string &name, bool value) const;
+    void setBool(UniformHandle uniform, bool value) const { if (uniform.isValid()) glUniform1i(uniform.location, (int)value); }
     // Sets an integer uniform.
-    void setInt(const std::string &name, int value) const;
+    void setInt(UniformHandle uniform, int value) const { if (uniform.isValid()) glUniform1i(uniform.location, value); }
     // Sets a float uniform.
-    void setFloat(const std::string &name, float value) const;
-    // Sets a 4x4 matrix uniform (e.g., model, view, projection matrices).
+    void setFloat(UniformHandle uniform, float value) const { if (uniform.isValid()) glUniform1f(uniform.location, value); }
+    // Sets a 4x4 matrix uniform.
     // matValue: a pointer to the first element of a 16-float array representing the matrix
     //           (expected to be in column-major order, as used by OpenGL and our Mat4).
-    void setMat4(const std::string &name, const float* matValue) const;
+    void setMat4(UniformHandle uniform, const float* matValue) const {
+        if (uniform.isValid()) glUniformMatrix4fv(uniform.location, 1, GL_FALSE, matValue);
+    }
+
+    // Name-based convenience setters: hash + table lookup, no driver round trip.
+    void setBool(const char* name, bool value) const { setBool(getUniform(name), value); }
+    void setInt(const char* name, int value) const { setInt(getUniform(name), value); }
+    void setFloat(const char* name, float value) const { setFloat(getUniform(name), value); }
+    void setMat4(const char* name, const float* matValue) const { setMat4(getUniform(name), matValue); }
     // You can add more setters for other uniform types (vec2, vec3, vec4, mat2, mat3, etc.) as needed.
 
 private:
+    enum class Status {
+        Pending, // Compiling or linking; status not read yet
+        Ready,
+        Failed
+    };
+    struct UniformInfo {
+        uint32_t nameHash;
+        GLint location;
+        GLenum type;  // e.g. GL_FLOAT_MAT4
+        GLint size;   // Array length, 1 for non-arrays
+        std::string name;
+    };
+    struct UniformBlockInfo {
+        uint32_t nameHash;
+        GLuint index;
+        GLint dataSize; // Bytes, as laid out by the driver
+        std::string name;
+    };
+
+    // Builds the uniform and uniform block tables from the linked program and binds the
+    // engine's shared uniform blocks and samplers to their binding points / texture units.
+    void reflect();
+
+    // Loads the program from the cache or submits the sources and links 'ID', without checking anything.
+    void start(const std::string& vertexCode, const std::string& fragmentCode, const std::string& defines);
+    void startCompile(const std::string& vertexCode, const std::string& fragmentCode);
+
+    std::vector<UniformInfo> uniforms;         // Sorted by nameHash
+    std::vector<UniformBlockInfo> uniformBlocks;
+
+    Status status;
+    GLuint vertexShader, fragmentShader; // Kept until finalize() for their compile logs
+    ShaderCache* cache;
+    uint64_t cacheKey;
+    bool fromCache;                      // Loaded from a binary: nothing to store
+    std::string label;                   // E.g. "vertexPath / fragmentPath", for error messages
+
     // A private utility function to check for compilation or linking errors.
     // shader: the ID of the shader or program to check.
     // type: a string indicating whether it's a "VERTEX" shader, "FRAGMENT" shader, or "PROGRAM".
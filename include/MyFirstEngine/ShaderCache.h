@@ -0,0 +1,71 @@
+// ShaderCache.h
+// On-disk cache of linked shader programs (GL 4.1 / ARB_get_program_binary).
+//
+// Compiling GLSL is the slowest part of startup, and the result only changes when the source,
+// the preprocessor defines or the driver does. After a program links, Shader hands it to
+// storeProgram(), which saves the driver's binary to '<directory>/<key>.bin'; the next run
+// calls loadProgram() with the same key and gets a linked program back without compiling.
+//
+// The key is a 64-bit FNV-1a hash of FORMAT_VERSION, GL_VENDOR / GL_RENDERER / GL_VERSION, the
+// defines and both sources, so a driver update or an edited shader simply misses. Drivers may
+// still reject a binary (glProgramBinary then leaves the program unlinked); loadProgram()
+// reports that as a miss and the caller compiles from source, which overwrites the stale file.
+//
+// Without program binary support (or without a directory), every load misses and nothing is
+// written: the cache only ever saves time, it is never required.
+
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <cstdint>
+#include <string>
+
+class ShaderCache {
+public:
+    // Bump when the file layout or the key changes, to ignore old files.
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    ShaderCache();
+
+    // Creates 'directory' if needed and reads the driver strings for the key. Needs a current GL
+    // context and GLExtensions::load(). An empty directory disables the cache. Returns false if
+    // the cache cannot be used (the engine runs without it).
+    bool init(const std::string& directory);
+    bool isEnabled() const { return enabled; }
+
+    // Key of one program variant.
+    uint64_t makeKey(const std::string& vertexSource, const std::string& fragmentSource,
+                     const std::string& defines) const;
+
+    // Creates a program from the binary stored under 'key'. Returns 0 on a miss, if the file is
+    // damaged or if the driver rejects the binary.
+    unsigned int loadProgram(uint64_t key);
+    // Saves a linked program (created with GL_PROGRAM_BINARY_RETRIEVABLE_HINT) under 'key'.
+    // The file is written under a temporary name and renamed, so readers never see half a file.
+    bool storeProgram(uint64_t key, unsigned int program);
+
+    // Counters since init(), for startup reports.
+    unsigned int getHits() const { return hits; }
+    unsigned int getMisses() const { return misses; }
+    unsigned int getStores() const { return stores; }
+
+private:
+    // Header in front of the driver's blob.
+    struct FileHeader {
+        uint32_t magic;        // FILE_MAGIC
+        uint32_t version;      // FORMAT_VERSION
+        uint32_t binaryFormat; // As returned by glGetProgramBinary
+        uint32_t length;       // Bytes of blob after the header
+        uint64_t key;          // Guards against renamed or colliding files
+    };
+    static constexpr uint32_t FILE_MAGIC = 0x42504553; // "SEPB"
+
+    std::string pathFor(uint64_t key) const;
+
+    bool enabled;
+    std::string directory;
+    std::string driverString; // Vendor, renderer and version, hashed into every key
+    unsigned int hits, misses, stores;
+};
+
+#endif // SHADERCACHE_H
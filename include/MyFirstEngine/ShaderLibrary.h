@@ -0,0 +1,99 @@
+// ShaderLibrary.h
+// Named shaders with compile-time feature variants.
+//
+// A shader source declares the features it can be built with, one per line:
+//   #pragma feature LIGHTING
+// (GLSL ignores pragmas it does not know, so the file still compiles on its own.) Features of the
+// vertex and fragment file are merged in order of appearance and numbered from bit 0, up to
+// MAX_FEATURES. get(name, featureMask) returns the program built with "#define <FEATURE> 1" for
+// every bit set in the mask; the source tests them with #ifdef, so each variant contains only the
+// code it uses instead of branching on uniforms at run time.
+//
+// Variants compile on first request, through Shader's asynchronous build and the ShaderCache.
+// Bits that do not name a declared feature are ignored, so masks that only differ there share
+// one variant. To avoid compiling during the first frames, list the variants a scene needs in a
+// manifest and prewarm() them at startup:
+//   # name  features...
+//   triangle LIGHTING LOD_FADE
+//   triangle
+//
+// Variants get dense indices in creation order (getVariantIndex()), which the Renderer uses as
+// the shader field of its sort keys.
+
+#ifndef SHADERLIBRARY_H
+#define SHADERLIBRARY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+class ShaderCache;
+
+class ShaderLibrary {
+public:
+    static constexpr uint32_t MAX_FEATURES = 32;
+    static constexpr uint32_t INVALID_VARIANT = 0xFFFFFFFFu;
+
+    ShaderLibrary();
+    // Deletes every variant's program; needs the GL context that created them.
+    ~ShaderLibrary();
+    ShaderLibrary(const ShaderLibrary&) = delete;
+    ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+    // Cache for the programs of variants created after this call (may be null).
+    void setCache(ShaderCache* programCache) { cache = programCache; }
+
+    // Reads the sources of 'name' and their feature declarations. Nothing is compiled yet.
+    // Returns false if the files cannot be read or 'name' was already added.
+    bool addShader(const std::string& name, const char* vertexPath, const char* fragmentPath);
+    bool hasShader(const std::string& name) const { return findShader(name) >= 0; }
+
+    // Bit of a declared feature; 0 (with an error) if 'name' does not declare it.
+    uint32_t getFeatureBit(const std::string& name, const std::string& feature) const;
+    // Mask with every declared feature of 'name' set.
+    uint32_t getAllFeatures(const std::string& name) const;
+    const std::vector<std::string>& getFeatures(const std::string& name) const;
+
+    // Index of the variant, compiling it if this is the first request. Returns INVALID_VARIANT if
+    // 'name' was never added or the program cannot be created.
+    uint32_t getVariantIndex(const std::string& name, uint32_t featureMask);
+    Shader* getVariant(uint32_t index) const { return index < variants.size() ? variants[index].shader : nullptr; }
+    // getVariant(getVariantIndex(name, featureMask)).
+    Shader* get(const std::string& name, uint32_t featureMask) { return getVariant(getVariantIndex(name, featureMask)); }
+    size_t getVariantCount() const { return variants.size(); }
+
+    // Creates every variant listed in the manifest file (format above). Compiles start but are not
+    // waited for; call finishCompiles() after other loading. Returns the number of variants listed,
+    // or -1 if the file cannot be read.
+    int prewarm(const char* manifestPath);
+    // Waits for all variants still compiling (those the driver already finished first) and
+    // reports errors. Returns the number that failed.
+    size_t finishCompiles();
+
+private:
+    struct Source {
+        std::string name;
+        std::string vertexPath, fragmentPath;
+        std::string vertexCode, fragmentCode;
+        std::vector<std::string> features; // Bit i = features[i]
+    };
+    struct Variant {
+        uint32_t source;
+        uint32_t featureMask;
+        Shader* shader;
+    };
+
+    int findShader(const std::string& name) const;
+    // Appends the '#pragma feature' names of 'code' not already in 'features'.
+    static void parseFeatures(const std::string& code, std::vector<std::string>& features);
+
+    std::vector<Source> sources;
+    std::vector<Variant> variants;
+    std::unordered_map<uint64_t, uint32_t> variantLookup; // (source << 32 | mask) -> variant index
+    ShaderCache* cache;
+};
+
+#endif // SHADERLIBRARY_H
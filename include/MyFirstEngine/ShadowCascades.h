@@ -0,0 +1,102 @@
+// ShadowCascades.h
+// Cascaded shadow maps for one directional light: split placement, fitting and caching.
+//
+// The camera's view depth range, up to ShadowSettings::maxDistance, is split into cascadeCount
+// slices with the practical split scheme (a blend of uniform and logarithmic splits weighted by
+// splitLambda), and each slice gets its own square shadow map of 'resolution' texels.
+// A cascade covers the smallest sphere around its slice of the camera frustum, so its size only
+// depends on the projection and not on the camera's orientation, and its light-space center is
+// snapped to whole texels. Together these keep shadow edges from shimmering as the camera moves:
+// the same world positions always fall on the same texels.
+//
+// Each cascade's light-space box is also its caster volume (casterFrustum): the frustum of the
+// orthographic projection without the near plane, so casters between the light and the box are
+// kept. The Renderer draws them with depth clamping, which flattens them onto the near plane
+// instead of clipping them.
+//
+// Distant cascades (index >= firstCachedCascade) are cached: they cover a sphere cachePadding
+// larger than needed and stay put until the slice leaves it, so as the camera moves they are
+// only refit now and then. The Renderer keeps their static casters in a separate depth layer
+// that is redrawn only when needsStaticRender() says so: after a refit, a light direction change,
+// or invalidateStatic() with the bounds of static geometry that moved inside it. Every other
+// frame costs a layer copy plus the dynamic casters. Near cascades are redrawn every frame.
+//
+// This class is GL-free; Renderer::renderShadowCascade() and Renderer::setShadows() draw and
+// bind the maps.
+
+#ifndef SHADOWCASCADES_H
+#define SHADOWCASCADES_H
+
+#include "../SimpleMath.h"
+#include <cstdint>
+
+class Camera;
+
+struct ShadowSettings {
+    uint32_t cascadeCount = 4;       // 1 to ShadowCascades::MAX_CASCADES
+    uint32_t resolution = 1024;      // Texels per side of each cascade's map
+    float maxDistance = 60.0f;       // View depth the last cascade reaches (at most the far plane)
+    float splitLambda = 0.75f;       // 0 = uniform splits, 1 = logarithmic
+    uint32_t firstCachedCascade = 2; // Cascades from this index on are cached; >= cascadeCount disables caching
+    float cachePadding = 0.25f;      // Cached cascades cover (1 + cachePadding) times the needed radius
+};
+
+struct ShadowCascade {
+    float nearDepth;          // View depth range of the camera slice this cascade shadows
+    float farDepth;
+    BoundingSphere bounds;    // World-space sphere covered by the map
+    Mat4 view;                // World to light space
+    Mat4 viewProjection;      // World to the map's clip space (orthographic)
+    Frustum casterFrustum;    // World-space caster volume: the map's box, open toward the light
+    float texelSize;          // World units per texel
+    bool cached;
+};
+
+class ShadowCascades {
+public:
+    static constexpr uint32_t MAX_CASCADES = 4;
+
+    ShadowCascades();
+
+    // Changing the settings refits and invalidates every cascade.
+    void setSettings(const ShadowSettings& settings);
+    const ShadowSettings& getSettings() const { return settings; }
+
+    // Direction the light travels in (need not be normalized). Any change invalidates the cached cascades.
+    void setLightDirection(const Vec3& direction);
+    const Vec3& getLightDirection() const { return lightDirection; }
+
+    // Fits the cascades to a camera. 'projection' must be a perspective matrix; near, far and the
+    // field of view are read from it. Call once per frame, before culling casters.
+    void update(const Mat4& view, const Mat4& projection);
+    void update(Camera& camera, float aspectRatio);
+
+    // Static geometry with world bounds 'bounds' changed (call with the old and the new bounds of
+    // a moved object): the cached cascades whose caster volume it touches are redrawn.
+    void invalidateStatic(const AABB& bounds);
+    // Forces every cascade to be refit and redrawn (e.g. after the shadow maps were recreated).
+    void invalidateAll();
+
+    uint32_t getCascadeCount() const { return settings.cascadeCount; }
+    const ShadowCascade& getCascade(uint32_t index) const { return cascades[index]; }
+    // True if the cascade's static casters must be drawn this frame; always true for uncached cascades.
+    bool needsStaticRender(uint32_t index) const { return !cascades[index].cached || staticDirty[index]; }
+    // Called by the Renderer once the static casters of a cached cascade are in its cache layer.
+    void markStaticRendered(uint32_t index) { staticDirty[index] = false; }
+
+private:
+    // Light-space rotation (no translation) looking along the light direction.
+    Mat4 computeLightRotation() const;
+    // Sets view, projection and caster volume of 'cascade' around 'center' with 'radius',
+    // snapping the center to whole texels in light space.
+    void fitCascade(ShadowCascade& cascade, const Vec3& center, float radius) const;
+
+    ShadowSettings settings;
+    Vec3 lightDirection;          // Normalized
+    Mat4 lightRotation;
+    ShadowCascade cascades[MAX_CASCADES];
+    bool staticDirty[MAX_CASCADES];
+    bool fitted[MAX_CASCADES];    // Cached cascades: has a cover to keep
+};
+
+#endif // SHADOWCASCADES_H
@@ -0,0 +1,87 @@
+// StreamBuffer.h
+// Ring buffer for data written by the CPU every frame (instance matrices, camera uniforms, ...).
+//
+// The buffer is split into FRAME_COUNT regions, one per frame in flight. Each frame bump-
+// allocates from its own region; when the frame ends a fence is inserted, and the region is only
+// reused FRAME_COUNT frames later after that fence has signalled. The CPU therefore writes
+// frame N+1 while the GPU still reads frame N, without orphaning or implicit driver syncs.
+//
+// Two mapping strategies, picked at init():
+//   - Persistent: with ARB_buffer_storage (GL 4.4) the whole buffer is mapped once, persistent
+//     and coherent. allocate() just returns a pointer; nothing is mapped or unmapped per frame.
+//   - Unsynchronized: otherwise each allocation is mapped with GL_MAP_UNSYNCHRONIZED_BIT and
+//     unmapped by commit(). The fences make the missing driver synchronization safe.
+//
+// A buffer object is not tied to a binding target, so one StreamBuffer can feed vertex
+// attributes and uniform blocks alike; pass the strictest alignment the data needs.
+
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+// One allocation: write 'size' bytes to 'data', call commit(), then draw using
+// 'buffer' at byte 'offset'. 'data' is only valid until commit() or the next allocate().
+struct StreamAllocation {
+    void* data;
+    unsigned int buffer; // GL buffer object name
+    size_t offset;       // In bytes from the start of 'buffer'
+    size_t size;
+};
+
+class StreamBuffer {
+public:
+    static constexpr int FRAME_COUNT = 3;
+
+    StreamBuffer();
+    // Deletes the buffer and any pending fences.
+    ~StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Creates the buffer with 'bytesPerFrame' per region. Requires a current GL context and,
+    // for the persistent path, GLExtensions::load(). Returns false on failure.
+    bool init(size_t bytesPerFrame);
+
+    // Fences the previous frame's region and moves to the next one, waiting (rarely) until the
+    // GPU has finished the frame that last used it.
+    void beginFrame();
+
+    // Reserves 'size' bytes aligned to 'alignment' (a power of two) in the current frame's region.
+    // If the region is full the buffer grows, so the returned 'buffer' may differ from earlier
+    // allocations. The old buffer is kept until the next beginFrame(), so commands already issued
+    // with it and ranges still bound from it (e.g. uniform blocks) stay valid for this frame.
+    // Earlier allocations' 'data' pointers do not: write them before allocating again.
+    StreamAllocation allocate(size_t size, size_t alignment = 16);
+    // Makes the written data visible to the GPU. A no-op for persistent coherent mappings.
+    void commit(const StreamAllocation& allocation);
+
+    bool isPersistent() const { return persistent; }
+    size_t getBytesPerFrame() const { return bytesPerFrame; }
+    // Number of beginFrame() calls that had to wait for the GPU (a sign the CPU is far ahead).
+    unsigned int getStallCount() const { return stallCount; }
+
+private:
+    // (Re)creates the buffer object with 'bytesPerFrame' per region and maps it if persistent.
+    bool createBuffer(size_t bytesPerFrame);
+    // Unmaps the buffer and moves it to retiredBuffers, dropping its fences.
+    void retireBuffer();
+    void destroyBuffer();
+    // Deletes the buffers replaced by growth. Deleting a buffer resets every binding of it.
+    void deleteRetiredBuffers();
+    // Blocks until 'fence' has signalled, then deletes it.
+    void waitFence(void*& fence);
+
+    unsigned int buffer;
+    bool persistent;
+    char* mappedData; // Whole buffer, persistent path only
+    size_t bytesPerFrame;
+    int frameIndex;    // Region currently being written
+    size_t frameOffset; // Next free byte inside the current region
+    void* fences[FRAME_COUNT]; // GLsync per region, null if none pending
+    unsigned int stallCount;
+    std::vector<unsigned int> retiredBuffers; // Replaced during the current frame, deleted at the next beginFrame()
+};
+
+#endif // STREAMBUFFER_H
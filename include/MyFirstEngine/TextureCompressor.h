@@ -0,0 +1,44 @@
+// TextureCompressor.h
+// CPU encoders (and reference decoders) for the block-compressed ImageFormats.
+//
+// Every format splits a level into 4x4 texel blocks, encoded independently; partial blocks at
+// the right and bottom edges repeat the last texel. Per block, the endpoints come from the
+// principal axis of the texel colors (BC1, BC7) or the value range (BC4 channels of BC3/BC5),
+// then every texel picks its nearest palette entry and a least-squares pass refits the
+// endpoints to those picks, kept if it lowers the error. The nearest-entry search is the hot
+// loop and runs four texels at a time with SSE when SimpleMath does (SIMPLEMATH_SSE).
+//
+//   BC1  565 endpoints, 2-bit indices; always the four-color mode, so alpha is dropped.
+//   BC3  BC4 alpha (8-bit endpoints, 3-bit indices) followed by a BC1 color block.
+//   BC5  Two BC4 blocks, red then green.
+//   BC7  Mode 6 only: one RGBA subset, 7-bit endpoints plus a p-bit each, 4-bit indices.
+//        The partitioned modes, which help blocks holding several distinct colors, are not
+//        searched; mode 6 alone already has more precision than BC1/BC3 everywhere else.
+//
+// compress() spreads the block rows of each level over a ThreadPool. decompress() is the
+// inverse, used by the cooker to report the error and by the streamer when the GL lacks a
+// format; it only understands mode 6 for BC7 (other modes decode as magenta).
+
+#ifndef TEXTURECOMPRESSOR_H
+#define TEXTURECOMPRESSOR_H
+
+#include "MyFirstEngine/Image.h"
+#include <cstdint>
+
+class ThreadPool;
+
+class TextureCompressor {
+public:
+    // Encodes every level of the RGBA8 image 'source' into 'format' (RGBA8 copies). Uses 'pool'
+    // if given, else runs on the calling thread. Returns false if 'source' is not RGBA8.
+    static bool compress(const Image& source, ImageFormat format, Image& out, ThreadPool* pool = nullptr);
+    // Decodes every level of 'source' to RGBA8. Returns false if any block could not be decoded.
+    static bool decompress(const Image& source, Image& out, ThreadPool* pool = nullptr);
+
+    // One 4x4 block: 'texels' is 16 RGBA8 texels, row by row; 'block' holds
+    // Image::getBlockBytes(format) bytes.
+    static void encodeBlock(ImageFormat format, const uint8_t* texels, uint8_t* block);
+    static bool decodeBlock(ImageFormat format, const uint8_t* block, uint8_t* texels);
+};
+
+#endif // TEXTURECOMPRESSOR_H
@@ -0,0 +1,177 @@
+// TextureStreamer.h
+// Asynchronous texture loading with on-demand mip residency under a VRAM budget.
+//
+// load() only queues the file: DECODE_THREADS background threads decode it (Image::load) and
+// build its mip chain, which then stays in system memory. Cooked textures (.setex, from the
+// texture cooker) skip both steps and stay block-compressed all the way to the GPU, uploaded
+// with glCompressedTexSubImage2D; a BC format the GL lacks is decompressed to RGBA8 instead.
+// From there the GPU copy holds a suffix of the chain, levels [residentLevel, levelCount): once
+// decoded, every texture gets its coarse levels (up to minResidentSize texels), and finer ones
+// follow when the texture is drawn large enough to need them. Callers (the Renderer, for
+// textured materials) report each frame how many pixels a texture covers with request(); the
+// wanted level is the one whose size is closest to that, i.e. about one texel per pixel.
+//
+// Residency changes are transitions: a new GL texture is allocated for the new level range and
+// filled over one or more frames, coarse levels first, then swapped in; until then draws keep
+// using the old one (or a 1x1 placeholder). Pixel data goes through a small ring of pixel buffer
+// objects (PBO_COUNT x PBO_SIZE): it is copied into a mapped PBO and uploaded from there, so
+// glTexSubImage2D returns without waiting, and a fence tells when a PBO can be refilled. At most
+// uploadBytesPerFrame are staged per update(), which bounds the frame-time cost of streaming.
+//
+// The budget covers the level ranges textures are heading for. When a promotion would exceed it,
+// the least recently requested textures not in use this frame are demoted to their coarse levels
+// (their high mips are evicted) until it fits; if that is not enough the promotion waits.
+//
+// All methods except the decode threads' internals run on the thread that owns the GL context.
+
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include "MyFirstEngine/Image.h"
+#include "glad/glad.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Handle to a texture owned by a TextureStreamer (index into its table).
+using TextureHandle = unsigned int;
+
+struct TextureStreamerSettings {
+    size_t vramBudgetBytes = 256u << 20;   // Total size of the resident level ranges
+    size_t uploadBytesPerFrame = 8u << 20; // Pixel data staged per update()
+    uint32_t minResidentSize = 64;         // Levels this small (largest side) are always resident
+};
+
+struct TextureStreamerStats {
+    size_t textures = 0;        // Handles created with load()
+    size_t decoding = 0;        // Still queued or being decoded
+    size_t failed = 0;          // Could not be decoded
+    size_t transitions = 0;     // Residency changes in progress
+    size_t residentBytes = 0;   // Allocated by GL textures, including transitions in progress
+    size_t committedBytes = 0;  // Where residency is heading; kept within the budget
+    size_t uploadedBytes = 0;   // Staged in the last update()
+    size_t evictions = 0;       // Textures demoted to free budget, since init()
+};
+
+class TextureStreamer {
+public:
+    static constexpr uint32_t DECODE_THREADS = 2;
+    static constexpr uint32_t PBO_COUNT = 4;
+    static constexpr size_t PBO_SIZE = 4u << 20;
+
+    TextureStreamer();
+    // Stops the decode threads and deletes every GL object; needs the GL context.
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Creates the PBO ring and the placeholder texture, and starts the decode threads.
+    bool init();
+    void setSettings(const TextureStreamerSettings& newSettings) { settings = newSettings; }
+    const TextureStreamerSettings& getSettings() const { return settings; }
+
+    // Queues 'path' for decoding and returns its handle at once (the same handle for the same
+    // path). The texture samples as the placeholder until its first levels are uploaded.
+    TextureHandle load(const std::string& path);
+    // Reports that 'texture' covers about 'screenPixels' pixels (largest side) this frame.
+    void request(TextureHandle texture, float screenPixels);
+    // Once per frame: takes finished decodes, plans residency changes within the budget and
+    // stages up to uploadBytesPerFrame of pixel data. Never waits for the decode threads or the GPU.
+    void update();
+
+    // GL texture to bind for 'texture': its resident levels or the placeholder.
+    GLuint getGLTexture(TextureHandle texture) const;
+    // First resident level (getLevelCount() while nothing is resident) and total levels
+    // (0 until decoded).
+    uint32_t getResidentLevel(TextureHandle texture) const;
+    uint32_t getLevelCount(TextureHandle texture) const;
+    const std::string& getPath(TextureHandle texture) const { return textures[texture]->path; }
+    bool isValid(TextureHandle texture) const { return texture < textures.size(); }
+    const TextureStreamerStats& getStats() const { return stats; }
+
+private:
+    enum class State {
+        Decoding,
+        Ready, // 'image' holds the decoded mip chain
+        Failed
+    };
+    struct Texture {
+        std::string path;
+        State state = State::Decoding;
+        Image image;
+        uint32_t minResidentLevel = 0;  // Coarse levels that are always resident start here
+        GLuint glTexture = 0;           // Levels [residentLevel, levelCount), or 0
+        uint32_t residentLevel = 0;
+        // Transition in progress (pendingTexture != 0): levels [pendingLevel, levelCount) are
+        // uploaded from the last level down; uploadLevel/uploadRow is the next row to stage.
+        GLuint pendingTexture = 0;
+        uint32_t pendingLevel = 0;
+        uint32_t uploadLevel = 0;
+        uint32_t uploadRow = 0;
+        float requestedPixels = 0.0f;   // Largest request this frame
+        uint64_t lastRequestFrame = 0;
+    };
+    struct DecodeJob {
+        TextureHandle texture;
+        std::string path;
+    };
+    struct DecodeResult {
+        TextureHandle texture;
+        bool ok;
+        Image image;
+    };
+    struct StagingBuffer {
+        GLuint buffer = 0;
+        GLsync fence = 0; // Set after the uploads reading it; the PBO is free once signaled
+    };
+    // One glTexSubImage2D (or glCompressedTexSubImage2D) from the PBO being filled.
+    struct StagedUpload {
+        GLuint texture;
+        GLint level;            // GL level (image level - pendingLevel)
+        ImageFormat format;
+        uint32_t row, rows;     // Block rows for compressed formats
+        uint32_t width, height; // Of the level, in texels
+        size_t offset, bytes;   // In the PBO
+    };
+
+    void decodeLoop();
+    // Level for a request of 'pixels' (clamped to [0, minResidentLevel]).
+    uint32_t wantedLevel(const Texture& texture) const;
+    // The level range the texture is heading for: pendingLevel during a transition.
+    uint32_t targetLevel(const Texture& texture) const;
+    // Allocates the GL texture for levels [firstLevel, levelCount) and queues its upload.
+    void startTransition(TextureHandle handle, uint32_t firstLevel);
+    // Demotes least recently requested textures until 'bytes' more fit the budget.
+    bool makeRoom(size_t bytes);
+    // Fills PBOs with pending rows until the per-frame budget or the free PBOs run out.
+    void stageUploads();
+    // Index of a PBO whose fence has signaled (or that was never used), or -1.
+    int acquireStagingBuffer();
+
+    TextureStreamerSettings settings;
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::unordered_map<std::string, TextureHandle> handlesByPath;
+    std::vector<TextureHandle> transitions; // Textures with a pending transition, in start order
+    StagingBuffer stagingBuffers[PBO_COUNT];
+    uint32_t nextStagingBuffer;
+    GLuint placeholderTexture;
+    uint64_t frame;
+    TextureStreamerStats stats;
+
+    // Decode threads: jobs in, results out, both under 'mutex'.
+    std::vector<std::thread> decodeThreads;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<DecodeJob> jobs;
+    std::vector<DecodeResult> results;
+    bool stopping;
+};
+
+#endif // TEXTURESTREAMER_H
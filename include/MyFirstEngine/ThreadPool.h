@@ -0,0 +1,64 @@
+// ThreadPool.h
+// Persistent worker threads for data-parallel loops (render command recording, culling, ...).
+//
+// parallelFor() splits [0, count) into batches that the workers and the calling thread pull
+// from a shared atomic counter until the range is exhausted; it returns once every batch is
+// done. Each participant has a stable index in [0, getThreadCount()) — the caller is always 0 —
+// so jobs can write into per-thread storage (e.g. RenderQueue buckets) without locking.
+// Workers sleep on a condition variable between jobs, so an idle pool costs nothing.
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // Called with a batch [begin, end) and the index of the thread running it.
+    using RangeFunction = std::function<void(size_t begin, size_t end, size_t threadIndex)>;
+
+    // Starts 'workerCount' background threads. 0 is valid: parallelFor then runs inline.
+    explicit ThreadPool(size_t workerCount = defaultWorkerCount());
+    // Stops and joins all workers.
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // One worker per hardware thread, minus the calling thread.
+    static size_t defaultWorkerCount();
+
+    // Workers plus the calling thread.
+    size_t getThreadCount() const { return workers.size() + 1; }
+
+    // Runs fn over [0, count) in batches of at least 'minBatchSize' items and waits for completion.
+    // Small ranges (a single batch) run inline on the calling thread.
+    // Not re-entrant: fn must not call parallelFor on the same pool.
+    void parallelFor(size_t count, size_t minBatchSize, const RangeFunction& fn);
+
+private:
+    void workerLoop(size_t threadIndex);
+    // Pulls batches of the current job until none are left.
+    void runBatches(size_t threadIndex);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeWorkers;
+    std::condition_variable jobFinished;
+    bool stopping;
+    unsigned long long jobGeneration; // Incremented for every job; workers wake when it changes
+
+    // Current job
+    const RangeFunction* jobFunction;
+    size_t jobCount;
+    size_t jobBatchSize;
+    std::atomic<size_t> nextIndex;
+    size_t activeWorkers; // Workers still inside the current job (guarded by mutex)
+};
+
+#endif // THREADPOOL_H
@@ -1,6 +1,7 @@
 // Transform.h
-// A basic transform component holding position, rotation, and scale.
-// Uses Vec3 from SimpleMath.h.
+// A compact TRS transform component: position, unit-quaternion rotation, and scale.
+// The values are local: relative to the parent node in the SceneGraph (or to the world for roots).
+// Uses Vec3 and Quat from SimpleMath.h.
 
 #ifndef TRANSFORM_H
 #define TRANSFORM_H
@@ -11,13 +12,29 @@
 
 struct Transform {
     Vec3 position;
-    Vec3 rotation; // Euler angles (in radians or degrees, be consistent for your usage)
+    Quat rotation; // Use Quat::fromEuler / toEulerDegrees to edit as Euler angles (degrees)
     Vec3 scale;
 
     // Constructor initializes to default values (e.g., no translation, no rotation, unit scale)
     Transform() : position(0.0f, 0.0f, 0.0f),
-                  rotation(0.0f, 0.0f, 0.0f),
+                  rotation(Quat::identity()),
                   scale(1.0f, 1.0f, 1.0f) {}
+
+    // Local model matrix: translate * rotate * scale, composed in closed form.
+    Mat4 getLocalMatrix() const {
+        return Mat4::fromTRS(position, rotation, scale);
+    }
+
+    // Inverse-transpose of the local model matrix (for normals), composed in closed form.
+    Mat4 getLocalNormalMatrix() const {
+        return Mat4::normalMatrixFromTRS(rotation, scale);
+    }
 };
 
+inline AABB::AABB(const Transform& transform) {
+    Vec3 halfExtents = transform.scale * 0.5f;
+    min = transform.position - halfExtents;
+    max = transform.position + halfExtents;
+}
+
 #endif // TRANSFORM_H
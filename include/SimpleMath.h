@@ -6,6 +6,38 @@
 #include <cstring> 
 #include <algorithm> // For std::swap
 #include <stdexcept> // For error handling if needed
+#include <cstddef>   // For size_t
+
+// --- SIMD backend selection ---
+// The vectorized paths are picked at compile time. Define SIMPLEMATH_NO_SIMD to force the scalar
+// reference implementation (useful for debugging or for validating the SIMD kernels against it).
+//   SIMPLEMATH_AVX  : 256-bit kernels (compile with -mavx or /arch:AVX); implies SSE
+//   SIMPLEMATH_SSE  : 128-bit kernels, always available on x86-64
+//   SIMPLEMATH_NEON : 128-bit kernels on ARM; inverse falls back to scalar
+#if !defined(SIMPLEMATH_NO_SIMD)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SIMPLEMATH_SSE 1
+        #if defined(__AVX__)
+            #define SIMPLEMATH_AVX 1
+            #include <immintrin.h>
+        #else
+            #include <emmintrin.h>
+        #endif
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define SIMPLEMATH_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
+#if defined(SIMPLEMATH_AVX)
+    #define SIMPLEMATH_SIMD_NAME "AVX"
+#elif defined(SIMPLEMATH_SSE)
+    #define SIMPLEMATH_SIMD_NAME "SSE"
+#elif defined(SIMPLEMATH_NEON)
+    #define SIMPLEMATH_SIMD_NAME "NEON"
+#else
+    #define SIMPLEMATH_SIMD_NAME "Scalar"
+#endif
 
 // Define M_PI if not already defined
 #ifndef M_PI
@@ -17,8 +49,8 @@ static float sm_toRadians(float degrees) {
     return degrees * (static_cast<float>(M_PI) / 180.0f);
 }
 
-// Forward declare GameObject for AABB constructor
-struct GameObject; 
+// Forward declare Transform for AABB constructor
+struct Transform;
 
 // --- Vec2 ---
 struct Vec2 {
@@ -53,8 +85,99 @@ struct Vec4 {
     Vec4(const Vec3& v, float w_val) : x(v.x), y(v.y), z(v.z), w(w_val) {}
 };
 
+// --- Quat ---
+// Unit quaternion rotation (x, y, z = vector part, w = scalar part).
+struct Quat {
+    float x, y, z, w;
+    Quat(float x = 0.0f, float y = 0.0f, float z = 0.0f, float w = 1.0f) : x(x), y(y), z(z), w(w) {}
+
+    static Quat identity() { return Quat(0.0f, 0.0f, 0.0f, 1.0f); }
+
+    static Quat fromAxisAngle(const Vec3& axis, float angleRadians) {
+        Vec3 n = axis.normalize();
+        float s = std::sin(angleRadians * 0.5f);
+        return Quat(n.x * s, n.y * s, n.z * s, std::cos(angleRadians * 0.5f));
+    }
+
+    // Same convention as Mat4::rotateEuler: Yaw (Y), then Pitch (X), then Roll (Z), angles in degrees.
+    static Quat fromEuler(const Vec3& eulerAnglesDegrees) {
+        float hx = sm_toRadians(eulerAnglesDegrees.x) * 0.5f;
+        float hy = sm_toRadians(eulerAnglesDegrees.y) * 0.5f;
+        float hz = sm_toRadians(eulerAnglesDegrees.z) * 0.5f;
+        float cx = std::cos(hx), sx = std::sin(hx);
+        float cy = std::cos(hy), sy = std::sin(hy);
+        float cz = std::cos(hz), sz = std::sin(hz);
+        // qY * qX * qZ expanded
+        return Quat(cy * sx * cz + sy * cx * sz,
+                    sy * cx * cz - cy * sx * sz,
+                    cy * cx * sz - sy * sx * cz,
+                    cy * cx * cz + sy * sx * sz);
+    }
+
+    // Inverse of fromEuler. Returns (pitch, yaw, roll) in degrees.
+    Vec3 toEulerDegrees() const {
+        const float toDeg = 180.0f / static_cast<float>(M_PI);
+        float m12 = 2.0f * (y * z - w * x);
+        float sinPitch = std::max(-1.0f, std::min(1.0f, -m12));
+        float pitch = std::asin(sinPitch);
+        float yaw, roll;
+        if (std::abs(sinPitch) < 0.9999f) {
+            yaw  = std::atan2(2.0f * (x * z + w * y), 1.0f - 2.0f * (x * x + y * y)); // atan2(m02, m22)
+            roll = std::atan2(2.0f * (x * y + w * z), 1.0f - 2.0f * (x * x + z * z)); // atan2(m10, m11)
+        } else { // Gimbal lock: fold roll into yaw
+            yaw  = std::atan2(-2.0f * (x * z - w * y), 1.0f - 2.0f * (y * y + z * z)); // atan2(-m20, m00)
+            roll = 0.0f;
+        }
+        return Vec3(pitch * toDeg, yaw * toDeg, roll * toDeg);
+    }
+
+    Quat operator*(const Quat& q) const {
+        return Quat(w * q.x + x * q.w + y * q.z - z * q.y,
+                    w * q.y - x * q.z + y * q.w + z * q.x,
+                    w * q.z + x * q.y - y * q.x + z * q.w,
+                    w * q.w - x * q.x - y * q.y - z * q.z);
+    }
+
+    static float dot(const Quat& a, const Quat& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+    Quat conjugate() const { return Quat(-x, -y, -z, w); }
+    Quat normalize() const {
+        float l = std::sqrt(x * x + y * y + z * z + w * w);
+        if (l > 1e-6f) { float inv = 1.0f / l; return Quat(x * inv, y * inv, z * inv, w * inv); }
+        return identity();
+    }
+
+    // Rotates a vector: v' = v + 2w(q x v) + 2 q x (q x v)
+    Vec3 rotate(const Vec3& v) const {
+        Vec3 q(x, y, z);
+        Vec3 t = Vec3::cross(q, v) * 2.0f;
+        return v + t * w + Vec3::cross(q, t);
+    }
+
+    // Normalized linear interpolation along the shortest arc. Cheap and fine for small steps.
+    static Quat nlerp(const Quat& a, const Quat& b, float t) {
+        float sign = dot(a, b) < 0.0f ? -1.0f : 1.0f;
+        return Quat(a.x + (b.x * sign - a.x) * t, a.y + (b.y * sign - a.y) * t,
+                    a.z + (b.z * sign - a.z) * t, a.w + (b.w * sign - a.w) * t).normalize();
+    }
+
+    // Spherical linear interpolation along the shortest arc (constant angular velocity).
+    static Quat slerp(const Quat& a, const Quat& b, float t) {
+        float cosTheta = dot(a, b);
+        float sign = 1.0f;
+        if (cosTheta < 0.0f) { cosTheta = -cosTheta; sign = -1.0f; }
+        if (cosTheta > 0.9995f) return nlerp(a, b, t); // Nearly parallel: avoid dividing by sin(~0)
+        float theta = std::acos(cosTheta);
+        float invSin = 1.0f / std::sin(theta);
+        float wa = std::sin((1.0f - t) * theta) * invSin;
+        float wb = std::sin(t * theta) * invSin * sign;
+        return Quat(a.x * wa + b.x * wb, a.y * wa + b.y * wb, a.z * wa + b.z * wb, a.w * wa + b.w * wb);
+    }
+};
+
 // --- Mat4 ---
-struct Mat4 {
+// Column-major 4x4 matrix. 16-byte aligned so each column loads as one SIMD register
+// (the AVX paths load column pairs with unaligned 256-bit loads, which is free on aligned data).
+struct alignas(16) Mat4 {
     float elements[16];
 
     Mat4(float diagonal = 1.0f) {
@@ -66,6 +189,55 @@ struct Mat4 {
 
     Mat4 operator*(const Mat4& other) const {
         Mat4 product(0.0f);
+#if defined(SIMPLEMATH_AVX)
+        // Two result columns per iteration: each 128-bit lane holds one column of 'other'.
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(elements + 0));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(elements + 4));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(elements + 8));
+        const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(elements + 12));
+        for (int c = 0; c < 4; c += 2) {
+            __m256 b = _mm256_loadu_ps(other.elements + c * 4);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(b, b, 0x00));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(b, b, 0x55)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(b, b, 0xAA)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(b, b, 0xFF)));
+            _mm256_storeu_ps(product.elements + c * 4, r);
+        }
+#elif defined(SIMPLEMATH_SSE)
+        const __m128 a0 = _mm_load_ps(elements + 0);
+        const __m128 a1 = _mm_load_ps(elements + 4);
+        const __m128 a2 = _mm_load_ps(elements + 8);
+        const __m128 a3 = _mm_load_ps(elements + 12);
+        for (int c = 0; c < 4; ++c) {
+            const float* b = other.elements + c * 4;
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[3])));
+            _mm_store_ps(product.elements + c * 4, r);
+        }
+#elif defined(SIMPLEMATH_NEON)
+        const float32x4_t a0 = vld1q_f32(elements + 0);
+        const float32x4_t a1 = vld1q_f32(elements + 4);
+        const float32x4_t a2 = vld1q_f32(elements + 8);
+        const float32x4_t a3 = vld1q_f32(elements + 12);
+        for (int c = 0; c < 4; ++c) {
+            const float* b = other.elements + c * 4;
+            float32x4_t r = vmulq_n_f32(a0, b[0]);
+            r = vmlaq_n_f32(r, a1, b[1]);
+            r = vmlaq_n_f32(r, a2, b[2]);
+            r = vmlaq_n_f32(r, a3, b[3]);
+            vst1q_f32(product.elements + c * 4, r);
+        }
+#else
+        product = multiplyScalar(other);
+#endif
+        return product;
+    }
+
+    // Scalar reference implementation of operator*(Mat4). Kept for validation and as the fallback.
+    Mat4 multiplyScalar(const Mat4& other) const {
+        Mat4 product(0.0f);
         for (int c = 0; c < 4; ++c) {
             for (int r = 0; r < 4; ++r) {
                 float sum = 0.0f;
@@ -80,10 +252,18 @@ struct Mat4 {
     
     Vec4 operator*(const Vec4& vec) const {
         Vec4 result;
+#if defined(SIMPLEMATH_SSE)
+        __m128 r = _mm_mul_ps(_mm_load_ps(elements + 0), _mm_set1_ps(vec.x));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(elements + 4), _mm_set1_ps(vec.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(elements + 8), _mm_set1_ps(vec.z)));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(elements + 12), _mm_set1_ps(vec.w)));
+        _mm_storeu_ps(&result.x, r);
+#else
         result.x = elements[0]*vec.x + elements[4]*vec.y + elements[8]*vec.z  + elements[12]*vec.w;
         result.y = elements[1]*vec.x + elements[5]*vec.y + elements[9]*vec.z  + elements[13]*vec.w;
         result.z = elements[2]*vec.x + elements[6]*vec.y + elements[10]*vec.z + elements[14]*vec.w;
         result.w = elements[3]*vec.x + elements[7]*vec.y + elements[11]*vec.z + elements[15]*vec.w;
+#endif
         return result;
     }
 
@@ -131,7 +311,149 @@ struct Mat4 {
         return rotY * rotX * rotZ; // Apply Yaw, then Pitch, then Roll
     }
 
+    // Model matrix translate(t) * rotate(r) * scale(s), built directly from the quaternion
+    // (no intermediate matrices, no matrix products, no trig).
+    static Mat4 fromTRS(const Vec3& t, const Quat& r, const Vec3& s) {
+        float xx = r.x * r.x, yy = r.y * r.y, zz = r.z * r.z;
+        float xy = r.x * r.y, xz = r.x * r.z, yz = r.y * r.z;
+        float wx = r.w * r.x, wy = r.w * r.y, wz = r.w * r.z;
+        Mat4 result;
+        result.elements[0]  = (1.0f - 2.0f * (yy + zz)) * s.x;
+        result.elements[1]  = (2.0f * (xy + wz)) * s.x;
+        result.elements[2]  = (2.0f * (xz - wy)) * s.x;
+        result.elements[3]  = 0.0f;
+        result.elements[4]  = (2.0f * (xy - wz)) * s.y;
+        result.elements[5]  = (1.0f - 2.0f * (xx + zz)) * s.y;
+        result.elements[6]  = (2.0f * (yz + wx)) * s.y;
+        result.elements[7]  = 0.0f;
+        result.elements[8]  = (2.0f * (xz + wy)) * s.z;
+        result.elements[9]  = (2.0f * (yz - wx)) * s.z;
+        result.elements[10] = (1.0f - 2.0f * (xx + yy)) * s.z;
+        result.elements[11] = 0.0f;
+        result.elements[12] = t.x;
+        result.elements[13] = t.y;
+        result.elements[14] = t.z;
+        result.elements[15] = 1.0f;
+        return result;
+    }
+
+    // Inverse-transpose of the upper 3x3 of fromTRS(t, r, s), for transforming normals.
+    // (R * S)^-T = R * S^-1, so it is the same rotation with the scale inverted. Translation is zero.
+    static Mat4 normalMatrixFromTRS(const Quat& r, const Vec3& s) {
+        Vec3 invScale(std::abs(s.x) > 1e-12f ? 1.0f / s.x : 0.0f,
+                      std::abs(s.y) > 1e-12f ? 1.0f / s.y : 0.0f,
+                      std::abs(s.z) > 1e-12f ? 1.0f / s.z : 0.0f);
+        return fromTRS(Vec3(0.0f, 0.0f, 0.0f), r, invScale);
+    }
+
+    // Inverse of fromTRS(t, r, s) in closed form: S^-1 * R^T * translate(-t).
+    static Mat4 inverseFromTRS(const Vec3& t, const Quat& r, const Vec3& s) {
+        Mat4 rotT = fromTRS(Vec3(0.0f, 0.0f, 0.0f), r.conjugate(), Vec3(1.0f, 1.0f, 1.0f));
+        Vec3 invScale(1.0f / s.x, 1.0f / s.y, 1.0f / s.z);
+        Mat4 result;
+        for (int c = 0; c < 3; ++c) { // Scale rows of R^T by 1/s
+            result.elements[c * 4 + 0] = rotT.elements[c * 4 + 0] * invScale.x;
+            result.elements[c * 4 + 1] = rotT.elements[c * 4 + 1] * invScale.y;
+            result.elements[c * 4 + 2] = rotT.elements[c * 4 + 2] * invScale.z;
+        }
+        result.elements[12] = -(result.elements[0] * t.x + result.elements[4] * t.y + result.elements[8]  * t.z);
+        result.elements[13] = -(result.elements[1] * t.x + result.elements[5] * t.y + result.elements[9]  * t.z);
+        result.elements[14] = -(result.elements[2] * t.x + result.elements[6] * t.y + result.elements[10] * t.z);
+        return result;
+    }
+
+    // General 4x4 inverse. Returns identity for singular matrices (same contract as inverseScalar).
     Mat4 inverse() const {
+#if defined(SIMPLEMATH_SSE)
+        // Cramer's rule with 2x2 sub-determinants, after Intel's "Streaming SIMD Extensions -
+        // Inverse of 4x4 Matrix". The routine is layout-agnostic: fed a column-major matrix it
+        // inverts the transpose and writes the transposed result, which is again column-major.
+        const float* src = elements;
+        __m128 minor0, minor1, minor2, minor3;
+        __m128 row0, row1, row2, row3, det, tmp1;
+        tmp1 = _mm_setzero_ps(); row1 = _mm_setzero_ps(); row3 = _mm_setzero_ps();
+
+        tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, reinterpret_cast<const __m64*>(src)), reinterpret_cast<const __m64*>(src + 4));
+        row1 = _mm_loadh_pi(_mm_loadl_pi(row1, reinterpret_cast<const __m64*>(src + 8)), reinterpret_cast<const __m64*>(src + 12));
+        row0 = _mm_shuffle_ps(tmp1, row1, 0x88);
+        row1 = _mm_shuffle_ps(row1, tmp1, 0xDD);
+        tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, reinterpret_cast<const __m64*>(src + 2)), reinterpret_cast<const __m64*>(src + 6));
+        row3 = _mm_loadh_pi(_mm_loadl_pi(row3, reinterpret_cast<const __m64*>(src + 10)), reinterpret_cast<const __m64*>(src + 14));
+        row2 = _mm_shuffle_ps(tmp1, row3, 0x88);
+        row3 = _mm_shuffle_ps(row3, tmp1, 0xDD);
+
+        tmp1 = _mm_mul_ps(row2, row3);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        minor0 = _mm_mul_ps(row1, tmp1);
+        minor1 = _mm_mul_ps(row0, tmp1);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp1), minor0);
+        minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor1);
+        minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+        tmp1 = _mm_mul_ps(row1, row2);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor0);
+        minor3 = _mm_mul_ps(row0, tmp1);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp1));
+        minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor3);
+        minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+        tmp1 = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+        minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor0);
+        minor2 = _mm_mul_ps(row0, tmp1);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp1));
+        minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor2);
+        minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+        tmp1 = _mm_mul_ps(row0, row1);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor2);
+        minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp1), minor3);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp1), minor2);
+        minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp1));
+
+        tmp1 = _mm_mul_ps(row0, row3);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp1));
+        minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor2);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor1);
+        minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp1));
+
+        tmp1 = _mm_mul_ps(row0, row2);
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+        minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor1);
+        minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp1));
+        tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+        minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp1));
+        minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor3);
+
+        det = _mm_mul_ps(row0, minor0);
+        det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+        det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+        float detScalar = _mm_cvtss_f32(det);
+        if (std::abs(detScalar) < 1e-6f) return identity(); // Matrix is singular or near-singular
+        det = _mm_set1_ps(1.0f / detScalar);
+
+        Mat4 inv;
+        _mm_store_ps(inv.elements + 0,  _mm_mul_ps(det, minor0));
+        _mm_store_ps(inv.elements + 4,  _mm_mul_ps(det, minor1));
+        _mm_store_ps(inv.elements + 8,  _mm_mul_ps(det, minor2));
+        _mm_store_ps(inv.elements + 12, _mm_mul_ps(det, minor3));
+        return inv;
+#else
+        return inverseScalar();
+#endif
+    }
+
+    // Scalar reference implementation of inverse() (cofactor expansion).
+    Mat4 inverseScalar() const {
         Mat4 inv; float det;
         inv.elements[0] = elements[5]*elements[10]*elements[15] - elements[5]*elements[11]*elements[14] - elements[9]*elements[6]*elements[15] + elements[9]*elements[7]*elements[14] + elements[13]*elements[6]*elements[11] - elements[13]*elements[7]*elements[10];
         inv.elements[4] = -elements[4]*elements[10]*elements[15] + elements[4]*elements[11]*elements[14] + elements[8]*elements[6]*elements[15] - elements[8]*elements[7]*elements[14] - elements[12]*elements[6]*elements[11] + elements[12]*elements[7]*elements[10];
@@ -180,6 +502,18 @@ struct Mat4 {
         return result;
     }
 
+    // Maps the view-space box [left,right] x [bottom,top] x [-nearZ,-farZ] to the clip cube.
+    static Mat4 orthographic(float left, float right, float bottom, float top, float nearZ, float farZ) {
+        Mat4 result = identity();
+        result.elements[0] = 2.0f / (right - left);
+        result.elements[5] = 2.0f / (top - bottom);
+        result.elements[10] = -2.0f / (farZ - nearZ);
+        result.elements[12] = -(right + left) / (right - left);
+        result.elements[13] = -(top + bottom) / (top - bottom);
+        result.elements[14] = -(farZ + nearZ) / (farZ - nearZ);
+        return result;
+    }
+
     static Mat4 lookAt(const Vec3& eye, const Vec3& center, const Vec3& worldUp) {
         Vec3 f = (center - eye).normalize();
         Vec3 s = Vec3::cross(f, worldUp).normalize();
@@ -201,6 +535,129 @@ struct Mat4 {
 };
 
 
+// --- Batch kernels ---
+// Array versions of the hot Mat4 operations. Culling, skinning and transform updates should go
+// through these rather than looping over operator* so they pick up the SIMD backend.
+// Each has a *Scalar twin that is the reference implementation.
+
+// out[i] = m * (in[i], 1), keeping xyz. 'm' is treated as affine (no perspective divide).
+// 'in' and 'out' may alias exactly (in-place) but must not partially overlap.
+inline void transformPointsScalar(const Mat4& m, const Vec3* in, Vec3* out, size_t n) {
+    const float* e = m.elements;
+    for (size_t i = 0; i < n; ++i) {
+        Vec3 p = in[i];
+        out[i] = Vec3(e[0] * p.x + e[4] * p.y + e[8]  * p.z + e[12],
+                      e[1] * p.x + e[5] * p.y + e[9]  * p.z + e[13],
+                      e[2] * p.x + e[6] * p.y + e[10] * p.z + e[14]);
+    }
+}
+
+inline void transformPoints(const Mat4& m, const Vec3* in, Vec3* out, size_t n) {
+#if defined(SIMPLEMATH_SSE)
+    const __m128 c0 = _mm_load_ps(m.elements + 0);
+    const __m128 c1 = _mm_load_ps(m.elements + 4);
+    const __m128 c2 = _mm_load_ps(m.elements + 8);
+    const __m128 c3 = _mm_load_ps(m.elements + 12);
+    for (size_t i = 0; i < n; ++i) {
+        const Vec3 p = in[i];
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.x)), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p.z)));
+        // Store xyz only: low pair, then z. A full 16-byte store would clobber out[i+1].x.
+        _mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), r);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(r, r));
+    }
+#elif defined(SIMPLEMATH_NEON)
+    const float32x4_t c0 = vld1q_f32(m.elements + 0);
+    const float32x4_t c1 = vld1q_f32(m.elements + 4);
+    const float32x4_t c2 = vld1q_f32(m.elements + 8);
+    const float32x4_t c3 = vld1q_f32(m.elements + 12);
+    for (size_t i = 0; i < n; ++i) {
+        const Vec3 p = in[i];
+        float32x4_t r = vmlaq_n_f32(c3, c0, p.x);
+        r = vmlaq_n_f32(r, c1, p.y);
+        r = vmlaq_n_f32(r, c2, p.z);
+        vst1_f32(&out[i].x, vget_low_f32(r));
+        out[i].z = vgetq_lane_f32(r, 2);
+    }
+#else
+    transformPointsScalar(m, in, out, n);
+#endif
+}
+
+// out[i] = m * (in[i], 1) as homogeneous Vec4 (no divide). Use for clip-space projection.
+inline void transformPointsHomogeneousScalar(const Mat4& m, const Vec3* in, Vec4* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = m * Vec4(in[i], 1.0f);
+}
+
+inline void transformPointsHomogeneous(const Mat4& m, const Vec3* in, Vec4* out, size_t n) {
+#if defined(SIMPLEMATH_SSE)
+    const __m128 c0 = _mm_load_ps(m.elements + 0);
+    const __m128 c1 = _mm_load_ps(m.elements + 4);
+    const __m128 c2 = _mm_load_ps(m.elements + 8);
+    const __m128 c3 = _mm_load_ps(m.elements + 12);
+    for (size_t i = 0; i < n; ++i) {
+        const Vec3 p = in[i];
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p.x)), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(p.z)));
+        _mm_storeu_ps(&out[i].x, r);
+    }
+#else
+    transformPointsHomogeneousScalar(m, in, out, n);
+#endif
+}
+
+// out[i] = a[i] * b[i]
+inline void multiplyMatricesScalar(const Mat4* a, const Mat4* b, Mat4* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i].multiplyScalar(b[i]);
+}
+
+inline void multiplyMatrices(const Mat4* a, const Mat4* b, Mat4* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a[i] * b[i];
+}
+
+// out[i] = a * b[i] (e.g. viewProjection * model for every object). 'a' is loaded once.
+inline void multiplyMatricesScalar(const Mat4& a, const Mat4* b, Mat4* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = a.multiplyScalar(b[i]);
+}
+
+inline void multiplyMatrices(const Mat4& a, const Mat4* b, Mat4* out, size_t n) {
+#if defined(SIMPLEMATH_AVX)
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.elements + 0));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.elements + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.elements + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a.elements + 12));
+    for (size_t i = 0; i < n; ++i) {
+        for (int c = 0; c < 4; c += 2) {
+            __m256 bc = _mm256_loadu_ps(b[i].elements + c * 4);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, 0x00));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF)));
+            _mm256_storeu_ps(out[i].elements + c * 4, r);
+        }
+    }
+#elif defined(SIMPLEMATH_SSE)
+    const __m128 a0 = _mm_load_ps(a.elements + 0);
+    const __m128 a1 = _mm_load_ps(a.elements + 4);
+    const __m128 a2 = _mm_load_ps(a.elements + 8);
+    const __m128 a3 = _mm_load_ps(a.elements + 12);
+    for (size_t i = 0; i < n; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            const float* bc = b[i].elements + c * 4;
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bc[0]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bc[1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bc[2])));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bc[3])));
+            _mm_store_ps(out[i].elements + c * 4, r);
+        }
+    }
+#else
+    for (size_t i = 0; i < n; ++i) out[i] = a * b[i];
+#endif
+}
+
 // Ray Structure
 struct Ray {
     Vec3 origin;
@@ -218,9 +675,84 @@ struct AABB {
         min = cen - halfExtents;
         max = cen + halfExtents;
     }
-    // Constructor from GameObject (simplified - assumes scale is full extents and object is axis aligned in world AFTER translation)
+    // Constructor from Transform (simplified - assumes scale is full extents and object is axis aligned in world AFTER translation)
     // For more accuracy with rotated objects, this needs to transform local AABB by model matrix.
-    AABB(const GameObject& go); // Declaration only, definition needs GameObject.h
+    AABB(const Transform& transform); // Declaration only, definition lives in Transform.h
+
+    Vec3 center() const { return (min + max) * 0.5f; }
+    Vec3 extents() const { return (max - min) * 0.5f; }
+
+    // Returns the world-space AABB enclosing this box after transformation by 'mat' (Arvo's method).
+    AABB transformed(const Mat4& mat) const {
+        Vec3 c = Mat4::transformPoint(mat, center());
+        Vec3 e = extents();
+        const float* m = mat.elements;
+        Vec3 he(std::abs(m[0]) * e.x + std::abs(m[4]) * e.y + std::abs(m[8]) * e.z,
+                std::abs(m[1]) * e.x + std::abs(m[5]) * e.y + std::abs(m[9]) * e.z,
+                std::abs(m[2]) * e.x + std::abs(m[6]) * e.y + std::abs(m[10]) * e.z);
+        return AABB(c, he);
+    }
+};
+
+// Bounding sphere. Looser than an AABB for boxy shapes, but rotation-invariant and the cheapest
+// volume to test against frustum planes.
+struct BoundingSphere {
+    Vec3 center;
+    float radius;
+
+    BoundingSphere(const Vec3& center = Vec3(0, 0, 0), float radius = 0.0f) : center(center), radius(radius) {}
+    // Smallest sphere around the box (center plus half diagonal).
+    static BoundingSphere fromAABB(const AABB& box) { return BoundingSphere(box.center(), box.extents().length()); }
+
+    // World-space sphere after transformation by 'mat'. The radius is scaled by the largest
+    // axis scale, so the result stays conservative under non-uniform scale.
+    BoundingSphere transformed(const Mat4& mat) const {
+        const float* m = mat.elements;
+        float sx = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+        float sy = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+        float sz = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+        return BoundingSphere(Mat4::transformPoint(mat, center), radius * std::sqrt(std::max(sx, std::max(sy, sz))));
+    }
+};
+
+// Six planes of a view volume, normals pointing inwards: a point p is inside a plane when
+// dot(normal, p) + d >= 0.
+struct Frustum {
+    enum PlaneIndex { Left = 0, Right, Bottom, Top, Near, Far, PlaneCount };
+    Vec4 planes[PlaneCount]; // xyz = unit normal, w = d
+
+    // Extracts the planes from a combined projection * view matrix (Gribb/Hartmann), so the
+    // planes are in world space. With a projection matrix alone they are in view space.
+    static Frustum fromMatrix(const Mat4& viewProjection) {
+        const float* m = viewProjection.elements; // Column-major: row i is (m[i], m[4+i], m[8+i], m[12+i])
+        Frustum f;
+        for (int i = 0; i < 3; ++i) {
+            // OpenGL clip space: -w <= x,y,z <= w, i.e. row3 + rowi >= 0 and row3 - rowi >= 0.
+            f.planes[i * 2 + 0] = Vec4(m[3] + m[i], m[7] + m[4 + i], m[11] + m[8 + i], m[15] + m[12 + i]);
+            f.planes[i * 2 + 1] = Vec4(m[3] - m[i], m[7] - m[4 + i], m[11] - m[8 + i], m[15] - m[12 + i]);
+        }
+        for (Vec4& p : f.planes) {
+            float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+            if (length > 1e-12f) { p.x /= length; p.y /= length; p.z /= length; p.w /= length; }
+        }
+        return f;
+    }
+
+    bool intersectsSphere(const BoundingSphere& sphere) const {
+        for (const Vec4& p : planes) {
+            if (p.x * sphere.center.x + p.y * sphere.center.y + p.z * sphere.center.z + p.w < -sphere.radius) return false;
+        }
+        return true;
+    }
+    // Conservative: may report boxes near frustum corners as visible.
+    bool intersectsAABB(const AABB& box) const {
+        Vec3 c = box.center(), e = box.extents();
+        for (const Vec4& p : planes) {
+            float r = std::abs(p.x) * e.x + std::abs(p.y) * e.y + std::abs(p.z) * e.z;
+            if (p.x * c.x + p.y * c.y + p.z * c.z + p.w < -r) return false;
+        }
+        return true;
+    }
 };
 
 // Ray-AABB intersection
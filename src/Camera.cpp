@@ -130,6 +130,14 @@ Mat4 Camera::getProjectionMatrix(float aspectRatio) {
     return Mat4::perspective(fovRad, aspectRatio, nearPlane, farPlane);
 }
 
+Mat4 Camera::getViewProjectionMatrix(float aspectRatio) {
+    return getProjectionMatrix(aspectRatio) * getViewMatrix();
+}
+
+Frustum Camera::getFrustum(float aspectRatio) {
+    return Frustum::fromMatrix(getViewProjectionMatrix(aspectRatio));
+}
+
 void Camera::processKeyboardFPS(const char* direction, float deltaTime) {
     float velocity = movementSpeed * deltaTime;
     Vec3 moveDirection(0.0f, 0.0f, 0.0f);
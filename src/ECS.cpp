@@ -0,0 +1,233 @@
+// ECS.cpp
+// Implementation of the non-template parts of the archetype ECS:
+// component registration, archetype creation, chunk allocation and entity moves.
+
+#include "MyFirstEngine/ECS.h"
+#include <algorithm> // For std::max
+#include <cstdlib>   // For std::abort
+#include <iostream>  // For std::cerr
+
+// --- Component registry ---
+
+// A plain array rather than a std::vector: global Worlds (like the editor's scene) are destroyed
+// during static destruction and still need the component infos, so the registry must never be torn down.
+static ComponentInfo g_componentInfos[MAX_COMPONENT_TYPES];
+static uint32_t g_componentCount = 0;
+
+ComponentTypeID registerComponentType(const ComponentInfo& info) {
+    if (g_componentCount >= MAX_COMPONENT_TYPES) {
+        std::cerr << "ERROR::ECS::REGISTER: Too many component types (max " << MAX_COMPONENT_TYPES << ")." << std::endl;
+        std::abort();
+    }
+    g_componentInfos[g_componentCount] = info;
+    return g_componentCount++;
+}
+
+const ComponentInfo& getComponentInfo(ComponentTypeID id) {
+    return g_componentInfos[id];
+}
+
+// --- Chunk memory ---
+
+static const size_t CHUNK_ALIGNMENT = 64; // Cache-line aligned so columns never straddle a line at the start
+
+static uint8_t* allocateChunkMemory(size_t bytes) {
+    return static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(CHUNK_ALIGNMENT)));
+}
+
+static void freeChunkMemory(uint8_t* data) {
+    ::operator delete(data, std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Computes the column layout of an archetype for a given per-chunk capacity.
+// Returns the number of bytes a chunk needs for that capacity.
+static size_t layoutColumns(Archetype* arch, uint32_t capacity) {
+    size_t offset = sizeof(Entity) * capacity;
+    for (size_t i = 0; i < arch->types.size(); ++i) {
+        const ComponentInfo& info = getComponentInfo(arch->types[i]);
+        offset = alignUp(offset, info.alignment);
+        arch->columnOffsets[i] = offset;
+        offset += info.size * capacity;
+    }
+    return offset;
+}
+
+// --- World ---
+
+World::World() : aliveCount(0) {
+    getOrCreateArchetype(0); // The empty archetype that freshly created entities live in
+}
+
+World::~World() {
+    for (Archetype* arch : archetypes) {
+        for (Chunk& chunk : arch->chunks) {
+            for (size_t t = 0; t < arch->types.size(); ++t) {
+                const ComponentInfo& info = getComponentInfo(arch->types[t]);
+                uint8_t* column = chunk.data + arch->columnOffsets[t];
+                for (uint32_t row = 0; row < chunk.count; ++row) {
+                    info.destroy(column + row * info.size);
+                }
+            }
+            freeChunkMemory(chunk.data);
+        }
+        delete arch;
+    }
+}
+
+Archetype* World::getOrCreateArchetype(ComponentMask mask) {
+    for (Archetype* arch : archetypes) {
+        if (arch->mask == mask) return arch;
+    }
+
+    Archetype* arch = new Archetype();
+    arch->mask = mask;
+    for (ComponentTypeID t = 0; t < MAX_COMPONENT_TYPES; ++t) {
+        arch->columnOf[t] = -1;
+        arch->addEdge[t] = nullptr;
+        arch->removeEdge[t] = nullptr;
+        if (mask & (ComponentMask(1) << t)) {
+            arch->columnOf[t] = static_cast<int>(arch->types.size());
+            arch->types.push_back(t);
+        }
+    }
+    arch->columnOffsets.resize(arch->types.size());
+
+    // Fit as many rows as possible into one chunk, accounting for alignment padding between columns.
+    size_t rowBytes = sizeof(Entity);
+    for (ComponentTypeID t : arch->types) rowBytes += getComponentInfo(t).size;
+    uint32_t capacity = static_cast<uint32_t>(std::max<size_t>(1, ECS_CHUNK_SIZE / rowBytes));
+    size_t bytes = layoutColumns(arch, capacity);
+    while (bytes > ECS_CHUNK_SIZE && capacity > 1) {
+        --capacity;
+        bytes = layoutColumns(arch, capacity);
+    }
+    arch->capacity = capacity;
+    arch->chunkBytes = std::max(bytes, ECS_CHUNK_SIZE);
+
+    archetypes.push_back(arch);
+    return arch;
+}
+
+Archetype* World::archetypeWith(Archetype* from, ComponentTypeID type) {
+    if (!from->addEdge[type]) {
+        Archetype* to = getOrCreateArchetype(from->mask | (ComponentMask(1) << type));
+        from->addEdge[type] = to;
+        to->removeEdge[type] = from;
+    }
+    return from->addEdge[type];
+}
+
+Archetype* World::archetypeWithout(Archetype* from, ComponentTypeID type) {
+    if (!from->removeEdge[type]) {
+        Archetype* to = getOrCreateArchetype(from->mask & ~(ComponentMask(1) << type));
+        from->removeEdge[type] = to;
+        to->addEdge[type] = from;
+    }
+    return from->removeEdge[type];
+}
+
+Entity World::create() {
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = static_cast<uint32_t>(records.size());
+        records.push_back(EntityRecord{ 0, nullptr, 0, 0 });
+    }
+    Entity entity(index, records[index].generation);
+
+    Archetype* empty = archetypes[0];
+    EntityRecord& rec = records[index];
+    rec.archetype = empty;
+    allocateRow(empty, entity, rec.chunk, rec.row);
+    ++aliveCount;
+    return entity;
+}
+
+void World::destroy(Entity entity) {
+    if (!isAlive(entity)) return;
+    EntityRecord& rec = records[entity.index];
+    Archetype* arch = rec.archetype;
+    const Chunk& chunk = arch->chunks[rec.chunk];
+    for (ComponentTypeID t : arch->types) {
+        getComponentInfo(t).destroy(arch->component(chunk, t, rec.row));
+    }
+    removeRow(arch, rec.chunk, rec.row);
+
+    rec.archetype = nullptr;
+    ++rec.generation; // Invalidate outstanding handles
+    freeIndices.push_back(entity.index);
+    --aliveCount;
+}
+
+bool World::isAlive(Entity entity) const {
+    if (entity.index >= records.size()) return false;
+    const EntityRecord& rec = records[entity.index];
+    return rec.archetype != nullptr && rec.generation == entity.generation;
+}
+
+void World::allocateRow(Archetype* arch, Entity entity, uint32_t& chunkIndex, uint32_t& row) {
+    if (arch->chunks.empty() || arch->chunks.back().count == arch->capacity) {
+        arch->chunks.push_back(Chunk{ allocateChunkMemory(arch->chunkBytes), 0 });
+    }
+    chunkIndex = static_cast<uint32_t>(arch->chunks.size() - 1);
+    Chunk& chunk = arch->chunks.back();
+    row = chunk.count++;
+    arch->entities(chunk)[row] = entity;
+}
+
+void World::moveEntity(Entity entity, Archetype* target) {
+    EntityRecord& rec = records[entity.index];
+    Archetype* source = rec.archetype;
+    uint32_t srcChunkIndex = rec.chunk;
+    uint32_t srcRow = rec.row;
+
+    uint32_t dstChunkIndex, dstRow;
+    allocateRow(target, entity, dstChunkIndex, dstRow);
+
+    const Chunk& srcChunk = source->chunks[srcChunkIndex];
+    const Chunk& dstChunk = target->chunks[dstChunkIndex];
+    for (ComponentTypeID t : source->types) {
+        void* src = source->component(srcChunk, t, srcRow);
+        if (target->columnOf[t] >= 0) {
+            getComponentInfo(t).moveConstruct(target->component(dstChunk, t, dstRow), src);
+        } else {
+            getComponentInfo(t).destroy(src);
+        }
+    }
+
+    removeRow(source, srcChunkIndex, srcRow);
+    rec.archetype = target;
+    rec.chunk = dstChunkIndex;
+    rec.row = dstRow;
+}
+
+void World::removeRow(Archetype* arch, uint32_t chunkIndex, uint32_t row) {
+    Chunk& last = arch->chunks.back();
+    uint32_t lastChunkIndex = static_cast<uint32_t>(arch->chunks.size() - 1);
+    uint32_t lastRow = last.count - 1;
+
+    if (chunkIndex != lastChunkIndex || row != lastRow) {
+        // Fill the hole with the archetype's very last row so every chunk but the last stays full.
+        Chunk& hole = arch->chunks[chunkIndex];
+        Entity movedEntity = arch->entities(last)[lastRow];
+        for (ComponentTypeID t : arch->types) {
+            getComponentInfo(t).moveConstruct(arch->component(hole, t, row), arch->component(last, t, lastRow));
+        }
+        arch->entities(hole)[row] = movedEntity;
+        EntityRecord& movedRec = records[movedEntity.index];
+        movedRec.chunk = chunkIndex;
+        movedRec.row = row;
+    }
+
+    --last.count;
+    if (last.count == 0) {
+        freeChunkMemory(last.data);
+        arch->chunks.pop_back();
+    }
+}
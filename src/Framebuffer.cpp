@@ -1,8 +1,10 @@
 #include "MyFirstEngine/Framebuffer.h" // Adjust path as necessary
+#include <algorithm> // For std::min, std::max
 #include <iostream> // For std::cerr
 
 Framebuffer::Framebuffer(int width, int height)
-    : fboID(0), colorTextureID(0), depthRenderbufferID(0), fboWidth(width), fboHeight(height) {
+    : fboID(0), colorTextureID(0), depthRenderbufferID(0), fboWidth(width), fboHeight(height),
+      capacityWidth(0), capacityHeight(0), maxSize(0), allocations(0), shrinkPending(false) {
     if (fboWidth <= 0 || fboHeight <= 0) {
         // Don't try to create if dimensions are invalid initially.
         // resize() will handle creation when valid dimensions are provided.
@@ -12,6 +14,15 @@ Framebuffer::Framebuffer(int width, int height)
         this->fboWidth = 1; // Set to minimal valid to avoid issues if bind is called before resize
         this->fboHeight = 1;
     }
+    GLint maxTexture = 0, maxRenderbuffer = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTexture);
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbuffer);
+    maxSize = std::max(1, std::min(maxTexture, maxRenderbuffer));
+    // A fixed-size target (e.g. the headless runner) gets exactly what it asked for.
+    capacityWidth = std::min(fboWidth, maxSize);
+    capacityHeight = std::min(fboHeight, maxSize);
+    fboWidth = capacityWidth;
+    fboHeight = capacityHeight;
     createAttachments();
 }
 
@@ -23,12 +34,13 @@ void Framebuffer::createAttachments() {
     // Delete existing attachments if any, to prevent leaks on resize/recreation
     deleteAttachments();
 
-    if (fboWidth <= 0 || fboHeight <= 0) {
+    if (capacityWidth <= 0 || capacityHeight <= 0) {
         // std::cerr << "Framebuffer Error: Cannot create attachments with invalid dimensions ("
         //           << fboWidth << "x" << fboHeight << ")." << std::endl;
         return; // Don't proceed if dimensions are invalid
     }
 
+    ++allocations;
     glGenFramebuffers(1, &fboID);
     glBindFramebuffer(GL_FRAMEBUFFER, fboID);
 
@@ -36,7 +48,7 @@ void Framebuffer::createAttachments() {
     glGenTextures(1, &colorTextureID);
     glBindTexture(GL_TEXTURE_2D, colorTextureID);
     // Using GL_RGBA for more flexibility with ImGui, GL_RGB is also an option
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, fboWidth, fboHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, capacityWidth, capacityHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // Common for FBO textures
@@ -47,7 +59,7 @@ void Framebuffer::createAttachments() {
     // Create depth/stencil renderbuffer attachment
     glGenRenderbuffers(1, &depthRenderbufferID);
     glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbufferID);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, fboWidth, fboHeight);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, capacityWidth, capacityHeight);
     glBindRenderbuffer(GL_RENDERBUFFER, 0); // Unbind renderbuffer
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbufferID);
 
@@ -78,8 +90,8 @@ void Framebuffer::deleteAttachments() {
 
 void Framebuffer::bind() {
     // If FBO wasn't created due to initial invalid size, try to create it now
-    // (assuming fboWidth/Height might have been updated by resize)
-    if (fboID == 0 && (fboWidth > 0 && fboHeight > 0)) {
+    // (assuming capacityWidth/Height might have been updated by resize)
+    if (fboID == 0 && (capacityWidth > 0 && capacityHeight > 0)) {
         createAttachments();
     }
     
@@ -89,7 +101,8 @@ void Framebuffer::bind() {
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, fboID);
-    glViewport(0, 0, fboWidth, fboHeight); // Set viewport to FBO's dimensions
+    // Render into the logical sub-rect; the rest of the capacity is left untouched.
+    glViewport(0, 0, fboWidth, fboHeight);
 }
 
 void Framebuffer::unbind() {
@@ -98,22 +111,52 @@ void Framebuffer::unbind() {
     // Typically done before rendering to the main window or before ImGui::Render().
 }
 
+int Framebuffer::grownCapacity(int size) const {
+    const int withHeadroom = size + static_cast<int>(static_cast<float>(size) * RESIZE_HEADROOM);
+    const int rounded = (withHeadroom + RESIZE_BUCKET - 1) / RESIZE_BUCKET * RESIZE_BUCKET;
+    return std::min(std::max(rounded, size), maxSize);
+}
+
 void Framebuffer::resize(int width, int height) {
-    // Only resize if dimensions actually changed AND are valid
-    if ((this->fboWidth == width && this->fboHeight == height) && (fboID != 0) ) {
-         // If dimensions are the same and FBO exists, no need to resize
-        if (width > 0 && height > 0) return;
+    if (width <= 0 || height <= 0) {
+        // Minimized or collapsed: keep the attachments for when the view comes back.
+        this->fboWidth = width;
+        this->fboHeight = height;
+        shrinkPending = false;
+        return;
     }
-    
+    width = std::min(width, maxSize);
+    height = std::min(height, maxSize);
     this->fboWidth = width;
     this->fboHeight = height;
 
-    if (fboWidth <= 0 || fboHeight <= 0) {
-        // std::cerr << "Framebuffer Warning: Resizing to invalid dimensions ("
-        //           << fboWidth << "x" << fboHeight << "). Deleting attachments." << std::endl;
-        deleteAttachments(); // Delete attachments if dimensions become invalid
+    // Grow: both axes get headroom so the next few pixels of a drag fit without reallocating.
+    if (fboID == 0 || width > capacityWidth || height > capacityHeight) {
+        capacityWidth = std::max(capacityWidth, grownCapacity(width));
+        capacityHeight = std::max(capacityHeight, grownCapacity(height));
+        shrinkPending = false;
+        createAttachments();
         return;
     }
-    
-    createAttachments(); // Recreate with new dimensions
-}
\ No newline at end of file
+
+    // Shrink lazily: only once the capacity has been over twice the area it needs for a while.
+    const int fitWidth = grownCapacity(width);
+    const int fitHeight = grownCapacity(height);
+    const bool oversized = static_cast<long long>(capacityWidth) * capacityHeight >
+                           2LL * fitWidth * fitHeight;
+    if (!oversized) {
+        shrinkPending = false;
+        return;
+    }
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (!shrinkPending) {
+        shrinkPending = true;
+        shrinkSince = now;
+        return;
+    }
+    if (std::chrono::duration<double>(now - shrinkSince).count() < SHRINK_DELAY_SECONDS) return;
+    capacityWidth = fitWidth;
+    capacityHeight = fitHeight;
+    shrinkPending = false;
+    createAttachments();
+}
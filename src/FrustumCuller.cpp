@@ -0,0 +1,127 @@
+// FrustumCuller.cpp
+// SIMD frustum tests over structure-of-arrays bounds.
+
+#include "MyFirstEngine/FrustumCuller.h"
+#include <algorithm> // For std::min
+
+void FrustumCuller::resize(size_t count) {
+    centerX.resize(count); centerY.resize(count); centerZ.resize(count);
+    radius.resize(count);
+    extentX.resize(count); extentY.resize(count); extentZ.resize(count);
+}
+
+size_t FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const {
+    visible.resize(size());
+    const size_t count = cullRange(frustum, 0, size(), visible.data());
+    visible.resize(count);
+    return count;
+}
+
+size_t FrustumCuller::cullRangeScalar(const Frustum& frustum, size_t begin, size_t end, uint32_t* out) const {
+    size_t written = 0;
+    for (size_t i = begin; i < end; ++i) {
+        bool inside = true;
+        for (const Vec4& p : frustum.planes) {
+            const float dist = p.x * centerX[i] + p.y * centerY[i] + p.z * centerZ[i] + p.w;
+            const float boxRadius = std::abs(p.x) * extentX[i] + std::abs(p.y) * extentY[i] + std::abs(p.z) * extentZ[i];
+            if (dist < -std::min(radius[i], boxRadius)) { inside = false; break; }
+        }
+        out[written] = static_cast<uint32_t>(i);
+        written += inside ? 1 : 0;
+    }
+    return written;
+}
+
+// The vector paths share one structure: for a group of objects compute, per plane,
+//   dist = n . c + d   and   r = min(sphere radius, |n| . extents)
+// and accumulate 'dist < -r' into an outside mask. Visible indices are then appended without
+// branches: every lane's index is written, but the output cursor only advances for visible ones.
+size_t FrustumCuller::cullRange(const Frustum& frustum, size_t begin, size_t end, uint32_t* out) const {
+    size_t written = 0;
+    size_t i = begin;
+
+#if defined(SIMPLEMATH_AVX)
+    __m256 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm256_set1_ps(frustum.planes[p].x); ax[p] = _mm256_andnot_ps(signMask, px[p]);
+        py[p] = _mm256_set1_ps(frustum.planes[p].y); ay[p] = _mm256_andnot_ps(signMask, py[p]);
+        pz[p] = _mm256_set1_ps(frustum.planes[p].z); az[p] = _mm256_andnot_ps(signMask, pz[p]);
+        pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+    for (; i + 8 <= end; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(&centerX[i]), cy = _mm256_loadu_ps(&centerY[i]), cz = _mm256_loadu_ps(&centerZ[i]);
+        const __m256 r = _mm256_loadu_ps(&radius[i]);
+        const __m256 ex = _mm256_loadu_ps(&extentX[i]), ey = _mm256_loadu_ps(&extentY[i]), ez = _mm256_loadu_ps(&extentZ[i]);
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            __m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], cx), _mm256_mul_ps(py[p], cy)),
+                                        _mm256_add_ps(_mm256_mul_ps(pz[p], cz), pw[p]));
+            __m256 boxRadius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)),
+                                             _mm256_mul_ps(az[p], ez));
+            __m256 negRadius = _mm256_xor_ps(_mm256_min_ps(r, boxRadius), signMask);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, negRadius, _CMP_LT_OQ));
+        }
+        const int visibleMask = ~_mm256_movemask_ps(outside) & 0xFF;
+        for (int lane = 0; lane < 8; ++lane) {
+            out[written] = static_cast<uint32_t>(i + lane);
+            written += (visibleMask >> lane) & 1;
+        }
+    }
+#elif defined(SIMPLEMATH_SSE)
+    __m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (int p = 0; p < 6; ++p) {
+        px[p] = _mm_set1_ps(frustum.planes[p].x); ax[p] = _mm_andnot_ps(signMask, px[p]);
+        py[p] = _mm_set1_ps(frustum.planes[p].y); ay[p] = _mm_andnot_ps(signMask, py[p]);
+        pz[p] = _mm_set1_ps(frustum.planes[p].z); az[p] = _mm_andnot_ps(signMask, pz[p]);
+        pw[p] = _mm_set1_ps(frustum.planes[p].w);
+    }
+    for (; i + 4 <= end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(&centerX[i]), cy = _mm_loadu_ps(&centerY[i]), cz = _mm_loadu_ps(&centerZ[i]);
+        const __m128 r = _mm_loadu_ps(&radius[i]);
+        const __m128 ex = _mm_loadu_ps(&extentX[i]), ey = _mm_loadu_ps(&extentY[i]), ez = _mm_loadu_ps(&extentZ[i]);
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)),
+                                     _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)), _mm_mul_ps(az[p], ez));
+            __m128 negRadius = _mm_xor_ps(_mm_min_ps(r, boxRadius), signMask);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negRadius));
+        }
+        const int visibleMask = ~_mm_movemask_ps(outside) & 0xF;
+        for (int lane = 0; lane < 4; ++lane) {
+            out[written] = static_cast<uint32_t>(i + lane);
+            written += (visibleMask >> lane) & 1;
+        }
+    }
+#elif defined(SIMPLEMATH_NEON)
+    float32x4_t px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; ++p) {
+        px[p] = vdupq_n_f32(frustum.planes[p].x); ax[p] = vabsq_f32(px[p]);
+        py[p] = vdupq_n_f32(frustum.planes[p].y); ay[p] = vabsq_f32(py[p]);
+        pz[p] = vdupq_n_f32(frustum.planes[p].z); az[p] = vabsq_f32(pz[p]);
+        pw[p] = vdupq_n_f32(frustum.planes[p].w);
+    }
+    for (; i + 4 <= end; i += 4) {
+        const float32x4_t cx = vld1q_f32(&centerX[i]), cy = vld1q_f32(&centerY[i]), cz = vld1q_f32(&centerZ[i]);
+        const float32x4_t r = vld1q_f32(&radius[i]);
+        const float32x4_t ex = vld1q_f32(&extentX[i]), ey = vld1q_f32(&extentY[i]), ez = vld1q_f32(&extentZ[i]);
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (int p = 0; p < 6; ++p) {
+            float32x4_t dist = vmlaq_f32(vmlaq_f32(vmlaq_f32(pw[p], px[p], cx), py[p], cy), pz[p], cz);
+            float32x4_t boxRadius = vmlaq_f32(vmlaq_f32(vmulq_f32(ax[p], ex), ay[p], ey), az[p], ez);
+            outside = vorrq_u32(outside, vcltq_f32(dist, vnegq_f32(vminq_f32(r, boxRadius))));
+        }
+        uint32_t lanes[4];
+        vst1q_u32(lanes, outside);
+        for (int lane = 0; lane < 4; ++lane) {
+            out[written] = static_cast<uint32_t>(i + lane);
+            written += lanes[lane] ? 0 : 1;
+        }
+    }
+#endif
+
+    // Remainder (and the whole range without SIMD).
+    return written + cullRangeScalar(frustum, i, end, out + written);
+}
@@ -0,0 +1,77 @@
+// GLExtensions.cpp
+// Detection and loading of optional OpenGL features.
+
+#include "MyFirstEngine/GLExtensions.h"
+#include <cstring>  // For std::strcmp
+#include <iostream> // For std::cerr (error output)
+
+int GLExtensions::majorVersion = 0;
+int GLExtensions::minorVersion = 0;
+bool GLExtensions::hasBufferStorage = false;
+PFN_GLBUFFERSTORAGE GLExtensions::bufferStorage = nullptr;
+bool GLExtensions::hasProgramBinary = false;
+PFN_GLGETPROGRAMBINARY GLExtensions::getProgramBinary = nullptr;
+PFN_GLPROGRAMBINARY GLExtensions::programBinary = nullptr;
+PFN_GLPROGRAMPARAMETERI GLExtensions::programParameteri = nullptr;
+bool GLExtensions::hasParallelShaderCompile = false;
+PFN_GLMAXSHADERCOMPILERTHREADS GLExtensions::maxShaderCompilerThreads = nullptr;
+bool GLExtensions::hasTextureCompressionS3TC = false;
+bool GLExtensions::hasTextureCompressionBPTC = false;
+
+bool GLExtensions::has(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && std::strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+bool GLExtensions::load(GLADloadproc loader) {
+    if (!loader || !glGetString(GL_VERSION)) {
+        std::cerr << "ERROR::GL_EXTENSIONS::LOAD: No current OpenGL context." << std::endl;
+        return false;
+    }
+    glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+    glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+    const int version = majorVersion * 10 + minorVersion;
+
+    // glBufferStorage has the same name in GL 4.4 core and in ARB_buffer_storage.
+    hasBufferStorage = false;
+    bufferStorage = nullptr;
+    if (version >= 44 || has("GL_ARB_buffer_storage")) {
+        bufferStorage = reinterpret_cast<PFN_GLBUFFERSTORAGE>(loader("glBufferStorage"));
+        hasBufferStorage = bufferStorage != nullptr;
+    }
+
+    // Program binaries: same names in GL 4.1 core and ARB_get_program_binary. A driver may expose
+    // the entry points but no formats (e.g. with its own shader cache disabled).
+    hasProgramBinary = false;
+    getProgramBinary = nullptr;
+    programBinary = nullptr;
+    programParameteri = nullptr;
+    if (version >= 41 || has("GL_ARB_get_program_binary")) {
+        getProgramBinary = reinterpret_cast<PFN_GLGETPROGRAMBINARY>(loader("glGetProgramBinary"));
+        programBinary = reinterpret_cast<PFN_GLPROGRAMBINARY>(loader("glProgramBinary"));
+        programParameteri = reinterpret_cast<PFN_GLPROGRAMPARAMETERI>(loader("glProgramParameteri"));
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        hasProgramBinary = getProgramBinary && programBinary && programParameteri && formats > 0;
+    }
+
+    // Parallel compilation: the KHR and ARB extensions share the token; only the suffix differs.
+    hasParallelShaderCompile = false;
+    maxShaderCompilerThreads = nullptr;
+    if (has("GL_KHR_parallel_shader_compile")) {
+        maxShaderCompilerThreads = reinterpret_cast<PFN_GLMAXSHADERCOMPILERTHREADS>(loader("glMaxShaderCompilerThreadsKHR"));
+    } else if (has("GL_ARB_parallel_shader_compile")) {
+        maxShaderCompilerThreads = reinterpret_cast<PFN_GLMAXSHADERCOMPILERTHREADS>(loader("glMaxShaderCompilerThreadsARB"));
+    }
+    hasParallelShaderCompile = maxShaderCompilerThreads != nullptr;
+
+    // Compressed formats only add tokens; the upload functions are core.
+    hasTextureCompressionS3TC = has("GL_EXT_texture_compression_s3tc");
+    hasTextureCompressionBPTC = version >= 42 || has("GL_ARB_texture_compression_bptc");
+    return true;
+}
@@ -0,0 +1,100 @@
+// GpuProfiler.cpp
+// Double-buffered GL_TIMESTAMP query pools.
+
+#include "MyFirstEngine/GpuProfiler.h"
+#include "glad/glad.h"
+#include <iostream> // For std::cerr
+
+GpuProfiler::GpuProfiler() : currentPool(0), recording(false), stalls(0) {
+    for (FramePool& pool : pools) {
+        pool.usedQueries = 0;
+        pool.frame = 0;
+        pool.pending = false;
+    }
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (FramePool& pool : pools) {
+        if (!pool.queries.empty()) glDeleteQueries(static_cast<GLsizei>(pool.queries.size()), pool.queries.data());
+    }
+}
+
+bool GpuProfiler::init() {
+    for (FramePool& pool : pools) {
+        pool.queries.resize(2 * MAX_SCOPES);
+        glGenQueries(static_cast<GLsizei>(pool.queries.size()), pool.queries.data());
+        pool.scopes.reserve(MAX_SCOPES);
+    }
+    openScopes.reserve(16);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "ERROR::GPU_PROFILER::INIT: Failed to create timer queries." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GpuProfiler::collect(FramePool& pool) {
+    if (!pool.pending) return;
+    pool.pending = false;
+    if (pool.scopes.empty()) return;
+
+    // Queries complete in order, so the last one tells whether the whole frame is available.
+    GLint available = 0;
+    glGetQueryObjectiv(pool.queries[pool.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) ++stalls;
+
+    resultScratch.clear();
+    for (const Scope& scope : pool.scopes) {
+        if (scope.endQuery == scope.beginQuery) continue; // Never closed
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(pool.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(pool.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+        resultScratch.push_back(Profiler::Event{ scope.name, Profiler::GPU_TRACK, scope.depth,
+                                                 static_cast<double>(begin) / 1e6, static_cast<double>(end) / 1e6 });
+    }
+    Profiler::get().addGpuFrame(pool.frame, resultScratch);
+}
+
+void GpuProfiler::beginFrame(uint64_t frame) {
+    if (pools[0].queries.empty()) return; // init() not called
+    currentPool = (currentPool + 1) % FRAME_BUFFERS;
+    FramePool& pool = pools[currentPool];
+    collect(pool);
+    pool.scopes.clear();
+    pool.usedQueries = 0;
+    pool.frame = frame;
+    openScopes.clear();
+    recording = Profiler::get().isEnabled();
+}
+
+void GpuProfiler::endFrame() {
+    if (!recording) return;
+    while (!openScopes.empty()) endScope();
+    FramePool& pool = pools[currentPool];
+    pool.pending = pool.usedQueries > 0;
+    recording = false;
+}
+
+void GpuProfiler::beginScope(const char* name) {
+    if (!recording) return;
+    FramePool& pool = pools[currentPool];
+    if (pool.scopes.size() >= MAX_SCOPES) {
+        openScopes.push_back(0xFFFFFFFFu); // Keeps begin/end pairs balanced
+        return;
+    }
+    const uint32_t query = pool.usedQueries++;
+    glQueryCounter(pool.queries[query], GL_TIMESTAMP);
+    pool.scopes.push_back(Scope{ name, static_cast<uint32_t>(openScopes.size()), query, query });
+    openScopes.push_back(static_cast<uint32_t>(pool.scopes.size() - 1));
+}
+
+void GpuProfiler::endScope() {
+    if (!recording || openScopes.empty()) return;
+    const uint32_t scope = openScopes.back();
+    openScopes.pop_back();
+    if (scope == 0xFFFFFFFFu) return;
+    FramePool& pool = pools[currentPool];
+    const uint32_t query = pool.usedQueries++;
+    glQueryCounter(pool.queries[query], GL_TIMESTAMP);
+    pool.scopes[scope].endQuery = query;
+}
@@ -0,0 +1,129 @@
+// HeadlessContext.cpp
+// EGL setup for the window-less OpenGL context.
+
+#include "MyFirstEngine/HeadlessContext.h"
+#include "MyFirstEngine/GLExtensions.h"
+#include "glad/glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>  // For std::strstr
+#include <iostream> // For std::cerr
+
+// True if the space-separated extension list contains 'name' as a whole word.
+static bool hasExtension(const char* extensions, const char* name) {
+    if (!extensions) return false;
+    const size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        bool startOk = (p == extensions || p[-1] == ' ');
+        bool endOk = (p[length] == ' ' || p[length] == '\0');
+        if (startOk && endOk) return true;
+    }
+    return false;
+}
+
+// Tries the display types that work without a window system, most specific first:
+// Mesa's surfaceless platform, then the first EGL device (e.g. NVIDIA headless), then the default display.
+static EGLDisplay openDisplay() {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+    }
+
+    PFNEGLQUERYDEVICESEXTPROC queryDevices =
+        reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+    if (getPlatformDisplay && queryDevices && hasExtension(clientExtensions, "EGL_EXT_platform_device")) {
+        EGLDeviceEXT devices[8];
+        EGLint deviceCount = 0;
+        if (queryDevices(8, devices, &deviceCount)) {
+            for (EGLint i = 0; i < deviceCount; ++i) {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[i], nullptr);
+                if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+            }
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) return display;
+    return EGL_NO_DISPLAY;
+}
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT), surface(EGL_NO_SURFACE), surfaceMode("none") {}
+
+HeadlessContext::~HeadlessContext() {
+    if (display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+}
+
+void* HeadlessContext::getProcAddress(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+bool HeadlessContext::init() {
+    display = openDisplay();
+    if (display == EGL_NO_DISPLAY) {
+        std::cerr << "ERROR::HEADLESS::INIT: Could not open an EGL display." << std::endl;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR::HEADLESS::INIT: EGL implementation does not support desktop OpenGL." << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "ERROR::HEADLESS::INIT: No suitable EGL config found." << std::endl;
+        return false;
+    }
+
+    // Same context version/profile the editor requests from GLFW.
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR::HEADLESS::INIT: Failed to create an OpenGL 3.3 core context (EGL error 0x"
+                  << std::hex << eglGetError() << std::dec << ")." << std::endl;
+        return false;
+    }
+
+    const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (hasExtension(displayExtensions, "EGL_KHR_surfaceless_context") &&
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        surfaceMode = "surfaceless";
+    } else {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context)) {
+            std::cerr << "ERROR::HEADLESS::INIT: Failed to make the context current." << std::endl;
+            return false;
+        }
+        surfaceMode = "pbuffer";
+    }
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(&HeadlessContext::getProcAddress))) {
+        std::cerr << "ERROR::HEADLESS::INIT: Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    GLExtensions::load(reinterpret_cast<GLADloadproc>(&HeadlessContext::getProcAddress));
+    return true;
+}
@@ -0,0 +1,803 @@
+// HeadlessMain.cpp
+// Headless render runner for CI and render-farm machines without a display.
+//
+// Builds the editor's demo scene (optionally plus a grid of extra objects), renders a fixed
+// number of frames into a Framebuffer through an EGL context and records per-frame timings:
+//   cpu_ms   - CPU time to update the scene and submit the frame's GL commands
+//   gpu_ms   - GPU time of the frame, measured with GL_TIME_ELAPSED queries
+//   frame_ms - wall time from the start of one frame to the start of the next
+//   cull_ms  - CPU time of the frustum culling stage (part of cpu_ms), plus the visible count
+//   occlusion_ms - CPU time of occluder rasterization and occlusion tests (part of cpu_ms)
+//   triangles - triangles submitted to the GPU (after culling and LOD selection)
+//   light_ms - CPU time to gather the lights and bin them into clusters (part of cpu_ms)
+//   shadow_ms - CPU time to fit the shadow cascades, cull their casters and submit them (part of cpu_ms)
+// ImGui and GLFW are not used at all. The camera orbits at a fixed rate per frame, so runs are
+// deterministic and directly comparable.
+//
+// Usage (run from the directory containing shaders/):
+//   SimpleEngineHeadless [--width=1280] [--height=720] [--frames=300] [--warmup=10]
+//                        [--objects=0] [--threads=1] [--cull=1] [--walls=0] [--occlusion=1] [--lod=1] [--profile=0]
+//                        [--lights=0] [--shader-cache=shader_cache] [--textures=0] [--texture-budget=256]
+//                        [--texture-format=rgba8] [--mesh=model.semesh] [--meshlet-cull=2]
+//                        [--shadows=0] [--shadow-size=1024] [--shadow-cache=1]
+//                        [--timings=timings.json] [--dump-dir=frames] [--dump-every=0]
+//   --dump-every=0 dumps only the last frame when --dump-dir is given (created if missing). Dumps
+//     are binary PPM files.
+//   --walls=N adds N wall rows across the object grid; they are the occluders for occlusion culling.
+//   --lod=0 always draws the grid spheres at full detail instead of selecting a level per frame.
+//   --lights=N scatters N point and spot lights over the grid and shades with clustered lighting;
+//     with 0 the scene is drawn unlit.
+//   --textures=N streams N generated textures (written once to headless_textures/) onto the grid
+//     cubes; --texture-budget is the streaming VRAM budget in MB. Residency is printed at the end.
+//     --texture-format=bc1|bc3|bc5|bc7 cooks them (once) into .setex files and streams those.
+//   --mesh=PATH replaces the grid triangles with a mesh, scaled to the same size: a cooked .semesh
+//     (memory-mapped, see MeshFile.h) or an .obj/.gltf/.glb imported, optimized and quantized at
+//     startup like the mesh cooker does. The load time is printed.
+//   --meshlet-cull=0|1|2 culls the mesh's meshlets not at all, against the frustum, or against the
+//     frustum and, if the mesh is single-sided, by normal cone (MeshletCulling); the visible share
+//     is printed.
+//   --shadows=N lights the scene with a sun casting N shadow cascades (ShadowCascades.h), at
+//     --shadow-size texels each. The spinning demo hierarchy and the LOD spheres (whose mesh
+//     changes with the level) cast dynamic shadows, everything else static ones, which the
+//     distant cascades cache; --shadow-cache=0 redraws every cascade every frame instead.
+//     Cascades redrawn, copied and kept per frame and the caster count are printed.
+//   --shader-cache=DIR keeps linked shader programs in DIR between runs; an empty value disables
+//     the cache. Renderer startup time and cache hits are printed either way.
+//   --profile=1 prints per-scope CPU and GPU statistics (PROFILE_SCOPE / GpuProfiler) at the end.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+
+#include "MyFirstEngine/ECS.h"
+#include "MyFirstEngine/GameObject.h"
+#include "MyFirstEngine/Transform.h"
+#include "MyFirstEngine/SceneGraph.h"
+#include "SimpleMath.h"
+#include "MyFirstEngine/Renderer.h"
+#include "MyFirstEngine/MeshRenderer.h"
+#include "MyFirstEngine/Camera.h"
+#include "MyFirstEngine/Framebuffer.h"
+#include "MyFirstEngine/HeadlessContext.h"
+#include "MyFirstEngine/RenderQueue.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include "MyFirstEngine/FrustumCuller.h"
+#include "MyFirstEngine/OcclusionCuller.h"
+#include "MyFirstEngine/LOD.h"
+#include "MyFirstEngine/Profiler.h"
+#include "MyFirstEngine/GpuProfiler.h"
+#include "MyFirstEngine/Light.h"
+#include "MyFirstEngine/LightClusterer.h"
+#include "MyFirstEngine/Image.h"
+#include "MyFirstEngine/TextureCompressor.h"
+#include "MyFirstEngine/MeshImporter.h"
+#include "MyFirstEngine/MeshOptimizer.h"
+#include "MyFirstEngine/Meshlet.h"
+#include "MyFirstEngine/ShadowCascades.h"
+
+unsigned int GameObject::nextID = 0;
+
+struct HeadlessOptions {
+    int width = 1280;
+    int height = 720;
+    int frames = 300;
+    int warmupFrames = 10;  // Rendered but not recorded (shader compilation, driver warm-up)
+    int extraObjects = 0;   // Additional objects laid out on a grid, for scaling runs
+    int threads = 1;        // Threads recording draw commands (including the main thread)
+    bool cull = true;       // Frustum culling before recording (--cull=0 draws everything)
+    int walls = 0;          // Wall rows across the grid, used as occluders
+    bool occlusion = true;  // CPU occlusion culling against the walls (--occlusion=0 disables)
+    bool lod = true;        // LOD selection for the grid spheres (--lod=0 keeps full detail)
+    bool profile = false;   // Print the scope profiler's statistics
+    int lights = 0;         // Dynamic lights over the grid (0 = unlit)
+    std::string shaderCacheDir = "shader_cache";
+    int textures = 0;       // Streamed textures on the grid cubes
+    int textureBudgetMB = 256;
+    ImageFormat textureFormat = ImageFormat::RGBA8;
+    std::string meshPath;   // Replaces the grid triangles when set
+    int meshletCull = 2;    // MeshletCulling of the --mesh meshlets
+    int shadows = 0;        // Shadow cascades of the sun (0 = no sun, no shadows)
+    int shadowSize = 1024;
+    bool shadowCache = true; // Cache the distant cascades' static casters
+    std::string timingsPath;
+    std::string dumpDir;
+    int dumpEvery = 0;
+};
+
+struct FrameTiming {
+    int frame;
+    double cpuMs;
+    double gpuMs;
+    double frameMs;
+    double cullMs;
+    double occlusionMs;
+    double lightMs;
+    double shadowMs;
+    size_t visible;
+    size_t triangles;
+    size_t meshletsTested;
+    size_t meshletsVisible;
+    ShadowStats shadows;
+    bool dumped;
+};
+
+// GL_TIME_ELAPSED queries are read back a few frames late so the CPU never waits on the GPU.
+static const int GPU_QUERY_LATENCY = 4;
+
+static bool parseOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--width") options.width = std::atoi(value.c_str());
+        else if (key == "--height") options.height = std::atoi(value.c_str());
+        else if (key == "--frames") options.frames = std::atoi(value.c_str());
+        else if (key == "--warmup") options.warmupFrames = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--objects") options.extraObjects = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--threads") options.threads = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--cull") options.cull = std::atoi(value.c_str()) != 0;
+        else if (key == "--walls") options.walls = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--occlusion") options.occlusion = std::atoi(value.c_str()) != 0;
+        else if (key == "--lod") options.lod = std::atoi(value.c_str()) != 0;
+        else if (key == "--profile") options.profile = std::atoi(value.c_str()) != 0;
+        else if (key == "--lights") options.lights = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--shader-cache") options.shaderCacheDir = value;
+        else if (key == "--textures") options.textures = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--texture-budget") options.textureBudgetMB = std::max(1, std::atoi(value.c_str()));
+        else if (key == "--texture-format" && Image::parseFormat(value, options.textureFormat)) continue;
+        else if (key == "--mesh") options.meshPath = value;
+        else if (key == "--meshlet-cull") options.meshletCull = std::min(std::max(std::atoi(value.c_str()), 0), 2);
+        else if (key == "--shadows") options.shadows = std::min(std::max(std::atoi(value.c_str()), 0), static_cast<int>(ShadowCascades::MAX_CASCADES));
+        else if (key == "--shadow-size") options.shadowSize = std::max(16, std::atoi(value.c_str()));
+        else if (key == "--shadow-cache") options.shadowCache = std::atoi(value.c_str()) != 0;
+        else if (key == "--timings") options.timingsPath = value;
+        else if (key == "--dump-dir") options.dumpDir = value;
+        else if (key == "--dump-every") options.dumpEvery = std::max(0, std::atoi(value.c_str()));
+        else {
+            std::cerr << "Usage: SimpleEngineHeadless [--width=N] [--height=N] [--frames=N] [--warmup=N] [--objects=N]"
+                          " [--threads=N] [--cull=0|1] [--walls=N] [--occlusion=0|1] [--lod=0|1] [--profile=0|1] [--lights=N]"
+                         " [--shader-cache=dir] [--textures=N] [--texture-budget=MB]"
+                         " [--texture-format=rgba8|bc1|bc3|bc5|bc7] [--mesh=file] [--meshlet-cull=0|1|2]"
+                         " [--shadows=0-4] [--shadow-size=N] [--shadow-cache=0|1]"
+                         " [--timings=file.json]"
+                         " [--dump-dir=dir] [--dump-every=N]" << std::endl;
+            return false;
+        }
+    }
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0) {
+        std::cerr << "ERROR::HEADLESS: --width, --height and --frames must be positive." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static Entity createGameObject(World& world, SceneGraph& graph, const std::string& name, const MeshRenderer& meshRenderer,
+                               const Vec3& position, Entity parent = Entity::null()) {
+    Entity entity = world.create();
+    world.add<Transform>(entity).position = position;
+    world.add<GameObject>(entity, name);
+    world.add<MeshRenderer>(entity, meshRenderer);
+    graph.addNode(entity, parent);
+    return entity;
+}
+
+// Writes a size x size tile pattern (grout lines over a per-file hue) for --textures.
+static void writeTestTexture(const std::string& path, uint32_t size, uint32_t seed) {
+    Image image;
+    image.levels.resize(1);
+    ImageLevel& level = image.levels[0];
+    level.width = level.height = size;
+    level.pixels.resize(static_cast<size_t>(size) * size * 4);
+    const uint8_t base[3] = { static_cast<uint8_t>(120 + (seed * 53) % 136), static_cast<uint8_t>(120 + (seed * 97) % 136),
+                              static_cast<uint8_t>(120 + (seed * 151) % 136) };
+    const uint32_t tile = size / 8;
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            uint8_t* p = &level.pixels[(static_cast<size_t>(y) * size + x) * 4];
+            const bool grout = x % tile < tile / 16 + 1 || y % tile < tile / 16 + 1;
+            const uint32_t shade = ((x / tile + y / tile) % 2) ? 255 : 200;
+            for (int c = 0; c < 3; ++c) p[c] = grout ? 40 : static_cast<uint8_t>(base[c] * shade / 255);
+            p[3] = 255;
+        }
+    }
+    image.savePPM(path);
+}
+
+// Same objects as the editor's startup scene (all drawn with 'material'; grid cubes cycle through
+// 'cubeMaterials' when given), plus 'extraObjects' on a square grid around it.
+// Grid objects cycle through cube, triangle (or 'gridMesh' at 'gridMeshScale' when valid) and a
+// sphere with four LOD levels ('sphereLevels', finest first). 'walls' long, thin cubes are spread evenly
+// across the grid (parallel to the X axis) and returned in 'wallEntities'. 'lights' point and
+// spot lights (every fourth one a spot pointing down) hover over the grid. Everything but the
+// returned demo hierarchy (which the caller spins) and the LOD spheres casts static shadows.
+static Entity buildScene(World& world, SceneGraph& graph, const Renderer& renderer, MaterialHandle material,
+                         const std::vector<MaterialHandle>& cubeMaterials, int extraObjects, int walls, int lights, const LODGroup& sphereLevels,
+                         MeshHandle gridMesh, float gridMeshScale, std::vector<Entity>& wallEntities) {
+    const MeshRenderer triangle(renderer.getBuiltinMesh(BuiltinMesh::Triangle), material);
+    const MeshRenderer cube(renderer.getBuiltinMesh(BuiltinMesh::Cube), material);
+    const MeshRenderer plane(renderer.getBuiltinMesh(BuiltinMesh::Plane), material, ShadowCasting::Static);
+
+    Entity triangleAlpha = createGameObject(world, graph, "Triangle Alpha", triangle, Vec3(0.0f, 0.0f, 0.0f));
+    Entity cubeBeta = createGameObject(world, graph, "Cube Beta", cube, Vec3(1.5f, 0.0f, 0.0f), triangleAlpha);
+    world.get<Transform>(cubeBeta)->scale = Vec3(0.5f, 0.5f, 0.5f);
+    world.get<Transform>(cubeBeta)->rotation = Quat::fromEuler(Vec3(0.0f, 45.0f, 30.0f));
+    Entity groundPlane = createGameObject(world, graph, "Ground Plane", plane, Vec3(0.0f, -0.75f, 0.0f));
+    world.get<Transform>(groundPlane)->scale = Vec3(5.0f, 0.1f, 5.0f);
+
+    int side = 1;
+    while (side * side < extraObjects) ++side;
+    const float spacing = 1.25f;
+    for (int i = 0; i < extraObjects; ++i) {
+        float x = (static_cast<float>(i % side) - 0.5f * static_cast<float>(side)) * spacing;
+        float z = (static_cast<float>(i / side) - 0.5f * static_cast<float>(side)) * spacing;
+        const MeshRenderer sphere(sphereLevels.currentMesh(), material);
+        const MeshRenderer texturedCube(cube.mesh, cubeMaterials.empty() ? material : cubeMaterials[(i / 3) % cubeMaterials.size()]);
+        const MeshRenderer imported(gridMesh, material);
+        const MeshRenderer& slotMesh = gridMesh != INVALID_RENDER_HANDLE ? imported : triangle;
+        const MeshRenderer& meshRenderer = (i % 3 == 0) ? texturedCube : (i % 3 == 1 ? slotMesh : sphere);
+        Entity e = createGameObject(world, graph, "Grid " + std::to_string(i), meshRenderer, Vec3(x, 0.0f, z - 3.0f));
+        world.get<MeshRenderer>(e)->shadowCasting = ShadowCasting::Static;
+        if (i % 3 == 0) world.get<Transform>(e)->scale = Vec3(0.4f, 0.4f, 0.4f);
+        if (i % 3 == 1 && gridMesh != INVALID_RENDER_HANDLE) world.get<Transform>(e)->scale = Vec3(gridMeshScale, gridMeshScale, gridMeshScale);
+        if (i % 3 == 2) {
+            world.get<Transform>(e)->scale = Vec3(0.6f, 0.6f, 0.6f);
+            world.add<LODGroup>(e, sphereLevels);
+            // LOD switches replace the mesh without invalidating the cached cascades.
+            world.get<MeshRenderer>(e)->shadowCasting = ShadowCasting::Dynamic;
+        }
+        world.get<Transform>(e)->rotation = Quat::fromEuler(Vec3(0.0f, static_cast<float>((i * 37) % 360), 0.0f));
+    }
+    const float gridSize = static_cast<float>(side) * spacing;
+    for (int i = 0; i < walls; ++i) {
+        float z = (static_cast<float>(i) + 0.5f) / static_cast<float>(walls) * gridSize - 0.5f * gridSize - 3.0f;
+        Entity wall = createGameObject(world, graph, "Wall " + std::to_string(i), cube, Vec3(0.0f, 0.5f, z));
+        world.get<MeshRenderer>(wall)->shadowCasting = ShadowCasting::Static;
+        world.get<Transform>(wall)->scale = Vec3(gridSize + 2.0f, 2.5f, 0.3f);
+        wallEntities.push_back(wall);
+    }
+    // Deterministic pseudo-random placement (same lights every run).
+    uint32_t seed = 12345u;
+    auto random01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    const float lightArea = std::max(gridSize, 8.0f);
+    for (int i = 0; i < lights; ++i) {
+        const Vec3 position((random01() - 0.5f) * lightArea, 0.4f + random01() * 0.8f, (random01() - 0.5f) * lightArea - 3.0f);
+        // Saturated colors from a hue wheel.
+        const float hue = random01() * 6.0f;
+        const Vec3 color(std::min(std::max(std::abs(hue - 3.0f) - 1.0f, 0.0f), 1.0f),
+                         std::min(std::max(2.0f - std::abs(hue - 2.0f), 0.0f), 1.0f),
+                         std::min(std::max(2.0f - std::abs(hue - 4.0f), 0.0f), 1.0f));
+        Entity light = world.create();
+        world.add<Transform>(light).position = position;
+        world.add<GameObject>(light, "Light " + std::to_string(i));
+        if (i % 4 == 3) {
+            world.add<Light>(light, Light::spot(color, 6.0f, 3.0f + random01() * 2.0f, Vec3(0.0f, -1.0f, 0.0f), 20.0f, 35.0f));
+        } else {
+            world.add<Light>(light, Light::point(color, 3.0f, 1.5f + random01() * 1.5f));
+        }
+        graph.addNode(light);
+    }
+    graph.markAllDirty();
+    return triangleAlpha;
+}
+
+// Writes the framebuffer's color attachment as a binary PPM (rows flipped to top-down order).
+static bool dumpFramePPM(Framebuffer& framebuffer, const std::string& path) {
+    const int w = framebuffer.getWidth(), h = framebuffer.getHeight();
+    std::vector<unsigned char> rgba(static_cast<size_t>(w) * h * 4);
+    framebuffer.bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    framebuffer.unbind();
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "ERROR::HEADLESS::DUMP: Could not open " << path << std::endl;
+        return false;
+    }
+    std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+    std::vector<unsigned char> row(static_cast<size_t>(w) * 3);
+    for (int y = h - 1; y >= 0; --y) {
+        const unsigned char* src = &rgba[static_cast<size_t>(y) * w * 4];
+        for (int x = 0; x < w; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), f);
+    }
+    std::fclose(f);
+    return true;
+}
+
+struct TimingStats {
+    double mean, p50, p95, max;
+};
+
+static TimingStats computeStats(std::vector<double> values) {
+    TimingStats s = { 0.0, 0.0, 0.0, 0.0 };
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    for (double v : values) s.mean += v;
+    s.mean /= static_cast<double>(values.size());
+    s.p50 = values[values.size() / 2];
+    s.p95 = values[std::min(values.size() - 1, (values.size() * 95) / 100)];
+    s.max = values.back();
+    return s;
+}
+
+static void writeStatsJson(std::FILE* f, const char* name, const TimingStats& s, bool last) {
+    std::fprintf(f, "    \"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f}%s\n",
+                 name, s.mean, s.p50, s.p95, s.max, last ? "" : ",");
+}
+
+static bool writeTimingsJson(const std::string& path, const HeadlessOptions& options, const char* surfaceMode,
+                             size_t objectCount, unsigned int drawCalls, const StreamBuffer& stream,
+                             const std::vector<FrameTiming>& timings,
+                             const TimingStats& cpu, const TimingStats& gpu, const TimingStats& frame,
+                             const TimingStats& cull, const TimingStats& occlusion, const TimingStats& light,
+                             const TimingStats& shadow) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::cerr << "ERROR::HEADLESS::TIMINGS: Could not open " << path << std::endl;
+        return false;
+    }
+    std::fprintf(f, "{\n  \"context\": {\n");
+    std::fprintf(f, "    \"gl_renderer\": \"%s\",\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    std::fprintf(f, "    \"gl_version\": \"%s\",\n", reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+    std::fprintf(f, "    \"surface\": \"%s\",\n", surfaceMode);
+    std::fprintf(f, "    \"width\": %d,\n    \"height\": %d,\n", options.width, options.height);
+    std::fprintf(f, "    \"objects\": %zu,\n", objectCount);
+    std::fprintf(f, "    \"draw_calls\": %u,\n", drawCalls);
+    std::fprintf(f, "    \"threads\": %d,\n", options.threads);
+    std::fprintf(f, "    \"cull\": %s,\n", options.cull ? "true" : "false");
+    std::fprintf(f, "    \"walls\": %d,\n", options.walls);
+    std::fprintf(f, "    \"occlusion\": %s,\n", options.occlusion ? "true" : "false");
+    std::fprintf(f, "    \"lod\": %s,\n", options.lod ? "true" : "false");
+    std::fprintf(f, "    \"lights\": %d,\n", options.lights);
+    std::fprintf(f, "    \"shadow_cascades\": %d,\n", options.shadows);
+    std::fprintf(f, "    \"shadow_cache\": %s,\n", options.shadowCache ? "true" : "false");
+    std::fprintf(f, "    \"stream_buffer\": \"%s\",\n", stream.isPersistent() ? "persistent" : "unsynchronized");
+    std::fprintf(f, "    \"stream_stalls\": %u,\n", stream.getStallCount());
+    std::fprintf(f, "    \"warmup_frames\": %d,\n    \"frames\": %d\n  },\n", options.warmupFrames, options.frames);
+    std::fprintf(f, "  \"summary\": {\n");
+    writeStatsJson(f, "cpu_ms", cpu, false);
+    writeStatsJson(f, "gpu_ms", gpu, false);
+    writeStatsJson(f, "frame_ms", frame, false);
+    writeStatsJson(f, "cull_ms", cull, false);
+    writeStatsJson(f, "occlusion_ms", occlusion, false);
+    writeStatsJson(f, "light_ms", light, false);
+    writeStatsJson(f, "shadow_ms", shadow, true);
+    std::fprintf(f, "  },\n  \"frames\": [\n");
+    for (size_t i = 0; i < timings.size(); ++i) {
+        const FrameTiming& t = timings[i];
+        std::fprintf(f, "    {\"frame\": %d, \"cpu_ms\": %.4f, \"gpu_ms\": %.4f, \"frame_ms\": %.4f, \"cull_ms\": %.4f,"
+                        " \"occlusion_ms\": %.4f, \"light_ms\": %.4f, \"shadow_ms\": %.4f, \"shadow_cascades_redrawn\": %u,"
+                        " \"visible\": %zu, \"triangles\": %zu, \"dumped\": %s}%s\n",
+                     t.frame, t.cpuMs, t.gpuMs, t.frameMs, t.cullMs, t.occlusionMs, t.lightMs, t.shadowMs, t.shadows.cascadesRendered,
+                     t.visible, t.triangles, t.dumped ? "true" : "false",
+                     i + 1 < timings.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    HeadlessOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    HeadlessContext glContext;
+    if (!glContext.init()) return -1;
+    std::cout << "Headless context (" << glContext.getSurfaceMode() << "): "
+              << reinterpret_cast<const char*>(glGetString(GL_RENDERER)) << ", OpenGL "
+              << reinterpret_cast<const char*>(glGetString(GL_VERSION)) << std::endl;
+
+    // Scope GL objects so they are released while the context is still current.
+    {
+        Renderer renderer;
+        renderer.setShaderCacheDirectory(options.shaderCacheDir);
+        const auto initStart = std::chrono::steady_clock::now();
+        if (!renderer.init()) { std::cerr << "Renderer init failed" << std::endl; return -1; }
+        const ShaderCache& shaderCache = renderer.getShaderCache();
+        std::printf("Renderer init: %.2f ms (%zu shader variants; shader cache %s: %u hits, %u misses)\n",
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - initStart).count(),
+                    renderer.getShaderLibrary().getVariantCount(), shaderCache.isEnabled() ? "on" : "off",
+                    shaderCache.getHits(), shaderCache.getMisses());
+
+        World world;
+        SceneGraph graph;
+        // Sphere LODs: each level halves the tessellation, error from the chord sagitta.
+        LODGroup sphereLevels;
+        for (uint32_t segments = 32; segments >= 4; segments /= 2) {
+            sphereLevels.addLevel(renderer.createMesh(MeshData::sphere(segments, segments / 2)),
+                                  segments == 32 ? 0.0f : MeshData::sphereError(segments, segments / 2));
+        }
+        LODSelector lodSelector;
+        std::vector<Entity> wallEntities;
+        // Only the shader features the run uses: unlit runs skip the light loop, and without LOD
+        // selection there is no cross-fade discard.
+        ShaderLibrary& shaderLibrary = renderer.getShaderLibrary();
+        uint32_t features = 0;
+        if (options.lights > 0 || options.shadows > 0) features |= shaderLibrary.getFeatureBit(Renderer::DEFAULT_SHADER, "LIGHTING");
+        if (options.shadows > 0) features |= shaderLibrary.getFeatureBit(Renderer::DEFAULT_SHADER, "SHADOWS");
+        if (options.lod) features |= shaderLibrary.getFeatureBit(Renderer::DEFAULT_SHADER, "LOD_FADE");
+        MaterialHandle material = renderer.createMaterialVariant(Renderer::DEFAULT_SHADER, features);
+        if (material == INVALID_RENDER_HANDLE || renderer.finishShaderCompiles() != 0) {
+            std::cerr << "Falling back to the default material." << std::endl;
+            material = renderer.getDefaultMaterial();
+        }
+        // Streamed textures: a tile pattern per file, at 1024 or 512 texels so budgets are easy to hit.
+        std::vector<MaterialHandle> cubeMaterials;
+        if (options.textures > 0) {
+            TextureStreamerSettings streamSettings = renderer.getTextureStreamer().getSettings();
+            streamSettings.vramBudgetBytes = static_cast<size_t>(options.textureBudgetMB) << 20;
+            renderer.getTextureStreamer().setSettings(streamSettings);
+            std::filesystem::create_directories("headless_textures");
+            const uint32_t textureFeature = shaderLibrary.getFeatureBit(Renderer::DEFAULT_SHADER, "TEXTURE");
+            for (int i = 0; i < options.textures; ++i) {
+                std::string path = "headless_textures/tiles_" + std::to_string(i) + ".ppm";
+                if (!std::filesystem::exists(path)) writeTestTexture(path, i % 2 == 0 ? 1024 : 512, static_cast<uint32_t>(i));
+                if (options.textureFormat != ImageFormat::RGBA8) {
+                    const std::string cookedPath = "headless_textures/tiles_" + std::to_string(i) + "_" +
+                                                   Image::getFormatName(options.textureFormat) + ".setex";
+                    Image source, cooked;
+                    if (!std::filesystem::exists(cookedPath) && source.load(path)) {
+                        source.generateMips();
+                        TextureCompressor::compress(source, options.textureFormat, cooked);
+                        cooked.saveCooked(cookedPath);
+                    }
+                    path = cookedPath;
+                }
+                const MaterialHandle textured = renderer.createMaterialVariant(Renderer::DEFAULT_SHADER, features | textureFeature);
+                if (textured == INVALID_RENDER_HANDLE) break;
+                renderer.setMaterialTexture(textured, renderer.getTextureStreamer().load(path));
+                cubeMaterials.push_back(textured);
+            }
+        }
+        // Cooked meshes are mapped and uploaded as they are; source files go through the importer.
+        MeshHandle gridMesh = INVALID_RENDER_HANDLE;
+        float gridMeshScale = 1.0f;
+        if (!options.meshPath.empty()) {
+            const auto loadStart = std::chrono::steady_clock::now();
+            const bool cooked = std::filesystem::path(options.meshPath).extension() == ".semesh";
+            if (cooked) {
+                gridMesh = renderer.loadMesh(options.meshPath);
+            } else {
+                ThreadPool importPool(ThreadPool::defaultWorkerCount());
+                MeshData imported;
+                PackedMeshData packed;
+                if (MeshImporter::importFile(options.meshPath, imported, &importPool)) {
+                    MeshOptimizer::optimize(imported);
+                    if (MeshOptimizer::quantize(imported, packed) && MeshletBuilder::build(MeshDataView(packed), packed.meshlets, &importPool)) {
+                        gridMesh = renderer.createMesh(MeshDataView(packed));
+                    }
+                }
+            }
+            if (gridMesh == INVALID_RENDER_HANDLE) return -1;
+            const MeshBounds& bounds = renderer.getMeshManager().getBounds(gridMesh);
+            gridMeshScale = bounds.sphere.radius > 0.0f ? 0.5f / bounds.sphere.radius : 1.0f;
+            std::printf("Mesh %s: %s in %.2f ms (%u triangles, %zu meshlets)\n", options.meshPath.c_str(), cooked ? "mapped" : "imported",
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count(),
+                        renderer.getMeshManager().getDrawInfo(gridMesh).indexCount / 3, renderer.getMeshManager().getMeshlets(gridMesh).size());
+            renderer.setMeshletCulling(static_cast<MeshletCulling>(options.meshletCull));
+        }
+        Entity spinner = buildScene(world, graph, renderer, material, cubeMaterials, options.extraObjects, options.walls, options.lights,
+                                    sphereLevels, gridMesh, gridMeshScale, wallEntities);
+
+        Camera camera(Vec3(0.0f, 2.0f, 7.0f), Vec3(0.0f, 0.5f, 0.0f));
+        Framebuffer framebuffer(options.width, options.height);
+        ThreadPool threadPool(static_cast<size_t>(options.threads - 1));
+        RenderQueue renderQueue(threadPool.getThreadCount());
+        FrustumCuller culler;
+        std::vector<uint32_t> visibleSlots;
+        const MeshManager& meshManager = renderer.getMeshManager();
+        OcclusionCuller occlusionCuller;
+        const uint32_t wallOccluder = occlusionCuller.addOccluderMesh(MeshData::cube());
+        std::vector<uint8_t> occluded;
+        LightClusterer lightClusterer;
+        // The sun: a directional light from above and behind the camera's start, and its cascades.
+        ShadowCascades shadowCascades;
+        RenderQueue staticCasters, dynamicCasters;
+        std::vector<uint32_t> casterSlots;
+        if (options.shadows > 0) {
+            const Vec3 sunDirection(-0.45f, -1.0f, -0.35f);
+            renderer.setDirectionalLight(sunDirection, Vec3(0.9f, 0.85f, 0.75f));
+            ShadowSettings shadowSettings;
+            shadowSettings.cascadeCount = static_cast<uint32_t>(options.shadows);
+            shadowSettings.resolution = static_cast<uint32_t>(options.shadowSize);
+            if (!options.shadowCache) shadowSettings.firstCachedCascade = ShadowCascades::MAX_CASCADES;
+            shadowCascades.setSettings(shadowSettings);
+            shadowCascades.setLightDirection(sunDirection);
+        }
+
+        Profiler& profiler = Profiler::get();
+        profiler.setEnabled(options.profile);
+        GpuProfiler gpuProfiler;
+        if (options.profile && !gpuProfiler.init()) return -1;
+
+        GLuint gpuQueries[GPU_QUERY_LATENCY];
+        glGenQueries(GPU_QUERY_LATENCY, gpuQueries);
+
+        using Clock = std::chrono::steady_clock;
+        const int totalFrames = options.warmupFrames + options.frames;
+        std::vector<FrameTiming> timings;
+        timings.reserve(totalFrames);
+        if (!options.dumpDir.empty()) {
+            std::error_code error;
+            std::filesystem::create_directories(options.dumpDir, error);
+            if (error) std::cerr << "ERROR::HEADLESS::DUMP: Could not create " << options.dumpDir << ": " << error.message() << std::endl;
+        }
+        Clock::time_point frameStart = Clock::now();
+
+        for (int frame = 0; frame < totalFrames; ++frame) {
+            profiler.beginFrame();
+            gpuProfiler.beginFrame(profiler.getFrameIndex());
+            // Deterministic animation: orbit the camera and spin the root of the demo hierarchy.
+            camera.yaw -= 1.0f; camera.updateCameraVectors(); // 1 degree per frame
+            Transform* spin = world.get<Transform>(spinner);
+            spin->rotation = Quat::fromAxisAngle(Vec3(0.0f, 1.0f, 0.0f), static_cast<float>(frame) * 0.02f);
+            graph.markDirty(spinner);
+
+            GLuint query = gpuQueries[frame % GPU_QUERY_LATENCY];
+            glBeginQuery(GL_TIME_ELAPSED, query);
+
+            framebuffer.bind(); gpuProfiler.beginScope("Scene Pass"); glEnable(GL_DEPTH_TEST);
+            glClearColor(0.1f, 0.12f, 0.15f, 1.0f); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Mat4 vM = camera.getViewMatrix();
+            Mat4 pM = camera.getProjectionMatrix(static_cast<float>(options.width) / static_cast<float>(options.height));
+            {
+                PROFILE_SCOPE("Scene Update");
+                graph.update(world);
+            }
+            const Mat4* worldMatrices = graph.getWorldMatrices();
+
+            // World-space bounds of every drawable node, then the frustum test over all of them.
+            Clock::time_point cullStart = Clock::now();
+            {
+                PROFILE_SCOPE("Frustum Culling");
+                culler.resize(graph.size());
+                threadPool.parallelFor(graph.size(), 1024, [&](size_t begin, size_t end, size_t) {
+                    for (size_t slot = begin; slot < end; ++slot) {
+                        const MeshRenderer* meshRenderer = world.get<MeshRenderer>(graph.getEntityAt(slot));
+                        if (!meshRenderer) { culler.setBounds(slot, BoundingSphere()); continue; }
+                        const MeshBounds& bounds = meshManager.getBounds(meshRenderer->mesh);
+                        culler.setBounds(slot, bounds.box, bounds.sphere, worldMatrices[slot]);
+                    }
+                });
+                if (options.cull) {
+                    culler.cull(Frustum::fromMatrix(pM * vM), visibleSlots);
+                } else {
+                    visibleSlots.resize(graph.size());
+                    for (size_t slot = 0; slot < graph.size(); ++slot) visibleSlots[slot] = static_cast<uint32_t>(slot);
+                }
+            }
+            const double cullMs = std::chrono::duration<double, std::milli>(Clock::now() - cullStart).count();
+
+            // Rasterize the walls into the CPU depth buffer and drop the objects hidden behind them.
+            Clock::time_point occlusionStart = Clock::now();
+            if (options.occlusion && !wallEntities.empty()) {
+                PROFILE_SCOPE("Occlusion Culling");
+                occlusionCuller.beginFrame(pM * vM);
+                for (Entity wall : wallEntities) occlusionCuller.addOccluder(wallOccluder, graph.getWorldMatrix(wall));
+                occlusionCuller.render(&threadPool);
+                occluded.resize(visibleSlots.size());
+                threadPool.parallelFor(visibleSlots.size(), 1024, [&](size_t begin, size_t end, size_t) {
+                    for (size_t i = begin; i < end; ++i) {
+                        const MeshRenderer* meshRenderer = world.get<MeshRenderer>(graph.getEntityAt(visibleSlots[i]));
+                        occluded[i] = meshRenderer && !occlusionCuller.isVisible(
+                            meshManager.getBounds(meshRenderer->mesh).box.transformed(worldMatrices[visibleSlots[i]]));
+                    }
+                });
+                size_t kept = 0;
+                for (size_t i = 0; i < visibleSlots.size(); ++i) {
+                    visibleSlots[kept] = visibleSlots[i];
+                    kept += occluded[i] ? 0 : 1;
+                }
+                visibleSlots.resize(kept);
+            }
+            const double occlusionMs = std::chrono::duration<double, std::milli>(Clock::now() - occlusionStart).count();
+
+            // LOD selection for what is left; fixed 60 Hz time step so fades are deterministic.
+            if (options.lod) {
+                PROFILE_SCOPE("LOD Selection");
+                lodSelector.setView(camera.position, camera.fov, options.height);
+                lodSelector.updateVisible(world, graph, visibleSlots, 1.0f / 60.0f, &threadPool);
+            }
+
+            renderer.beginFrame(vM, pM);
+            // Bin the lights into the camera's clusters (unlit without lights).
+            Clock::time_point lightStart = Clock::now();
+            if (options.lights > 0 || options.shadows > 0) {
+                PROFILE_SCOPE("Light Clustering");
+                lightClusterer.setView(vM, pM, options.width, options.height);
+                lightClusterer.gatherLights(world, graph);
+                lightClusterer.build(&threadPool);
+                renderer.setLights(lightClusterer);
+            }
+            const double lightMs = std::chrono::duration<double, std::milli>(Clock::now() - lightStart).count();
+            // Shadow cascades: each draws the casters inside its own light-space volume. Static
+            // casters are only gathered for cascades that will redraw them.
+            Clock::time_point shadowStart = Clock::now();
+            if (options.shadows > 0) {
+                PROFILE_SCOPE("Shadows");
+                shadowCascades.update(vM, pM);
+                for (uint32_t c = 0; c < shadowCascades.getCascadeCount(); ++c) {
+                    const bool drawStatic = shadowCascades.needsStaticRender(c);
+                    culler.cull(shadowCascades.getCascade(c).casterFrustum, casterSlots);
+                    for (uint32_t slot : casterSlots) {
+                        const MeshRenderer* meshRenderer = world.get<MeshRenderer>(graph.getEntityAt(slot));
+                        if (!meshRenderer || meshRenderer->shadowCasting == ShadowCasting::None) continue;
+                        const bool isStatic = meshRenderer->shadowCasting == ShadowCasting::Static;
+                        if (isStatic && !drawStatic) continue;
+                        RenderQueue& casters = isStatic ? staticCasters : dynamicCasters;
+                        casters.getBucket(0).push(renderer.makeShadowSortKey(meshRenderer->mesh), worldMatrices[slot]);
+                    }
+                    renderer.renderShadowCascade(shadowCascades, c, staticCasters, dynamicCasters, &threadPool);
+                }
+                renderer.setShadows(shadowCascades);
+            }
+            const double shadowMs = std::chrono::duration<double, std::milli>(Clock::now() - shadowStart).count();
+            // Record draw commands for the visible nodes in parallel, one queue bucket per pool thread.
+            {
+                PROFILE_SCOPE("Record Commands");
+                threadPool.parallelFor(visibleSlots.size(), 1024, [&](size_t begin, size_t end, size_t threadIndex) {
+                    RenderBucket& bucket = renderQueue.getBucket(threadIndex);
+                    for (size_t i = begin; i < end; ++i) {
+                        const uint32_t slot = visibleSlots[i];
+                        const Entity entity = graph.getEntityAt(slot);
+                        const MeshRenderer* meshRenderer = world.get<MeshRenderer>(entity);
+                        if (!meshRenderer) continue;
+                        const LODGroup* lod = world.get<LODGroup>(entity);
+                        if (lod && lod->isFading()) {
+                            // Cross-fade: both levels, complementary dither patterns.
+                            bucket.push(renderer.makeSortKey(lod->previousMesh(), meshRenderer->material, worldMatrices[slot]),
+                                        worldMatrices[slot], lod->outgoingFade());
+                            bucket.push(renderer.makeSortKey(meshRenderer->mesh, meshRenderer->material, worldMatrices[slot]),
+                                        worldMatrices[slot], lod->incomingFade());
+                            continue;
+                        }
+                        bucket.push(renderer.makeSortKey(meshRenderer->mesh, meshRenderer->material, worldMatrices[slot]),
+                                    worldMatrices[slot]);
+                    }
+                });
+            }
+            renderer.flush(renderQueue, &threadPool);
+            gpuProfiler.endScope();
+            framebuffer.unbind();
+
+            glEndQuery(GL_TIME_ELAPSED);
+            gpuProfiler.endFrame();
+            profiler.endFrame();
+            glFlush();
+            double cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+            FrameTiming timing = { frame - options.warmupFrames, cpuMs, 0.0, 0.0, cullMs, occlusionMs, lightMs, shadowMs,
+                                  visibleSlots.size(), renderer.getLastFlushStats().triangles, renderer.getLastFlushStats().meshletsTested,
+                                  renderer.getLastFlushStats().meshletsVisible, renderer.getShadowStats(), false };
+            const bool lastFrame = (frame + 1 == totalFrames);
+            if (!options.dumpDir.empty() && frame >= options.warmupFrames) {
+                int recorded = frame - options.warmupFrames;
+                if ((options.dumpEvery > 0 && recorded % options.dumpEvery == 0) || lastFrame) {
+                    char name[32];
+                    std::snprintf(name, sizeof(name), "/frame_%05d.ppm", recorded);
+                    timing.dumped = dumpFramePPM(framebuffer, options.dumpDir + name);
+                }
+            }
+            timings.push_back(timing);
+
+            // Collect the GPU time of the frame that used this query slot GPU_QUERY_LATENCY-1 frames ago.
+            int readFrame = frame - (GPU_QUERY_LATENCY - 1);
+            if (readFrame >= 0) {
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(gpuQueries[readFrame % GPU_QUERY_LATENCY], GL_QUERY_RESULT, &ns);
+                timings[readFrame].gpuMs = static_cast<double>(ns) / 1e6;
+            }
+
+            Clock::time_point nextStart = Clock::now();
+            timings[frame].frameMs = std::chrono::duration<double, std::milli>(nextStart - frameStart).count();
+            frameStart = nextStart;
+        }
+        // Drain the queries still in flight.
+        for (int readFrame = std::max(0, totalFrames - (GPU_QUERY_LATENCY - 1)); readFrame < totalFrames; ++readFrame) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(gpuQueries[readFrame % GPU_QUERY_LATENCY], GL_QUERY_RESULT, &ns);
+            timings[readFrame].gpuMs = static_cast<double>(ns) / 1e6;
+        }
+        glDeleteQueries(GPU_QUERY_LATENCY, gpuQueries);
+
+        // Drop warm-up frames from the results.
+        timings.erase(timings.begin(), timings.begin() + options.warmupFrames);
+        std::vector<double> cpu, gpu, frameTimes, cullTimes, occlusionTimes, lightTimes, shadowTimes;
+        double visibleSum = 0.0, triangleSum = 0.0, meshletSum = 0.0, visibleMeshletSum = 0.0;
+        ShadowStats shadowSum;
+        for (const FrameTiming& t : timings) {
+            shadowSum.cascadesRendered += t.shadows.cascadesRendered;
+            shadowSum.cascadesCopied += t.shadows.cascadesCopied;
+            shadowSum.cascadesKept += t.shadows.cascadesKept;
+            shadowSum.drawCalls += t.shadows.drawCalls;
+            shadowSum.casters += t.shadows.casters;
+            shadowSum.triangles += t.shadows.triangles;
+            visibleSum += static_cast<double>(t.visible);
+            triangleSum += static_cast<double>(t.triangles);
+            meshletSum += static_cast<double>(t.meshletsTested);
+            visibleMeshletSum += static_cast<double>(t.meshletsVisible);
+            if (t.dumped) continue; // Readback stalls would skew the statistics
+            cpu.push_back(t.cpuMs); gpu.push_back(t.gpuMs); frameTimes.push_back(t.frameMs); cullTimes.push_back(t.cullMs);
+            occlusionTimes.push_back(t.occlusionMs); lightTimes.push_back(t.lightMs); shadowTimes.push_back(t.shadowMs);
+        }
+        TimingStats cpuStats = computeStats(cpu), gpuStats = computeStats(gpu), frameStats = computeStats(frameTimes);
+        TimingStats cullStats = computeStats(cullTimes), occlusionStats = computeStats(occlusionTimes);
+        TimingStats lightStats = computeStats(lightTimes), shadowStats = computeStats(shadowTimes);
+
+        const unsigned int drawCalls = renderer.getLastFlushStats().drawCalls;
+        std::printf("%d frames at %dx%d, %zu objects, %u draw calls per frame\n",
+                    options.frames, options.width, options.height, graph.size(), drawCalls);
+        std::printf("  cpu   mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f\n", cpuStats.mean, cpuStats.p50, cpuStats.p95, cpuStats.max);
+        std::printf("  gpu   mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f\n", gpuStats.mean, gpuStats.p50, gpuStats.p95, gpuStats.max);
+        std::printf("  frame mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f\n", frameStats.mean, frameStats.p50, frameStats.p95, frameStats.max);
+        std::printf("  cull  mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f  (%.0f of %zu visible)\n", cullStats.mean, cullStats.p50,
+                    cullStats.p95, cullStats.max, timings.empty() ? 0.0 : visibleSum / static_cast<double>(timings.size()), graph.size());
+        std::printf("  %.0f triangles per frame (LOD %s)\n", timings.empty() ? 0.0 : triangleSum / static_cast<double>(timings.size()),
+                    options.lod ? "on" : "off");
+        if (meshletSum > 0.0) {
+            std::printf("  %.0f of %.0f meshlets per frame visible (%.1f%%)\n", visibleMeshletSum / static_cast<double>(timings.size()),
+                        meshletSum / static_cast<double>(timings.size()), 100.0 * visibleMeshletSum / meshletSum);
+        }
+        if (options.occlusion && !wallEntities.empty()) {
+            std::printf("  occl  mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f  (%zu walls, %dx%d depth buffer)\n", occlusionStats.mean,
+                        occlusionStats.p50, occlusionStats.p95, occlusionStats.max, wallEntities.size(),
+                        occlusionCuller.getWidth(), occlusionCuller.getHeight());
+        }
+        if (options.lights > 0) {
+            std::printf("  light mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f  (%zu lights, %zu cluster entries, max %u per cluster)\n",
+                        lightStats.mean, lightStats.p50, lightStats.p95, lightStats.max, lightClusterer.getLightCount(),
+                        lightClusterer.getLightIndices().size(), lightClusterer.getMaxLightsPerCluster());
+        }
+        if (options.shadows > 0 && !timings.empty()) {
+            const double frames = static_cast<double>(timings.size());
+            std::printf("  shadow mean %.3f ms  p50 %.3f  p95 %.3f  max %.3f  (%d cascades at %d^2%s)\n", shadowStats.mean, shadowStats.p50,
+                        shadowStats.p95, shadowStats.max, options.shadows, options.shadowSize, options.shadowCache ? ", distant ones cached" : "");
+            std::printf("  per frame: %.2f cascades redrawn, %.2f copied, %.2f kept; %.1f draw calls, %.0f casters, %.0f triangles\n",
+                        shadowSum.cascadesRendered / frames, shadowSum.cascadesCopied / frames, shadowSum.cascadesKept / frames,
+                        shadowSum.drawCalls / frames, shadowSum.casters / frames, static_cast<double>(shadowSum.triangles) / frames);
+        }
+        if (options.profile) {
+            // CPU time summed over threads; 'wall' and 'thr' show scopes that ran on several at once.
+            std::printf("  %-28s %9s %9s %9s %9s %9s %4s\n", "scope (ms per frame)", "avg", "p95", "p99", "max", "wall", "thr");
+            for (const Profiler::ScopeStats& s : profiler.getStats()) {
+                std::printf("  %*s%s%-*s %9.3f %9.3f %9.3f %9.3f %9.3f %4u\n", static_cast<int>(s.depth * 2), "", s.gpu ? "GPU " : "",
+                            28 - static_cast<int>(s.depth * 2) - (s.gpu ? 4 : 0), s.name.c_str(), s.averageMs, s.p95Ms, s.p99Ms, s.maxMs,
+                            s.averageWallMs, s.threads);
+            }
+        }
+        const StreamBuffer& stream = renderer.getFrameStream();
+        std::printf("  stream buffer %s, %zu KB per frame, %u stalls\n", stream.isPersistent() ? "persistent" : "unsynchronized",
+                    stream.getBytesPerFrame() / 1024, stream.getStallCount());
+        if (options.textures > 0) {
+            const TextureStreamerStats& textureStats = renderer.getTextureStreamer().getStats();
+            std::printf("  textures: %zu streamed, %.1f of %d MB resident, %zu evictions, %zu decoding, %zu failed\n",
+                        textureStats.textures, textureStats.residentBytes / (1024.0 * 1024.0), options.textureBudgetMB,
+                        textureStats.evictions, textureStats.decoding, textureStats.failed);
+        }
+
+        if (!options.timingsPath.empty() &&
+            !writeTimingsJson(options.timingsPath, options, glContext.getSurfaceMode(), graph.size(), drawCalls,
+                              renderer.getFrameStream(), timings, cpuStats, gpuStats, frameStats, cullStats, occlusionStats,
+                              lightStats, shadowStats)) {
+            return 1;
+        }
+    }
+    return 0;
+}
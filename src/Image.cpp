@@ -0,0 +1,316 @@
+// Image.cpp
+// PPM/PGM and TGA decoding, the cooked texture container, PPM writing and mip generation.
+
+#include "MyFirstEngine/Image.h"
+#include <algorithm> // For std::max, std::min
+#include <cstdio>    // For std::FILE, std::rename
+#include <cstring>   // For std::memcpy
+#include <iostream>  // For std::cerr (error output)
+
+// Largest accepted side; larger files are rejected rather than allocating gigabytes.
+static const uint32_t MAX_IMAGE_SIZE = 16384;
+
+// Cooked texture header; the level data follows it directly.
+struct CookedHeader {
+    uint32_t magic;      // COOKED_MAGIC
+    uint32_t version;    // COOKED_VERSION
+    uint32_t format;     // ImageFormat
+    uint32_t width;      // Level 0
+    uint32_t height;
+    uint32_t levelCount; // At most fullLevelCount(width, height)
+};
+static const uint32_t COOKED_MAGIC = 0x58544553; // "SETX"
+static const uint32_t COOKED_VERSION = 1;
+
+static bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    bool ok = size > 0;
+    if (ok) {
+        bytes.resize(static_cast<size_t>(size));
+        ok = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Next whitespace-separated unsigned integer of a PNM header, skipping '#' comments.
+static bool readHeaderNumber(const std::vector<uint8_t>& bytes, size_t& pos, uint32_t& value) {
+    while (pos < bytes.size()) {
+        if (bytes[pos] == '#') {
+            while (pos < bytes.size() && bytes[pos] != '\n') ++pos;
+        } else if (bytes[pos] == ' ' || bytes[pos] == '\t' || bytes[pos] == '\r' || bytes[pos] == '\n') {
+            ++pos;
+        } else {
+            break;
+        }
+    }
+    if (pos >= bytes.size() || bytes[pos] < '0' || bytes[pos] > '9') return false;
+    uint64_t number = 0;
+    while (pos < bytes.size() && bytes[pos] >= '0' && bytes[pos] <= '9') {
+        number = number * 10 + static_cast<uint64_t>(bytes[pos++] - '0');
+        if (number > 0xFFFFFFFFull) return false;
+    }
+    value = static_cast<uint32_t>(number);
+    return true;
+}
+
+static bool decodePNM(const std::vector<uint8_t>& bytes, ImageLevel& level) {
+    const uint32_t channels = bytes[1] == '6' ? 3 : 1;
+    size_t pos = 2;
+    uint32_t width = 0, height = 0, maxValue = 0;
+    if (!readHeaderNumber(bytes, pos, width) || !readHeaderNumber(bytes, pos, height) ||
+        !readHeaderNumber(bytes, pos, maxValue) || maxValue != 255) return false;
+    ++pos; // Single whitespace before the pixels
+    if (width == 0 || height == 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE) return false;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (bytes.size() < pos + pixelCount * channels) return false;
+
+    level.width = width;
+    level.height = height;
+    level.pixels.resize(pixelCount * 4);
+    const uint8_t* src = bytes.data() + pos;
+    uint8_t* dst = level.pixels.data();
+    for (size_t i = 0; i < pixelCount; ++i, src += channels, dst += 4) {
+        dst[0] = src[0];
+        dst[1] = src[channels == 3 ? 1 : 0];
+        dst[2] = src[channels == 3 ? 2 : 0];
+        dst[3] = 255;
+    }
+    return true;
+}
+
+static bool decodeTGA(const std::vector<uint8_t>& bytes, ImageLevel& level) {
+    if (bytes.size() < 18) return false;
+    const uint8_t idLength = bytes[0];
+    const uint8_t colorMapType = bytes[1];
+    const uint8_t imageType = bytes[2];
+    const uint32_t width = bytes[12] | (bytes[13] << 8);
+    const uint32_t height = bytes[14] | (bytes[15] << 8);
+    const uint32_t bitsPerPixel = bytes[16];
+    const bool topDown = (bytes[17] & 0x20) != 0;
+    const bool rle = imageType == 10 || imageType == 11;
+    const bool gray = imageType == 3 || imageType == 11;
+    if (colorMapType != 0 || (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11)) return false;
+    if (gray ? bitsPerPixel != 8 : (bitsPerPixel != 24 && bitsPerPixel != 32)) return false;
+    if (width == 0 || height == 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE) return false;
+
+    const uint32_t channels = bitsPerPixel / 8;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    size_t pos = 18 + idLength;
+    level.width = width;
+    level.height = height;
+    level.pixels.resize(pixelCount * 4);
+
+    // Pixels in file order (BGR(A) or gray), expanded to RGBA; rows flipped afterwards if needed.
+    auto writePixel = [&](size_t index, const uint8_t* src) {
+        uint8_t* dst = &level.pixels[index * 4];
+        if (gray) {
+            dst[0] = dst[1] = dst[2] = src[0];
+            dst[3] = 255;
+        } else {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            dst[3] = channels == 4 ? src[3] : 255;
+        }
+    };
+    size_t index = 0;
+    while (index < pixelCount) {
+        if (!rle) {
+            if (pos + channels > bytes.size()) return false;
+            writePixel(index++, &bytes[pos]);
+            pos += channels;
+            continue;
+        }
+        if (pos >= bytes.size()) return false;
+        const uint8_t packet = bytes[pos++];
+        const size_t runLength = std::min<size_t>((packet & 0x7F) + 1, pixelCount - index);
+        if (packet & 0x80) { // One pixel repeated
+            if (pos + channels > bytes.size()) return false;
+            for (size_t i = 0; i < runLength; ++i) writePixel(index++, &bytes[pos]);
+            pos += channels;
+        } else {
+            if (pos + runLength * channels > bytes.size()) return false;
+            for (size_t i = 0; i < runLength; ++i, pos += channels) writePixel(index++, &bytes[pos]);
+        }
+    }
+
+    // TGA rows are bottom-up unless flagged; images here are stored top row first, like PPM.
+    if (!topDown) {
+        const size_t rowBytes = static_cast<size_t>(width) * 4;
+        std::vector<uint8_t> row(rowBytes);
+        for (uint32_t y = 0; y < height / 2; ++y) {
+            uint8_t* a = &level.pixels[y * rowBytes];
+            uint8_t* b = &level.pixels[(height - 1 - y) * rowBytes];
+            std::memcpy(row.data(), a, rowBytes);
+            std::memcpy(a, b, rowBytes);
+            std::memcpy(b, row.data(), rowBytes);
+        }
+    }
+    return true;
+}
+
+static bool decodeCooked(const std::vector<uint8_t>& bytes, Image& image) {
+    CookedHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.version != COOKED_VERSION || header.format > static_cast<uint32_t>(ImageFormat::BC7)) return false;
+    if (header.width == 0 || header.height == 0 || header.width > MAX_IMAGE_SIZE || header.height > MAX_IMAGE_SIZE) return false;
+    if (header.levelCount == 0 || header.levelCount > Image::fullLevelCount(header.width, header.height)) return false;
+
+    image.format = static_cast<ImageFormat>(header.format);
+    image.levels.resize(header.levelCount);
+    size_t pos = sizeof(header);
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        ImageLevel& level = image.levels[i];
+        level.width = std::max(header.width >> i, 1u);
+        level.height = std::max(header.height >> i, 1u);
+        const size_t size = image.getRowBytes(i) * image.getRowCount(i);
+        if (bytes.size() < pos + size) return false;
+        level.pixels.assign(bytes.begin() + static_cast<std::ptrdiff_t>(pos), bytes.begin() + static_cast<std::ptrdiff_t>(pos + size));
+        pos += size;
+    }
+    return true;
+}
+
+size_t Image::getByteSize(uint32_t firstLevel) const {
+    size_t bytes = 0;
+    for (uint32_t i = firstLevel; i < levels.size(); ++i) bytes += levels[i].pixels.size();
+    return bytes;
+}
+
+bool Image::load(const std::string& path) {
+    levels.clear();
+    format = ImageFormat::RGBA8;
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes)) {
+        std::cerr << "ERROR::IMAGE::LOAD: Cannot read '" << path << "'." << std::endl;
+        return false;
+    }
+    if (bytes.size() >= sizeof(CookedHeader) && std::memcmp(bytes.data(), &COOKED_MAGIC, sizeof(COOKED_MAGIC)) == 0) {
+        if (decodeCooked(bytes, *this)) return true;
+        levels.clear();
+        format = ImageFormat::RGBA8;
+        std::cerr << "ERROR::IMAGE::LOAD: '" << path << "' is a truncated or unsupported cooked texture." << std::endl;
+        return false;
+    }
+    ImageLevel level;
+    bool decoded = false;
+    if (bytes.size() > 2 && bytes[0] == 'P' && (bytes[1] == '5' || bytes[1] == '6')) {
+        decoded = decodePNM(bytes, level);
+    } else {
+        decoded = decodeTGA(bytes, level);
+    }
+    if (!decoded) {
+        std::cerr << "ERROR::IMAGE::LOAD: '" << path << "' is not a supported PPM/PGM/TGA image." << std::endl;
+        return false;
+    }
+    levels.push_back(std::move(level));
+    return true;
+}
+
+bool Image::savePPM(const std::string& path, uint32_t level) const {
+    if (level >= levels.size() || isCompressed()) return false;
+    const ImageLevel& source = levels[level];
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::IMAGE::SAVE_PPM: Cannot write '" << path << "'." << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%u %u\n255\n", source.width, source.height);
+    std::vector<uint8_t> rgb(static_cast<size_t>(source.width) * source.height * 3);
+    for (size_t i = 0, n = rgb.size() / 3; i < n; ++i) {
+        rgb[i * 3 + 0] = source.pixels[i * 4 + 0];
+        rgb[i * 3 + 1] = source.pixels[i * 4 + 1];
+        rgb[i * 3 + 2] = source.pixels[i * 4 + 2];
+    }
+    const bool ok = std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+bool Image::saveCooked(const std::string& path) const {
+    if (levels.empty()) return false;
+    CookedHeader header;
+    header.magic = COOKED_MAGIC;
+    header.version = COOKED_VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.width = getWidth();
+    header.height = getHeight();
+    header.levelCount = getLevelCount();
+
+    const std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::IMAGE::SAVE_COOKED: Cannot write '" << temporaryPath << "'." << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const ImageLevel& level : levels) {
+        ok = ok && std::fwrite(level.pixels.data(), 1, level.pixels.size(), file) == level.pixels.size();
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        std::cerr << "ERROR::IMAGE::SAVE_COOKED: Failed to write '" << path << "'." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* Image::getFormatName(ImageFormat format) {
+    switch (format) {
+    case ImageFormat::RGBA8: return "rgba8";
+    case ImageFormat::BC1: return "bc1";
+    case ImageFormat::BC3: return "bc3";
+    case ImageFormat::BC5: return "bc5";
+    case ImageFormat::BC7: return "bc7";
+    }
+    return "unknown";
+}
+
+bool Image::parseFormat(const std::string& name, ImageFormat& format) {
+    for (uint32_t i = 0; i <= static_cast<uint32_t>(ImageFormat::BC7); ++i) {
+        if (name == getFormatName(static_cast<ImageFormat>(i))) {
+            format = static_cast<ImageFormat>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Image::fullLevelCount(uint32_t width, uint32_t height) {
+    uint32_t count = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1) ++count;
+    return count;
+}
+
+void Image::generateMips() {
+    if (levels.empty() || isCompressed()) return;
+    levels.resize(1);
+    const uint32_t count = fullLevelCount(levels[0].width, levels[0].height);
+    levels.reserve(count);
+    for (uint32_t i = 1; i < count; ++i) {
+        const ImageLevel& src = levels[i - 1];
+        ImageLevel dst;
+        dst.width = std::max(src.width / 2, 1u);
+        dst.height = std::max(src.height / 2, 1u);
+        dst.pixels.resize(static_cast<size_t>(dst.width) * dst.height * 4);
+        // 2x2 box filter; a side that is already 1 (or odd at the edge) reuses its last texel.
+        for (uint32_t y = 0; y < dst.height; ++y) {
+            const uint32_t y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+            const uint8_t* row0 = &src.pixels[static_cast<size_t>(y0) * src.width * 4];
+            const uint8_t* row1 = &src.pixels[static_cast<size_t>(y1) * src.width * 4];
+            uint8_t* out = &dst.pixels[static_cast<size_t>(y) * dst.width * 4];
+            for (uint32_t x = 0; x < dst.width; ++x) {
+                const uint32_t x0 = std::min(x * 2, src.width - 1) * 4, x1 = std::min(x * 2 + 1, src.width - 1) * 4;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    out[x * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(std::move(dst));
+    }
+}
@@ -0,0 +1,84 @@
+// LOD.cpp
+// Screen-space-error LOD selection with hysteresis and cross-fade timing.
+
+#include "MyFirstEngine/LOD.h"
+#include "MyFirstEngine/ECS.h"
+#include "MyFirstEngine/SceneGraph.h"
+#include "MyFirstEngine/MeshRenderer.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::tan, std::sqrt
+
+LODSelector::LODSelector()
+    : cameraPosition(0.0f, 0.0f, 0.0f), pixelsPerUnitAtUnitDistance(1.0f) {}
+
+void LODSelector::setView(const Vec3& position, float fovDegrees, int viewportHeight) {
+    cameraPosition = position;
+    const float halfFov = 0.5f * fovDegrees * 3.14159265358979f / 180.0f;
+    const float tanHalfFov = std::max(std::tan(halfFov), 1e-4f);
+    pixelsPerUnitAtUnitDistance = static_cast<float>(std::max(viewportHeight, 1)) / (2.0f * tanHalfFov);
+}
+
+uint32_t LODSelector::selectLevel(const LODGroup& group, const Mat4& model) const {
+    if (group.levelCount <= 1) return 0;
+    const float* m = model.elements;
+    // Errors scale with the object's largest axis scale; distance is to the object's origin.
+    const float scaleSq = std::max(m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                   std::max(m[4] * m[4] + m[5] * m[5] + m[6] * m[6], m[8] * m[8] + m[9] * m[9] + m[10] * m[10]));
+    const float scale = std::sqrt(scaleSq);
+    const Vec3 toObject = Vec3(m[12], m[13], m[14]) - cameraPosition;
+    const float distance = toObject.length();
+
+    const uint32_t current = std::min(group.currentLevel, group.levelCount - 1);
+    if (projectedError(group.levels[current].geometricError * scale, distance) > settings.maxPixelError) {
+        // Too coarse: refine to the coarsest level that meets the budget (level 0 always does).
+        uint32_t level = current;
+        while (level > 0 && projectedError(group.levels[level].geometricError * scale, distance) > settings.maxPixelError) --level;
+        return level;
+    }
+    // Coarsen only with margin, so the next frame does not immediately refine again.
+    const float coarsenLimit = settings.maxPixelError * (1.0f - settings.hysteresis);
+    uint32_t level = current;
+    while (level + 1 < group.levelCount &&
+           projectedError(group.levels[level + 1].geometricError * scale, distance) <= coarsenLimit) ++level;
+    return level;
+}
+
+void LODSelector::update(LODGroup& group, const Mat4& model, float deltaTime) const {
+    if (group.isFading()) {
+        group.fadeProgress = settings.fadeDuration > 0.0f ? group.fadeProgress + deltaTime / settings.fadeDuration : 1.0f;
+        if (group.fadeProgress < 1.0f) return; // Finish the running transition first
+        group.fadeProgress = 1.0f;
+    }
+    const uint32_t level = selectLevel(group, model);
+    if (level == group.currentLevel) return;
+    group.previousLevel = group.currentLevel;
+    group.currentLevel = level;
+    group.fadeProgress = settings.fadeDuration > 0.0f ? 0.0f : 1.0f;
+}
+
+size_t LODSelector::updateVisible(World& world, const SceneGraph& graph, const std::vector<uint32_t>& slots,
+                                  float deltaTime, ThreadPool* pool) const {
+    const Mat4* worldMatrices = graph.getWorldMatrices();
+    auto updateRange = [&](size_t begin, size_t end) {
+        size_t fading = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const Entity entity = graph.getEntityAt(slots[i]);
+            LODGroup* group = world.get<LODGroup>(entity);
+            if (!group || group->levelCount == 0) continue;
+            update(*group, worldMatrices[slots[i]], deltaTime);
+            if (MeshRenderer* meshRenderer = world.get<MeshRenderer>(entity)) meshRenderer->mesh = group->currentMesh();
+            fading += group->isFading() ? 1 : 0;
+        }
+        return fading;
+    };
+    if (!pool) return updateRange(0, slots.size());
+
+    std::vector<size_t> fadingPerThread(pool->getThreadCount(), 0);
+    pool->parallelFor(slots.size(), 1024, [&](size_t begin, size_t end, size_t threadIndex) {
+        fadingPerThread[threadIndex] += updateRange(begin, end);
+    });
+    size_t fading = 0;
+    for (size_t count : fadingPerThread) fading += count;
+    return fading;
+}
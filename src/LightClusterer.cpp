@@ -0,0 +1,294 @@
+// LightClusterer.cpp
+// Froxel grid setup and multithreaded, SIMD light binning.
+
+#include "MyFirstEngine/LightClusterer.h"
+#include "MyFirstEngine/ECS.h"
+#include "MyFirstEngine/SceneGraph.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::log, std::pow, std::sqrt, std::cos
+
+LightClusterer::LightClusterer()
+    : nearPlane(0.1f), farPlane(1000.0f), sliceScale(1.0f), sliceBias(0.0f),
+      viewportWidth(1), viewportHeight(1), maxLightsPerCluster(0) {
+    setView(Mat4::identity(), Mat4::perspective(0.785f, 1.0f, 0.1f, 1000.0f), 1, 1);
+    clusters.resize(CLUSTER_COUNT, Cluster{ 0, 0 });
+}
+
+void LightClusterer::setView(const Mat4& view, const Mat4& projection, int width, int height) {
+    viewMatrix = view;
+    viewportWidth = std::max(width, 1);
+    viewportHeight = std::max(height, 1);
+
+    // Near/far from P[10] = -(f+n)/(f-n), P[14] = -2fn/(f-n).
+    const float* p = projection.elements;
+    nearPlane = p[14] / (p[10] - 1.0f);
+    farPlane = p[14] / (p[10] + 1.0f);
+    if (!(nearPlane > 0.0f) || !(farPlane > nearPlane)) {
+        nearPlane = 0.1f;
+        farPlane = 1000.0f;
+    }
+    const float logRatio = std::log(farPlane / nearPlane);
+    sliceScale = static_cast<float>(CLUSTERS_Z) / logRatio;
+    sliceBias = -std::log(nearPlane) * sliceScale;
+    for (uint32_t z = 0; z <= CLUSTERS_Z; ++z) {
+        sliceDepths[z] = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / CLUSTERS_Z);
+    }
+    sliceDepths[0] = 0.0f;                    // Everything closer than near still lands in slice 0
+    sliceDepths[CLUSTERS_Z] = farPlane * 2.0f; // and everything up to far in the last one
+
+    // NDC x = P[0] * x / depth, so the boundary at NDC 'ndc' is the plane x = (ndc / P[0]) * depth.
+    for (uint32_t i = 0; i <= CLUSTERS_X; ++i) {
+        const float ndc = -1.0f + 2.0f * static_cast<float>(i) / CLUSTERS_X;
+        columnSlopes[i] = ndc / p[0];
+        columnScales[i] = 1.0f / std::sqrt(1.0f + columnSlopes[i] * columnSlopes[i]);
+    }
+    for (uint32_t i = 0; i <= CLUSTERS_Y; ++i) {
+        const float ndc = -1.0f + 2.0f * static_cast<float>(i) / CLUSTERS_Y;
+        rowSlopes[i] = ndc / p[5];
+        rowScales[i] = 1.0f / std::sqrt(1.0f + rowSlopes[i] * rowSlopes[i]);
+    }
+}
+
+void LightClusterer::clearLights() {
+    lights.clear();
+    boundsX.clear();
+    boundsY.clear();
+    boundsDepth.clear();
+    boundsRadius.clear();
+}
+
+bool LightClusterer::addLight(const Light& light, const Mat4& world) {
+    if (lights.size() >= MAX_LIGHTS) return false;
+    const Vec3 position = Mat4::transformPoint(world, Vec3(0.0f, 0.0f, 0.0f));
+    const Vec3 direction = Mat4::transformDirection(world, light.direction).normalize();
+    const float range = std::max(light.range, 1e-3f);
+
+    GpuLight gpu;
+    gpu.positionRange[0] = position.x; gpu.positionRange[1] = position.y; gpu.positionRange[2] = position.z;
+    gpu.positionRange[3] = range;
+    gpu.colorCosOuter[0] = light.color.x * light.intensity;
+    gpu.colorCosOuter[1] = light.color.y * light.intensity;
+    gpu.colorCosOuter[2] = light.color.z * light.intensity;
+    gpu.directionCosInner[0] = direction.x; gpu.directionCosInner[1] = direction.y; gpu.directionCosInner[2] = direction.z;
+
+    // Bounding sphere: the light's range, or for a spot the smallest sphere around its cone.
+    Vec3 center = position;
+    float radius = range;
+    if (light.type == LightType::Spot) {
+        const float degToRad = 3.14159265358979f / 180.0f;
+        const float outer = std::min(std::max(light.outerConeDegrees, 0.1f), 89.9f) * degToRad;
+        const float inner = std::min(std::max(light.innerConeDegrees, 0.0f), light.outerConeDegrees) * degToRad;
+        const float cosOuter = std::cos(outer);
+        gpu.colorCosOuter[3] = cosOuter;
+        gpu.directionCosInner[3] = std::max(std::cos(inner), cosOuter + 1e-4f);
+        if (cosOuter < 0.70710678f) {
+            // Wide cone: the sphere through the rim circle.
+            center = position + direction * (range * cosOuter);
+            radius = range * std::sin(outer);
+        } else {
+            // Narrow cone: the sphere through the apex and the rim circle.
+            radius = range / (2.0f * cosOuter);
+            center = position + direction * radius;
+        }
+    } else {
+        gpu.colorCosOuter[3] = -2.0f;
+        gpu.directionCosInner[3] = 1.0f;
+    }
+    lights.push_back(gpu);
+
+    const Vec3 viewCenter = Mat4::transformPoint(viewMatrix, center);
+    boundsX.push_back(viewCenter.x);
+    boundsY.push_back(viewCenter.y);
+    boundsDepth.push_back(-viewCenter.z);
+    boundsRadius.push_back(radius);
+    return true;
+}
+
+size_t LightClusterer::gatherLights(World& world, const SceneGraph& graph) {
+    clearLights();
+    world.each<Light>([&](Entity entity, Light& light) {
+        addLight(light, graph.getWorldMatrix(entity));
+    });
+    return lights.size();
+}
+
+void LightClusterer::tileMasks(float x, float y, float depth, float radius, uint32_t& columns, uint32_t& rows) const {
+    // Column c lies between boundaries c and c + 1. The sphere misses it if it is entirely on the
+    // negative side of boundary c or entirely on the positive side of boundary c + 1.
+    columns = 0;
+    bool notBelow = (x - columnSlopes[0] * depth) * columnScales[0] >= -radius;
+    for (uint32_t c = 0; c < CLUSTERS_X; ++c) {
+        const float distance = (x - columnSlopes[c + 1] * depth) * columnScales[c + 1];
+        if (notBelow && distance <= radius) columns |= 1u << c;
+        notBelow = distance >= -radius;
+    }
+    rows = 0;
+    notBelow = (y - rowSlopes[0] * depth) * rowScales[0] >= -radius;
+    for (uint32_t r = 0; r < CLUSTERS_Y; ++r) {
+        const float distance = (y - rowSlopes[r + 1] * depth) * rowScales[r + 1];
+        if (notBelow && distance <= radius) rows |= 1u << r;
+        notBelow = distance >= -radius;
+    }
+}
+
+#if defined(SIMPLEMATH_SSE)
+// Bit per lane: distance(lane) >= -radius, and distance(lane) <= radius.
+static inline void planeTest4(__m128 coord, __m128 depth, __m128 radius, float slope, float scale,
+                              int& notBelow, int& notAbove) {
+    const __m128 distance = _mm_mul_ps(_mm_sub_ps(coord, _mm_mul_ps(_mm_set1_ps(slope), depth)), _mm_set1_ps(scale));
+    notBelow = _mm_movemask_ps(_mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+    notAbove = _mm_movemask_ps(_mm_cmple_ps(distance, radius));
+}
+#elif defined(SIMPLEMATH_NEON)
+static inline int laneMask4(uint32x4_t mask) {
+    uint32_t lanes[4];
+    vst1q_u32(lanes, mask);
+    return (lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8);
+}
+static inline void planeTest4(float32x4_t coord, float32x4_t depth, float32x4_t radius, float slope, float scale,
+                              int& notBelow, int& notAbove) {
+    const float32x4_t distance = vmulq_n_f32(vmlsq_n_f32(coord, depth, slope), scale);
+    notBelow = laneMask4(vcgeq_f32(distance, vnegq_f32(radius)));
+    notAbove = laneMask4(vcleq_f32(distance, radius));
+}
+#endif
+
+void LightClusterer::binSlice(uint32_t z) {
+    SliceBins& bins = slices[z];
+    bins.candidates.clear();
+    bins.entries.clear();
+    std::fill(bins.tileCounts, bins.tileCounts + CLUSTERS_X * CLUSTERS_Y, 0u);
+
+    // --- 1. Lights whose sphere overlaps the slice's depth range ---
+    const float sliceNear = sliceDepths[z], sliceFar = sliceDepths[z + 1];
+    const size_t count = lights.size();
+    size_t i = 0;
+#if defined(SIMPLEMATH_SSE)
+    const __m128 nearV = _mm_set1_ps(sliceNear), farV = _mm_set1_ps(sliceFar);
+    for (; i + 4 <= count; i += 4) {
+        const __m128 depth = _mm_loadu_ps(&boundsDepth[i]), radius = _mm_loadu_ps(&boundsRadius[i]);
+        const __m128 overlap = _mm_and_ps(_mm_cmpgt_ps(_mm_add_ps(depth, radius), nearV),
+                                          _mm_cmplt_ps(_mm_sub_ps(depth, radius), farV));
+        const int mask = _mm_movemask_ps(overlap);
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) bins.candidates.push_back(static_cast<uint32_t>(i + lane));
+        }
+    }
+#elif defined(SIMPLEMATH_NEON)
+    const float32x4_t nearV = vdupq_n_f32(sliceNear), farV = vdupq_n_f32(sliceFar);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t depth = vld1q_f32(&boundsDepth[i]), radius = vld1q_f32(&boundsRadius[i]);
+        const int mask = laneMask4(vandq_u32(vcgtq_f32(vaddq_f32(depth, radius), nearV),
+                                             vcltq_f32(vsubq_f32(depth, radius), farV)));
+        for (int lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) bins.candidates.push_back(static_cast<uint32_t>(i + lane));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        if (boundsDepth[i] + boundsRadius[i] > sliceNear && boundsDepth[i] - boundsRadius[i] < sliceFar) {
+            bins.candidates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // --- 2. Tile ranges against the column/row planes, 4 candidates at a time ---
+    auto addLight = [&](uint32_t light, uint32_t columns, uint32_t rows) {
+        for (uint32_t r = 0; r < CLUSTERS_Y; ++r) {
+            if (!(rows & (1u << r))) continue;
+            for (uint32_t c = 0; c < CLUSTERS_X; ++c) {
+                if (!(columns & (1u << c))) continue;
+                const uint32_t tile = r * CLUSTERS_X + c;
+                bins.entries.push_back((tile << 16) | light);
+                ++bins.tileCounts[tile];
+            }
+        }
+    };
+    const size_t candidateCount = bins.candidates.size();
+    size_t k = 0;
+#if defined(SIMPLEMATH_SSE) || defined(SIMPLEMATH_NEON)
+    for (; k + 4 <= candidateCount; k += 4) {
+        float gx[4], gy[4], gd[4], gr[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint32_t light = bins.candidates[k + lane];
+            gx[lane] = boundsX[light]; gy[lane] = boundsY[light];
+            gd[lane] = boundsDepth[light]; gr[lane] = boundsRadius[light];
+        }
+#if defined(SIMPLEMATH_SSE)
+        const __m128 x = _mm_loadu_ps(gx), y = _mm_loadu_ps(gy), depth = _mm_loadu_ps(gd), radius = _mm_loadu_ps(gr);
+#else
+        const float32x4_t x = vld1q_f32(gx), y = vld1q_f32(gy), depth = vld1q_f32(gd), radius = vld1q_f32(gr);
+#endif
+        uint32_t columns[4] = { 0, 0, 0, 0 }, rows[4] = { 0, 0, 0, 0 };
+        int notBelow = 0, notAbove = 0, previousNotBelow = 0;
+        planeTest4(x, depth, radius, columnSlopes[0], columnScales[0], previousNotBelow, notAbove);
+        for (uint32_t c = 0; c < CLUSTERS_X; ++c) {
+            planeTest4(x, depth, radius, columnSlopes[c + 1], columnScales[c + 1], notBelow, notAbove);
+            const int overlap = previousNotBelow & notAbove;
+            for (int lane = 0; lane < 4; ++lane) columns[lane] |= static_cast<uint32_t>((overlap >> lane) & 1) << c;
+            previousNotBelow = notBelow;
+        }
+        planeTest4(y, depth, radius, rowSlopes[0], rowScales[0], previousNotBelow, notAbove);
+        for (uint32_t r = 0; r < CLUSTERS_Y; ++r) {
+            planeTest4(y, depth, radius, rowSlopes[r + 1], rowScales[r + 1], notBelow, notAbove);
+            const int overlap = previousNotBelow & notAbove;
+            for (int lane = 0; lane < 4; ++lane) rows[lane] |= static_cast<uint32_t>((overlap >> lane) & 1) << r;
+            previousNotBelow = notBelow;
+        }
+        for (int lane = 0; lane < 4; ++lane) {
+            if (columns[lane] && rows[lane]) addLight(bins.candidates[k + lane], columns[lane], rows[lane]);
+        }
+    }
+#endif
+    for (; k < candidateCount; ++k) {
+        const uint32_t light = bins.candidates[k];
+        uint32_t columns = 0, rows = 0;
+        tileMasks(boundsX[light], boundsY[light], boundsDepth[light], boundsRadius[light], columns, rows);
+        if (columns && rows) addLight(light, columns, rows);
+    }
+}
+
+void LightClusterer::scatterSlice(uint32_t z) {
+    const SliceBins& bins = slices[z];
+    const uint32_t tilesPerSlice = CLUSTERS_X * CLUSTERS_Y;
+    uint32_t cursor[CLUSTERS_X * CLUSTERS_Y];
+    for (uint32_t tile = 0; tile < tilesPerSlice; ++tile) cursor[tile] = clusters[z * tilesPerSlice + tile].offset;
+    // Entries are in ascending light order, so every cluster's list ends up sorted.
+    for (uint32_t entry : bins.entries) {
+        lightIndices[cursor[entry >> 16]++] = static_cast<uint16_t>(entry & 0xFFFFu);
+    }
+}
+
+void LightClusterer::build(ThreadPool* pool) {
+    // --- 1. Bin each slice independently ---
+    if (pool) {
+        pool->parallelFor(CLUSTERS_Z, 1, [this](size_t begin, size_t end, size_t) {
+            for (size_t z = begin; z < end; ++z) binSlice(static_cast<uint32_t>(z));
+        });
+    } else {
+        for (uint32_t z = 0; z < CLUSTERS_Z; ++z) binSlice(z);
+    }
+
+    // --- 2. Cluster offsets (prefix sum over slices, then tiles) ---
+    const uint32_t tilesPerSlice = CLUSTERS_X * CLUSTERS_Y;
+    uint32_t offset = 0;
+    maxLightsPerCluster = 0;
+    for (uint32_t z = 0; z < CLUSTERS_Z; ++z) {
+        for (uint32_t tile = 0; tile < tilesPerSlice; ++tile) {
+            const uint32_t count = slices[z].tileCounts[tile];
+            clusters[z * tilesPerSlice + tile] = Cluster{ offset, count };
+            offset += count;
+            maxLightsPerCluster = std::max(maxLightsPerCluster, count);
+        }
+    }
+
+    // --- 3. Flatten into the index list ---
+    lightIndices.resize(offset);
+    if (pool) {
+        pool->parallelFor(CLUSTERS_Z, 1, [this](size_t begin, size_t end, size_t) {
+            for (size_t z = begin; z < end; ++z) scatterSlice(static_cast<uint32_t>(z));
+        });
+    } else {
+        for (uint32_t z = 0; z < CLUSTERS_Z; ++z) scatterSlice(z);
+    }
+}
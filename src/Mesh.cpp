@@ -0,0 +1,136 @@
+// Mesh.cpp
+// Bounds computation and built-in primitive meshes.
+
+#include "MyFirstEngine/Mesh.h"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For std::sqrt, std::sin, std::cos
+
+MeshBounds MeshData::computeBounds() const {
+    MeshBounds bounds;
+    bounds.box = AABB(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 0.0f, 0.0f));
+    const VertexFormat::Element* position = format.find(VertexAttribute::Position);
+    const size_t count = vertexCount();
+    if (!position || position->components < 3 || count == 0) return bounds;
+
+    const uint32_t floats = format.floatsPerVertex();
+    const size_t first = position->offset / sizeof(float);
+    Vec3& lo = bounds.box.min;
+    Vec3& hi = bounds.box.max;
+    lo = Vec3(vertices[first], vertices[first + 1], vertices[first + 2]);
+    hi = lo;
+    for (size_t v = 1; v < count; ++v) {
+        const float* p = &vertices[v * floats + first];
+        lo = Vec3(std::min(lo.x, p[0]), std::min(lo.y, p[1]), std::min(lo.z, p[2]));
+        hi = Vec3(std::max(hi.x, p[0]), std::max(hi.y, p[1]), std::max(hi.z, p[2]));
+    }
+    bounds.sphere.center = bounds.box.center();
+    // Tighter than half the AABB diagonal for most meshes: the farthest vertex from the center.
+    float radiusSq = 0.0f;
+    for (size_t v = 0; v < count; ++v) {
+        const float* p = &vertices[v * floats + first];
+        Vec3 d = Vec3(p[0], p[1], p[2]) - bounds.sphere.center;
+        radiusSq = std::max(radiusSq, Vec3::dot(d, d));
+    }
+    bounds.sphere.radius = std::sqrt(radiusSq);
+    return bounds;
+}
+
+MeshData MeshData::triangle() {
+    MeshData data;
+    data.format = VertexFormat::positionColorNormalUV();
+    data.vertices = {
+        // Positions          // Colors          // Normals         // UVs
+        -0.5f, -0.5f, 0.0f,   1.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f,  0.0f, 0.0f, // Bottom-left (Red)
+         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 1.0f,  1.0f, 0.0f, // Bottom-right (Green)
+         0.0f,  0.5f, 0.0f,   0.0f, 0.0f, 1.0f,  0.0f, 0.0f, 1.0f,  0.5f, 1.0f  // Top-center (Blue)
+    };
+    data.indices = { 0, 1, 2 };
+    return data;
+}
+
+MeshData MeshData::cube() {
+    // Each face: outward normal axis, two in-plane axes (u x v = normal, so CCW from outside) and a color.
+    struct Face { Vec3 normal, u, v, color; };
+    static const Face faces[6] = {
+        { Vec3( 1, 0, 0), Vec3( 0, 0,-1), Vec3(0, 1, 0), Vec3(0.90f, 0.30f, 0.25f) }, // +X
+        { Vec3(-1, 0, 0), Vec3( 0, 0, 1), Vec3(0, 1, 0), Vec3(0.55f, 0.15f, 0.12f) }, // -X
+        { Vec3( 0, 1, 0), Vec3( 1, 0, 0), Vec3(0, 0,-1), Vec3(0.30f, 0.85f, 0.35f) }, // +Y
+        { Vec3( 0,-1, 0), Vec3( 1, 0, 0), Vec3(0, 0, 1), Vec3(0.15f, 0.45f, 0.18f) }, // -Y
+        { Vec3( 0, 0, 1), Vec3( 1, 0, 0), Vec3(0, 1, 0), Vec3(0.25f, 0.45f, 0.95f) }, // +Z
+        { Vec3( 0, 0,-1), Vec3(-1, 0, 0), Vec3(0, 1, 0), Vec3(0.12f, 0.22f, 0.55f) }  // -Z
+    };
+    static const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+    MeshData data;
+    data.format = VertexFormat::positionColorNormalUV();
+    data.singleSided = true;
+    const uint32_t floats = data.format.floatsPerVertex();
+    data.vertices.reserve(6 * 4 * floats);
+    data.indices.reserve(6 * 6);
+    for (const Face& face : faces) {
+        const uint32_t base = static_cast<uint32_t>(data.vertices.size() / floats);
+        for (const float* c : corners) {
+            Vec3 p = (face.normal + face.u * c[0] + face.v * c[1]) * 0.5f;
+            data.vertices.insert(data.vertices.end(), { p.x, p.y, p.z, face.color.x, face.color.y, face.color.z,
+                                                        face.normal.x, face.normal.y, face.normal.z,
+                                                        c[0] * 0.5f + 0.5f, c[1] * 0.5f + 0.5f });
+        }
+        data.indices.insert(data.indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
+    return data;
+}
+
+MeshData MeshData::plane() {
+    MeshData data;
+    data.format = VertexFormat::positionColorNormalUV();
+    data.vertices = {
+        -0.5f, 0.0f,  0.5f,   0.35f, 0.38f, 0.42f,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f,
+         0.5f, 0.0f,  0.5f,   0.35f, 0.38f, 0.42f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+         0.5f, 0.0f, -0.5f,   0.45f, 0.48f, 0.52f,   0.0f, 1.0f, 0.0f,   1.0f, 1.0f,
+        -0.5f, 0.0f, -0.5f,   0.45f, 0.48f, 0.52f,   0.0f, 1.0f, 0.0f,   0.0f, 1.0f
+    };
+    data.indices = { 0, 1, 2, 0, 2, 3 };
+    return data;
+}
+
+MeshData MeshData::sphere(uint32_t segments, uint32_t rings) {
+    segments = std::max(segments, 3u);
+    rings = std::max(rings, 2u);
+    const float pi = 3.14159265358979f;
+
+    MeshData data;
+    data.format = VertexFormat::positionColorNormalUV();
+    data.singleSided = true;
+    data.vertices.reserve(static_cast<size_t>(rings + 1) * (segments + 1) * data.format.floatsPerVertex());
+    data.indices.reserve(static_cast<size_t>(rings) * segments * 6);
+    // (rings + 1) x (segments + 1) grid from the north pole down; the seam column is duplicated.
+    for (uint32_t r = 0; r <= rings; ++r) {
+        const float theta = pi * static_cast<float>(r) / static_cast<float>(rings);
+        for (uint32_t s = 0; s <= segments; ++s) {
+            const float phi = 2.0f * pi * static_cast<float>(s) / static_cast<float>(segments);
+            Vec3 n(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            data.vertices.insert(data.vertices.end(), { n.x * 0.5f, n.y * 0.5f, n.z * 0.5f,
+                                                        n.x * 0.5f + 0.5f, n.y * 0.5f + 0.5f, n.z * 0.5f + 0.5f,
+                                                        n.x, n.y, n.z,
+                                                        static_cast<float>(s) / static_cast<float>(segments),
+                                                        static_cast<float>(r) / static_cast<float>(rings) });
+        }
+    }
+    for (uint32_t r = 0; r < rings; ++r) {
+        for (uint32_t s = 0; s < segments; ++s) {
+            const uint32_t a = r * (segments + 1) + s, b = a + segments + 1; // b is below a
+            // Counter-clockwise seen from outside.
+            data.indices.insert(data.indices.end(), { a, a + 1, b + 1, a, b + 1, b });
+        }
+    }
+    return data;
+}
+
+float MeshData::sphereError(uint32_t segments, uint32_t rings) {
+    segments = std::max(segments, 3u);
+    rings = std::max(rings, 2u);
+    const float pi = 3.14159265358979f;
+    // Sagitta of the longest edge: distance from the chord's midpoint to the arc, radius 0.5.
+    const float halfAngle = std::max(pi / static_cast<float>(segments), 0.5f * pi / static_cast<float>(rings));
+    return 0.5f * (1.0f - std::cos(halfAngle));
+}
@@ -0,0 +1,150 @@
+// MeshCookerMain.cpp
+// Offline mesh cooker: OBJ/glTF in, memory-mappable cooked meshes (.semesh) out.
+//
+// Each input is imported on all cores (MeshImporter.h) into the engine's vertex format,
+// reordered for the vertex cache, overdraw and vertex fetch and quantized to 20-byte vertices
+// (MeshOptimizer.h), cut into meshlets for per-cluster culling (Meshlet.h), and written next to
+// the input (or into --out-dir) with the extension replaced by .semesh. Renderer::loadMesh()
+// maps those and uploads straight from the mapping (MeshFile.h), so at runtime there is no text
+// parsing, no welding, no normal generation and no reordering. The cooker only links the
+// GL-free core library.
+//
+// Usage:
+//   SimpleEngineMeshCooker [--threads=0] [--optimize=1] [--quantize=1] [--meshlets=1] [--out-dir=dir]
+//                          [--verify=1] input...
+//   --threads=0 uses one thread per core.
+//   --verify=1 maps the written file back and times that, i.e. the runtime load path minus
+//     the GPU upload.
+//   --optimize=0 keeps the imported triangle and vertex order, --quantize=0 the float vertices,
+//     --meshlets=0 leaves meshlets out (the mesh is then always drawn whole).
+// Per file, it prints the vertex and triangle counts, the sizes, the import and optimization
+// times, the ACMR (vertex shader runs per triangle, 16-entry FIFO cache) before and after, the
+// bytes per vertex, the meshlet count and whether the mesh is single-sided (only then are its
+// meshlets culled by normal cone).
+
+#include "MyFirstEngine/MeshFile.h"
+#include "MyFirstEngine/MeshImporter.h"
+#include "MyFirstEngine/MeshOptimizer.h"
+#include "MyFirstEngine/Meshlet.h"
+#include "MyFirstEngine/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct CookerOptions {
+    int threads = 0;
+    bool optimize = true;
+    bool quantize = true;
+    bool meshlets = true;
+    bool verify = true;
+    std::string outDir;
+    std::vector<std::string> inputs;
+};
+
+static bool parseOptions(int argc, char** argv, CookerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--threads") options.threads = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--optimize") options.optimize = std::atoi(value.c_str()) != 0;
+        else if (key == "--quantize") options.quantize = std::atoi(value.c_str()) != 0;
+        else if (key == "--meshlets") options.meshlets = std::atoi(value.c_str()) != 0;
+        else if (key == "--out-dir") options.outDir = value;
+        else if (key == "--verify") options.verify = std::atoi(value.c_str()) != 0;
+        else {
+            std::cerr << "Usage: SimpleEngineMeshCooker [--threads=N] [--optimize=0|1] [--quantize=0|1] [--meshlets=0|1]"
+                         " [--out-dir=dir] [--verify=0|1] input..." << std::endl;
+            return false;
+        }
+    }
+    if (options.inputs.empty()) {
+        std::cerr << "ERROR::MESH_COOKER: No input files." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    CookerOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    ThreadPool pool(options.threads > 0 ? static_cast<size_t>(options.threads - 1) : ThreadPool::defaultWorkerCount());
+    int failures = 0;
+    for (const std::string& input : options.inputs) {
+        std::filesystem::path output(input);
+        output.replace_extension(".semesh");
+        if (!options.outDir.empty()) output = std::filesystem::path(options.outDir) / output.filename();
+
+        const auto start = std::chrono::steady_clock::now();
+        MeshData mesh;
+        if (!MeshImporter::importFile(input, mesh, &pool)) {
+            ++failures;
+            continue;
+        }
+        const double importMilliseconds = millisecondsSince(start);
+
+        const auto optimizeStart = std::chrono::steady_clock::now();
+        const float acmrBefore = MeshOptimizer::computeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+        if (options.optimize) MeshOptimizer::optimize(mesh);
+        const float acmrAfter = MeshOptimizer::computeACMR(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+        PackedMeshData packed;
+        if (options.quantize && !MeshOptimizer::quantize(mesh, packed)) {
+            ++failures;
+            continue;
+        }
+        MeshDataView cooked = options.quantize ? MeshDataView(packed) : MeshDataView(mesh);
+        std::vector<Meshlet> meshlets;
+        if (options.meshlets) {
+            if (!MeshletBuilder::build(cooked, meshlets, &pool)) {
+                ++failures;
+                continue;
+            }
+            cooked.meshlets = meshlets.data();
+            cooked.meshletCount = meshlets.size();
+        }
+        const double optimizeMilliseconds = millisecondsSince(optimizeStart);
+
+        if (!options.outDir.empty()) std::filesystem::create_directories(options.outDir);
+        if (!MeshFile::save(output.string(), cooked)) {
+            ++failures;
+            continue;
+        }
+        std::error_code error;
+        const uintmax_t sourceBytes = std::filesystem::file_size(input, error);
+        const uintmax_t cookedBytes = std::filesystem::file_size(output, error);
+        std::printf("%s -> %s: %zu vertices, %zu triangles, %.1f MB -> %.1f MB, import %.1f ms, optimize %.1f ms,"
+                    " ACMR %.3f -> %.3f, %u -> %u bytes per vertex, %zu meshlets, %s", input.c_str(), output.string().c_str(),
+                    cooked.vertexCount, cooked.indexCount / 3, sourceBytes / (1024.0 * 1024.0), cookedBytes / (1024.0 * 1024.0),
+                    importMilliseconds, optimizeMilliseconds, acmrBefore, acmrAfter, mesh.format.stride, cooked.format.stride, meshlets.size(),
+                    cooked.singleSided ? "single-sided" : "double-sided");
+        if (options.verify) {
+            const auto mapStart = std::chrono::steady_clock::now();
+            MeshFile file;
+            if (!file.open(output.string()) || file.getView().vertexCount != cooked.vertexCount || file.getView().indexCount != cooked.indexCount) {
+                std::printf("\n");
+                std::cerr << "ERROR::MESH_COOKER: '" << output.string() << "' did not read back." << std::endl;
+                ++failures;
+                continue;
+            }
+            std::printf(", map %.2f ms", millisecondsSince(mapStart));
+        }
+        std::printf("\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+// MeshFile.cpp
+// Cooked mesh writing and memory-mapped loading.
+
+#include "MyFirstEngine/MeshFile.h"
+#include <cstdio>   // For std::FILE, std::rename
+#include <cstring>  // For std::memset, std::memcpy
+#include <iostream> // For std::cerr (error output)
+#include <vector>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>    // For open
+    #include <sys/mman.h> // For mmap, madvise
+    #include <sys/stat.h> // For fstat
+    #include <unistd.h>   // For close
+#endif
+
+static_assert(sizeof(Meshlet) == 40, "Meshlets are stored as they are laid out in memory");
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+MeshFile::MeshFile()
+    : mapping(nullptr), mappingSize(0)
+#ifdef _WIN32
+    , fileHandle(nullptr), mappingHandle(nullptr)
+#endif
+{}
+
+MeshFile::~MeshFile() {
+    close();
+}
+
+bool MeshFile::save(const std::string& path, const MeshDataView& data) {
+    const size_t vertexCount = data.vertexCount;
+    if (vertexCount == 0 || data.indexCount == 0) {
+        std::cerr << "ERROR::MESH_FILE::SAVE: Mesh has no vertices or indices." << std::endl;
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = FILE_MAGIC;
+    header.version = FORMAT_VERSION;
+    header.elementCount = data.format.elementCount;
+    header.stride = data.format.stride;
+    for (uint32_t i = 0; i < data.format.elementCount; ++i) {
+        const VertexFormat::Element& element = data.format.elements[i];
+        header.elements[i] = static_cast<uint32_t>(element.type) << 16 | static_cast<uint32_t>(element.attribute) << 8 | element.components;
+    }
+    header.vertexCount = vertexCount;
+    header.indexCount = data.indexCount;
+    header.vertexOffset = alignUp(sizeof(FileHeader), DATA_ALIGNMENT);
+    header.indexOffset = alignUp(header.vertexOffset + vertexCount * data.format.stride, DATA_ALIGNMENT);
+    header.meshletCount = data.meshlets ? data.meshletCount : 0;
+    header.meshletOffset = header.meshletCount > 0 ? alignUp(header.indexOffset + data.indexCount * sizeof(uint32_t), DATA_ALIGNMENT) : 0;
+    const MeshBounds& bounds = data.bounds;
+    const Vec3 corners[4] = { bounds.box.min, bounds.box.max, bounds.sphere.center, data.dequantization.offset };
+    float* targets[4] = { header.boxMin, header.boxMax, header.sphereCenter, header.positionOffset };
+    for (int i = 0; i < 4; ++i) {
+        targets[i][0] = corners[i].x;
+        targets[i][1] = corners[i].y;
+        targets[i][2] = corners[i].z;
+    }
+    header.sphereRadius = bounds.sphere.radius;
+    header.positionScale = data.dequantization.scale;
+    header.flags = data.singleSided ? FLAG_SINGLE_SIDED : 0u;
+
+    const std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::MESH_FILE::SAVE: Cannot write '" << temporaryPath << "'." << std::endl;
+        return false;
+    }
+    // Zero padding up to each aligned array.
+    const std::vector<char> padding(DATA_ALIGNMENT, 0);
+    const size_t vertexBytes = vertexCount * data.format.stride;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && std::fwrite(padding.data(), 1, header.vertexOffset - sizeof(header), file) == header.vertexOffset - sizeof(header);
+    ok = ok && std::fwrite(data.vertices, 1, vertexBytes, file) == vertexBytes;
+    const size_t gap = header.indexOffset - header.vertexOffset - vertexBytes;
+    ok = ok && std::fwrite(padding.data(), 1, gap, file) == gap;
+    ok = ok && std::fwrite(data.indices, sizeof(uint32_t), data.indexCount, file) == data.indexCount;
+    if (header.meshletCount > 0) {
+        const size_t meshletGap = header.meshletOffset - header.indexOffset - data.indexCount * sizeof(uint32_t);
+        ok = ok && std::fwrite(padding.data(), 1, meshletGap, file) == meshletGap;
+        ok = ok && std::fwrite(data.meshlets, sizeof(Meshlet), data.meshletCount, file) == data.meshletCount;
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        std::cerr << "ERROR::MESH_FILE::SAVE: Failed to write '" << path << "'." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MeshFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "ERROR::MESH_FILE::OPEN: Cannot open '" << path << "'." << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mappingObject = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mappingObject = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mappingObject) {
+        mapping = MapViewOfFile(mappingObject, FILE_MAP_READ, 0, 0, 0);
+        mappingSize = static_cast<size_t>(size.QuadPart);
+    }
+    fileHandle = file;
+    mappingHandle = mappingObject;
+#else
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        std::cerr << "ERROR::MESH_FILE::OPEN: Cannot open '" << path << "'." << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        if (address != MAP_FAILED) {
+            mapping = address;
+            mappingSize = static_cast<size_t>(info.st_size);
+            // Read ahead: the whole file is about to be copied front to back.
+            madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+            madvise(mapping, mappingSize, MADV_WILLNEED);
+        }
+    }
+    ::close(file); // The mapping keeps its own reference
+#endif
+    if (!mapping) {
+        std::cerr << "ERROR::MESH_FILE::OPEN: Cannot map '" << path << "'." << std::endl;
+        close();
+        return false;
+    }
+
+    FileHeader header;
+    bool valid = mappingSize >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, mapping, sizeof(header));
+        valid = header.magic == FILE_MAGIC && header.version == FORMAT_VERSION && header.elementCount > 0 &&
+                header.elementCount <= VertexFormat::MAX_ATTRIBUTES && header.vertexCount > 0 && header.indexCount > 0 &&
+                header.vertexOffset % DATA_ALIGNMENT == 0 && header.indexOffset % DATA_ALIGNMENT == 0;
+    }
+    if (valid) {
+        view.format = VertexFormat();
+        for (uint32_t i = 0; i < header.elementCount; ++i) {
+            const uint32_t components = header.elements[i] & 0xFF;
+            valid = valid && components >= 1 && components <= 4 &&
+                    (header.elements[i] >> 16) <= static_cast<uint32_t>(VertexComponentType::SNorm10_10_10_2);
+            view.format.add(static_cast<VertexAttribute>((header.elements[i] >> 8) & 0xFF), components,
+                            static_cast<VertexComponentType>(header.elements[i] >> 16));
+        }
+        // Counts are bounded by the file size first, so the range checks cannot overflow.
+        valid = valid && header.stride > 0 && view.format.stride == header.stride && header.vertexCount <= mappingSize / header.stride &&
+                header.indexCount <= mappingSize / sizeof(uint32_t) && header.indexOffset <= mappingSize && header.vertexOffset <= header.indexOffset &&
+                header.vertexOffset + header.vertexCount * header.stride <= header.indexOffset &&
+                header.indexOffset + header.indexCount * sizeof(uint32_t) <= mappingSize;
+        valid = valid && (header.meshletCount == 0 ||
+                          (header.meshletOffset % DATA_ALIGNMENT == 0 && header.meshletCount <= mappingSize / sizeof(Meshlet) &&
+                           header.meshletOffset >= header.indexOffset + header.indexCount * sizeof(uint32_t) &&
+                           header.meshletOffset <= mappingSize && header.meshletCount * sizeof(Meshlet) <= mappingSize - header.meshletOffset));
+    }
+    if (!valid) {
+        std::cerr << "ERROR::MESH_FILE::OPEN: '" << path << "' is not a valid cooked mesh (version " << FORMAT_VERSION << ")." << std::endl;
+        close();
+        return false;
+    }
+    const char* base = static_cast<const char*>(mapping);
+    view.vertices = base + header.vertexOffset;
+    view.vertexCount = static_cast<size_t>(header.vertexCount);
+    view.indices = reinterpret_cast<const uint32_t*>(base + header.indexOffset);
+    view.indexCount = static_cast<size_t>(header.indexCount);
+    view.meshlets = header.meshletCount > 0 ? reinterpret_cast<const Meshlet*>(base + header.meshletOffset) : nullptr;
+    view.meshletCount = static_cast<size_t>(header.meshletCount);
+    view.bounds.box.min = Vec3(header.boxMin[0], header.boxMin[1], header.boxMin[2]);
+    view.bounds.box.max = Vec3(header.boxMax[0], header.boxMax[1], header.boxMax[2]);
+    view.bounds.sphere.center = Vec3(header.sphereCenter[0], header.sphereCenter[1], header.sphereCenter[2]);
+    view.bounds.sphere.radius = header.sphereRadius;
+    view.dequantization.offset = Vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+    view.dequantization.scale = header.positionScale;
+    view.singleSided = (header.flags & FLAG_SINGLE_SIDED) != 0;
+    return true;
+}
+
+void MeshFile::close() {
+#ifdef _WIN32
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (mapping) munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    view = MeshDataView();
+}
@@ -0,0 +1,926 @@
+// MeshImporter.cpp
+// OBJ parsing, a minimal JSON reader and glTF 2.0 primitive conversion.
+
+#include "MyFirstEngine/MeshImporter.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm>     // For std::min, std::max, std::swap, std::sort, std::binary_search
+#include <cctype>        // For std::tolower
+#include <charconv>      // For std::from_chars
+#include <cmath>         // For std::sqrt
+#include <cstdio>        // For std::FILE
+#include <cstring>       // For std::memcpy, std::memchr
+#include <functional>    // For std::function
+#include <iostream>      // For std::cerr (error output)
+#include <utility>       // For std::pair
+#include <vector>
+
+// Floats per output vertex (positionColorNormalUV): position, color, normal, texture coordinate.
+static const uint32_t VERTEX_FLOATS = 11;
+static const uint32_t NO_INDEX = 0xFFFFFFFFu;
+
+static bool readFile(const std::string& path, std::vector<char>& bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    bool ok = size >= 0;
+    if (ok) {
+        bytes.resize(static_cast<size_t>(size));
+        ok = std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Runs fn(begin, end) over [0, count) on 'pool', or inline without one.
+static void forRange(ThreadPool* pool, size_t count, size_t minBatch, const std::function<void(size_t, size_t)>& fn) {
+    if (pool) {
+        pool->parallelFor(count, minBatch, [&](size_t begin, size_t end, size_t) { fn(begin, end); });
+    } else if (count > 0) {
+        fn(0, count);
+    }
+}
+
+// Sums area-weighted face normals into the vertices of every triangle, then normalizes.
+// 'vertices' is in the output layout; 'sharedSlot' maps a vertex to the accumulator it shares
+// with others at the same position, or is empty for one accumulator per vertex.
+static void computeNormals(float* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount,
+                           const std::vector<uint32_t>& sharedSlot, size_t slotCount) {
+    std::vector<Vec3> sums(slotCount, Vec3(0.0f, 0.0f, 0.0f));
+    auto slot = [&](uint32_t vertex) { return sharedSlot.empty() ? vertex : sharedSlot[vertex]; };
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        const float* a = &vertices[static_cast<size_t>(indices[i]) * VERTEX_FLOATS];
+        const float* b = &vertices[static_cast<size_t>(indices[i + 1]) * VERTEX_FLOATS];
+        const float* c = &vertices[static_cast<size_t>(indices[i + 2]) * VERTEX_FLOATS];
+        const Vec3 faceNormal = Vec3::cross(Vec3(b[0] - a[0], b[1] - a[1], b[2] - a[2]), Vec3(c[0] - a[0], c[1] - a[1], c[2] - a[2]));
+        for (size_t k = 0; k < 3; ++k) {
+            Vec3& sum = sums[slot(indices[i + k])];
+            sum = sum + faceNormal;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const Vec3& sum = sums[slot(static_cast<uint32_t>(v))];
+        const float length = std::sqrt(Vec3::dot(sum, sum));
+        float* normal = &vertices[v * VERTEX_FLOATS + 6];
+        normal[0] = length > 0.0f ? sum.x / length : 0.0f;
+        normal[1] = length > 0.0f ? sum.y / length : 1.0f;
+        normal[2] = length > 0.0f ? sum.z / length : 0.0f;
+    }
+}
+
+bool MeshImporter::importFile(const std::string& path, MeshData& out, ThreadPool* pool) {
+    const size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    for (char& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (extension == "obj") return importOBJ(path, out, pool);
+    if (extension == "gltf" || extension == "glb") return importGLTF(path, out, pool);
+    std::cerr << "ERROR::MESH_IMPORTER::IMPORT_FILE: Unknown mesh format '" << path << "' (expected .obj, .gltf or .glb)." << std::endl;
+    return false;
+}
+
+// --- OBJ ---
+
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    // Pass 1: lines in the chunk; pass 2 starts each kind at the total of the chunks before it.
+    size_t lineCount = 0, positionCount = 0, texCoordCount = 0, normalCount = 0;
+    size_t lineBase = 0, positionBase = 0, texCoordBase = 0, normalBase = 0;
+    // Pass 2
+    std::vector<float> positions;  // xyz + rgb (white unless the line has a color)
+    std::vector<float> texCoords;  // uv, V already flipped
+    std::vector<float> normals;    // xyz
+    std::vector<uint32_t> corners; // Global position, texture coordinate and normal index per triangle corner
+    size_t errorLine = 0; // Global, 1-based; 0 if the chunk parsed
+};
+
+struct ObjCornerKey {
+    uint32_t position, texCoord, normal;
+    bool operator==(const ObjCornerKey& other) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+static bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) ++p;
+    return p;
+}
+
+// Parses a float after optional blanks. Locale-independent, unlike strtof.
+static bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') ++p; // from_chars does not take a plus sign
+    const std::from_chars_result result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// Resolves a 1-based OBJ index (negative: counted back from the 'count' elements so far).
+static bool resolveIndex(long long index, size_t count, uint32_t& out) {
+    if (index > 0 && static_cast<unsigned long long>(index) <= count) {
+        out = static_cast<uint32_t>(index - 1);
+        return true;
+    }
+    if (index < 0 && static_cast<unsigned long long>(-index) <= count) {
+        out = static_cast<uint32_t>(static_cast<long long>(count) + index);
+        return true;
+    }
+    return false;
+}
+
+// Line kind from its first token: 'v', 't' (vt), 'n' (vn), 'f' or 0 for anything else.
+static char objLineKind(const char* p, const char* end) {
+    if (end - p < 2 || !(isBlank(p[1]) || (p[0] == 'v' && (p[1] == 't' || p[1] == 'n') && end - p > 2 && isBlank(p[2])))) {
+        return 0;
+    }
+    if (p[0] == 'f') return 'f';
+    if (p[0] != 'v') return 0;
+    return isBlank(p[1]) ? 'v' : p[1];
+}
+
+static void countObjLines(ObjChunk& chunk) {
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(chunk.end - line)));
+        const char* end = newline ? newline : chunk.end;
+        const char kind = objLineKind(skipBlanks(line, end), end);
+        chunk.positionCount += kind == 'v';
+        chunk.texCoordCount += kind == 't';
+        chunk.normalCount += kind == 'n';
+        ++chunk.lineCount;
+        line = newline ? newline + 1 : chunk.end;
+    }
+}
+
+static bool parseObjFace(const char* p, const char* end, size_t positionCount, size_t texCoordCount, size_t normalCount,
+                         std::vector<uint32_t>& polygon, std::vector<uint32_t>& corners) {
+    polygon.clear();
+    for (p = skipBlanks(p, end); p < end; p = skipBlanks(p, end)) {
+        // v, v/t, v//n or v/t/n
+        long long values[3] = { 0, 0, 0 };
+        for (int k = 0; k < 3 && p < end && !isBlank(*p); ++k) {
+            if (k > 0 && *p++ != '/') return false;
+            if (p < end && *p != '/' && !isBlank(*p)) {
+                const std::from_chars_result result = std::from_chars(p, end, values[k]);
+                if (result.ec != std::errc()) return false;
+                p = result.ptr;
+            }
+        }
+        if (p < end && !isBlank(*p)) return false;
+        uint32_t corner[3] = { NO_INDEX, NO_INDEX, NO_INDEX };
+        if (!resolveIndex(values[0], positionCount, corner[0])) return false;
+        if (values[1] != 0 && !resolveIndex(values[1], texCoordCount, corner[1])) return false;
+        if (values[2] != 0 && !resolveIndex(values[2], normalCount, corner[2])) return false;
+        polygon.insert(polygon.end(), corner, corner + 3);
+    }
+    const size_t cornerCount = polygon.size() / 3;
+    if (cornerCount < 3) return false;
+    for (size_t i = 1; i + 1 < cornerCount; ++i) { // Fan around the first corner
+        corners.insert(corners.end(), polygon.begin(), polygon.begin() + 3);
+        corners.insert(corners.end(), polygon.begin() + static_cast<std::ptrdiff_t>(i * 3), polygon.begin() + static_cast<std::ptrdiff_t>(i * 3 + 6));
+    }
+    return true;
+}
+
+static void parseObjChunk(ObjChunk& chunk) {
+    chunk.positions.reserve(chunk.positionCount * 6);
+    chunk.texCoords.reserve(chunk.texCoordCount * 2);
+    chunk.normals.reserve(chunk.normalCount * 3);
+    // Global counts so far, for resolving relative indices.
+    size_t positionCount = chunk.positionBase, texCoordCount = chunk.texCoordBase, normalCount = chunk.normalBase;
+    std::vector<uint32_t> polygon;
+    size_t lineNumber = chunk.lineBase;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        ++lineNumber;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(chunk.end - line)));
+        const char* end = newline ? newline : chunk.end;
+        const char* p = skipBlanks(line, end);
+        line = newline ? newline + 1 : chunk.end;
+
+        bool ok = true;
+        switch (objLineKind(p, end)) {
+        case 'v': {
+            // x y z, optionally followed by w (ignored) or an r g b color.
+            float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+            p += 1;
+            ok = parseFloat(p, end, values[0]) && parseFloat(p, end, values[1]) && parseFloat(p, end, values[2]);
+            float extra[3];
+            int extraCount = 0;
+            while (ok && extraCount < 3 && skipBlanks(p, end) < end) ok = parseFloat(p, end, extra[extraCount++]);
+            if (extraCount == 3) {
+                std::memcpy(values + 3, extra, sizeof(extra));
+            }
+            ok = ok && (extraCount == 0 || extraCount == 1 || extraCount == 3);
+            chunk.positions.insert(chunk.positions.end(), values, values + 6);
+            ++positionCount;
+            break;
+        }
+        case 't': {
+            float u = 0.0f, v = 0.0f;
+            p += 2;
+            ok = parseFloat(p, end, u) && (skipBlanks(p, end) == end || parseFloat(p, end, v));
+            chunk.texCoords.push_back(u);
+            chunk.texCoords.push_back(1.0f - v);
+            ++texCoordCount;
+            break;
+        }
+        case 'n': {
+            float n[3] = { 0.0f, 0.0f, 0.0f };
+            p += 2;
+            ok = parseFloat(p, end, n[0]) && parseFloat(p, end, n[1]) && parseFloat(p, end, n[2]);
+            chunk.normals.insert(chunk.normals.end(), n, n + 3);
+            ++normalCount;
+            break;
+        }
+        case 'f':
+            ok = parseObjFace(p + 1, end, positionCount, texCoordCount, normalCount, polygon, chunk.corners);
+            break;
+        default: // Comments, o, g, s, usemtl, mtllib, l, p, ...
+            break;
+        }
+        if (!ok) {
+            chunk.errorLine = lineNumber;
+            return;
+        }
+    }
+}
+
+// True if the triangles form closed surfaces: every edge between two positions is used exactly
+// once in each direction. Seen from outside, such a mesh never shows a back face. Degenerate
+// triangles and non-manifold edges count as open.
+static bool isClosedObjMesh(const std::vector<uint32_t>& indices, const std::vector<ObjCornerKey>& vertexKeys) {
+    std::vector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        for (size_t k = 0; k < 3; ++k) {
+            const uint64_t from = vertexKeys[indices[i + k]].position, to = vertexKeys[indices[i + (k + 1) % 3]].position;
+            if (from == to) return false;
+            edges.push_back(from << 32 | to);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (i > 0 && edges[i] == edges[i - 1]) return false;
+        if (!std::binary_search(edges.begin(), edges.end(), edges[i] << 32 | edges[i] >> 32)) return false;
+    }
+    return true;
+}
+
+bool MeshImporter::importOBJ(const std::string& path, MeshData& out, ThreadPool* pool) {
+    std::vector<char> bytes;
+    if (!readFile(path, bytes)) {
+        std::cerr << "ERROR::MESH_IMPORTER::IMPORT_OBJ: Cannot read '" << path << "'." << std::endl;
+        return false;
+    }
+
+    // Chunks of at least 1 MB, about four per thread, each ending after a newline.
+    const size_t threads = pool ? pool->getThreadCount() : 1;
+    const size_t chunkCount = std::max<size_t>(1, std::min(bytes.size() >> 20, threads * 4));
+    std::vector<ObjChunk> chunks(chunkCount);
+    const char* data = bytes.data();
+    const char* dataEnd = data + bytes.size();
+    const char* start = data;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* end = i + 1 == chunkCount ? dataEnd : std::max(start, data + bytes.size() * (i + 1) / chunkCount);
+        const char* newline = static_cast<const char*>(std::memchr(end, '\n', static_cast<size_t>(dataEnd - end)));
+        end = i + 1 == chunkCount || !newline ? dataEnd : newline + 1;
+        chunks[i].begin = start;
+        chunks[i].end = end;
+        start = end;
+    }
+
+    forRange(pool, chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) countObjLines(chunks[i]);
+    });
+    size_t positionTotal = 0, texCoordTotal = 0, normalTotal = 0, lineTotal = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.lineBase = lineTotal;
+        chunk.positionBase = positionTotal;
+        chunk.texCoordBase = texCoordTotal;
+        chunk.normalBase = normalTotal;
+        lineTotal += chunk.lineCount;
+        positionTotal += chunk.positionCount;
+        texCoordTotal += chunk.texCoordCount;
+        normalTotal += chunk.normalCount;
+    }
+    forRange(pool, chunkCount, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) parseObjChunk(chunks[i]);
+    });
+
+    size_t cornerTotal = 0;
+    for (const ObjChunk& chunk : chunks) {
+        if (chunk.errorLine != 0) {
+            std::cerr << "ERROR::MESH_IMPORTER::IMPORT_OBJ: " << path << ":" << chunk.errorLine << ": Malformed line." << std::endl;
+            return false;
+        }
+        cornerTotal += chunk.corners.size() / 3;
+    }
+    if (cornerTotal == 0 || positionTotal >= NO_INDEX) {
+        std::cerr << "ERROR::MESH_IMPORTER::IMPORT_OBJ: '" << path << "' has no faces or too many vertices." << std::endl;
+        return false;
+    }
+
+    // Global attribute arrays, in file order.
+    std::vector<float> positions, texCoords, normals;
+    positions.reserve(positionTotal * 6);
+    texCoords.reserve(texCoordTotal * 2);
+    normals.reserve(normalTotal * 3);
+    for (const ObjChunk& chunk : chunks) {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+    }
+
+    // Weld corners into vertices. Without texture coordinates and normals the positions are the
+    // vertices; otherwise each distinct (position, texture coordinate, normal) becomes one. The
+    // vertices of a position are chained from it, and a position rarely has more than a few, so
+    // lookups are a short walk instead of a hash.
+    out.format = VertexFormat::positionColorNormalUV();
+    out.indices.clear();
+    out.indices.reserve(cornerTotal);
+    std::vector<ObjCornerKey> vertexKeys;
+    if (texCoordTotal == 0 && normalTotal == 0) {
+        vertexKeys.resize(positionTotal);
+        for (size_t i = 0; i < positionTotal; ++i) vertexKeys[i] = ObjCornerKey{ static_cast<uint32_t>(i), NO_INDEX, NO_INDEX };
+        for (const ObjChunk& chunk : chunks) {
+            for (size_t c = 0; c < chunk.corners.size(); c += 3) out.indices.push_back(chunk.corners[c]);
+        }
+    } else {
+        std::vector<uint32_t> firstVertex(positionTotal, NO_INDEX); // Per position
+        std::vector<uint32_t> nextVertex;                          // Per vertex, within its position's chain
+        vertexKeys.reserve(positionTotal + positionTotal / 4);
+        nextVertex.reserve(positionTotal + positionTotal / 4);
+        for (const ObjChunk& chunk : chunks) {
+            for (size_t c = 0; c < chunk.corners.size(); c += 3) {
+                const ObjCornerKey key{ chunk.corners[c], chunk.corners[c + 1], chunk.corners[c + 2] };
+                uint32_t vertex = firstVertex[key.position];
+                while (vertex != NO_INDEX && !(vertexKeys[vertex] == key)) vertex = nextVertex[vertex];
+                if (vertex == NO_INDEX) {
+                    vertex = static_cast<uint32_t>(vertexKeys.size());
+                    vertexKeys.push_back(key);
+                    nextVertex.push_back(firstVertex[key.position]);
+                    firstVertex[key.position] = vertex;
+                }
+                out.indices.push_back(vertex);
+            }
+        }
+    }
+
+    const size_t vertexCount = vertexKeys.size();
+    out.vertices.resize(vertexCount * VERTEX_FLOATS);
+    forRange(pool, vertexCount, 16384, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const ObjCornerKey& key = vertexKeys[v];
+            float* vertex = &out.vertices[v * VERTEX_FLOATS];
+            std::memcpy(vertex, &positions[static_cast<size_t>(key.position) * 6], 6 * sizeof(float));
+            if (key.normal != NO_INDEX) {
+                std::memcpy(vertex + 6, &normals[static_cast<size_t>(key.normal) * 3], 3 * sizeof(float));
+            } else {
+                vertex[6] = 0.0f;
+                vertex[7] = 1.0f;
+                vertex[8] = 0.0f;
+            }
+            vertex[9] = key.texCoord != NO_INDEX ? texCoords[static_cast<size_t>(key.texCoord) * 2] : 0.0f;
+            vertex[10] = key.texCoord != NO_INDEX ? texCoords[static_cast<size_t>(key.texCoord) * 2 + 1] : 0.0f;
+        }
+    });
+    // Smooth normals when the file has none; vertices split by texture seams still share them.
+    if (normalTotal == 0) {
+        std::vector<uint32_t> sharedSlot;
+        if (vertexCount != positionTotal || texCoordTotal != 0) {
+            sharedSlot.resize(vertexCount);
+            for (size_t v = 0; v < vertexCount; ++v) sharedSlot[v] = vertexKeys[v].position;
+        }
+        computeNormals(out.vertices.data(), vertexCount, out.indices.data(), out.indices.size(), sharedSlot, positionTotal);
+    }
+    out.singleSided = isClosedObjMesh(out.indices, vertexKeys);
+    return true;
+}
+
+// --- JSON ---
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;                           // Array
+    std::vector<std::pair<std::string, JsonValue>> members; // Object
+
+    // Missing keys and indices read as null.
+    const JsonValue& operator[](const std::string& key) const {
+        for (const auto& member : members) {
+            if (member.first == key) return member.second;
+        }
+        return null();
+    }
+    const JsonValue& operator[](size_t index) const { return index < items.size() ? items[index] : null(); }
+    size_t size() const { return items.size(); }
+    bool isNull() const { return type == Type::Null; }
+    double asNumber(double fallback = 0.0) const { return type == Type::Number ? number : fallback; }
+    // Non-negative integer, or 'fallback' for anything else.
+    size_t asIndex(size_t fallback = static_cast<size_t>(-1)) const {
+        return type == Type::Number && number >= 0.0 && number < 9.0e15 ? static_cast<size_t>(number) : fallback;
+    }
+
+    static const JsonValue& null() {
+        static const JsonValue value;
+        return value;
+    }
+};
+
+static const char* skipJsonSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    return p;
+}
+
+static void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+static bool parseJsonString(const char*& p, const char* end, std::string& out) {
+    ++p; // Opening quote
+    while (p < end && *p != '"') {
+        if (*p != '\\') {
+            out += *p++;
+            continue;
+        }
+        if (++p >= end) return false;
+        const char escape = *p++;
+        switch (escape) {
+        case '"': case '\\': case '/': out += escape; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t code = 0;
+            if (end - p < 4 || std::from_chars(p, p + 4, code, 16).ptr != p + 4) return false;
+            appendUtf8(out, code); // Surrogate pairs stay separate; names and URIs here are ASCII
+            p += 4;
+            break;
+        }
+        default: return false;
+        }
+    }
+    if (p >= end) return false;
+    ++p; // Closing quote
+    return true;
+}
+
+static bool parseJson(const char*& p, const char* end, JsonValue& value, int depth) {
+    p = skipJsonSpace(p, end);
+    if (p >= end || depth > 64) return false;
+    if (*p == '{') {
+        value.type = JsonValue::Type::Object;
+        p = skipJsonSpace(p + 1, end);
+        if (p < end && *p == '}') return ++p, true;
+        for (;;) {
+            p = skipJsonSpace(p, end);
+            std::pair<std::string, JsonValue> member;
+            if (p >= end || *p != '"' || !parseJsonString(p, end, member.first)) return false;
+            p = skipJsonSpace(p, end);
+            if (p >= end || *p++ != ':' || !parseJson(p, end, member.second, depth + 1)) return false;
+            value.members.push_back(std::move(member));
+            p = skipJsonSpace(p, end);
+            if (p < end && *p == ',') { ++p; continue; }
+            if (p < end && *p == '}') return ++p, true;
+            return false;
+        }
+    }
+    if (*p == '[') {
+        value.type = JsonValue::Type::Array;
+        p = skipJsonSpace(p + 1, end);
+        if (p < end && *p == ']') return ++p, true;
+        for (;;) {
+            value.items.emplace_back();
+            if (!parseJson(p, end, value.items.back(), depth + 1)) return false;
+            p = skipJsonSpace(p, end);
+            if (p < end && *p == ',') { ++p; continue; }
+            if (p < end && *p == ']') return ++p, true;
+            return false;
+        }
+    }
+    if (*p == '"') {
+        value.type = JsonValue::Type::String;
+        return parseJsonString(p, end, value.string);
+    }
+    static const char* literals[3] = { "true", "false", "null" };
+    for (int i = 0; i < 3; ++i) {
+        const size_t length = std::strlen(literals[i]);
+        if (static_cast<size_t>(end - p) >= length && std::memcmp(p, literals[i], length) == 0) {
+            value.type = i == 2 ? JsonValue::Type::Null : JsonValue::Type::Bool;
+            value.boolean = i == 0;
+            p += length;
+            return true;
+        }
+    }
+    value.type = JsonValue::Type::Number;
+    const std::from_chars_result result = std::from_chars(p, end, value.number);
+    if (result.ec != std::errc()) return false;
+    p = result.ptr;
+    return true;
+}
+
+// --- glTF ---
+
+// An accessor resolved to its bytes: element i starts at data + i * stride.
+struct GltfAccessor {
+    const uint8_t* data = nullptr;
+    size_t count = 0;
+    size_t stride = 0;
+    uint32_t componentType = 0;
+    uint32_t components = 0;
+    bool normalized = false;
+};
+
+// A primitive to import and the world matrix of the node instancing it (column-major).
+struct GltfDraw {
+    size_t mesh;
+    size_t primitive;
+    float matrix[16];
+    size_t firstVertex, vertexCount;
+    size_t firstIndex, indexCount;
+};
+
+static const uint32_t GLTF_BYTE = 5120, GLTF_UNSIGNED_BYTE = 5121, GLTF_SHORT = 5122, GLTF_UNSIGNED_SHORT = 5123,
+                      GLTF_UNSIGNED_INT = 5125, GLTF_FLOAT = 5126;
+
+static bool decodeBase64(const char* p, const char* end, std::vector<uint8_t>& out) {
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (; p < end && *p != '='; ++p) {
+        const char c = *p;
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '+') value = 62;
+        else if (c == '/') value = 63;
+        else return false;
+        bits = (bits << 6) | static_cast<uint32_t>(value);
+        bitCount += 6;
+        if (bitCount >= 8) {
+            bitCount -= 8;
+            out.push_back(static_cast<uint8_t>(bits >> bitCount));
+        }
+    }
+    return true;
+}
+
+// Buffer 'uri': a base64 data URI or a path relative to the glTF file (with %XX escapes).
+static bool loadGltfBuffer(const std::string& uri, const std::string& directory, std::vector<uint8_t>& out) {
+    if (uri.compare(0, 5, "data:") == 0) {
+        const size_t comma = uri.find(',');
+        if (comma == std::string::npos || uri.find(";base64") > comma) return false;
+        return decodeBase64(uri.data() + comma + 1, uri.data() + uri.size(), out);
+    }
+    std::string path = directory;
+    for (size_t i = 0; i < uri.size(); ++i) {
+        unsigned int code = 0;
+        if (uri[i] == '%' && i + 2 < uri.size() && std::from_chars(uri.data() + i + 1, uri.data() + i + 3, code, 16).ptr == uri.data() + i + 3) {
+            path += static_cast<char>(code);
+            i += 2;
+        } else {
+            path += uri[i];
+        }
+    }
+    std::vector<char> bytes;
+    if (!readFile(path, bytes)) return false;
+    out.assign(bytes.begin(), bytes.end());
+    return true;
+}
+
+static uint32_t gltfComponentSize(uint32_t componentType) {
+    switch (componentType) {
+    case GLTF_BYTE: case GLTF_UNSIGNED_BYTE: return 1;
+    case GLTF_SHORT: case GLTF_UNSIGNED_SHORT: return 2;
+    case GLTF_UNSIGNED_INT: case GLTF_FLOAT: return 4;
+    default: return 0;
+    }
+}
+
+static bool getGltfAccessor(const JsonValue& gltf, const std::vector<std::vector<uint8_t>>& buffers, size_t index, GltfAccessor& out) {
+    const JsonValue& accessor = gltf["accessors"][index];
+    const JsonValue& view = gltf["bufferViews"][accessor["bufferView"].asIndex()];
+    const size_t bufferIndex = view["buffer"].asIndex();
+    if (accessor.isNull() || view.isNull() || bufferIndex >= buffers.size() || !accessor["sparse"].isNull()) return false;
+
+    static const char* types[4] = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+    out.components = 0;
+    for (uint32_t i = 0; i < 4; ++i) {
+        if (accessor["type"].string == types[i]) out.components = i + 1;
+    }
+    out.componentType = static_cast<uint32_t>(accessor["componentType"].asIndex(0));
+    out.normalized = accessor["normalized"].boolean;
+    out.count = accessor["count"].asIndex(0);
+    const size_t componentSize = gltfComponentSize(out.componentType);
+    const size_t elementSize = componentSize * out.components;
+    if (elementSize == 0) return false;
+    out.stride = view["byteStride"].asIndex(0);
+    if (out.stride == 0) out.stride = elementSize;
+
+    const std::vector<uint8_t>& buffer = buffers[bufferIndex];
+    const size_t viewOffset = view["byteOffset"].asIndex(0), viewLength = view["byteLength"].asIndex(0);
+    const size_t offset = accessor["byteOffset"].asIndex(0);
+    if (viewOffset > buffer.size() || viewLength > buffer.size() - viewOffset || out.stride < elementSize) return false;
+    if (out.count > 0 && (offset > viewLength || (out.count - 1) > (viewLength - offset - std::min(elementSize, viewLength - offset)) / out.stride ||
+                          offset + (out.count - 1) * out.stride + elementSize > viewLength)) {
+        return false;
+    }
+    out.data = buffer.data() + viewOffset + offset;
+    return true;
+}
+
+static float readGltfComponent(const uint8_t* p, uint32_t componentType, bool normalized) {
+    switch (componentType) {
+    case GLTF_FLOAT: { float v; std::memcpy(&v, p, 4); return v; }
+    case GLTF_UNSIGNED_BYTE: return normalized ? p[0] / 255.0f : p[0];
+    case GLTF_BYTE: { const int8_t v = static_cast<int8_t>(p[0]); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+    case GLTF_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, p, 2); return normalized ? v / 65535.0f : v; }
+    case GLTF_SHORT: { int16_t v; std::memcpy(&v, p, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+    case GLTF_UNSIGNED_INT: { uint32_t v; std::memcpy(&v, p, 4); return static_cast<float>(v); }
+    default: return 0.0f;
+    }
+}
+
+// Element 'i' of 'accessor' into 'out' (up to 'count' components; missing ones keep their value).
+static void readGltfElement(const GltfAccessor& accessor, size_t i, float* out, uint32_t count) {
+    const uint8_t* p = accessor.data + i * accessor.stride;
+    const uint32_t size = gltfComponentSize(accessor.componentType);
+    for (uint32_t c = 0; c < std::min(count, accessor.components); ++c) out[c] = readGltfComponent(p + c * size, accessor.componentType, accessor.normalized);
+}
+
+static void multiplyMatrix(const float* a, const float* b, float* out) {
+    float result[16];
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) sum += a[k * 4 + row] * b[column * 4 + k];
+            result[column * 4 + row] = sum;
+        }
+    }
+    std::memcpy(out, result, sizeof(result));
+}
+
+// Local matrix of a node: 'matrix', or translation * rotation * scale.
+static void gltfNodeMatrix(const JsonValue& node, float* m) {
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        for (size_t i = 0; i < 16; ++i) m[i] = static_cast<float>(matrix[i].asNumber());
+        return;
+    }
+    const JsonValue& t = node["translation"];
+    const JsonValue& r = node["rotation"];
+    const JsonValue& s = node["scale"];
+    const float x = static_cast<float>(r[0].asNumber(0.0)), y = static_cast<float>(r[1].asNumber(0.0));
+    const float z = static_cast<float>(r[2].asNumber(0.0)), w = static_cast<float>(r[3].asNumber(1.0));
+    const float scale[3] = { static_cast<float>(s[0].asNumber(1.0)), static_cast<float>(s[1].asNumber(1.0)), static_cast<float>(s[2].asNumber(1.0)) };
+    const float rotation[9] = { // Columns
+        1 - 2 * (y * y + z * z), 2 * (x * y + z * w),     2 * (x * z - y * w),
+        2 * (x * y - z * w),     1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+        2 * (x * z + y * w),     2 * (y * z - x * w),     1 - 2 * (x * x + y * y)
+    };
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) m[column * 4 + row] = rotation[column * 3 + row] * scale[column];
+        m[column * 4 + 3] = 0.0f;
+    }
+    for (int row = 0; row < 3; ++row) m[12 + row] = static_cast<float>(t[static_cast<size_t>(row)].asNumber(0.0));
+    m[15] = 1.0f;
+}
+
+static void collectGltfDraws(const JsonValue& gltf, size_t nodeIndex, const float* parent, int depth, std::vector<GltfDraw>& draws) {
+    const JsonValue& node = gltf["nodes"][nodeIndex];
+    if (node.isNull() || depth > 64) return; // Missing node or a cycle
+    float world[16];
+    gltfNodeMatrix(node, world);
+    multiplyMatrix(parent, world, world);
+    const size_t meshIndex = node["mesh"].asIndex();
+    const JsonValue& mesh = gltf["meshes"][meshIndex];
+    for (size_t p = 0; p < mesh["primitives"].size(); ++p) {
+        GltfDraw draw{};
+        draw.mesh = meshIndex;
+        draw.primitive = p;
+        std::memcpy(draw.matrix, world, sizeof(world));
+        draws.push_back(draw);
+    }
+    const JsonValue& children = node["children"];
+    for (size_t i = 0; i < children.size(); ++i) collectGltfDraws(gltf, children[i].asIndex(), world, depth + 1, draws);
+}
+
+// Converts one primitive into its vertex and index ranges of 'out'. Returns false on bad data.
+static bool convertGltfDraw(const JsonValue& gltf, const std::vector<std::vector<uint8_t>>& buffers, const GltfDraw& draw, MeshData& out) {
+    const JsonValue& primitive = gltf["meshes"][draw.mesh]["primitives"][draw.primitive];
+    const JsonValue& attributes = primitive["attributes"];
+    GltfAccessor positions, normals, texCoords, colors, indices;
+    if (!getGltfAccessor(gltf, buffers, attributes["POSITION"].asIndex(), positions)) return false;
+    const bool hasNormals = !attributes["NORMAL"].isNull();
+    const bool hasTexCoords = !attributes["TEXCOORD_0"].isNull();
+    const bool hasColors = !attributes["COLOR_0"].isNull();
+    const bool indexed = !primitive["indices"].isNull();
+    if ((hasNormals && !getGltfAccessor(gltf, buffers, attributes["NORMAL"].asIndex(), normals)) ||
+        (hasTexCoords && !getGltfAccessor(gltf, buffers, attributes["TEXCOORD_0"].asIndex(), texCoords)) ||
+        (hasColors && !getGltfAccessor(gltf, buffers, attributes["COLOR_0"].asIndex(), colors)) ||
+        (indexed && !getGltfAccessor(gltf, buffers, primitive["indices"].asIndex(), indices))) {
+        return false;
+    }
+    if ((hasNormals && normals.count < draw.vertexCount) || (hasTexCoords && texCoords.count < draw.vertexCount) ||
+        (hasColors && colors.count < draw.vertexCount)) {
+        return false;
+    }
+
+    // Normals go through the cofactor matrix (the inverse transpose up to scale), flipped with
+    // the winding when the node mirrors.
+    const float* m = draw.matrix;
+    float cofactor[9] = {
+        m[5] * m[10] - m[6] * m[9], m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+        m[2] * m[9] - m[1] * m[10], m[0] * m[10] - m[2] * m[8], m[1] * m[8] - m[0] * m[9],
+        m[1] * m[6] - m[2] * m[5], m[2] * m[4] - m[0] * m[6], m[0] * m[5] - m[1] * m[4]
+    };
+    const float determinant = m[0] * cofactor[0] + m[4] * cofactor[1] + m[8] * cofactor[2];
+    const bool mirrored = determinant < 0.0f;
+    if (mirrored) {
+        for (float& c : cofactor) c = -c;
+    }
+
+    float* vertices = &out.vertices[draw.firstVertex * VERTEX_FLOATS];
+    for (size_t v = 0; v < draw.vertexCount; ++v) {
+        float position[3] = { 0.0f, 0.0f, 0.0f }, normal[3] = { 0.0f, 1.0f, 0.0f }, uv[2] = { 0.0f, 0.0f };
+        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        readGltfElement(positions, v, position, 3);
+        if (hasNormals) readGltfElement(normals, v, normal, 3);
+        if (hasTexCoords) readGltfElement(texCoords, v, uv, 2);
+        if (hasColors) readGltfElement(colors, v, color, 3);
+        float* vertex = &vertices[v * VERTEX_FLOATS];
+        for (int row = 0; row < 3; ++row) {
+            vertex[row] = m[row] * position[0] + m[4 + row] * position[1] + m[8 + row] * position[2] + m[12 + row];
+            vertex[3 + row] = color[row];
+        }
+        // cofactor is stored row by row: row i is the i-th component of the transformed normal.
+        float n[3];
+        for (int row = 0; row < 3; ++row) n[row] = cofactor[row] * normal[0] + cofactor[3 + row] * normal[1] + cofactor[6 + row] * normal[2];
+        const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        for (int row = 0; row < 3; ++row) vertex[6 + row] = length > 0.0f ? n[row] / length : normal[row];
+        vertex[9] = uv[0]; // glTF UVs already start at the top-left, like the images here
+        vertex[10] = uv[1];
+    }
+
+    uint32_t* target = &out.indices[draw.firstIndex];
+    for (size_t i = 0; i < draw.indexCount; ++i) {
+        uint32_t index = static_cast<uint32_t>(i);
+        if (indexed) {
+            float value = 0.0f;
+            if (indices.components != 1 || indices.componentType == GLTF_FLOAT) return false;
+            const uint8_t* p = indices.data + i * indices.stride;
+            if (indices.componentType == GLTF_UNSIGNED_INT) std::memcpy(&index, p, 4);
+            else { readGltfElement(indices, i, &value, 1); index = static_cast<uint32_t>(value); }
+        }
+        if (index >= draw.vertexCount) return false;
+        target[i] = index;
+    }
+    if (mirrored) {
+        for (size_t i = 0; i + 2 < draw.indexCount; i += 3) std::swap(target[i + 1], target[i + 2]);
+    }
+    if (!hasNormals) computeNormals(vertices, draw.vertexCount, target, draw.indexCount, std::vector<uint32_t>(), draw.vertexCount);
+    for (size_t i = 0; i < draw.indexCount; ++i) target[i] += static_cast<uint32_t>(draw.firstVertex);
+    return true;
+}
+
+bool MeshImporter::importGLTF(const std::string& path, MeshData& out, ThreadPool* pool) {
+    std::vector<char> bytes;
+    if (!readFile(path, bytes)) {
+        std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: Cannot read '" << path << "'." << std::endl;
+        return false;
+    }
+    // .glb: 12-byte header, then a JSON chunk and an optional BIN chunk (buffer 0).
+    const char* json = bytes.data();
+    const char* jsonEnd = bytes.data() + bytes.size();
+    std::vector<uint8_t> binaryChunk;
+    bool binary = false;
+    if (bytes.size() >= 20 && std::memcmp(bytes.data(), "glTF", 4) == 0) {
+        binary = true;
+        uint32_t chunkLength = 0, chunkType = 0;
+        std::memcpy(&chunkLength, bytes.data() + 12, 4);
+        std::memcpy(&chunkType, bytes.data() + 16, 4);
+        if (chunkType != 0x4E4F534A || chunkLength > bytes.size() - 20) { // "JSON"
+            std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: '" << path << "' is not a valid .glb file." << std::endl;
+            return false;
+        }
+        json = bytes.data() + 20;
+        jsonEnd = json + chunkLength;
+        const size_t binOffset = 20 + ((chunkLength + 3) & ~3u);
+        if (binOffset + 8 <= bytes.size()) {
+            uint32_t binLength = 0, binType = 0;
+            std::memcpy(&binLength, bytes.data() + binOffset, 4);
+            std::memcpy(&binType, bytes.data() + binOffset + 4, 4);
+            if (binType == 0x004E4942 && binLength <= bytes.size() - binOffset - 8) { // "BIN"
+                binaryChunk.assign(bytes.begin() + static_cast<std::ptrdiff_t>(binOffset + 8),
+                                   bytes.begin() + static_cast<std::ptrdiff_t>(binOffset + 8 + binLength));
+            }
+        }
+    }
+    JsonValue gltf;
+    const char* cursor = json;
+    if (!parseJson(cursor, jsonEnd, gltf, 0) || gltf.type != JsonValue::Type::Object) {
+        std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: '" << path << "' is not valid glTF JSON." << std::endl;
+        return false;
+    }
+
+    const size_t slash = path.find_last_of("/\\");
+    const std::string directory = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    std::vector<std::vector<uint8_t>> buffers(gltf["buffers"].size());
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const JsonValue& uri = gltf["buffers"][i]["uri"];
+        const bool ok = uri.isNull() ? (binary && i == 0) : loadGltfBuffer(uri.string, directory, buffers[i]);
+        if (uri.isNull() && ok) buffers[i].swap(binaryChunk);
+        if (!ok) {
+            std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: Cannot load buffer " << i << " of '" << path << "'." << std::endl;
+            return false;
+        }
+    }
+
+    // The default scene's node tree, or every mesh untransformed if there is no scene.
+    std::vector<GltfDraw> draws;
+    static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    const JsonValue& scene = gltf["scenes"][gltf["scene"].asIndex(0)];
+    if (!scene.isNull()) {
+        for (size_t i = 0; i < scene["nodes"].size(); ++i) collectGltfDraws(gltf, scene["nodes"][i].asIndex(), identity, 0, draws);
+    } else {
+        for (size_t meshIndex = 0; meshIndex < gltf["meshes"].size(); ++meshIndex) {
+            for (size_t p = 0; p < gltf["meshes"][meshIndex]["primitives"].size(); ++p) {
+                GltfDraw draw{};
+                draw.mesh = meshIndex;
+                draw.primitive = p;
+                std::memcpy(draw.matrix, identity, sizeof(identity));
+                draws.push_back(draw);
+            }
+        }
+    }
+
+    // Sizes first, so every primitive can be converted into its own range in parallel.
+    size_t vertexTotal = 0, indexTotal = 0, skipped = 0;
+    std::vector<GltfDraw> triangleDraws;
+    for (GltfDraw& draw : draws) {
+        const JsonValue& primitive = gltf["meshes"][draw.mesh]["primitives"][draw.primitive];
+        const JsonValue& accessors = gltf["accessors"];
+        if (primitive["mode"].asIndex(4) != 4) { // TRIANGLES only
+            ++skipped;
+            continue;
+        }
+        draw.vertexCount = accessors[primitive["attributes"]["POSITION"].asIndex()]["count"].asIndex(0);
+        draw.indexCount = primitive["indices"].isNull() ? draw.vertexCount : accessors[primitive["indices"].asIndex()]["count"].asIndex(0);
+        draw.indexCount -= draw.indexCount % 3;
+        if (draw.vertexCount == 0 || draw.indexCount == 0) {
+            ++skipped;
+            continue;
+        }
+        draw.firstVertex = vertexTotal;
+        draw.firstIndex = indexTotal;
+        vertexTotal += draw.vertexCount;
+        indexTotal += draw.indexCount;
+        triangleDraws.push_back(draw);
+    }
+    if (skipped > 0) std::cerr << "WARNING::MESH_IMPORTER::IMPORT_GLTF: Skipped " << skipped << " non-triangle or empty primitives in '" << path << "'." << std::endl;
+    if (triangleDraws.empty() || vertexTotal >= NO_INDEX) {
+        std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: '" << path << "' has no triangles or too many vertices." << std::endl;
+        return false;
+    }
+
+    out.format = VertexFormat::positionColorNormalUV();
+    out.vertices.resize(vertexTotal * VERTEX_FLOATS);
+    out.indices.resize(indexTotal);
+    // Single-sided unless a primitive's material is double-sided (the default material is not).
+    out.singleSided = true;
+    for (const GltfDraw& draw : triangleDraws) {
+        const JsonValue& primitive = gltf["meshes"][draw.mesh]["primitives"][draw.primitive];
+        if (gltf["materials"][primitive["material"].asIndex()]["doubleSided"].boolean) out.singleSided = false;
+    }
+    std::vector<uint8_t> failed(triangleDraws.size(), 0);
+    forRange(pool, triangleDraws.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) failed[i] = convertGltfDraw(gltf, buffers, triangleDraws[i], out) ? 0 : 1;
+    });
+    for (size_t i = 0; i < failed.size(); ++i) {
+        if (failed[i]) {
+            std::cerr << "ERROR::MESH_IMPORTER::IMPORT_GLTF: Mesh " << triangleDraws[i].mesh << ", primitive " << triangleDraws[i].primitive
+                      << " of '" << path << "' has missing or out-of-range data." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
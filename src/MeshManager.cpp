@@ -0,0 +1,166 @@
+// MeshManager.cpp
+// Implementation of the arena-based mesh storage.
+
+#include "MyFirstEngine/MeshManager.h"
+#include "glad/glad.h" // For OpenGL functions
+#include <algorithm>   // For std::max
+#include <iostream>    // For std::cerr (error output)
+#include <utility>     // For std::move
+
+MeshManager::MeshManager()
+    : maxMeshes(0xFFFFFFFFu) {
+}
+
+MeshManager::~MeshManager() {
+    for (Arena& arena : arenas) {
+        if (arena.vertexBuffer != 0) glDeleteBuffers(1, &arena.vertexBuffer);
+        if (arena.indexBuffer != 0) glDeleteBuffers(1, &arena.indexBuffer);
+        if (arena.VAO != 0) glDeleteVertexArrays(1, &arena.VAO);
+    }
+}
+
+// GL type and normalization of a vertex component type.
+static void getGLComponentType(VertexComponentType type, GLenum& glType, GLboolean& normalized) {
+    switch (type) {
+    case VertexComponentType::Float16: glType = GL_HALF_FLOAT; normalized = GL_FALSE; break;
+    case VertexComponentType::SNorm16: glType = GL_SHORT; normalized = GL_TRUE; break;
+    case VertexComponentType::UNorm8: glType = GL_UNSIGNED_BYTE; normalized = GL_TRUE; break;
+    case VertexComponentType::SNorm10_10_10_2: glType = GL_INT_2_10_10_10_REV; normalized = GL_TRUE; break;
+    default: glType = GL_FLOAT; normalized = GL_FALSE; break;
+    }
+}
+
+uint32_t MeshManager::createArena(const VertexFormat& format, size_t vertexCapacity, size_t indexCapacity) {
+    Arena arena;
+    arena.format = format;
+    arena.vertexRanges = RangeAllocator(vertexCapacity);
+    arena.indexRanges = RangeAllocator(indexCapacity);
+    glGenVertexArrays(1, &arena.VAO);
+    glGenBuffers(1, &arena.vertexBuffer);
+    glGenBuffers(1, &arena.indexBuffer);
+
+    glBindVertexArray(arena.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexCapacity * format.stride, nullptr, GL_STATIC_DRAW);
+    // The element buffer binding is part of the VAO state.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity * sizeof(uint32_t), nullptr, GL_STATIC_DRAW);
+
+    // Per-vertex attributes as declared by the format.
+    for (uint32_t i = 0; i < format.elementCount; ++i) {
+        const VertexFormat::Element& element = format.elements[i];
+        const GLuint location = static_cast<GLuint>(element.attribute);
+        GLenum glType;
+        GLboolean normalized;
+        getGLComponentType(element.type, glType, normalized);
+        glVertexAttribPointer(location, static_cast<GLint>(element.components), glType, normalized,
+                              static_cast<GLsizei>(format.stride), (void*)(uintptr_t)element.offset);
+        glEnableVertexAttribArray(location);
+    }
+    // Per-instance model matrix: four vec4 columns, advancing once per instance.
+    // Pointers are set by the Renderer, which owns the instance buffer.
+    for (GLuint column = 0; column < 4; ++column) {
+        glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + column);
+        glVertexAttribDivisor(INSTANCE_MODEL_LOCATION + column, 1);
+    }
+    glEnableVertexAttribArray(INSTANCE_FADE_LOCATION);
+    glVertexAttribDivisor(INSTANCE_FADE_LOCATION, 1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // After the VAO is unbound, so the VAO keeps it
+
+    arenas.push_back(arena);
+    return static_cast<uint32_t>(arenas.size() - 1);
+}
+
+uint32_t MeshManager::findArena(const VertexFormat& format, size_t vertexCount, size_t indexCount) {
+    for (uint32_t i = 0; i < arenas.size(); ++i) {
+        const Arena& arena = arenas[i];
+        if (arena.format == format && arena.vertexRanges.getLargestFreeRange() >= vertexCount &&
+            arena.indexRanges.getLargestFreeRange() >= indexCount) {
+            return i;
+        }
+    }
+    return createArena(format, std::max(vertexCount, DEFAULT_ARENA_VERTICES), std::max(indexCount, DEFAULT_ARENA_INDICES));
+}
+
+MeshHandle MeshManager::createMesh(const MeshData& data) {
+    return createMesh(MeshDataView(data));
+}
+
+MeshHandle MeshManager::createMesh(const MeshDataView& data) {
+    const size_t vertexCount = data.vertexCount;
+    const size_t indexCount = data.indexCount;
+    if (vertexCount == 0 || indexCount == 0 || data.format.elementCount == 0) {
+        std::cerr << "ERROR::MESH_MANAGER::CREATE_MESH: Mesh has no vertices or indices." << std::endl;
+        return INVALID_RENDER_HANDLE;
+    }
+    for (size_t i = 0; i < indexCount; ++i) {
+        const uint32_t index = data.indices[i];
+        if (index >= vertexCount) {
+            std::cerr << "ERROR::MESH_MANAGER::CREATE_MESH: Index " << index << " out of range ("
+                      << vertexCount << " vertices)." << std::endl;
+            return INVALID_RENDER_HANDLE;
+        }
+    }
+    for (size_t i = 0; data.meshlets && i < data.meshletCount; ++i) {
+        const Meshlet& meshlet = data.meshlets[i];
+        if (meshlet.indexCount % 3 != 0 || meshlet.firstIndex > indexCount || meshlet.indexCount > indexCount - meshlet.firstIndex) {
+            std::cerr << "ERROR::MESH_MANAGER::CREATE_MESH: Meshlet " << i << " out of range (" << indexCount << " indices)." << std::endl;
+            return INVALID_RENDER_HANDLE;
+        }
+    }
+    if (freeHandles.empty() && meshes.size() >= maxMeshes) {
+        std::cerr << "ERROR::MESH_MANAGER::CREATE_MESH: Mesh limit (" << maxMeshes << ") reached." << std::endl;
+        return INVALID_RENDER_HANDLE;
+    }
+
+    const uint32_t arenaIndex = findArena(data.format, vertexCount, indexCount);
+    Arena& arena = arenas[arenaIndex];
+    const size_t firstVertex = arena.vertexRanges.allocate(vertexCount);
+    const size_t firstIndex = arena.indexRanges.allocate(indexCount);
+
+    // Indices stay relative to the mesh; baseVertex moves them to its range at draw time.
+    glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, firstVertex * arena.format.stride, vertexCount * arena.format.stride, data.vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0); // Binding GL_ELEMENT_ARRAY_BUFFER with a VAO bound would change that VAO
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, firstIndex * sizeof(uint32_t), indexCount * sizeof(uint32_t), data.indices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    MeshRecord record;
+    record.info.arena = arenaIndex;
+    record.info.baseVertex = static_cast<int32_t>(firstVertex);
+    record.info.firstIndex = static_cast<uint32_t>(firstIndex);
+    record.info.indexCount = static_cast<uint32_t>(indexCount);
+    record.info.vertexCount = static_cast<uint32_t>(vertexCount);
+    record.info.bounds = data.bounds;
+    record.info.dequantization = data.dequantization;
+    if (data.meshlets) record.meshlets.assign(data.meshlets, data.meshlets + data.meshletCount);
+    record.singleSided = data.singleSided;
+    record.live = true;
+
+    if (!freeHandles.empty()) {
+        MeshHandle handle = freeHandles.back();
+        freeHandles.pop_back();
+        meshes[handle] = std::move(record);
+        return handle;
+    }
+    meshes.push_back(std::move(record));
+    return static_cast<MeshHandle>(meshes.size() - 1);
+}
+
+void MeshManager::destroyMesh(MeshHandle mesh) {
+    if (!isValid(mesh)) {
+        std::cerr << "ERROR::MESH_MANAGER::DESTROY_MESH: Invalid mesh handle " << mesh << "." << std::endl;
+        return;
+    }
+    MeshRecord& record = meshes[mesh];
+    Arena& arena = arenas[record.info.arena];
+    arena.vertexRanges.free(static_cast<size_t>(record.info.baseVertex), record.info.vertexCount);
+    arena.indexRanges.free(record.info.firstIndex, record.info.indexCount);
+    record.meshlets = std::vector<Meshlet>();
+    record.live = false;
+    freeHandles.push_back(mesh);
+}
@@ -0,0 +1,383 @@
+// MeshOptimizer.cpp
+// Forsyth vertex cache ordering, cluster sorting for overdraw, vertex fetch order and quantization.
+
+#include "MyFirstEngine/MeshOptimizer.h"
+#include <algorithm> // For std::stable_sort, std::min, std::max
+#include <cmath>     // For std::pow, std::sqrt, std::lround
+#include <cstring>   // For std::memcpy
+#include <iostream>  // For std::cerr (error output)
+#include <vector>
+
+static const uint32_t NO_VERTEX = 0xFFFFFFFFu;
+
+// --- Vertex cache (Forsyth) ---
+
+// Scores past this many remaining triangles are all about the same.
+static const uint32_t MAX_SCORED_VALENCE = 64;
+
+struct ForsythScores {
+    float cache[MeshOptimizer::VERTEX_CACHE_SIZE];
+    float valence[MAX_SCORED_VALENCE];
+
+    ForsythScores() {
+        const uint32_t cacheSize = MeshOptimizer::VERTEX_CACHE_SIZE;
+        // The three vertices of the last triangle get a fixed score, so the next triangle does not
+        // favour one of its edges; after that the score falls off with the LRU position.
+        for (uint32_t i = 0; i < cacheSize; ++i) {
+            cache[i] = i < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(cacheSize - 3), 1.5f);
+        }
+        // Vertices with few triangles left are finished first, so they can leave the cache for good.
+        valence[0] = 0.0f;
+        for (uint32_t i = 1; i < MAX_SCORED_VALENCE; ++i) valence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+    }
+
+    float score(int32_t cachePosition, uint32_t remaining) const {
+        if (remaining == 0) return -1.0f; // Never chosen again
+        return (cachePosition >= 0 ? cache[cachePosition] : 0.0f) + valence[std::min(remaining, MAX_SCORED_VALENCE - 1)];
+    }
+};
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    static const ForsythScores scores;
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+
+    // Triangles around each vertex; the first remaining[v] entries of a vertex are the ones not
+    // emitted yet.
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) ++remaining[indices[i]];
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) adjacencyOffset[v + 1] = adjacencyOffset[v] + remaining[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) vertexScore[v] = scores.score(-1, remaining[v]);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> output(triangleCount * 3);
+
+    // The cache plus room for the three vertices pushed in front of it.
+    uint32_t cache[VERTEX_CACHE_SIZE + 3], nextCache[VERTEX_CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+    size_t cursor = 0; // Fallback scan when nothing in the cache has triangles left
+    size_t best = 0;
+    for (size_t written = 0; written < triangleCount; ++written) {
+        if (best == static_cast<size_t>(-1)) {
+            while (emitted[cursor]) ++cursor;
+            best = cursor;
+        }
+        const uint32_t* triangle = &indices[best * 3];
+        std::memcpy(&output[written * 3], triangle, 3 * sizeof(uint32_t));
+        emitted[best] = 1;
+
+        // Remove the triangle from its vertices' remaining lists, and push them to the cache front.
+        uint32_t nextCount = 0;
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = triangle[k];
+            uint32_t* list = &adjacency[adjacencyOffset[v]];
+            for (uint32_t i = 0; i < remaining[v]; ++i) {
+                if (list[i] == best) {
+                    list[i] = list[remaining[v] - 1];
+                    --remaining[v];
+                    break;
+                }
+            }
+            bool cached = false;
+            for (uint32_t i = 0; i < nextCount; ++i) cached = cached || nextCache[i] == v;
+            if (!cached) nextCache[nextCount++] = v;
+        }
+        for (uint32_t i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) nextCache[nextCount++] = v;
+        }
+        // Rescore the cache; vertices pushed out of it lose their cache score.
+        for (uint32_t i = 0; i < nextCount; ++i) {
+            const uint32_t v = nextCache[i];
+            cachePosition[v] = i < VERTEX_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+            vertexScore[v] = scores.score(cachePosition[v], remaining[v]);
+        }
+        cacheCount = std::min(nextCount, VERTEX_CACHE_SIZE);
+        std::memcpy(cache, nextCache, cacheCount * sizeof(uint32_t));
+
+        // The next triangle is the best one touching the cache.
+        best = static_cast<size_t>(-1);
+        float bestScore = -1.0f;
+        for (uint32_t i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            const uint32_t* list = &adjacency[adjacencyOffset[v]];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                const uint32_t* candidate = &indices[static_cast<size_t>(list[j]) * 3];
+                const float score = vertexScore[candidate[0]] + vertexScore[candidate[1]] + vertexScore[candidate[2]];
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = list[j];
+                }
+            }
+        }
+    }
+    std::memcpy(indices, output.data(), triangleCount * 3 * sizeof(uint32_t));
+}
+
+// --- Overdraw ---
+
+// FIFO cache simulation: a vertex is cached if it missed within the last 'size' misses.
+struct FifoCache {
+    std::vector<uint32_t> missTime;
+    uint32_t time;
+    uint32_t size;
+
+    FifoCache(size_t vertexCount, uint32_t cacheSize) : missTime(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+    uint32_t access(uint32_t v) {
+        if (time - missTime[v] <= size) return 0;
+        missTime[v] = time++;
+        return 1;
+    }
+    void clear() { time += size + 1; }
+};
+
+static bool findFloatPosition(const VertexFormat& format, uint32_t& offset) {
+    const VertexFormat::Element* position = format.find(VertexAttribute::Position);
+    if (!position || position->components != 3 || position->type != VertexComponentType::Float32) return false;
+    offset = position->offset / static_cast<uint32_t>(sizeof(float));
+    return true;
+}
+
+void MeshOptimizer::optimizeOverdraw(MeshData& mesh, float threshold) {
+    const size_t triangleCount = mesh.indices.size() / 3;
+    uint32_t positionOffset;
+    if (triangleCount == 0 || !findFloatPosition(mesh.format, positionOffset)) return;
+    const uint32_t floats = mesh.format.floatsPerVertex();
+    const size_t vertexCount = mesh.vertexCount();
+    const uint32_t* indices = mesh.indices.data();
+
+    // Hard cuts where a triangle misses on all three vertices: the cache starts over there anyway.
+    std::vector<size_t> hardStarts;
+    FifoCache cache(vertexCount, FIFO_CACHE_SIZE);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint32_t misses = cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+        if (t == 0 || misses == 3) hardStarts.push_back(t);
+    }
+    hardStarts.push_back(triangleCount);
+
+    // Soft cuts inside each hard cluster, wherever the running ACMR from the last cut is within
+    // 'threshold' of the whole cluster's, so the cache restart after the cut costs little.
+    std::vector<size_t> clusterStarts;
+    for (size_t h = 0; h + 1 < hardStarts.size(); ++h) {
+        const size_t begin = hardStarts[h], end = hardStarts[h + 1];
+        cache.clear();
+        uint32_t clusterMisses = 0;
+        for (size_t t = begin; t < end; ++t) {
+            clusterMisses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+        }
+        const float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+        cache.clear();
+        clusterStarts.push_back(begin);
+        size_t start = begin;
+        uint32_t misses = 0;
+        for (size_t t = begin; t + 1 < end; ++t) {
+            misses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+            if (static_cast<float>(misses) <= limit * static_cast<float>(t + 1 - start)) {
+                clusterStarts.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                cache.clear();
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+    const size_t clusterCount = clusterStarts.size() - 1;
+
+    // Area-weighted centroid and normal per cluster, and of the whole mesh.
+    std::vector<Vec3> clusterCentroid(clusterCount), clusterNormal(clusterCount);
+    Vec3 meshCentroid(0.0f, 0.0f, 0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c) {
+        Vec3 centroid(0.0f, 0.0f, 0.0f), normal(0.0f, 0.0f, 0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t) {
+            const float* a = &mesh.vertices[static_cast<size_t>(indices[t * 3]) * floats + positionOffset];
+            const float* b = &mesh.vertices[static_cast<size_t>(indices[t * 3 + 1]) * floats + positionOffset];
+            const float* d = &mesh.vertices[static_cast<size_t>(indices[t * 3 + 2]) * floats + positionOffset];
+            const Vec3 n = Vec3::cross(Vec3(b[0] - a[0], b[1] - a[1], b[2] - a[2]), Vec3(d[0] - a[0], d[1] - a[1], d[2] - a[2]));
+            const float weight = std::sqrt(Vec3::dot(n, n));
+            centroid = centroid + Vec3(a[0] + b[0] + d[0], a[1] + b[1] + d[1], a[2] + b[2] + d[2]) * (weight / 3.0f);
+            normal = normal + n;
+            area += weight;
+        }
+        meshCentroid = meshCentroid + centroid;
+        meshArea += area;
+        clusterCentroid[c] = area > 0.0f ? centroid * (1.0f / area) : centroid;
+        const float length = std::sqrt(Vec3::dot(normal, normal));
+        clusterNormal[c] = length > 0.0f ? normal * (1.0f / length) : normal;
+    }
+    if (meshArea > 0.0f) meshCentroid = meshCentroid * (1.0f / meshArea);
+
+    // Clusters on the outside facing outward are the likeliest occluders of the rest: draw them first.
+    std::vector<float> sortKey(clusterCount);
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        sortKey[c] = Vec3::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c]);
+        order[c] = static_cast<uint32_t>(c);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(triangleCount * 3);
+    for (uint32_t c : order) {
+        sorted.insert(sorted.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+    }
+    mesh.indices.swap(sorted);
+}
+
+// --- Vertex fetch ---
+
+size_t MeshOptimizer::optimizeVertexFetch(MeshData& mesh) {
+    const uint32_t floats = mesh.format.floatsPerVertex();
+    const size_t vertexCount = mesh.vertexCount();
+    std::vector<uint32_t> remap(vertexCount, NO_VERTEX);
+    uint32_t next = 0;
+    for (uint32_t& index : mesh.indices) {
+        if (remap[index] == NO_VERTEX) remap[index] = next++;
+        index = remap[index];
+    }
+    std::vector<float> vertices(static_cast<size_t>(next) * floats);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != NO_VERTEX) std::memcpy(&vertices[static_cast<size_t>(remap[v]) * floats], &mesh.vertices[v * floats], floats * sizeof(float));
+    }
+    mesh.vertices.swap(vertices);
+    return next;
+}
+
+void MeshOptimizer::optimize(MeshData& mesh, float overdrawThreshold) {
+    if (mesh.indices.size() < 3) return;
+    optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount());
+    optimizeOverdraw(mesh, overdrawThreshold);
+    optimizeVertexFetch(mesh);
+}
+
+float MeshOptimizer::computeACMR(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return 0.0f;
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i) misses += cache.access(indices[i]);
+    return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+// --- Quantization ---
+
+// IEEE half float, rounded to nearest even; overflow becomes infinity.
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent == 0xFF) return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0)); // Infinity or NaN
+    const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if (halfExponent >= 31) return static_cast<uint16_t>(sign | 0x7C00);
+    uint32_t shift = 13;
+    if (halfExponent <= 0) { // Subnormal half (or zero)
+        if (halfExponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        shift = static_cast<uint32_t>(14 - halfExponent);
+    }
+    uint32_t half = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+    if (halfExponent > 0) half |= static_cast<uint32_t>(halfExponent) << 10;
+    if (rest > halfway || (rest == halfway && (half & 1))) ++half; // May carry into the exponent, which is correct
+    return static_cast<uint16_t>(sign | half);
+}
+
+static int32_t quantizeSNorm(float value, int32_t maximum) {
+    return static_cast<int32_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * static_cast<float>(maximum)));
+}
+
+// Octahedral encoding in the x and y fields of a 10:10:10:2 word; w = -1 tells the shader.
+static uint32_t packOctahedralNormal(float x, float y, float z) {
+    const float sum = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (sum <= 0.0f) {
+        x = y = 0.0f;
+        z = 1.0f;
+    } else {
+        x /= sum;
+        y /= sum;
+        z /= sum;
+    }
+    if (z < 0.0f) { // Fold the lower hemisphere over the diagonals
+        const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+    }
+    const uint32_t qx = static_cast<uint32_t>(quantizeSNorm(x, 511)) & 0x3FF;
+    const uint32_t qy = static_cast<uint32_t>(quantizeSNorm(y, 511)) & 0x3FF;
+    return qx | qy << 10 | 3u << 30;
+}
+
+bool MeshOptimizer::quantize(const MeshData& mesh, PackedMeshData& out) {
+    uint32_t positionOffset;
+    if (!findFloatPosition(mesh.format, positionOffset)) {
+        std::cerr << "ERROR::MESH_OPTIMIZER::QUANTIZE: Mesh has no 3-component float position." << std::endl;
+        return false;
+    }
+    const VertexFormat::Element* color = mesh.format.find(VertexAttribute::Color);
+    const VertexFormat::Element* normal = mesh.format.find(VertexAttribute::Normal);
+    const VertexFormat::Element* texCoord = mesh.format.find(VertexAttribute::TexCoord0);
+    const VertexFormat full = VertexFormat::quantizedPositionColorNormalUV();
+    out.format = VertexFormat();
+    for (uint32_t i = 0; i < full.elementCount; ++i) {
+        const VertexFormat::Element& element = full.elements[i];
+        if (mesh.format.find(element.attribute)) out.format.add(element.attribute, element.components, element.type);
+    }
+    const uint32_t colorOut = color ? out.format.find(VertexAttribute::Color)->offset : 0;
+    const uint32_t normalOut = normal ? out.format.find(VertexAttribute::Normal)->offset : 0;
+    const uint32_t texCoordOut = texCoord ? out.format.find(VertexAttribute::TexCoord0)->offset : 0;
+
+    // One scale for all axes, so the dequantization is a similarity transform and normals need
+    // no correction.
+    out.bounds = mesh.computeBounds();
+    const Vec3 halfExtents = (out.bounds.box.max - out.bounds.box.min) * 0.5f;
+    const float extent = std::max(halfExtents.x, std::max(halfExtents.y, halfExtents.z));
+    out.dequantization.offset = (out.bounds.box.min + out.bounds.box.max) * 0.5f;
+    out.dequantization.scale = extent > 0.0f ? extent : 1.0f;
+    const float inverseScale = 1.0f / out.dequantization.scale;
+    const Vec3& offset = out.dequantization.offset;
+
+    const size_t vertexCount = mesh.vertexCount();
+    const uint32_t floats = mesh.format.floatsPerVertex();
+    const uint32_t stride = out.format.stride;
+    out.vertices.assign(vertexCount * stride, 0);
+    out.indices = mesh.indices;
+    out.singleSided = mesh.singleSided;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* source = &mesh.vertices[v * floats];
+        uint8_t* target = &out.vertices[v * stride];
+        const float* p = source + positionOffset;
+        const int16_t position[4] = { static_cast<int16_t>(quantizeSNorm((p[0] - offset.x) * inverseScale, 32767)),
+                                      static_cast<int16_t>(quantizeSNorm((p[1] - offset.y) * inverseScale, 32767)),
+                                      static_cast<int16_t>(quantizeSNorm((p[2] - offset.z) * inverseScale, 32767)), 32767 };
+        std::memcpy(target, position, sizeof(position));
+        if (color) {
+            const float* c = source + color->offset / sizeof(float);
+            for (uint32_t k = 0; k < 4; ++k) {
+                const float value = k < color->components ? c[k] : 1.0f;
+                target[colorOut + k] = static_cast<uint8_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+            }
+        }
+        if (normal) {
+            const float* n = source + normal->offset / sizeof(float);
+            const uint32_t packed = packOctahedralNormal(n[0], normal->components > 1 ? n[1] : 0.0f, normal->components > 2 ? n[2] : 0.0f);
+            std::memcpy(target + normalOut, &packed, sizeof(packed));
+        }
+        if (texCoord) {
+            const float* t = source + texCoord->offset / sizeof(float);
+            const uint16_t uv[2] = { floatToHalf(t[0]), floatToHalf(texCoord->components > 1 ? t[1] : 0.0f) };
+            std::memcpy(target + texCoordOut, uv, sizeof(uv));
+        }
+    }
+    return true;
+}
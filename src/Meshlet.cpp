@@ -0,0 +1,170 @@
+// Meshlet.cpp
+// Meshlet building (greedy index-order scan, bounds and normal cones) and per-instance culling.
+
+#include "MyFirstEngine/Meshlet.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::sqrt
+#include <cstring>   // For std::memcpy
+#include <iostream>  // For std::cerr (error output)
+
+// Decodes every vertex position to object space. Returns false for unsupported position formats.
+static bool decodePositions(const MeshDataView& mesh, std::vector<Vec3>& positions) {
+    const VertexFormat::Element* position = mesh.format.find(VertexAttribute::Position);
+    if (!position || position->components < 3 ||
+        (position->type != VertexComponentType::Float32 && position->type != VertexComponentType::SNorm16)) return false;
+    positions.resize(mesh.vertexCount);
+    const uint8_t* base = static_cast<const uint8_t*>(mesh.vertices) + position->offset;
+    const uint32_t stride = mesh.format.stride;
+    const PositionDequantization& dequantization = mesh.dequantization;
+    for (size_t v = 0; v < mesh.vertexCount; ++v) {
+        const uint8_t* p = base + v * stride;
+        float xyz[3];
+        if (position->type == VertexComponentType::Float32) {
+            std::memcpy(xyz, p, sizeof(xyz));
+        } else {
+            int16_t q[3];
+            std::memcpy(q, p, sizeof(q));
+            // GL's SNORM rule: -32768 and -32767 both read as -1.
+            for (int c = 0; c < 3; ++c) xyz[c] = std::max(static_cast<float>(q[c]) / 32767.0f, -1.0f);
+        }
+        positions[v] = Vec3(xyz[0], xyz[1], xyz[2]) * dequantization.scale + dequantization.offset;
+    }
+    return true;
+}
+
+// Bounding sphere (around the box center) and normal cone of one meshlet.
+static void computeMeshletBounds(Meshlet& meshlet, const uint32_t* indices, const std::vector<Vec3>& positions) {
+    const uint32_t* first = indices + meshlet.firstIndex;
+    Vec3 minimum = positions[first[0]], maximum = minimum;
+    for (uint32_t i = 1; i < meshlet.indexCount; ++i) {
+        const Vec3& p = positions[first[i]];
+        minimum = Vec3(std::min(minimum.x, p.x), std::min(minimum.y, p.y), std::min(minimum.z, p.z));
+        maximum = Vec3(std::max(maximum.x, p.x), std::max(maximum.y, p.y), std::max(maximum.z, p.z));
+    }
+    meshlet.center = (minimum + maximum) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (uint32_t i = 0; i < meshlet.indexCount; ++i) {
+        const Vec3 d = positions[first[i]] - meshlet.center;
+        radiusSquared = std::max(radiusSquared, Vec3::dot(d, d));
+    }
+    meshlet.radius = std::sqrt(radiusSquared);
+
+    // Axis: the average unit normal. Cutoff: with every normal within angle a of the axis, the
+    // cluster faces away from a camera c when each view direction (p - c) is within 90 - a degrees
+    // of the axis, i.e. dot(normalize(p - c), axis) >= sin(a).
+    Vec3 normalSum;
+    for (uint32_t t = 0; t < meshlet.indexCount; t += 3) {
+        const Vec3& a = positions[first[t]];
+        normalSum = normalSum + Vec3::cross(positions[first[t + 1]] - a, positions[first[t + 2]] - a).normalize();
+    }
+    meshlet.coneAxis = normalSum.normalize();
+    meshlet.coneCutoff = MeshletBuilder::NO_CONE;
+    if (meshlet.coneAxis.length() == 0.0f) return;
+    float minimumDot = 1.0f;
+    for (uint32_t t = 0; t < meshlet.indexCount; t += 3) {
+        const Vec3& a = positions[first[t]];
+        const Vec3 normal = Vec3::cross(positions[first[t + 1]] - a, positions[first[t + 2]] - a).normalize();
+        if (normal.length() > 0.0f) minimumDot = std::min(minimumDot, Vec3::dot(normal, meshlet.coneAxis));
+    }
+    if (minimumDot > 0.0f) meshlet.coneCutoff = std::sqrt(std::max(1.0f - minimumDot * minimumDot, 0.0f));
+}
+
+bool MeshletBuilder::build(const MeshDataView& mesh, std::vector<Meshlet>& out, ThreadPool* pool) {
+    out.clear();
+    std::vector<Vec3> positions;
+    if (!decodePositions(mesh, positions)) {
+        std::cerr << "ERROR::MESHLET::BUILD: Mesh needs a 3- or 4-component Float32 or SNorm16 position." << std::endl;
+        return false;
+    }
+
+    // Greedy scan: a triangle joins the current meshlet unless it would exceed either limit.
+    // 'owner' marks the vertices already in the current meshlet.
+    const uint32_t NO_MESHLET = 0xFFFFFFFFu;
+    std::vector<uint32_t> owner(mesh.vertexCount, NO_MESHLET);
+    const size_t triangleCount = mesh.indexCount / 3;
+    uint32_t current = 0;
+    uint32_t meshletStart = 0;
+    uint32_t meshletVertices = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const uint32_t a = mesh.indices[t * 3], b = mesh.indices[t * 3 + 1], c = mesh.indices[t * 3 + 2];
+        uint32_t added = (owner[a] != current) + (owner[b] != current && b != a) + (owner[c] != current && c != a && c != b);
+        if (meshletVertices + added > MAX_VERTICES || t - meshletStart / 3u >= MAX_TRIANGLES) {
+            out.push_back(Meshlet{ meshletStart, static_cast<uint32_t>(t * 3) - meshletStart, Vec3(), 0.0f, Vec3(), NO_CONE });
+            ++current;
+            meshletStart = static_cast<uint32_t>(t * 3);
+            meshletVertices = 0;
+            added = 1 + (b != a) + (c != a && c != b);
+        }
+        owner[a] = owner[b] = owner[c] = current;
+        meshletVertices += added;
+    }
+    if (triangleCount * 3 > meshletStart) {
+        out.push_back(Meshlet{ meshletStart, static_cast<uint32_t>(triangleCount * 3) - meshletStart, Vec3(), 0.0f, Vec3(), NO_CONE });
+    }
+
+    auto computeRange = [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) computeMeshletBounds(out[i], mesh.indices, positions);
+    };
+    if (pool) pool->parallelFor(out.size(), 256, computeRange);
+    else computeRange(0, out.size(), 0);
+    return true;
+}
+
+MeshletCuller::MeshletCuller() : coneCulling(true) {}
+
+void MeshletCuller::setView(const Frustum& viewFrustum, const Vec3& viewPosition, bool cone) {
+    frustum = viewFrustum;
+    cameraPosition = viewPosition;
+    coneCulling = cone;
+}
+
+size_t MeshletCuller::cull(const Meshlet* meshlets, size_t count, const Mat4& model, bool singleSided, MeshletRange* out,
+                           size_t* visibleMeshlets) const {
+    // World plane (n, d) applied to model * x is the object-space plane M^T (n, d): its signed
+    // distances are world distances, against which object radii grow by the largest axis scale.
+    const float* m = model.elements;
+    Vec4 planes[Frustum::PlaneCount];
+    for (int i = 0; i < Frustum::PlaneCount; ++i) {
+        const Vec4& p = frustum.planes[i];
+        planes[i] = Vec4(p.x * m[0] + p.y * m[1] + p.z * m[2] + p.w * m[3],
+                         p.x * m[4] + p.y * m[5] + p.z * m[6] + p.w * m[7],
+                         p.x * m[8] + p.y * m[9] + p.z * m[10] + p.w * m[11],
+                         p.x * m[12] + p.y * m[13] + p.z * m[14] + p.w * m[15]);
+    }
+    const float scaleSquared = std::max(m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                        std::max(m[4] * m[4] + m[5] * m[5] + m[6] * m[6], m[8] * m[8] + m[9] * m[9] + m[10] * m[10]));
+    const float radiusScale = std::sqrt(scaleSquared);
+    const Vec3 camera = Mat4::transformPoint(model.inverse(), cameraPosition);
+    const bool coneTest = coneCulling && singleSided;
+
+    size_t ranges = 0;
+    size_t visible = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Meshlet& meshlet = meshlets[i];
+        const Vec3& c = meshlet.center;
+        const float radius = meshlet.radius * radiusScale;
+        bool inside = true;
+        for (const Vec4& p : planes) {
+            if (p.x * c.x + p.y * c.y + p.z * c.z + p.w < -radius) {
+                inside = false;
+                break;
+            }
+        }
+        if (!inside) continue;
+        // Back-facing when every point of the bounding sphere is seen within the cone's
+        // complement: dot(center - camera, axis) >= cutoff * |center - camera| + radius.
+        if (coneTest && meshlet.coneCutoff <= 1.0f) {
+            const Vec3 d = c - camera;
+            if (Vec3::dot(d, meshlet.coneAxis) >= meshlet.coneCutoff * d.length() + meshlet.radius) continue;
+        }
+        ++visible;
+        if (ranges > 0 && out[ranges - 1].firstIndex + out[ranges - 1].indexCount == meshlet.firstIndex) {
+            out[ranges - 1].indexCount += meshlet.indexCount;
+        } else {
+            out[ranges++] = MeshletRange{ meshlet.firstIndex, meshlet.indexCount };
+        }
+    }
+    if (visibleMeshlets) *visibleMeshlets = visible;
+    return ranges;
+}
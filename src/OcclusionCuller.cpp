@@ -0,0 +1,305 @@
+// OcclusionCuller.cpp
+// Software occluder rasterization and hierarchical depth tests.
+
+#include "MyFirstEngine/OcclusionCuller.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm> // For std::min, std::max, std::fill
+#include <cmath>     // For std::abs, std::floor, std::ceil
+
+OcclusionCuller::OcclusionCuller(int w, int h)
+    : width(std::max(4, (w + 3) & ~3)), height(std::max(1, h)) {
+    tilesX = (width + TILE_WIDTH - 1) / TILE_WIDTH;
+    tilesY = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    tileBins.resize(static_cast<size_t>(tilesX) * tilesY);
+    depth.assign(static_cast<size_t>(width) * height, 1.0f);
+
+    // Pyramid levels down to 1x1; each texel covers 2x2 texels of the level below.
+    int levelWidth = width, levelHeight = height;
+    while (levelWidth > 1 || levelHeight > 1) {
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+        PyramidLevel level;
+        level.width = levelWidth;
+        level.height = levelHeight;
+        level.minDepth.assign(static_cast<size_t>(levelWidth) * levelHeight, 1.0f);
+        level.maxDepth.assign(static_cast<size_t>(levelWidth) * levelHeight, 1.0f);
+        pyramid.push_back(level);
+    }
+}
+
+uint32_t OcclusionCuller::addOccluderMesh(const MeshData& mesh) {
+    OccluderMesh occluder;
+    const VertexFormat::Element* position = mesh.format.find(VertexAttribute::Position);
+    if (position && position->components >= 3) {
+        const size_t count = mesh.vertexCount();
+        const uint32_t floats = mesh.format.floatsPerVertex();
+        const size_t first = position->offset / sizeof(float);
+        occluder.positions.reserve(count);
+        for (size_t v = 0; v < count; ++v) {
+            const float* p = &mesh.vertices[v * floats + first];
+            occluder.positions.push_back(Vec3(p[0], p[1], p[2]));
+        }
+        occluder.indices = mesh.indices;
+    }
+    occluderMeshes.push_back(occluder);
+    return static_cast<uint32_t>(occluderMeshes.size() - 1);
+}
+
+void OcclusionCuller::beginFrame(const Mat4& vp) {
+    viewProjection = vp;
+    instances.clear();
+}
+
+void OcclusionCuller::addOccluder(uint32_t occluderMesh, const Mat4& model) {
+    if (occluderMesh < occluderMeshes.size()) instances.push_back(OccluderInstance{ occluderMesh, model });
+}
+
+void OcclusionCuller::addScreenTriangle(const Vec4& a, const Vec4& b, const Vec4& c) {
+    // Clip space -> pixels; depth from NDC [-1,1] to [0,1].
+    const Vec4* v[3] = { &a, &b, &c };
+    float x[3], y[3], z[3];
+    for (int i = 0; i < 3; ++i) {
+        const float invW = 1.0f / v[i]->w;
+        x[i] = (v[i]->x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+        y[i] = (v[i]->y * invW * 0.5f + 0.5f) * static_cast<float>(height);
+        z[i] = v[i]->z * invW * 0.5f + 0.5f;
+    }
+    // Counter-clockwise (front-facing) triangles have positive area; the rest are skipped.
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.0f)) return;
+
+    // Pixels are tested at their centers (px + 0.5), with the edges pulled inward below.
+    ScreenTriangle tri;
+    tri.minX = std::max(0, static_cast<int>(std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5f)));
+    tri.maxX = std::min(width - 1, static_cast<int>(std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5f)));
+    tri.minY = std::max(0, static_cast<int>(std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5f)));
+    tri.maxY = std::min(height - 1, static_cast<int>(std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5f)));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+    for (int e = 0; e < 3; ++e) {
+        const int i = e, j = (e + 1) % 3;
+        // Positive to the left of i->j, i.e. inside a CCW triangle.
+        tri.edgeA[e] = y[i] - y[j];
+        tri.edgeB[e] = x[j] - x[i];
+        // Conservative inward: at a pixel center the edge function varies by at most
+        // 0.5 * (|A| + |B|) across the pixel, so requiring that margin keeps only pixels the
+        // triangle covers completely. A partly covered pixel must not hide what shows beside it.
+        tri.edgeC[e] = -(tri.edgeA[e] * x[i] + tri.edgeB[e] * y[i]) - 0.5f * (std::abs(tri.edgeA[e]) + std::abs(tri.edgeB[e]));
+    }
+    const float invArea = 1.0f / area;
+    tri.zDx = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) * invArea;
+    tri.zDy = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) * invArea;
+    // Store the depth of the pixel's farthest corner, not its center, for the same reason.
+    tri.zBase = z[0] - tri.zDx * x[0] - tri.zDy * y[0] + 0.5f * (std::abs(tri.zDx) + std::abs(tri.zDy));
+
+    const uint32_t index = static_cast<uint32_t>(triangles.size());
+    triangles.push_back(tri);
+    for (int ty = tri.minY / TILE_HEIGHT; ty <= tri.maxY / TILE_HEIGHT; ++ty)
+        for (int tx = tri.minX / TILE_WIDTH; tx <= tri.maxX / TILE_WIDTH; ++tx)
+            tileBins[static_cast<size_t>(ty) * tilesX + tx].push_back(index);
+}
+
+void OcclusionCuller::setupTriangle(const Vec4& a, const Vec4& b, const Vec4& c) {
+    // Trivial reject: all three vertices outside the same side of the view volume.
+    const Vec4* v[3] = { &a, &b, &c };
+    int outsideAll = 0x3F;
+    for (int i = 0; i < 3; ++i) {
+        int outside = 0;
+        if (v[i]->x < -v[i]->w) outside |= 1;
+        if (v[i]->x > v[i]->w) outside |= 2;
+        if (v[i]->y < -v[i]->w) outside |= 4;
+        if (v[i]->y > v[i]->w) outside |= 8;
+        if (v[i]->z < -v[i]->w) outside |= 16;
+        if (v[i]->z > v[i]->w) outside |= 32;
+        outsideAll &= outside;
+    }
+    if (outsideAll) return;
+
+    // Near plane (z >= -w): keep w positive before the perspective divide.
+    float d[3];
+    bool allInside = true;
+    for (int i = 0; i < 3; ++i) {
+        d[i] = v[i]->z + v[i]->w;
+        allInside = allInside && d[i] >= 0.0f;
+    }
+    if (allInside) {
+        addScreenTriangle(a, b, c);
+        return;
+    }
+    // Sutherland-Hodgman against one plane: at most 4 output vertices.
+    Vec4 polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        const int j = (i + 1) % 3;
+        if (d[i] >= 0.0f) polygon[count++] = *v[i];
+        if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+            const float t = d[i] / (d[i] - d[j]);
+            polygon[count++] = Vec4(v[i]->x + (v[j]->x - v[i]->x) * t, v[i]->y + (v[j]->y - v[i]->y) * t,
+                                    v[i]->z + (v[j]->z - v[i]->z) * t, v[i]->w + (v[j]->w - v[i]->w) * t);
+        }
+    }
+    for (int i = 1; i + 1 < count; ++i) addScreenTriangle(polygon[0], polygon[i], polygon[i + 1]);
+}
+
+void OcclusionCuller::rasterizeTile(int tile) {
+    const int tileX0 = (tile % tilesX) * TILE_WIDTH;
+    const int tileY0 = (tile / tilesX) * TILE_HEIGHT;
+    const int tileX1 = std::min(tileX0 + TILE_WIDTH, width) - 1;  // Inclusive
+    const int tileY1 = std::min(tileY0 + TILE_HEIGHT, height) - 1;
+
+    for (int y = tileY0; y <= tileY1; ++y)
+        std::fill(depth.begin() + static_cast<size_t>(y) * width + tileX0, depth.begin() + static_cast<size_t>(y) * width + tileX1 + 1, 1.0f);
+
+    for (uint32_t index : tileBins[tile]) {
+        const ScreenTriangle& tri = triangles[index];
+        // Start on a 4-pixel boundary: tiles and the buffer width are multiples of 4, so a group
+        // never crosses the tile edge. Lanes outside the triangle fail the edge tests.
+        const int x0 = std::max(tri.minX, tileX0) & ~3;
+        const int x1 = std::min(tri.maxX, tileX1);
+        const int y0 = std::max(tri.minY, tileY0);
+        const int y1 = std::min(tri.maxY, tileY1);
+        for (int y = y0; y <= y1; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* row = &depth[static_cast<size_t>(y) * width];
+            int x = x0;
+#if defined(SIMPLEMATH_SSE)
+            const __m128 a0 = _mm_set1_ps(tri.edgeA[0]), a1 = _mm_set1_ps(tri.edgeA[1]), a2 = _mm_set1_ps(tri.edgeA[2]);
+            const __m128 r0 = _mm_set1_ps(tri.edgeB[0] * py + tri.edgeC[0]);
+            const __m128 r1 = _mm_set1_ps(tri.edgeB[1] * py + tri.edgeC[1]);
+            const __m128 r2 = _mm_set1_ps(tri.edgeB[2] * py + tri.edgeC[2]);
+            const __m128 zRow = _mm_set1_ps(tri.zBase + tri.zDy * py), zDx = _mm_set1_ps(tri.zDx);
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            for (; x <= x1; x += 4) {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), r0), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), r1), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), r2), zero));
+                const __m128 z = _mm_add_ps(zRow, _mm_mul_ps(zDx, px));
+                const __m128 old = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(old, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+            }
+#elif defined(SIMPLEMATH_NEON)
+            const float32x4_t a0 = vdupq_n_f32(tri.edgeA[0]), a1 = vdupq_n_f32(tri.edgeA[1]), a2 = vdupq_n_f32(tri.edgeA[2]);
+            const float32x4_t r0 = vdupq_n_f32(tri.edgeB[0] * py + tri.edgeC[0]);
+            const float32x4_t r1 = vdupq_n_f32(tri.edgeB[1] * py + tri.edgeC[1]);
+            const float32x4_t r2 = vdupq_n_f32(tri.edgeB[2] * py + tri.edgeC[2]);
+            const float32x4_t zRow = vdupq_n_f32(tri.zBase + tri.zDy * py), zDx = vdupq_n_f32(tri.zDx);
+            const float laneValues[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+            const float32x4_t laneOffsets = vld1q_f32(laneValues);
+            for (; x <= x1; x += 4) {
+                const float32x4_t px = vaddq_f32(vdupq_n_f32(static_cast<float>(x)), laneOffsets);
+                uint32x4_t inside = vcgeq_f32(vmlaq_f32(r0, a0, px), vdupq_n_f32(0.0f));
+                inside = vandq_u32(inside, vcgeq_f32(vmlaq_f32(r1, a1, px), vdupq_n_f32(0.0f)));
+                inside = vandq_u32(inside, vcgeq_f32(vmlaq_f32(r2, a2, px), vdupq_n_f32(0.0f)));
+                const float32x4_t z = vmlaq_f32(zRow, zDx, px);
+                const float32x4_t old = vld1q_f32(row + x);
+                vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(old, z), old));
+            }
+#endif
+            for (; x <= x1; ++x) {
+                const float px = static_cast<float>(x) + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3; ++e) inside = inside && (tri.edgeA[e] * px + tri.edgeB[e] * py + tri.edgeC[e] >= 0.0f);
+                if (inside) row[x] = std::min(row[x], tri.zBase + tri.zDx * px + tri.zDy * py);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid() {
+    const float* srcMin = depth.data();
+    const float* srcMax = depth.data();
+    int srcWidth = width, srcHeight = height;
+    for (PyramidLevel& level : pyramid) {
+        for (int y = 0; y < level.height; ++y) {
+            const int sy0 = y * 2, sy1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (int x = 0; x < level.width; ++x) {
+                const int sx0 = x * 2, sx1 = std::min(x * 2 + 1, srcWidth - 1);
+                const int i00 = sy0 * srcWidth + sx0, i01 = sy0 * srcWidth + sx1;
+                const int i10 = sy1 * srcWidth + sx0, i11 = sy1 * srcWidth + sx1;
+                level.minDepth[y * level.width + x] = std::min(std::min(srcMin[i00], srcMin[i01]), std::min(srcMin[i10], srcMin[i11]));
+                level.maxDepth[y * level.width + x] = std::max(std::max(srcMax[i00], srcMax[i01]), std::max(srcMax[i10], srcMax[i11]));
+            }
+        }
+        srcMin = level.minDepth.data();
+        srcMax = level.maxDepth.data();
+        srcWidth = level.width;
+        srcHeight = level.height;
+    }
+}
+
+void OcclusionCuller::render(ThreadPool* pool) {
+    triangles.clear();
+    for (std::vector<uint32_t>& bin : tileBins) bin.clear();
+
+    // --- 1. Transform, clip and bin ---
+    for (const OccluderInstance& instance : instances) {
+        const OccluderMesh& mesh = occluderMeshes[instance.mesh];
+        const Mat4 mvp = viewProjection * instance.model;
+        clipVertices.resize(mesh.positions.size());
+        transformPointsHomogeneous(mvp, mesh.positions.data(), clipVertices.data(), mesh.positions.size());
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            setupTriangle(clipVertices[mesh.indices[i]], clipVertices[mesh.indices[i + 1]], clipVertices[mesh.indices[i + 2]]);
+        }
+    }
+
+    // --- 2. Rasterize tiles (each tile clears and owns its own pixels) ---
+    const size_t tileCount = tileBins.size();
+    if (pool) {
+        pool->parallelFor(tileCount, 1, [this](size_t begin, size_t end, size_t) {
+            for (size_t tile = begin; tile < end; ++tile) rasterizeTile(static_cast<int>(tile));
+        });
+    } else {
+        for (size_t tile = 0; tile < tileCount; ++tile) rasterizeTile(static_cast<int>(tile));
+    }
+
+    // --- 3. Min/max pyramid ---
+    buildPyramid();
+}
+
+bool OcclusionCuller::isVisible(const AABB& worldBox) const {
+    if (triangles.empty()) return true;
+
+    // Project the 8 corners. Boxes reaching behind the near plane are always visible.
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, nearestZ = 1e30f;
+    for (int i = 0; i < 8; ++i) {
+        const Vec3 corner((i & 1) ? worldBox.max.x : worldBox.min.x, (i & 2) ? worldBox.max.y : worldBox.min.y,
+                          (i & 4) ? worldBox.max.z : worldBox.min.z);
+        const Vec4 clip = viewProjection * Vec4(corner, 1.0f);
+        if (clip.w <= 1e-5f || clip.z < -clip.w) return true;
+        const float invW = 1.0f / clip.w;
+        const float sx = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+        const float sy = (clip.y * invW * 0.5f + 0.5f) * static_cast<float>(height);
+        minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+        nearestZ = std::min(nearestZ, clip.z * invW * 0.5f + 0.5f);
+    }
+    // Every pixel the rectangle touches (pixel x covers [x, x+1)).
+    const int px0 = std::max(0, static_cast<int>(std::floor(minX)));
+    const int py0 = std::max(0, static_cast<int>(std::floor(minY)));
+    const int px1 = std::min(width - 1, static_cast<int>(std::floor(maxX)));
+    const int py1 = std::min(height - 1, static_cast<int>(std::floor(maxY)));
+    if (px0 > px1 || py0 > py1) return false; // Entirely off screen
+
+    // Coarsest level where the rectangle spans at most 2x2 texels.
+    int level = 0;
+    while (level < static_cast<int>(pyramid.size()) && ((px1 >> level) - (px0 >> level) > 1 || (py1 >> level) - (py0 >> level) > 1)) ++level;
+
+    for (; level >= 0; --level) {
+        const int levelWidth = level == 0 ? width : pyramid[level - 1].width;
+        const float* minDepth = level == 0 ? depth.data() : pyramid[level - 1].minDepth.data();
+        const float* maxDepth = level == 0 ? depth.data() : pyramid[level - 1].maxDepth.data();
+        bool allBehind = true;
+        for (int y = py0 >> level; y <= (py1 >> level); ++y) {
+            for (int x = px0 >> level; x <= (px1 >> level); ++x) {
+                const int i = y * levelWidth + x;
+                if (minDepth[i] > nearestZ) return true; // Nearer than every occluder under this texel
+                if (maxDepth[i] >= nearestZ) allBehind = false;
+            }
+        }
+        if (allBehind) return false; // Behind the farthest occluder everywhere it covers
+    }
+    return true;
+}
@@ -0,0 +1,180 @@
+// Profiler.cpp
+// Scope collection, frame history and rolling statistics.
+
+#include "MyFirstEngine/Profiler.h"
+#include <algorithm> // For std::sort, std::max, std::find
+#include <cstring>   // For std::strcmp
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : enabled(true), epoch(std::chrono::steady_clock::now()), frameIndex(0), inFrame(false),
+      trackCount(0), historyStart(0) {
+    current.index = 0;
+    current.startMs = 0.0;
+    current.endMs = 0.0;
+}
+
+uint32_t& Profiler::threadDepth() {
+    thread_local uint32_t depth = 0;
+    return depth;
+}
+
+uint32_t Profiler::threadTrack() {
+    // Assigned on the thread's first scope; called with eventMutex held.
+    thread_local uint32_t track = GPU_TRACK;
+    if (track == GPU_TRACK) track = trackCount++;
+    return track;
+}
+
+void Profiler::beginFrame() {
+    if (!enabled) return;
+    std::lock_guard<std::mutex> lock(eventMutex);
+    current.index = frameIndex;
+    current.startMs = nowMs();
+    current.events.clear();
+    current.gpuEvents.clear();
+    inFrame = true;
+}
+
+void Profiler::addEvent(const char* name, uint32_t depth, double startMs, double endMs) {
+    std::lock_guard<std::mutex> lock(eventMutex);
+    if (!inFrame) return; // Outside beginFrame()/endFrame() (e.g. during startup)
+    current.events.push_back(Event{ name, threadTrack(), depth, startMs, endMs });
+}
+
+void Profiler::endFrame() {
+    if (!enabled || !inFrame) return;
+    {
+        std::lock_guard<std::mutex> lock(eventMutex);
+        current.endMs = nowMs();
+        inFrame = false;
+    }
+    // Scopes complete innermost first; order them by start so parents precede their children.
+    std::sort(current.events.begin(), current.events.end(), [](const Event& x, const Event& y) {
+        return x.track != y.track ? x.track < y.track : x.startMs < y.startMs;
+    });
+    accumulate(current.events, false);
+    if (history.size() < HISTORY_FRAMES) {
+        history.push_back(current);
+    } else {
+        // Reuse the oldest frame's vectors instead of reallocating.
+        Frame& slot = history[historyStart];
+        slot.index = current.index;
+        slot.startMs = current.startMs;
+        slot.endMs = current.endMs;
+        slot.events.assign(current.events.begin(), current.events.end());
+        slot.gpuEvents.clear();
+        historyStart = (historyStart + 1) % HISTORY_FRAMES;
+    }
+    ++frameIndex;
+    updateStats();
+}
+
+void Profiler::addGpuFrame(uint64_t frame, const std::vector<Event>& events) {
+    if (!enabled || events.empty()) return;
+    accumulate(events, true);
+    for (size_t i = 0; i < history.size(); ++i) {
+        Frame& f = history[i];
+        if (f.index != frame) continue;
+        // GPU clock and CPU clock are unrelated: line the first GPU scope up with the CPU frame start.
+        const double offset = f.startMs - events.front().startMs;
+        f.gpuEvents.clear();
+        for (Event e : events) {
+            e.track = GPU_TRACK;
+            e.startMs += offset;
+            e.endMs += offset;
+            f.gpuEvents.push_back(e);
+        }
+        break;
+    }
+}
+
+size_t Profiler::samplesFor(const char* name, bool gpu, uint32_t depth) {
+    for (size_t i = 0; i < scopes.size(); ++i) {
+        if (scopes[i].gpu == gpu && std::strcmp(scopes[i].name.c_str(), name) == 0) return i;
+    }
+    ScopeSamples scope;
+    scope.name = name;
+    scope.gpu = gpu;
+    scope.depth = depth;
+    scope.next = 0;
+    scope.last = 0.0;
+    scope.lastThreads = 0;
+    scopes.push_back(scope);
+    return scopes.size() - 1;
+}
+
+void Profiler::accumulate(const std::vector<Event>& events, bool gpu) {
+    // Gather each scope's runs in this frame (a scope can run several times per frame, on
+    // several threads).
+    struct Runs {
+        size_t scope;
+        std::vector<std::pair<double, double>> intervals; // (start, end) ms
+        std::vector<uint32_t> tracks;                     // Distinct
+    };
+    std::vector<Runs> runs;
+    for (const Event& e : events) {
+        const size_t scope = samplesFor(e.name, gpu, e.depth);
+        auto it = std::find_if(runs.begin(), runs.end(), [scope](const Runs& r) { return r.scope == scope; });
+        if (it == runs.end()) {
+            runs.push_back(Runs{ scope, {}, {} });
+            it = runs.end() - 1;
+        }
+        it->intervals.emplace_back(e.startMs, e.endMs);
+        if (std::find(it->tracks.begin(), it->tracks.end(), e.track) == it->tracks.end()) it->tracks.push_back(e.track);
+    }
+    for (Runs& r : runs) {
+        // CPU time sums every run; wall-clock time is the length of their union.
+        std::sort(r.intervals.begin(), r.intervals.end());
+        double cpu = 0.0, wall = 0.0, coveredUntil = -1e300;
+        for (const auto& interval : r.intervals) {
+            cpu += interval.second - interval.first;
+            const double start = std::max(interval.first, coveredUntil);
+            if (interval.second > start) wall += interval.second - start;
+            coveredUntil = std::max(coveredUntil, interval.second);
+        }
+        ScopeSamples& scope = scopes[r.scope];
+        if (scope.samples.size() < HISTORY_FRAMES) {
+            scope.samples.push_back(cpu);
+            scope.wallSamples.push_back(wall);
+        } else {
+            scope.samples[scope.next] = cpu;
+            scope.wallSamples[scope.next] = wall;
+        }
+        scope.next = (scope.next + 1) % HISTORY_FRAMES;
+        scope.last = cpu;
+        scope.lastThreads = static_cast<uint32_t>(r.tracks.size());
+    }
+}
+
+void Profiler::updateStats() {
+    stats.clear();
+    for (int pass = 0; pass < 2; ++pass) { // CPU scopes first, then GPU
+        for (const ScopeSamples& scope : scopes) {
+            if (scope.gpu != (pass == 1) || scope.samples.empty()) continue;
+            sortScratch.assign(scope.samples.begin(), scope.samples.end());
+            std::sort(sortScratch.begin(), sortScratch.end());
+            double sum = 0.0;
+            for (double s : sortScratch) sum += s;
+            const size_t n = sortScratch.size();
+            ScopeStats s;
+            s.name = scope.name;
+            s.gpu = scope.gpu;
+            s.depth = scope.depth;
+            s.lastMs = scope.last;
+            s.averageMs = sum / static_cast<double>(n);
+            s.p95Ms = sortScratch[std::min(n - 1, static_cast<size_t>(0.95 * static_cast<double>(n)))];
+            s.p99Ms = sortScratch[std::min(n - 1, static_cast<size_t>(0.99 * static_cast<double>(n)))];
+            s.maxMs = sortScratch.back();
+            double wallSum = 0.0;
+            for (double w : scope.wallSamples) wallSum += w;
+            s.averageWallMs = wallSum / static_cast<double>(n);
+            s.threads = scope.lastThreads;
+            stats.push_back(s);
+        }
+    }
+}
@@ -0,0 +1,170 @@
+// ProfilerWindow.cpp
+// ImGui drawing of the profiler's statistics and flame chart.
+
+#include "MyFirstEngine/ProfilerWindow.h"
+#include "MyFirstEngine/Profiler.h"
+#include "imgui.h"
+#include <algorithm> // For std::max, std::min
+#include <cstdio>    // For std::snprintf
+#include <vector>
+
+// Window state that outlives a frame.
+struct ProfilerWindowState {
+    bool paused = false;
+    float spanMs = 50.0f;   // Width of the flame chart
+    float scrollMs = 0.0f;  // How far back from the newest frame the chart ends (paused only)
+    std::vector<Profiler::Frame> frozen; // History captured when pausing
+};
+static ProfilerWindowState windowState;
+
+static ImU32 scopeColor(const char* name, bool gpu) {
+    // Stable color per name (FNV-1a hash to hue).
+    unsigned int hash = 2166136261u;
+    for (const char* c = name; *c; ++c) hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+    const float hue = static_cast<float>(hash % 1000) / 1000.0f;
+    return ImColor::HSV(hue, gpu ? 0.35f : 0.55f, gpu ? 0.95f : 0.85f);
+}
+
+static void drawStatsTable(const Profiler& profiler) {
+    const ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable |
+                                  ImGuiTableFlags_SizingStretchProp;
+    if (!ImGui::BeginTable("ProfilerScopes", 8, flags)) return;
+    ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+    ImGui::TableSetupColumn("Last");
+    ImGui::TableSetupColumn("Avg");
+    ImGui::TableSetupColumn("p95");
+    ImGui::TableSetupColumn("p99");
+    ImGui::TableSetupColumn("Max");
+    ImGui::TableSetupColumn("Wall avg"); // Times above are CPU time summed over threads
+    ImGui::TableSetupColumn("Threads");
+    ImGui::TableHeadersRow();
+    for (const Profiler::ScopeStats& s : profiler.getStats()) {
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("%*s%s%s", static_cast<int>(s.depth * 2), "", s.gpu ? "[GPU] " : "", s.name.c_str());
+        const double values[5] = { s.lastMs, s.averageMs, s.p95Ms, s.p99Ms, s.maxMs };
+        for (int i = 0; i < 5; ++i) {
+            ImGui::TableSetColumnIndex(i + 1);
+            ImGui::Text("%.3f", values[i]);
+        }
+        ImGui::TableSetColumnIndex(6);
+        ImGui::Text("%.3f", s.averageWallMs);
+        ImGui::TableSetColumnIndex(7);
+        ImGui::Text("%u", s.threads);
+    }
+    ImGui::EndTable();
+}
+
+static void drawFlameChart(const std::vector<const Profiler::Frame*>& frames, uint32_t trackCount) {
+    if (frames.empty()) return;
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const double endMs = frames.back()->endMs - windowState.scrollMs;
+    const double beginMs = endMs - windowState.spanMs;
+
+    // Lane heights from the deepest scope of each track within the view.
+    std::vector<uint32_t> laneDepth(trackCount + 1, 0); // Last lane is the GPU
+    for (const Profiler::Frame* f : frames) {
+        if (f->endMs < beginMs || f->startMs > endMs) continue;
+        for (const Profiler::Event& e : f->events) {
+            if (e.track < trackCount) laneDepth[e.track] = std::max(laneDepth[e.track], e.depth + 1);
+        }
+        for (const Profiler::Event& e : f->gpuEvents) laneDepth[trackCount] = std::max(laneDepth[trackCount], e.depth + 1);
+    }
+    std::vector<float> laneTop(trackCount + 1, 0.0f);
+    float height = 0.0f;
+    for (size_t lane = 0; lane < laneDepth.size(); ++lane) {
+        laneTop[lane] = height + rowHeight; // One row for the lane label
+        height = laneTop[lane] + static_cast<float>(std::max<uint32_t>(laneDepth[lane], 1)) * rowHeight + 4.0f;
+    }
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 50.0f);
+    const float msToPixels = width / windowState.spanMs;
+    drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(30, 32, 36, 255));
+    drawList->PushClipRect(origin, ImVec2(origin.x + width, origin.y + height), true);
+
+    for (size_t lane = 0; lane < laneTop.size(); ++lane) {
+        char label[32];
+        if (lane < trackCount) std::snprintf(label, sizeof(label), "CPU thread %zu", lane);
+        else std::snprintf(label, sizeof(label), "GPU");
+        drawList->AddText(ImVec2(origin.x + 4.0f, origin.y + laneTop[lane] - rowHeight + 2.0f), IM_COL32(160, 160, 160, 255), label);
+    }
+
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+    const Profiler::Event* hovered = nullptr;
+    auto drawEvent = [&](const Profiler::Event& e, size_t lane) {
+        if (e.endMs < beginMs || e.startMs > endMs) return;
+        const float x0 = origin.x + static_cast<float>(e.startMs - beginMs) * msToPixels;
+        const float x1 = std::max(x0 + 1.0f, origin.x + static_cast<float>(e.endMs - beginMs) * msToPixels);
+        const float y0 = origin.y + laneTop[lane] + static_cast<float>(e.depth) * rowHeight;
+        const float y1 = y0 + rowHeight - 1.0f;
+        drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), scopeColor(e.name, lane == trackCount));
+        if (x1 - x0 > 30.0f) {
+            drawList->PushClipRect(ImVec2(std::max(x0, origin.x), y0), ImVec2(x1, y1), true);
+            drawList->AddText(ImVec2(std::max(x0, origin.x) + 2.0f, y0 + 2.0f), IM_COL32(20, 20, 20, 255), e.name);
+            drawList->PopClipRect();
+        }
+        if (mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) hovered = &e;
+    };
+    for (const Profiler::Frame* f : frames) {
+        if (f->endMs < beginMs || f->startMs > endMs) continue;
+        // Frame boundary.
+        const float fx = origin.x + static_cast<float>(f->startMs - beginMs) * msToPixels;
+        drawList->AddLine(ImVec2(fx, origin.y), ImVec2(fx, origin.y + height), IM_COL32(90, 90, 90, 255));
+        for (const Profiler::Event& e : f->events) {
+            if (e.track < trackCount) drawEvent(e, e.track);
+        }
+        for (const Profiler::Event& e : f->gpuEvents) drawEvent(e, trackCount);
+    }
+    drawList->PopClipRect();
+
+    ImGui::InvisibleButton("FlameChart", ImVec2(width, height));
+    if (hovered && ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%s%s\n%.3f ms", hovered->track == Profiler::GPU_TRACK ? "[GPU] " : "", hovered->name,
+                          hovered->endMs - hovered->startMs);
+    }
+}
+
+void drawProfilerWindow(const Profiler& profiler, bool* open) {
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+    if (ImGui::Checkbox("Pause", &windowState.paused)) {
+        windowState.frozen.clear();
+        windowState.scrollMs = 0.0f;
+        if (windowState.paused) {
+            for (size_t i = 0; i < profiler.getHistorySize(); ++i) windowState.frozen.push_back(profiler.getHistoryFrame(i));
+        }
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(150.0f);
+    ImGui::SliderFloat("Span (ms)", &windowState.spanMs, 5.0f, 500.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+
+    std::vector<const Profiler::Frame*> frames;
+    if (windowState.paused) {
+        for (const Profiler::Frame& f : windowState.frozen) frames.push_back(&f);
+    } else {
+        for (size_t i = 0; i < profiler.getHistorySize(); ++i) frames.push_back(&profiler.getHistoryFrame(i));
+    }
+
+    // Frame times.
+    std::vector<float> frameTimes;
+    frameTimes.reserve(frames.size());
+    for (const Profiler::Frame* f : frames) frameTimes.push_back(static_cast<float>(f->endMs - f->startMs));
+    if (!frameTimes.empty()) {
+        char overlay[48];
+        std::snprintf(overlay, sizeof(overlay), "last %.2f ms", frameTimes.back());
+        ImGui::PlotLines("##FrameTimes", frameTimes.data(), static_cast<int>(frameTimes.size()), 0, overlay, 0.0f,
+                         *std::max_element(frameTimes.begin(), frameTimes.end()) * 1.1f, ImVec2(-1.0f, 50.0f));
+    }
+    if (windowState.paused && !frames.empty()) {
+        const float historyMs = static_cast<float>(frames.back()->endMs - frames.front()->startMs);
+        ImGui::SliderFloat("Scroll back (ms)", &windowState.scrollMs, 0.0f, std::max(0.0f, historyMs - windowState.spanMs));
+    }
+
+    if (ImGui::CollapsingHeader("Scopes", ImGuiTreeNodeFlags_DefaultOpen)) drawStatsTable(profiler);
+    if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen)) drawFlameChart(frames, profiler.getTrackCount());
+    ImGui::End();
+}
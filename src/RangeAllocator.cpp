@@ -0,0 +1,71 @@
+// RangeAllocator.cpp
+// Implementation of the first-fit range allocator.
+
+#include "MyFirstEngine/RangeAllocator.h"
+#include <algorithm> // For std::lower_bound
+#include <iostream>  // For std::cerr (error output)
+
+RangeAllocator::RangeAllocator(size_t capacity)
+    : capacity(capacity), used(0) {
+    if (capacity > 0) freeRanges.push_back(Range{ 0, capacity });
+}
+
+size_t RangeAllocator::allocate(size_t size) {
+    if (size == 0) return INVALID_OFFSET;
+    for (size_t i = 0; i < freeRanges.size(); ++i) {
+        Range& range = freeRanges[i];
+        if (range.size < size) continue;
+        const size_t offset = range.offset;
+        range.offset += size;
+        range.size -= size;
+        if (range.size == 0) freeRanges.erase(freeRanges.begin() + i);
+        used += size;
+        return offset;
+    }
+    return INVALID_OFFSET;
+}
+
+void RangeAllocator::free(size_t offset, size_t size) {
+    if (size == 0 || offset == INVALID_OFFSET) return;
+    if (offset + size > capacity || size > used) {
+        std::cerr << "ERROR::RANGE_ALLOCATOR::FREE: Range [" << offset << ", " << offset + size
+                  << ") was not allocated from this allocator." << std::endl;
+        return;
+    }
+    used -= size;
+
+    // First free range that starts after the released one.
+    std::vector<Range>::iterator next = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset,
+        [](const Range& range, size_t value) { return range.offset < value; });
+
+    const bool mergePrev = next != freeRanges.begin() && (next - 1)->offset + (next - 1)->size == offset;
+    const bool mergeNext = next != freeRanges.end() && offset + size == next->offset;
+    if (mergePrev && mergeNext) {
+        (next - 1)->size += size + next->size;
+        freeRanges.erase(next);
+    } else if (mergePrev) {
+        (next - 1)->size += size;
+    } else if (mergeNext) {
+        next->offset = offset;
+        next->size += size;
+    } else {
+        freeRanges.insert(next, Range{ offset, size });
+    }
+}
+
+void RangeAllocator::grow(size_t newCapacity) {
+    if (newCapacity <= capacity) return;
+    const size_t added = newCapacity - capacity;
+    if (!freeRanges.empty() && freeRanges.back().offset + freeRanges.back().size == capacity) {
+        freeRanges.back().size += added;
+    } else {
+        freeRanges.push_back(Range{ capacity, added });
+    }
+    capacity = newCapacity;
+}
+
+size_t RangeAllocator::getLargestFreeRange() const {
+    size_t largest = 0;
+    for (const Range& range : freeRanges) largest = std::max(largest, range.size);
+    return largest;
+}
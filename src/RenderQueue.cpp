@@ -0,0 +1,117 @@
+// RenderQueue.cpp
+// Bucket merging and radix sorting for the render command queue.
+
+#include "MyFirstEngine/RenderQueue.h"
+#include <algorithm> // For std::swap, std::sort
+#include <cstring>   // For std::memcpy
+#include <iostream>  // For std::cerr
+
+// Below this size an insertion sort beats building eight histograms.
+static const size_t RADIX_SORT_THRESHOLD = 64;
+
+void radixSortKeys(uint64_t* keys, uint32_t* values, uint64_t* tmpKeys, uint32_t* tmpValues, size_t n) {
+    if (n < 2) return;
+    if (n < RADIX_SORT_THRESHOLD) {
+        for (size_t i = 1; i < n; ++i) {
+            uint64_t key = keys[i];
+            uint32_t value = values[i];
+            size_t j = i;
+            for (; j > 0 && keys[j - 1] > key; --j) {
+                keys[j] = keys[j - 1];
+                values[j] = values[j - 1];
+            }
+            keys[j] = key;
+            values[j] = value;
+        }
+        return;
+    }
+
+    // All eight histograms in one read of the keys.
+    size_t histograms[8][256] = {};
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t key = keys[i];
+        for (int digit = 0; digit < 8; ++digit) {
+            ++histograms[digit][(key >> (digit * 8)) & 0xFF];
+        }
+    }
+
+    uint64_t* srcKeys = keys;
+    uint32_t* srcValues = values;
+    uint64_t* dstKeys = tmpKeys;
+    uint32_t* dstValues = tmpValues;
+    for (int digit = 0; digit < 8; ++digit) {
+        size_t* histogram = histograms[digit];
+        // Every key has the same byte here: this pass would not change the order.
+        if (histogram[(srcKeys[0] >> (digit * 8)) & 0xFF] == n) continue;
+
+        size_t offset = 0;
+        for (int b = 0; b < 256; ++b) {
+            size_t count = histogram[b];
+            histogram[b] = offset;
+            offset += count;
+        }
+        const int shift = digit * 8;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t key = srcKeys[i];
+            size_t dst = histogram[(key >> shift) & 0xFF]++;
+            dstKeys[dst] = key;
+            dstValues[dst] = srcValues[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    // An odd number of executed passes leaves the result in the scratch buffers.
+    if (srcKeys != keys) {
+        std::memcpy(keys, srcKeys, n * sizeof(uint64_t));
+        std::memcpy(values, srcValues, n * sizeof(uint32_t));
+    }
+}
+
+RenderQueue::RenderQueue(size_t bucketCount) {
+    setBucketCount(bucketCount);
+}
+
+void RenderQueue::setBucketCount(size_t count) {
+    if (count == 0) count = 1;
+    if (count > (size_t(1) << (32 - BUCKET_SHIFT))) {
+        std::cerr << "ERROR::RENDERQUEUE::SET_BUCKET_COUNT: Too many buckets (" << count << ")." << std::endl;
+        count = size_t(1) << (32 - BUCKET_SHIFT);
+    }
+    buckets.resize(count);
+    clear();
+}
+
+void RenderQueue::clear() {
+    for (RenderBucket& bucket : buckets) bucket.clear();
+    sortedKeys.clear();
+    sortedRefs.clear();
+}
+
+void RenderQueue::sort() {
+    size_t total = 0;
+    for (const RenderBucket& bucket : buckets) total += bucket.size();
+    sortedKeys.resize(total);
+    sortedRefs.resize(total);
+    scratchKeys.resize(total);
+    scratchRefs.resize(total);
+
+    // Merge: concatenate keys and remember where each command's matrix lives.
+    // Matrices stay in their buckets; only 12 bytes per command move during the sort.
+    size_t out = 0;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        const RenderBucket& bucket = buckets[b];
+        if (bucket.size() > INDEX_MASK + 1) {
+            std::cerr << "ERROR::RENDERQUEUE::SORT: Bucket " << b << " holds too many commands; extra commands dropped." << std::endl;
+        }
+        const size_t count = std::min<size_t>(bucket.size(), INDEX_MASK + 1);
+        if (count) std::memcpy(&sortedKeys[out], bucket.keys.data(), count * sizeof(uint64_t));
+        const uint32_t base = static_cast<uint32_t>(b) << BUCKET_SHIFT;
+        for (size_t i = 0; i < count; ++i) sortedRefs[out + i] = base | static_cast<uint32_t>(i);
+        out += count;
+    }
+    sortedKeys.resize(out);
+    sortedRefs.resize(out);
+
+    radixSortKeys(sortedKeys.data(), sortedRefs.data(), scratchKeys.data(), scratchRefs.data(), out);
+}
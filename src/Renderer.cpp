@@ -1,133 +1,742 @@
 // Renderer.cpp
 // Implementation of the Renderer class.
 // Initializes OpenGL state, manages shaders and vertex buffers,
-// and draws objects using Model, View, and Projection (MVP) matrices.
+// and draws batches of objects with instanced draw calls.
 
 #include "MyFirstEngine/Renderer.h" // Path to Renderer.h, assuming it's in include/MyFirstEngine/
 #include "glad/glad.h"              // For OpenGL functions
+#include "MyFirstEngine/Profiler.h" // For PROFILE_SCOPE
+#include "MyFirstEngine/GLExtensions.h" // For KHR_parallel_shader_compile
+#include "MyFirstEngine/MeshFile.h"     // For loadMesh()
+#include "MyFirstEngine/ThreadPool.h"   // For flush()'s parallel meshlet culling
+#include <algorithm>                // For std::max
+#include <atomic>                   // For std::atomic
+#include <cmath>                    // For std::sqrt
+#include <cstring>                  // For std::memcpy
 #include <iostream>                 // For std::cerr (error output)
 
 // Constructor: Initializes member variables
-Renderer::Renderer() : VAO(0), VBO(0), shaderProgram(nullptr) {
-    // VAO, VBO are initialized to 0, indicating they are not yet generated by OpenGL.
-    // shaderProgram is initialized to nullptr, indicating no shader is loaded yet.
+Renderer::Renderer()
+    : defaultMaterial(INVALID_RENDER_HANDLE),
+      uniformAlignment(256), frameInvDepthRange(1.0f / 1000.0f),
+      maxTextureBufferTexels(0), ambientLight(0.15f, 0.15f, 0.15f), sunDirection(0.0f, -1.0f, 0.0f),
+      sunColor(0.0f, 0.0f, 0.0f), shaderCacheDirectory("shader_cache"), framePixelsPerUnit(0.0f),
+      shadowShader(nullptr), shadowMaps(0), staticShadowMaps(0), shadowResolution(0), shadowLayers(0),
+      meshletCulling(MeshletCulling::FrustumAndCone), frameMeshletCulling(MeshletCulling::FrustumAndCone) {
+    // Meshes, materials and the frame stream are created in init(), once a GL context exists.
+    for (MeshHandle& mesh : builtinMeshes) mesh = INVALID_RENDER_HANDLE;
+    for (unsigned int& texture : lightTextures) texture = 0;
+    for (unsigned int& framebuffer : shadowFramebuffers) framebuffer = 0;
+    for (bool& hasDynamic : shadowLayerHasDynamic) hasDynamic = false;
+    meshManager.setMaxMeshes(SortKey::MAX_MESHES);
 }
 
 // Destructor: Cleans up OpenGL resources
 Renderer::~Renderer() {
-    // Delete the shader program if it was allocated
-    if (shaderProgram) {
-        delete shaderProgram;
-        shaderProgram = nullptr; // Set to nullptr to avoid dangling pointer issues
-    }
-    // Delete the Vertex Buffer Object if it was generated
-    if (VBO != 0) {
-        glDeleteBuffers(1, &VBO);
-        VBO = 0; // Reset ID
-    }
-    // Delete the Vertex Array Object if it was generated
-    if (VAO != 0) {
-        glDeleteVertexArrays(1, &VAO);
-        VAO = 0; // Reset ID
-    }
+    // Shader programs belong to shaderLibrary and are deleted with it.
+    if (lightTextures[0] != 0) glDeleteTextures(3, lightTextures);
+    if (shadowMaps != 0) glDeleteTextures(1, &shadowMaps);
+    if (staticShadowMaps != 0) glDeleteTextures(1, &staticShadowMaps);
+    if (shadowFramebuffers[0] != 0) glDeleteFramebuffers(2, shadowFramebuffers);
+    // Mesh arenas and the frame stream are released by their own destructors.
 }
 
 // Initializes the renderer
 bool Renderer::init() {
-    // --- 1. Load and Compile Shaders ---
-    // The shader paths are relative to the executable's working directory.
-    // CMakeLists.txt should copy "assets/shaders/triangle.vert" and "assets/shaders/triangle.frag"
-    // to a "shaders/" subdirectory in the build output folder.
-    // Ensure these shader files are the updated versions that use MVP matrices.
-    shaderProgram = new Shader("shaders/triangle.vert", "shaders/triangle.frag");
+    // --- 1. Frame Stream ---
+    // Holds the camera uniforms and the per-instance model matrices every arena VAO reads.
+    // 1 MB per frame covers ~16K instances; it grows on demand.
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = alignment > 0 ? static_cast<size_t>(alignment) : 256;
+    if (!frameStream.init(1u << 20)) {
+        std::cerr << "ERROR::RENDERER::INIT: Failed to create the frame stream buffer." << std::endl;
+        return false;
+    }
+
+    // --- 1b. Light Buffer Textures ---
+    // Views of the frame stream for the clustered-lighting data (see setLights()).
+    glGenTextures(3, lightTextures);
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    maxTextureBufferTexels = maxTexels > 0 ? static_cast<size_t>(maxTexels) : 65536;
 
-    // Check if the shader program was created and linked successfully
-    if (!shaderProgram || shaderProgram->ID == 0) {
+    // --- 2. Default Material ---
+    // Program binaries are reused from shaderCacheDirectory; a missing cache only costs time.
+    // Let the driver pick its compiler thread count (0xFFFFFFFF means "implementation maximum").
+    shaderCache.init(shaderCacheDirectory);
+    shaderLibrary.setCache(&shaderCache);
+    if (GLExtensions::hasParallelShaderCompile) GLExtensions::maxShaderCompilerThreads(0xFFFFFFFFu);
+    // The shader paths are relative to the executable's working directory.
+    // CMakeLists.txt copies "Assets/shaders/triangle.vert" and "Assets/shaders/triangle.frag"
+    // (and the variant manifest) to a "shaders/" subdirectory in the build output folder.
+    // The default material uses every feature of the triangle shader. Its program and the
+    // manifest's variants compile while the meshes below are uploaded; they are checked at the end.
+    if (shaderLibrary.addShader(DEFAULT_SHADER, "shaders/triangle.vert", "shaders/triangle.frag")) {
+        shaderLibrary.prewarm("shaders/variants.txt"); // Optional
+        defaultMaterial = createMaterialVariant(DEFAULT_SHADER, shaderLibrary.getFeatureBit(DEFAULT_SHADER, "LIGHTING") |
+                                                                    shaderLibrary.getFeatureBit(DEFAULT_SHADER, "LOD_FADE"));
+    }
+    if (defaultMaterial == INVALID_RENDER_HANDLE) {
         std::cerr << "ERROR::RENDERER::INIT: Failed to create or link shader program." << std::endl;
-        if (shaderProgram) { // Clean up if allocated but failed
-            delete shaderProgram;
-            shaderProgram = nullptr;
-        }
         return false; // Initialization failed
     }
+    // Shadow casters all draw with one depth-only program. Without it there are no shadows.
+    if (shaderLibrary.addShader(SHADOW_SHADER, "shaders/shadow.vert", "shaders/shadow.frag")) {
+        const uint32_t variant = shaderLibrary.getVariantIndex(SHADOW_SHADER, 0);
+        if (variant != ShaderLibrary::INVALID_VARIANT) shadowShader = shaderLibrary.getVariant(variant);
+    }
 
-    // --- 2. Set up Vertex Data, Buffers, and Attributes ---
-    glGenVertexArrays(1, &VAO); // Generate a Vertex Array Object
-    glGenBuffers(1, &VBO);      // Generate a Vertex Buffer Object
-
-    glBindVertexArray(VAO); // Bind the VAO so subsequent VBO and attribute configurations are stored in it
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO); // Bind the VBO to the GL_ARRAY_BUFFER target
-    // Copy the vertex data (defined in Renderer.h's 'vertices' array) into the VBO's memory
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    // Configure vertex attributes:
-    // Stride: 6 * sizeof(float) because each vertex has 3 position floats + 3 color floats.
-
-    // Position attribute (corresponds to 'layout (location = 0)' in the vertex shader)
-    // Index: 0
-    // Size: 3 components (x, y, z)
-    // Type: GL_FLOAT
-    // Normalized: GL_FALSE
-    // Stride: total size of one vertex's data in bytes
-    // Pointer: offset of the position data from the start of the vertex data (0 for the first attribute)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0); // Enable this vertex attribute
-
-    // Color attribute (corresponds to 'layout (location = 1)' in the vertex shader)
-    // Index: 1
-    // Size: 3 components (r, g, b)
-    // Type: GL_FLOAT
-    // Normalized: GL_FALSE
-    // Stride: total size of one vertex's data in bytes
-    // Pointer: offset of the color data from the start of the vertex data (after 3 position floats)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1); // Enable this vertex attribute
-
-    // Unbind VBO (the VAO "remembers" this VBO and its attribute configuration)
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    // Unbind VAO (to prevent accidental modification)
-    glBindVertexArray(0);
+    // --- 2b. Texture Streaming ---
+    if (!textureStreamer.init()) {
+        std::cerr << "ERROR::RENDERER::INIT: Failed to initialize texture streaming." << std::endl;
+        return false;
+    }
+
+    // --- 3. Built-in Meshes ---
+    // All three share one arena, so drawing them together needs a single VAO bind.
+    builtinMeshes[static_cast<int>(BuiltinMesh::Triangle)] = createMesh(MeshData::triangle());
+    builtinMeshes[static_cast<int>(BuiltinMesh::Cube)] = createMesh(MeshData::cube());
+    builtinMeshes[static_cast<int>(BuiltinMesh::Plane)] = createMesh(MeshData::plane());
+    for (MeshHandle mesh : builtinMeshes) {
+        if (mesh == INVALID_RENDER_HANDLE) {
+            std::cerr << "ERROR::RENDERER::INIT: Failed to create the built-in meshes." << std::endl;
+            return false;
+        }
+    }
 
-    // --- 3. Enable Depth Testing ---
+    // --- 4. Enable Depth Testing ---
     // This ensures that objects closer to the camera correctly occlude objects farther away.
     glEnable(GL_DEPTH_TEST);
-    // glDepthFunc(GL_LESS); // Optional: specify the depth comparison function (GL_LESS is default)
+
+    // --- 5. Finish the Shader Programs ---
+    finishShaderCompiles();
+    if (!materials[defaultMaterial].shader->isReady()) {
+        std::cerr << "ERROR::RENDERER::INIT: Failed to create or link shader program." << std::endl;
+        return false;
+    }
+    if (shadowShader && shadowShader->isReady()) {
+        shadowViewProjectionUniform = shadowShader->getUniform("lightViewProjection");
+    } else {
+        std::cerr << "ERROR::RENDERER::INIT: Failed to build the shadow shader; shadows are disabled." << std::endl;
+        shadowShader = nullptr;
+    }
 
     return true; // Initialization successful
 }
 
-// Draws the scene using the provided Model, View, and Projection matrices
-void Renderer::draw(const Mat4& model, const Mat4& view, const Mat4& projection) {
-    // --- 1. Clear Buffers ---
-    // Set the clear color (background color)
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f); // Dark grey
-    // Clear the color buffer and the depth buffer from the previous frame
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    // --- 2. Prepare for Drawing ---
-    // Check if the shader program is valid
-    if (shaderProgram && shaderProgram->ID != 0) {
-        shaderProgram->use(); // Activate the shader program
-
-        // --- 3. Set Uniforms ---
-        // Send the MVP matrices to the shader program.
-        // The Shader class's setMat4 method takes a const float* to the matrix elements.
-        // The uniform names ("model", "view", "projection") must match those in the vertex shader.
-        shaderProgram->setMat4("model", model.getElementsPtr());
-        shaderProgram->setMat4("view", view.getElementsPtr());
-        shaderProgram->setMat4("projection", projection.getElementsPtr());
-
-        // --- 4. Draw the Object ---
-        glBindVertexArray(VAO); // Bind the VAO that contains our triangle's vertex data and attributes
-        // Draw the triangle:
-        // Mode: GL_TRIANGLES
-        // Starting index: 0
-        // Number of vertices: 3
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-
-        glBindVertexArray(0); // Unbind the VAO after drawing
+MeshHandle Renderer::createMesh(const MeshData& data) {
+    return meshManager.createMesh(data);
+}
+
+MeshHandle Renderer::createMesh(const MeshDataView& data) {
+    return meshManager.createMesh(data);
+}
+
+MeshHandle Renderer::loadMesh(const std::string& path) {
+    PROFILE_SCOPE("Load Mesh");
+    MeshFile file;
+    if (!file.open(path)) return INVALID_RENDER_HANDLE;
+    return meshManager.createMesh(file.getView());
+}
+
+void Renderer::destroyMesh(MeshHandle mesh) {
+    meshManager.destroyMesh(mesh);
+}
+
+MaterialHandle Renderer::createMaterial(const char* vertexPath, const char* fragmentPath, bool translucent) {
+    // Registered under its paths, so materials made from the same files share one program.
+    const std::string name = std::string(vertexPath) + " / " + fragmentPath;
+    if (!shaderLibrary.hasShader(name) && !shaderLibrary.addShader(name, vertexPath, fragmentPath)) {
+        std::cerr << "ERROR::RENDERER::CREATE_MATERIAL: Failed to create material from " << name << std::endl;
+        return INVALID_RENDER_HANDLE;
+    }
+    return createMaterialVariant(name, 0, translucent);
+}
+
+MaterialHandle Renderer::createMaterialVariant(const std::string& shaderName, uint32_t featureMask, bool translucent) {
+    if (materials.size() >= SortKey::MAX_MATERIALS) {
+        std::cerr << "ERROR::RENDERER::CREATE_MATERIAL: Material limit reached." << std::endl;
+        return INVALID_RENDER_HANDLE;
+    }
+    // Only missing sources can fail here; compile and link errors surface in finalizeMaterial().
+    const uint32_t variant = shaderLibrary.getVariantIndex(shaderName, featureMask);
+    if (variant == ShaderLibrary::INVALID_VARIANT || variant >= SortKey::MAX_SHADERS) {
+        std::cerr << "ERROR::RENDERER::CREATE_MATERIAL: Failed to create material from shader '" << shaderName
+                  << "'" << (variant == ShaderLibrary::INVALID_VARIANT ? "." : " (shader variant limit reached).")
+                  << std::endl;
+        return INVALID_RENDER_HANDLE;
+    }
+    Material material;
+    material.shader = shaderLibrary.getVariant(variant);
+    material.shaderKey = variant; // Materials on the same variant share the sort key's shader field
+    material.translucent = translucent;
+    material.finalized = false;
+    material.texture = INVALID_RENDER_HANDLE;
+    materials.push_back(material);
+    return static_cast<MaterialHandle>(materials.size() - 1);
+}
+
+void Renderer::setMaterialTexture(MaterialHandle material, TextureHandle texture) {
+    if (material >= materials.size()) {
+        std::cerr << "ERROR::RENDERER::SET_MATERIAL_TEXTURE: Invalid material handle." << std::endl;
+        return;
+    }
+    materials[material].texture = textureStreamer.isValid(texture) ? texture : INVALID_RENDER_HANDLE;
+}
+
+bool Renderer::finalizeMaterial(Material& material) {
+    if (material.finalized) return material.shader->isReady();
+    material.finalized = true;
+    if (!material.shader->finalize()) return false; // Shader printed the logs
+    if (!material.shader->hasUniformBlock("Camera")) {
+        std::cerr << "ERROR::RENDERER::FINALIZE_MATERIAL: Shader variant " << material.shaderKey
+                  << " does not use the 'Camera' uniform block; objects will not be transformed." << std::endl;
+    }
+    return true;
+}
+
+size_t Renderer::finishShaderCompiles() {
+    // Waits for the programs (including prewarmed variants no material uses yet), then checks
+    // each material once.
+    const size_t failed = shaderLibrary.finishCompiles();
+    for (Material& material : materials) finalizeMaterial(material);
+    return failed;
+}
+
+void Renderer::requestTextureSize(TextureHandle texture, MeshHandle mesh, const RenderQueue& queue, size_t begin,
+                                  size_t end) {
+    // Diameter * largest axis scale * pixels per unit / depth, for the instance that needs the
+    // most detail. Depth is clamped to the diameter, so objects the camera is inside (or
+    // behind it) count as about viewport-sized.
+    const BoundingSphere& sphere = meshManager.getBounds(mesh).sphere;
+    const float* v = frameView.elements;
+    float largest = 0.0f;
+    for (size_t i = begin; i < end; ++i) {
+        const float* m = queue.getModel(i).elements;
+        const float scaleSq = std::max(m[0] * m[0] + m[1] * m[1] + m[2] * m[2],
+                                       std::max(m[4] * m[4] + m[5] * m[5] + m[6] * m[6], m[8] * m[8] + m[9] * m[9] + m[10] * m[10]));
+        const float depth = -(v[2] * m[12] + v[6] * m[13] + v[10] * m[14] + v[14]);
+        const float diameter = 2.0f * sphere.radius * std::sqrt(scaleSq);
+        largest = std::max(largest, diameter * framePixelsPerUnit / std::max(depth, std::max(diameter, 1e-4f)));
+    }
+    textureStreamer.request(texture, largest);
+}
+
+void Renderer::bindInstanceAttributes(const StreamAllocation& instances, size_t fadeOffset, size_t firstInstance) {
+    glBindBuffer(GL_ARRAY_BUFFER, instances.buffer);
+    const size_t base = instances.offset + firstInstance * sizeof(Mat4);
+    for (GLuint column = 0; column < 4; ++column) {
+        glVertexAttribPointer(INSTANCE_MODEL_LOCATION + column, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
+                              (void*)(base + column * 4 * sizeof(float)));
+    }
+    glVertexAttribPointer(INSTANCE_FADE_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(float),
+                          (void*)(fadeOffset + firstInstance * sizeof(float)));
+}
+
+void Renderer::beginFrame(const Mat4& view, const Mat4& projection) {
+    frameStream.beginFrame();
+    textureStreamer.update();
+
+    StreamAllocation cameraData = frameStream.allocate(sizeof(CameraUniforms), uniformAlignment);
+    if (!cameraData.data) return;
+    CameraUniforms camera;
+    camera.view = view;
+    camera.projection = projection;
+    camera.viewProjection = projection * view;
+    // The view matrix is rigid (R | t), so the eye position is -R^T * t.
+    const float* v = view.elements;
+    camera.cameraPosition[0] = -(v[0] * v[12] + v[1] * v[13] + v[2] * v[14]);
+    camera.cameraPosition[1] = -(v[4] * v[12] + v[5] * v[13] + v[6] * v[14]);
+    camera.cameraPosition[2] = -(v[8] * v[12] + v[9] * v[13] + v[10] * v[14]);
+    camera.cameraPosition[3] = 1.0f;
+
+    std::memcpy(cameraData.data, &camera, sizeof(CameraUniforms));
+    frameStream.commit(cameraData);
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_UNIFORM_BINDING, cameraData.buffer,
+                      static_cast<GLintptr>(cameraData.offset), sizeof(CameraUniforms));
+
+    uploadLights(nullptr); // Unlit until setLights()
+    uploadShadows(nullptr); // No shadows until setShadows()
+    shadowStats = ShadowStats();
+
+    frameView = view;
+    // Far plane from a perspective projection (P[10] = -(f+n)/(f-n), P[14] = -2fn/(f-n)),
+    // used to normalize sort-key depths to [0,1].
+    const float* p = projection.elements;
+    float farPlane = (p[11] == -1.0f && p[10] != -1.0f) ? p[14] / (p[10] + 1.0f) : 1000.0f;
+    frameInvDepthRange = farPlane > 0.0f ? 1.0f / farPlane : 1.0f / 1000.0f;
+    // P[5] = 1 / tan(fov / 2): half the viewport height covers 1 / P[5] units at depth 1.
+    GLint viewport[4] = { 0, 0, 0, 0 };
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    framePixelsPerUnit = 0.5f * static_cast<float>(viewport[3]) * p[5];
+    frameMeshletCulling = meshletCulling;
+    meshletCuller.setView(Frustum::fromMatrix(camera.viewProjection),
+                          Vec3(camera.cameraPosition[0], camera.cameraPosition[1], camera.cameraPosition[2]),
+                          frameMeshletCulling == MeshletCulling::FrustumAndCone);
+    frameQueue.clear();
+}
+
+bool Renderer::setLights(const LightClusterer& clusterer) {
+    if (uploadLights(&clusterer)) return true;
+    uploadLights(nullptr);
+    return false;
+}
+
+bool Renderer::uploadLights(const LightClusterer* clusterer) {
+    // One allocation: the uniform block first (uniform-aligned), then the three arrays, each
+    // starting on a multiple of its texel size so it can be addressed by a texel base.
+    const size_t lightCount = clusterer ? clusterer->getLightCount() : 0;
+    const size_t lightBytes = lightCount * sizeof(LightClusterer::GpuLight);
+    const size_t clusterBytes = clusterer ? clusterer->getClusters().size() * sizeof(LightClusterer::Cluster) : 0;
+    const size_t indexBytes = clusterer ? clusterer->getLightIndices().size() * sizeof(uint16_t) : 0;
+    StreamAllocation data = frameStream.allocate(sizeof(LightUniforms) + lightBytes + clusterBytes + indexBytes,
+                                                 uniformAlignment);
+    if (!data.data) return false;
+
+    LightUniforms uniforms;
+    std::memset(&uniforms, 0, sizeof(uniforms));
+    uniforms.ambientColor[0] = uniforms.ambientColor[1] = uniforms.ambientColor[2] = 1.0f;
+    if (clusterer) {
+        const size_t lightsOffset = data.offset + sizeof(LightUniforms); // sizeof(LightUniforms) = 96
+        const size_t clustersOffset = lightsOffset + lightBytes;
+        const size_t indicesOffset = clustersOffset + clusterBytes;
+        // The buffer textures view the whole stream buffer, which must fit the texel limit.
+        if ((indicesOffset + indexBytes) / sizeof(uint16_t) > maxTextureBufferTexels) {
+            std::cerr << "ERROR::RENDERER::SET_LIGHTS: Frame stream exceeds GL_MAX_TEXTURE_BUFFER_SIZE ("
+                      << maxTextureBufferTexels << " texels); drawing unlit." << std::endl;
+            frameStream.commit(data);
+            return false;
+        }
+        char* bytes = static_cast<char*>(data.data) + sizeof(LightUniforms);
+        if (lightBytes) std::memcpy(bytes, clusterer->getLights().data(), lightBytes);
+        if (clusterBytes) std::memcpy(bytes + lightBytes, clusterer->getClusters().data(), clusterBytes);
+        if (indexBytes) std::memcpy(bytes + lightBytes + clusterBytes, clusterer->getLightIndices().data(), indexBytes);
+
+        uniforms.clusterGrid[0] = LightClusterer::CLUSTERS_X;
+        uniforms.clusterGrid[1] = LightClusterer::CLUSTERS_Y;
+        uniforms.clusterGrid[2] = LightClusterer::CLUSTERS_Z;
+        uniforms.clusterGrid[3] = static_cast<uint32_t>(lightCount);
+        uniforms.clusterScale[0] = static_cast<float>(LightClusterer::CLUSTERS_X) / clusterer->getViewportWidth();
+        uniforms.clusterScale[1] = static_cast<float>(LightClusterer::CLUSTERS_Y) / clusterer->getViewportHeight();
+        uniforms.clusterScale[2] = clusterer->getSliceScale();
+        uniforms.clusterScale[3] = clusterer->getSliceBias();
+        uniforms.ambientColor[0] = ambientLight.x;
+        uniforms.ambientColor[1] = ambientLight.y;
+        uniforms.ambientColor[2] = ambientLight.z;
+        uniforms.texelBases[0] = static_cast<uint32_t>(lightsOffset / 16);
+        uniforms.texelBases[1] = static_cast<uint32_t>(clustersOffset / sizeof(LightClusterer::Cluster));
+        uniforms.texelBases[2] = static_cast<uint32_t>(indicesOffset / sizeof(uint16_t));
+        uniforms.sunDirection[0] = -sunDirection.x;
+        uniforms.sunDirection[1] = -sunDirection.y;
+        uniforms.sunDirection[2] = -sunDirection.z;
+        uniforms.sunColor[0] = sunColor.x;
+        uniforms.sunColor[1] = sunColor.y;
+        uniforms.sunColor[2] = sunColor.z;
+
+        // Attached every frame: a grown stream buffer is a new object that may reuse the old name.
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+        const GLint units[3] = { LIGHT_DATA_TEXTURE_UNIT, LIGHT_CLUSTERS_TEXTURE_UNIT, LIGHT_INDICES_TEXTURE_UNIT };
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + units[i]);
+            glBindTexture(GL_TEXTURE_BUFFER, lightTextures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], data.buffer);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+    std::memcpy(data.data, &uniforms, sizeof(LightUniforms));
+    frameStream.commit(data);
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTS_UNIFORM_BINDING, data.buffer,
+                      static_cast<GLintptr>(data.offset), sizeof(LightUniforms));
+    return true;
+}
+
+void Renderer::setDirectionalLight(const Vec3& direction, const Vec3& color) {
+    const Vec3 normalized = Vec3(direction).normalize();
+    if (normalized.length() > 0.0f) sunDirection = normalized;
+    sunColor = color;
+}
+
+void Renderer::uploadShadows(const ShadowCascades* cascades) {
+    StreamAllocation data = frameStream.allocate(sizeof(ShadowUniforms), uniformAlignment);
+    if (!data.data) return;
+    ShadowUniforms uniforms = {};
+    if (cascades) {
+        // Clip space [-1,1] to texture coordinates and depth in [0,1].
+        const Mat4 bias = Mat4::translate(Vec3(0.5f, 0.5f, 0.5f)) * Mat4::scale(Vec3(0.5f, 0.5f, 0.5f));
+        for (uint32_t i = 0; i < cascades->getCascadeCount(); ++i) {
+            const ShadowCascade& cascade = cascades->getCascade(i);
+            uniforms.shadowMatrices[i] = bias * cascade.viewProjection;
+            uniforms.cascadeSplits[i] = cascade.farDepth;
+            uniforms.cascadeTexelSizes[i] = cascade.texelSize;
+        }
+        uniforms.shadowParams[0] = static_cast<float>(cascades->getCascadeCount());
+        uniforms.shadowParams[1] = SHADOW_NORMAL_OFFSET;
+        uniforms.shadowParams[2] = 1.0f / static_cast<float>(shadowResolution);
+    }
+    std::memcpy(data.data, &uniforms, sizeof(ShadowUniforms));
+    frameStream.commit(data);
+    glBindBufferRange(GL_UNIFORM_BUFFER, SHADOWS_UNIFORM_BINDING, data.buffer,
+                      static_cast<GLintptr>(data.offset), sizeof(ShadowUniforms));
+}
+
+bool Renderer::createShadowMaps(const ShadowSettings& settings) {
+    if (shadowMaps != 0) glDeleteTextures(1, &shadowMaps);
+    if (staticShadowMaps != 0) glDeleteTextures(1, &staticShadowMaps);
+    if (shadowFramebuffers[0] == 0) glGenFramebuffers(2, shadowFramebuffers);
+    shadowMaps = staticShadowMaps = 0;
+    shadowResolution = shadowLayers = 0;
+
+    // Created on the shadow map's own unit so the material texture bindings are left alone.
+    const GLsizei size = static_cast<GLsizei>(settings.resolution);
+    const GLsizei layers = static_cast<GLsizei>(settings.cascadeCount);
+    unsigned int textures[2];
+    glGenTextures(2, textures);
+    glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_TEXTURE_UNIT);
+    for (int i = 0; i < 2; ++i) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textures[i]);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, size, size, layers, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+        // The lit shaders compare in the sampler; linear filtering makes that a 2x2 PCF.
+        const bool compared = i == 0;
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, compared ? GL_LINEAR : GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, compared ? GL_LINEAR : GL_NEAREST);
+        if (compared) {
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        }
+    }
+    glActiveTexture(GL_TEXTURE0);
+    shadowMaps = textures[0];
+    staticShadowMaps = textures[1];
+
+    // Depth only: no color buffers to draw to or read from.
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    bool complete = true;
+    for (int i = 0; i < 2; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, shadowFramebuffers[i]);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, textures[i], 0, 0);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+    if (!complete) {
+        std::cerr << "ERROR::RENDERER::CREATE_SHADOW_MAPS: Shadow map framebuffer is incomplete ("
+                  << size << "x" << size << ", " << layers << " layers)." << std::endl;
+        return false;
+    }
+    shadowResolution = settings.resolution;
+    shadowLayers = settings.cascadeCount;
+    for (bool& hasDynamic : shadowLayerHasDynamic) hasDynamic = false;
+    return true;
+}
+
+// Commands recorded into a queue's buckets (RenderQueue::size() only counts after sort()).
+static size_t countCommands(RenderQueue& queue) {
+    size_t count = 0;
+    for (size_t i = 0; i < queue.getBucketCount(); ++i) count += queue.getBucket(i).size();
+    return count;
+}
+
+void Renderer::flushShadowCasters(RenderQueue& casters, ThreadPool* pool) {
+    flush(casters, pool);
+    shadowStats.drawCalls += lastFlushStats.drawCalls;
+    shadowStats.casters += lastFlushStats.instances;
+    shadowStats.triangles += lastFlushStats.triangles;
+}
+
+void Renderer::renderShadowCascade(ShadowCascades& cascades, uint32_t cascade, RenderQueue& staticCasters,
+                                   RenderQueue& dynamicCasters, ThreadPool* pool) {
+    PROFILE_SCOPE("Shadow Cascade");
+    const ShadowSettings& settings = cascades.getSettings();
+    if (shadowShader && (settings.resolution != shadowResolution || settings.cascadeCount != shadowLayers)) {
+        if (createShadowMaps(settings)) cascades.invalidateAll();
+    }
+    if (!shadowShader || shadowMaps == 0 || cascade >= cascades.getCascadeCount()) {
+        staticCasters.clear();
+        dynamicCasters.clear();
+        return;
+    }
+
+    GLint previousDrawFramebuffer = 0, previousReadFramebuffer = 0;
+    GLint previousViewport[4] = { 0, 0, 0, 0 };
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    const ShadowCascade& target = cascades.getCascade(cascade);
+    const GLsizei size = static_cast<GLsizei>(shadowResolution);
+    glViewport(0, 0, size, size);
+    // Casters between the light and the cascade's box are flattened onto its near plane instead
+    // of being clipped. The slope-scaled offset keeps lit surfaces from shadowing themselves.
+    glEnable(GL_DEPTH_CLAMP);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(SHADOW_SLOPE_BIAS, SHADOW_CONSTANT_BIAS);
+    if (shadowShader->use()) shadowShader->setMat4(shadowViewProjectionUniform, target.viewProjection.elements);
+    shadowMeshletCuller.setView(target.casterFrustum, target.bounds.center, false);
+
+    const GLint layer = static_cast<GLint>(cascade);
+    glBindFramebuffer(GL_FRAMEBUFFER, shadowFramebuffers[0]);
+    if (!target.cached) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMaps, 0, layer);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        flushShadowCasters(staticCasters, pool);
+        flushShadowCasters(dynamicCasters, pool);
+        ++shadowStats.cascadesRendered;
     } else {
-        std::cerr << "ERROR::RENDERER::DRAW: Called with invalid or uninitialized shader program." << std::endl;
+        // Static casters go to the cache layer, only when they changed. The final layer is the
+        // cache plus this frame's dynamic casters; if neither changed, last frame's is still right.
+        const bool staticChanged = cascades.needsStaticRender(cascade);
+        const bool hasDynamic = countCommands(dynamicCasters) > 0;
+        if (staticChanged) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowMaps, 0, layer);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            flushShadowCasters(staticCasters, pool);
+            cascades.markStaticRendered(cascade);
+            ++shadowStats.cascadesRendered;
+        } else {
+            staticCasters.clear();
+        }
+        if (staticChanged || hasDynamic || shadowLayerHasDynamic[cascade]) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMaps, 0, layer);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, shadowFramebuffers[1]);
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticShadowMaps, 0, layer);
+            glBlitFramebuffer(0, 0, size, size, 0, 0, size, size, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+            flushShadowCasters(dynamicCasters, pool);
+            if (!staticChanged) ++shadowStats.cascadesCopied;
+        } else {
+            dynamicCasters.clear();
+            ++shadowStats.cascadesKept;
+        }
+        shadowLayerHasDynamic[cascade] = hasDynamic;
     }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDisable(GL_DEPTH_CLAMP);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousDrawFramebuffer));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousReadFramebuffer));
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void Renderer::setShadows(const ShadowCascades& cascades) {
+    if (shadowMaps == 0 || cascades.getCascadeCount() > shadowLayers) return; // No cascade rendered yet
+    uploadShadows(&cascades);
+    glActiveTexture(GL_TEXTURE0 + SHADOW_MAP_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMaps);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+uint64_t Renderer::makeSortKey(MeshHandle mesh, MaterialHandle material, const Mat4& model, RenderPass pass) const {
+    const Material& mat = materials[material];
+    if (pass == RenderPass::Opaque && mat.translucent) pass = RenderPass::Translucent;
+    // View-space distance of the object's origin: -(view * position).z
+    const float* v = frameView.elements;
+    const float* m = model.elements;
+    float viewZ = v[2] * m[12] + v[6] * m[13] + v[10] * m[14] + v[14];
+    return SortKey::make(pass, mat.translucent, mat.shaderKey, material, mesh, -viewZ * frameInvDepthRange);
+}
+
+void Renderer::submit(MeshHandle mesh, MaterialHandle material, const Mat4& model, float fade) {
+    if (!meshManager.isValid(mesh) || material >= materials.size()) {
+        std::cerr << "ERROR::RENDERER::SUBMIT: Invalid mesh or material handle." << std::endl;
+        return;
+    }
+    frameQueue.getBucket(0).push(makeSortKey(mesh, material, model), model, fade);
+}
+
+void Renderer::flush(ThreadPool* pool) {
+    flush(frameQueue, pool);
+}
+
+void Renderer::flush(RenderQueue& queue, ThreadPool* pool) {
+    PROFILE_SCOPE("Renderer::flush");
+    lastFlushStats = RenderStats();
+    {
+        PROFILE_SCOPE("Sort");
+        queue.sort();
+    }
+    const size_t count = queue.size();
+    if (count == 0) {
+        queue.clear();
+        return;
+    }
+
+    // --- 1-2. Gather matrices, then fades, in draw order straight into this frame's stream region ---
+    // The region is not read by the GPU any more (its fence was waited on in beginFrame()),
+    // so there is no orphaning and no intermediate copy. One allocation for both arrays: a second
+    // allocate() could grow the stream buffer and unmap the first one's memory before it is
+    // written. Growth keeps the old buffer until the next beginFrame(), so the Camera, Lights and
+    // Shadows blocks bound from it stay valid for the rest of the frame.
+    StreamAllocation instances = frameStream.allocate(count * (sizeof(Mat4) + sizeof(float)), sizeof(Mat4));
+    if (!instances.data) {
+        queue.clear();
+        return;
+    }
+    Mat4* instanceData = static_cast<Mat4*>(instances.data);
+    float* fadeData = reinterpret_cast<float*>(instanceData + count);
+    for (size_t i = 0; i < count; ++i) {
+        instanceData[i] = queue.getModel(i);
+        fadeData[i] = queue.getFade(i);
+    }
+    frameStream.commit(instances);
+    const size_t fadeOffset = instances.offset + count * sizeof(Mat4);
+
+    // --- 3. Meshlet culling: the visible index ranges of every instance of a mesh with meshlets ---
+    // Each command gets room for all its meshlets, so the instances cull in parallel.
+    meshletRangeOffsets.assign(count + 1, 0);
+    if (frameMeshletCulling != MeshletCulling::Off) {
+        for (size_t i = 0; i < count; ++i) {
+            meshletRangeOffsets[i + 1] = meshletRangeOffsets[i] + meshManager.getMeshlets(SortKey::mesh(queue.getKey(i))).size();
+        }
+    }
+    const bool cullMeshlets = meshletRangeOffsets[count] > 0;
+    if (cullMeshlets) {
+        PROFILE_SCOPE("Meshlet Culling");
+        meshletRanges.resize(meshletRangeOffsets[count]);
+        meshletRangeCounts.resize(count);
+        std::atomic<size_t> visibleMeshlets(0);
+        auto cullRange = [&](size_t begin, size_t end, size_t) {
+            size_t visible = 0;
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t key = queue.getKey(i);
+                const MeshHandle mesh = SortKey::mesh(key);
+                const std::vector<Meshlet>& meshlets = meshManager.getMeshlets(mesh);
+                // Shadow casters are culled to the cascade being drawn, without the cone test.
+                // Elsewhere the cone test only applies to single-sided meshes.
+                const MeshletCuller& culler = SortKey::pass(key) == RenderPass::Shadow ? shadowMeshletCuller : meshletCuller;
+                size_t instanceVisible = 0;
+                // Models come from the queue: the stream copy may be write-combined memory.
+                meshletRangeCounts[i] = static_cast<uint32_t>(culler.cull(meshlets.data(), meshlets.size(), queue.getModel(i),
+                                                                          meshManager.isSingleSided(mesh),
+                                                                          &meshletRanges[meshletRangeOffsets[i]], &instanceVisible));
+                visible += instanceVisible;
+            }
+            visibleMeshlets += visible;
+        };
+        if (pool) pool->parallelFor(count, 4, cullRange);
+        else cullRange(0, count, 0);
+        lastFlushStats.meshletsTested = meshletRangeOffsets[count];
+        lastFlushStats.meshletsVisible = visibleMeshlets;
+    }
+
+    // --- 4. One instanced draw per run of commands with the same pass and state ---
+    // Keys are sorted, so state only changes at run boundaries and each change is applied once.
+    uint32_t boundMaterial = INVALID_RENDER_HANDLE;
+    const uint32_t SHADOW_PROGRAM = INVALID_RENDER_HANDLE - 1; // boundMaterial while the shadow shader is bound
+    uint32_t boundArena = INVALID_RENDER_HANDLE;
+    // Position dequantization is a constant attribute (no array), so it is context state: start
+    // from the identity every flush.
+    PositionDequantization boundDequantization;
+    glVertexAttrib4f(MESH_DEQUANTIZATION_LOCATION, 0.0f, 0.0f, 0.0f, 1.0f);
+    bool blending = false;
+    size_t runStart = 0;
+    while (runStart < count) {
+        const uint64_t firstKey = queue.getKey(runStart);
+        const uint64_t batch = SortKey::batchBits(firstKey);
+        size_t runEnd = runStart + 1;
+        while (runEnd < count && SortKey::batchBits(queue.getKey(runEnd)) == batch) ++runEnd;
+
+        const bool translucent = SortKey::isTranslucent(firstKey);
+        if (translucent != blending) {
+            // Translucent objects blend over the opaque scene and test, but do not write, depth.
+            if (translucent) {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDepthMask(GL_FALSE);
+            } else {
+                glDisable(GL_BLEND);
+                glDepthMask(GL_TRUE);
+            }
+            blending = translucent;
+        }
+        const bool shadowPass = SortKey::pass(firstKey) == RenderPass::Shadow;
+        const uint32_t materialIndex = SortKey::material(firstKey);
+        if (shadowPass) {
+            // Casters only write depth, all with the shadow shader; renderShadowCascade() has
+            // set its light matrix.
+            if (boundMaterial != SHADOW_PROGRAM) {
+                if (!shadowShader || !shadowShader->use()) {
+                    runStart = runEnd;
+                    continue;
+                }
+                boundMaterial = SHADOW_PROGRAM;
+            }
+        } else if (materialIndex != boundMaterial) {
+            // Camera data comes from the UBO; nothing else to set. A material whose program
+            // failed to build draws nothing.
+            Material& material = materials[materialIndex];
+            if (!finalizeMaterial(material) || !material.shader->use()) {
+                runStart = runEnd;
+                continue;
+            }
+            if (material.texture != INVALID_RENDER_HANDLE) {
+                glActiveTexture(GL_TEXTURE0 + ALBEDO_TEXTURE_UNIT);
+                glBindTexture(GL_TEXTURE_2D, textureStreamer.getGLTexture(material.texture));
+            }
+            boundMaterial = materialIndex;
+        }
+        const TextureHandle texture = shadowPass ? INVALID_RENDER_HANDLE : materials[materialIndex].texture;
+        if (texture != INVALID_RENDER_HANDLE) {
+            requestTextureSize(texture, SortKey::mesh(firstKey), queue, runStart, runEnd);
+        }
+
+        // Meshes are sub-ranges of a shared arena: the VAO only changes when the arena does.
+        const MeshDrawInfo& mesh = meshManager.getDrawInfo(SortKey::mesh(firstKey));
+        if (mesh.arena != boundArena) {
+            glBindVertexArray(meshManager.getArenaVAO(mesh.arena));
+            boundArena = mesh.arena;
+            ++lastFlushStats.vaoBinds;
+        }
+        const PositionDequantization& dequantization = mesh.dequantization;
+        if (dequantization.scale != boundDequantization.scale || dequantization.offset.x != boundDequantization.offset.x ||
+            dequantization.offset.y != boundDequantization.offset.y || dequantization.offset.z != boundDequantization.offset.z) {
+            glVertexAttrib4f(MESH_DEQUANTIZATION_LOCATION, dequantization.offset.x, dequantization.offset.y, dequantization.offset.z,
+                             dequantization.scale);
+            boundDequantization = dequantization;
+        }
+        if (cullMeshlets && meshletRangeOffsets[runStart + 1] > meshletRangeOffsets[runStart]) {
+            // GL 3.3 has no instanced multi-draw: one multi-draw of the visible ranges per instance.
+            for (size_t i = runStart; i < runEnd; ++i) {
+                const size_t rangeCount = meshletRangeCounts[i];
+                if (rangeCount == 0) continue;
+                const MeshletRange* ranges = &meshletRanges[meshletRangeOffsets[i]];
+                multiDrawCounts.resize(rangeCount);
+                multiDrawOffsets.resize(rangeCount);
+                multiDrawBaseVertices.assign(rangeCount, mesh.baseVertex);
+                size_t indexCount = 0;
+                for (size_t r = 0; r < rangeCount; ++r) {
+                    multiDrawCounts[r] = static_cast<GLsizei>(ranges[r].indexCount);
+                    multiDrawOffsets[r] = (void*)(uintptr_t)((mesh.firstIndex + ranges[r].firstIndex) * sizeof(uint32_t));
+                    indexCount += ranges[r].indexCount;
+                }
+                bindInstanceAttributes(instances, fadeOffset, i);
+                glMultiDrawElementsBaseVertex(GL_TRIANGLES, multiDrawCounts.data(), GL_UNSIGNED_INT, multiDrawOffsets.data(),
+                                              static_cast<GLsizei>(rangeCount), multiDrawBaseVertices.data());
+                ++lastFlushStats.drawCalls;
+                lastFlushStats.triangles += indexCount / 3;
+            }
+            runStart = runEnd;
+            continue;
+        }
+        bindInstanceAttributes(instances, fadeOffset, runStart);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(mesh.indexCount), GL_UNSIGNED_INT,
+                                          (void*)(uintptr_t)(mesh.firstIndex * sizeof(uint32_t)),
+                                          static_cast<GLsizei>(runEnd - runStart), mesh.baseVertex);
+        ++lastFlushStats.drawCalls;
+        lastFlushStats.triangles += static_cast<size_t>(mesh.indexCount / 3) * (runEnd - runStart);
+        runStart = runEnd;
+    }
+    lastFlushStats.instances = static_cast<unsigned int>(count);
+
+    if (blending) {
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    queue.clear();
 }
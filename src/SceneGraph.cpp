@@ -0,0 +1,202 @@
+// SceneGraph.cpp
+// Implementation of the depth-first ordered transform hierarchy.
+
+#include "MyFirstEngine/SceneGraph.h"
+#include "MyFirstEngine/Transform.h"
+#include <algorithm> // For std::sort
+#include <iostream>  // For std::cerr
+
+SceneGraph::SceneGraph() {}
+
+uint32_t SceneGraph::slotOf(Entity entity) const {
+    if (entity.isNull() || entity.index >= slotOfEntity.size()) return INVALID_SLOT;
+    uint32_t slot = slotOfEntity[entity.index];
+    if (slot == INVALID_SLOT || nodeEntities[slot] != entity) return INVALID_SLOT;
+    return slot;
+}
+
+bool SceneGraph::contains(Entity entity) const {
+    return slotOf(entity) != INVALID_SLOT;
+}
+
+Entity SceneGraph::getParent(Entity entity) const {
+    uint32_t slot = slotOf(entity);
+    return slot == INVALID_SLOT ? Entity::null() : parentEntities[slot];
+}
+
+void SceneGraph::adjustAncestorSizes(int32_t slot, int32_t delta) {
+    while (slot >= 0) {
+        subtreeSizes[slot] = static_cast<uint32_t>(static_cast<int32_t>(subtreeSizes[slot]) + delta);
+        slot = parentSlots[slot];
+    }
+}
+
+void SceneGraph::rebuildIndices() {
+    std::fill(slotOfEntity.begin(), slotOfEntity.end(), INVALID_SLOT);
+    for (uint32_t slot = 0; slot < nodeEntities.size(); ++slot) {
+        slotOfEntity[nodeEntities[slot].index] = slot;
+    }
+    for (uint32_t slot = 0; slot < nodeEntities.size(); ++slot) {
+        uint32_t parent = slotOf(parentEntities[slot]);
+        parentSlots[slot] = parent == INVALID_SLOT ? -1 : static_cast<int32_t>(parent);
+        depths[slot] = parent == INVALID_SLOT ? 0 : depths[parent] + 1; // Parents precede children
+    }
+}
+
+void SceneGraph::insertBlock(uint32_t pos, int32_t parentSlot, const std::vector<Entity>& entities,
+                             const std::vector<Entity>& parents, const std::vector<uint32_t>& sizes,
+                             const std::vector<Mat4>& locals, const std::vector<uint8_t>& dirty) {
+    const bool append = (pos == nodeEntities.size());
+    const size_t count = entities.size();
+
+    nodeEntities.insert(nodeEntities.begin() + pos, entities.begin(), entities.end());
+    parentEntities.insert(parentEntities.begin() + pos, parents.begin(), parents.end());
+    subtreeSizes.insert(subtreeSizes.begin() + pos, sizes.begin(), sizes.end());
+    localMatrices.insert(localMatrices.begin() + pos, locals.begin(), locals.end());
+    worldMatrices.insert(worldMatrices.begin() + pos, locals.begin(), locals.end());
+    dirtyFlags.insert(dirtyFlags.begin() + pos, dirty.begin(), dirty.end());
+    parentSlots.insert(parentSlots.begin() + pos, count, -1);
+    depths.insert(depths.begin() + pos, count, 0);
+
+    for (const Entity& e : entities) {
+        if (e.index >= slotOfEntity.size()) slotOfEntity.resize(e.index + 1, INVALID_SLOT);
+    }
+
+    // The parent precedes 'pos', so its slot (and its ancestors' slots) are unaffected by the insert.
+    adjustAncestorSizes(parentSlot, static_cast<int32_t>(count));
+
+    if (!append) {
+        rebuildIndices();
+        return;
+    }
+    // Fast path: nothing after 'pos' moved, so only the new nodes need their lookups filled in.
+    for (uint32_t slot = pos; slot < nodeEntities.size(); ++slot) {
+        slotOfEntity[nodeEntities[slot].index] = slot;
+        uint32_t parent = slotOf(parentEntities[slot]);
+        parentSlots[slot] = parent == INVALID_SLOT ? -1 : static_cast<int32_t>(parent);
+        depths[slot] = parent == INVALID_SLOT ? 0 : depths[parent] + 1;
+    }
+}
+
+void SceneGraph::addNode(Entity entity, Entity parent) {
+    if (contains(entity)) return;
+    int32_t parentSlot = -1;
+    if (!parent.isNull()) {
+        uint32_t p = slotOf(parent);
+        if (p == INVALID_SLOT) {
+            std::cerr << "ERROR::SCENEGRAPH::ADD_NODE: Parent entity is not in the graph; adding as root." << std::endl;
+            parent = Entity::null();
+        } else {
+            parentSlot = static_cast<int32_t>(p);
+        }
+    }
+    uint32_t pos = parentSlot < 0 ? static_cast<uint32_t>(nodeEntities.size())
+                                  : static_cast<uint32_t>(parentSlot) + subtreeSizes[parentSlot];
+    insertBlock(pos, parentSlot, { entity }, { parent }, { 1u }, { Mat4::identity() }, { 1 });
+    dirtyEntities.push_back(entity.index);
+}
+
+void SceneGraph::removeNode(Entity entity) {
+    uint32_t slot = slotOf(entity);
+    if (slot == INVALID_SLOT) return;
+    uint32_t count = subtreeSizes[slot];
+    uint32_t end = slot + count;
+    const bool atEnd = (end == nodeEntities.size());
+
+    adjustAncestorSizes(parentSlots[slot], -static_cast<int32_t>(count));
+    for (uint32_t i = slot; i < end; ++i) slotOfEntity[nodeEntities[i].index] = INVALID_SLOT;
+
+    nodeEntities.erase(nodeEntities.begin() + slot, nodeEntities.begin() + end);
+    parentEntities.erase(parentEntities.begin() + slot, parentEntities.begin() + end);
+    parentSlots.erase(parentSlots.begin() + slot, parentSlots.begin() + end);
+    subtreeSizes.erase(subtreeSizes.begin() + slot, subtreeSizes.begin() + end);
+    depths.erase(depths.begin() + slot, depths.begin() + end);
+    localMatrices.erase(localMatrices.begin() + slot, localMatrices.begin() + end);
+    worldMatrices.erase(worldMatrices.begin() + slot, worldMatrices.begin() + end);
+    dirtyFlags.erase(dirtyFlags.begin() + slot, dirtyFlags.begin() + end);
+
+    if (!atEnd) rebuildIndices();
+}
+
+bool SceneGraph::setParent(Entity entity, Entity newParent) {
+    uint32_t slot = slotOf(entity);
+    if (slot == INVALID_SLOT) return false;
+    if (parentEntities[slot] == newParent) return true;
+
+    uint32_t count = subtreeSizes[slot];
+    if (!newParent.isNull()) {
+        uint32_t p = slotOf(newParent);
+        if (p == INVALID_SLOT) return false;
+        if (p >= slot && p < slot + count) return false; // New parent is inside the subtree being moved
+    }
+
+    // Copy the subtree out, remove it, then re-insert it under the new parent.
+    std::vector<Entity> entities(nodeEntities.begin() + slot, nodeEntities.begin() + slot + count);
+    std::vector<Entity> parents(parentEntities.begin() + slot, parentEntities.begin() + slot + count);
+    std::vector<uint32_t> sizes(subtreeSizes.begin() + slot, subtreeSizes.begin() + slot + count);
+    std::vector<Mat4> locals(localMatrices.begin() + slot, localMatrices.begin() + slot + count);
+    std::vector<uint8_t> dirty(dirtyFlags.begin() + slot, dirtyFlags.begin() + slot + count);
+    parents[0] = newParent;
+
+    removeNode(entity);
+
+    int32_t parentSlot = newParent.isNull() ? -1 : static_cast<int32_t>(slotOf(newParent));
+    uint32_t pos = parentSlot < 0 ? static_cast<uint32_t>(nodeEntities.size())
+                                  : static_cast<uint32_t>(parentSlot) + subtreeSizes[parentSlot];
+    insertBlock(pos, parentSlot, entities, parents, sizes, locals, dirty);
+
+    // The subtree's world matrices now depend on a different parent.
+    uint32_t newSlot = slotOf(entity);
+    if (!dirtyFlags[newSlot]) dirtyFlags[newSlot] = 1;
+    dirtyEntities.push_back(entity.index);
+    return true;
+}
+
+void SceneGraph::markDirty(Entity entity) {
+    uint32_t slot = slotOf(entity);
+    if (slot == INVALID_SLOT || dirtyFlags[slot]) return;
+    dirtyFlags[slot] = 1;
+    dirtyEntities.push_back(entity.index);
+}
+
+void SceneGraph::markAllDirty() {
+    for (uint32_t slot = 0; slot < nodeEntities.size(); ++slot) {
+        if (!dirtyFlags[slot]) {
+            dirtyFlags[slot] = 1;
+            dirtyEntities.push_back(nodeEntities[slot].index);
+        }
+    }
+}
+
+size_t SceneGraph::update(World& world) {
+    if (dirtyEntities.empty()) return 0;
+
+    // Translate dirty entities to their current slots and process them in depth-first order,
+    // so an ancestor's pass clears the flags of any dirty descendants before we reach them.
+    std::vector<uint32_t> dirtySlots;
+    dirtySlots.reserve(dirtyEntities.size());
+    for (uint32_t index : dirtyEntities) {
+        if (index < slotOfEntity.size() && slotOfEntity[index] != INVALID_SLOT) {
+            dirtySlots.push_back(slotOfEntity[index]);
+        }
+    }
+    dirtyEntities.clear();
+    std::sort(dirtySlots.begin(), dirtySlots.end());
+
+    size_t recomputed = 0;
+    for (uint32_t root : dirtySlots) {
+        if (!dirtyFlags[root]) continue; // Already handled as part of an ancestor's subtree
+        const uint32_t end = root + subtreeSizes[root];
+        for (uint32_t slot = root; slot < end; ++slot) {
+            if (dirtyFlags[slot]) {
+                const Transform* t = world.get<Transform>(nodeEntities[slot]);
+                localMatrices[slot] = t ? t->getLocalMatrix() : Mat4::identity();
+                dirtyFlags[slot] = 0;
+            }
+            int32_t parent = parentSlots[slot];
+            worldMatrices[slot] = parent < 0 ? localMatrices[slot] : worldMatrices[parent] * localMatrices[slot];
+        }
+        recomputed += end - root;
+    }
+    return recomputed;
+}
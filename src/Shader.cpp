@@ -7,119 +7,264 @@
 #include <fstream>               // For std::ifstream (file input stream)
 #include <sstream>               // For std::stringstream (string stream for reading file buffer)
 #include <iostream>              // For std::cerr (error output)
+#include <algorithm>             // For std::sort, std::lower_bound
+#include "MyFirstEngine/ShaderCache.h"
+#include "MyFirstEngine/GLExtensions.h" // For program binaries and KHR_parallel_shader_compile
 
-// Constructor: Reads shader source files, compiles and links them.
-Shader::Shader(const char* vertexPath, const char* fragmentPath) : ID(0) {
+// GLSL requires #version to come first, so defines go on the lines right after it. A #line
+// directive keeps compiler messages pointing at the lines of the original file.
+static std::string insertDefines(const std::string& source, const std::string& defines) {
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) return source + "\n" + defines;
+    const long nextLine = static_cast<long>(std::count(source.begin(), source.begin() + lineEnd, '\n')) + 2;
+    return source.substr(0, lineEnd + 1) + defines + "#line " + std::to_string(nextLine) + "\n" +
+           source.substr(lineEnd + 1);
+}
+
+// Constructor: Reads shader source files and starts building the program.
+Shader::Shader(const char* vertexPath, const char* fragmentPath, ShaderCache* cache)
+    : ID(0), status(Status::Failed), vertexShader(0), fragmentShader(0), cache(cache), cacheKey(0),
+      fromCache(false), label(std::string(vertexPath) + " / " + fragmentPath) {
     // 1. Retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
     std::string fragmentCode;
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+    if (!loadSource(vertexPath, vertexCode) || !loadSource(fragmentPath, fragmentCode)) {
+        // ID remains 0 if shader loading fails, indicating an error.
+        return;
+    }
+    start(vertexCode, fragmentCode, std::string());
+}
 
+Shader::Shader(const std::string& vertexSource, const std::string& fragmentSource, const std::string& defines,
+               const std::string& label, ShaderCache* cache)
+    : ID(0), status(Status::Failed), vertexShader(0), fragmentShader(0), cache(cache), cacheKey(0),
+      fromCache(false), label(label) {
+    if (defines.empty()) {
+        start(vertexSource, fragmentSource, defines);
+    } else {
+        start(insertDefines(vertexSource, defines), insertDefines(fragmentSource, defines), defines);
+    }
+}
+
+bool Shader::loadSource(const char* path, std::string& source) {
+    std::ifstream file;
     // Ensure ifstream objects can throw exceptions on failure (badbit) or logical error (failbit)
-    vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
     try {
-        // Open files
-        vShaderFile.open(vertexPath);
-        fShaderFile.open(fragmentPath);
-        std::stringstream vShaderStream, fShaderStream;
-        // Read file's buffer contents into streams
-        vShaderStream << vShaderFile.rdbuf();
-        fShaderStream << fShaderFile.rdbuf();
-        // Close file handlers
-        vShaderFile.close();
-        fShaderFile.close();
-        // Convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        file.open(path, std::ios::binary);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        source = stream.str();
     }
     catch (std::ifstream::failure& e) {
         std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        std::cerr << "Vertex Path: " << vertexPath << "; Fragment Path: " << fragmentPath << std::endl;
-        // ID remains 0 if shader loading fails, indicating an error.
-        return;
+        std::cerr << "Path: " << path << std::endl;
+        return false;
     }
+    return true;
+}
+
+void Shader::start(const std::string& vertexCode, const std::string& fragmentCode, const std::string& defines) {
+    // A cached binary skips compiling entirely; it is already linked, so only the reflection is
+    // left for finalize().
+    if (cache && cache->isEnabled()) {
+        cacheKey = cache->makeKey(vertexCode, fragmentCode, defines);
+        ID = cache->loadProgram(cacheKey);
+        if (ID != 0) {
+            fromCache = true;
+            status = Status::Pending;
+            return;
+        }
+    }
+    // Otherwise compile and link, leaving the result for finalize().
+    startCompile(vertexCode, fragmentCode);
+}
+
+void Shader::startCompile(const std::string& vertexCode, const std::string& fragmentCode) {
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
 
-    // 2. Compile shaders
-    unsigned int vertexShader, fragmentShader;
-
-    // Vertex Shader
+    // No status queries in between: each one would make the driver finish the work right here.
     vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vShaderCode, NULL);
     glCompileShader(vertexShader);
-    checkCompileErrors(vertexShader, "VERTEX"); // Check for compilation errors
-
-    // Fragment Shader
     fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(fragmentShader, 1, &fShaderCode, NULL);
     glCompileShader(fragmentShader);
-    checkCompileErrors(fragmentShader, "FRAGMENT"); // Check for compilation errors
 
-    // Shader Program: Link the compiled shaders
-    ID = glCreateProgram(); // Create a shader program and get its ID
-    glAttachShader(ID, vertexShader);   // Attach the vertex shader
-    glAttachShader(ID, fragmentShader); // Attach the fragment shader
-    glLinkProgram(ID);                 // Link the program
-    checkCompileErrors(ID, "PROGRAM"); // Check for linking errors
+    ID = glCreateProgram();
+    glAttachShader(ID, vertexShader);
+    glAttachShader(ID, fragmentShader);
+    if (cache && cache->isEnabled()) {
+        // Asks the driver to keep the binary around for ShaderCache::storeProgram().
+        GLExtensions::programParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(ID);
+    status = Status::Pending;
+}
 
-    // Delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    // If ID is still 0 after all this (e.g., due to linking error),
-    // it indicates a problem. checkCompileErrors will print details.
+bool Shader::isCompileComplete() const {
+    if (status != Status::Pending || fromCache || !GLExtensions::hasParallelShaderCompile) return true;
+    GLint complete = 0;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
 }
 
-// Destructor: Cleans up the shader program
-Shader::~Shader() {
-    if (ID != 0) { // Only delete if a program was successfully created and linked
+bool Shader::finalize() {
+    if (status != Status::Pending) return status == Status::Ready;
+
+    // This is the first status query, so it blocks until the driver is done with the program.
+    GLint linked = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        std::cerr << "ERROR::SHADER::FINALIZE: Failed to build " << label << std::endl;
+        if (vertexShader != 0) checkCompileErrors(vertexShader, "VERTEX");
+        if (fragmentShader != 0) checkCompileErrors(fragmentShader, "FRAGMENT");
+        checkCompileErrors(ID, "PROGRAM");
+    }
+
+    // Delete the shaders as they're linked into our program now and no longer necessary
+    if (vertexShader != 0) {
+        glDetachShader(ID, vertexShader);
+        glDeleteShader(vertexShader);
+        vertexShader = 0;
+    }
+    if (fragmentShader != 0) {
+        glDetachShader(ID, fragmentShader);
+        glDeleteShader(fragmentShader);
+        fragmentShader = 0;
+    }
+
+    // A program that failed to link is useless; report it as ID 0 (checkCompileErrors printed the log).
+    if (!linked) {
         glDeleteProgram(ID);
+        ID = 0;
+        status = Status::Failed;
+        return false;
     }
+    reflect();
+    if (cache && !fromCache) cache->storeProgram(cacheKey, ID);
+    status = Status::Ready;
+    return true;
 }
 
-// Activates the shader program
-void Shader::use() {
-    if (ID != 0) { // Only use if the program ID is valid
+// Reads every active uniform and uniform block of the linked program into lookup tables.
+void Shader::reflect() {
+    GLint uniformCount = 0, maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<GLchar> nameBuffer(static_cast<size_t>(std::max(maxNameLength, 1)));
+
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GLuint index = static_cast<GLuint>(i);
+        // Members of uniform blocks have no location; they are written through the block's buffer.
+        GLint blockIndex = -1;
+        glGetActiveUniformsiv(ID, 1, &index, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+        if (blockIndex != -1) continue;
+
+        GLsizei length = 0;
+        UniformInfo info;
+        glGetActiveUniform(ID, index, static_cast<GLsizei>(nameBuffer.size()), &length, &info.size, &info.type, nameBuffer.data());
+        info.name.assign(nameBuffer.data(), static_cast<size_t>(length));
+        info.location = glGetUniformLocation(ID, info.name.c_str());
+        if (info.location < 0) continue; // Built-ins (gl_*) have no location
+        info.nameHash = hashUniformName(info.name.c_str());
+        uniforms.push_back(info);
+
+        // Arrays are reported as "name[0]"; also register the bare name.
+        if (length > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0) {
+            UniformInfo bare = info;
+            bare.name = info.name.substr(0, info.name.size() - 3);
+            bare.nameHash = hashUniformName(bare.name.c_str());
+            uniforms.push_back(bare);
+        }
+    }
+    std::sort(uniforms.begin(), uniforms.end(),
+              [](const UniformInfo& a, const UniformInfo& b) { return a.nameHash < b.nameHash; });
+    for (size_t i = 1; i < uniforms.size(); ++i) {
+        if (uniforms[i].nameHash == uniforms[i - 1].nameHash) {
+            std::cerr << "ERROR::SHADER::REFLECT: Uniform names '" << uniforms[i - 1].name << "' and '"
+                      << uniforms[i].name << "' have the same hash; rename one of them." << std::endl;
+        }
+    }
+
+    GLint blockCount = 0, maxBlockNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+    nameBuffer.resize(static_cast<size_t>(std::max(maxBlockNameLength, 1)));
+    for (GLint i = 0; i < blockCount; ++i) {
+        GLsizei length = 0;
+        UniformBlockInfo block;
+        block.index = static_cast<GLuint>(i);
+        glGetActiveUniformBlockName(ID, block.index, static_cast<GLsizei>(nameBuffer.size()), &length, nameBuffer.data());
+        glGetActiveUniformBlockiv(ID, block.index, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+        block.name.assign(nameBuffer.data(), static_cast<size_t>(length));
+        block.nameHash = hashUniformName(block.name.c_str());
+        uniformBlocks.push_back(block);
+
+        // GLSL 3.30 has no layout(binding = N), so shared blocks are bound here instead.
+        if (block.nameHash == hashUniformName("Camera")) {
+            glUniformBlockBinding(ID, block.index, CAMERA_UNIFORM_BINDING);
+        } else if (block.nameHash == hashUniformName("Lights")) {
+            glUniformBlockBinding(ID, block.index, LIGHTS_UNIFORM_BINDING);
+        } else if (block.nameHash == hashUniformName("Shadows")) {
+            glUniformBlockBinding(ID, block.index, SHADOWS_UNIFORM_BINDING);
+        }
+    }
+
+    // Likewise no layout(binding = N) for samplers: shared ones get their units once, here.
+    const UniformHandle lightData = getUniform("lightData");
+    const UniformHandle lightClusters = getUniform("lightClusters");
+    const UniformHandle lightIndices = getUniform("lightIndices");
+    const UniformHandle albedoTexture = getUniform("albedoTexture");
+    const UniformHandle shadowMap = getUniform("shadowMap");
+    if (lightData.isValid() || lightClusters.isValid() || lightIndices.isValid() || albedoTexture.isValid() || shadowMap.isValid()) {
+        GLint previousProgram = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
         glUseProgram(ID);
-    } else {
-        // Optionally, log an error if trying to use an invalid shader program
-        // std::cerr << "ERROR::SHADER::USE_FAILED Program ID is 0. Shader might not have compiled/linked correctly." << std::endl;
+        setInt(lightData, LIGHT_DATA_TEXTURE_UNIT);
+        setInt(lightClusters, LIGHT_CLUSTERS_TEXTURE_UNIT);
+        setInt(lightIndices, LIGHT_INDICES_TEXTURE_UNIT);
+        setInt(albedoTexture, ALBEDO_TEXTURE_UNIT);
+        setInt(shadowMap, SHADOW_MAP_TEXTURE_UNIT);
+        glUseProgram(static_cast<GLuint>(previousProgram));
     }
 }
 
-// Utility uniform functions
-void Shader::setBool(const std::string &name, bool value) const {
-    if (ID != 0) glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-}
-void Shader::setInt(const std::string &name, int value) const {
-    if (ID != 0) glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+UniformHandle Shader::getUniform(uint32_t nameHash) const {
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), nameHash,
+                               [](const UniformInfo& info, uint32_t hash) { return info.nameHash < hash; });
+    UniformHandle handle;
+    if (it != uniforms.end() && it->nameHash == nameHash) handle.location = it->location;
+    return handle;
 }
-void Shader::setFloat(const std::string &name, float value) const {
-    if (ID != 0) glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+
+bool Shader::hasUniformBlock(const char* name) const {
+    const uint32_t hash = hashUniformName(name);
+    for (const UniformBlockInfo& block : uniformBlocks) {
+        if (block.nameHash == hash) return true;
+    }
+    return false;
 }
 
-// Sets a 4x4 matrix uniform in the shader program
-void Shader::setMat4(const std::string &name, const float* matValue) const {
-    if (ID != 0) {
-        // glGetUniformLocation gets the location of the uniform variable 'name' in the shader program 'ID'.
-        // glUniformMatrix4fv sets the value of the 4x4 float matrix uniform.
-        // 1: number of matrices to modify (we are modifying 1 matrix).
-        // GL_FALSE: specifies whether the matrix should be transposed.
-        //           Our Mat4 class stores data in column-major order, which OpenGL expects, so no transpose is needed.
-        // matValue: a pointer to the first element of the 16-float array representing the matrix.
-        GLint loc = glGetUniformLocation(ID, name.c_str());
-        if (loc != -1) { // Check if uniform was actually found
-             glUniformMatrix4fv(loc, 1, GL_FALSE, matValue);
-        } else {
-            // This can be a common source of bugs if uniform names don't match
-            // or if the uniform is optimized out by the shader compiler because it's not used.
-            // std::cerr << "Warning: Uniform '" << name << "' not found in shader program ID " << ID << std::endl;
-        }
+// Destructor: Cleans up the shader program
+Shader::~Shader() {
+    if (vertexShader != 0) glDeleteShader(vertexShader); // Never finalized
+    if (fragmentShader != 0) glDeleteShader(fragmentShader);
+    if (ID != 0) { // Only delete if a program was successfully created and linked
+        glDeleteProgram(ID);
     }
 }
 
+// Activates the shader program
+bool Shader::use() {
+    if (!finalize()) return false; // Logged once by finalize()
+    glUseProgram(ID);
+    return true;
+}
+
 // Utility function for checking shader compilation and linking errors.
 void Shader::checkCompileErrors(GLuint shaderOrProgramID, std::string type) {
     GLint success;
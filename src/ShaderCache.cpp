@@ -0,0 +1,143 @@
+// ShaderCache.cpp
+// Program binary files: key hashing, loading with glProgramBinary and saving with glGetProgramBinary.
+
+#include "MyFirstEngine/ShaderCache.h"
+#include "MyFirstEngine/GLExtensions.h"
+#include "glad/glad.h"
+#include <cstdio>     // For std::FILE, std::snprintf, std::rename
+#include <filesystem> // For std::filesystem::create_directories
+#include <iostream>   // For std::cerr (error output)
+#include <vector>
+
+// 64-bit FNV-1a, continued from 'hash'.
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Hashes a string with its length, so "ab" + "c" and "a" + "bc" give different keys.
+static uint64_t hashString(uint64_t hash, const std::string& text) {
+    const uint64_t length = text.size();
+    hash = hashBytes(hash, &length, sizeof(length));
+    return hashBytes(hash, text.data(), text.size());
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+ShaderCache::ShaderCache() : enabled(false), hits(0), misses(0), stores(0) {}
+
+bool ShaderCache::init(const std::string& cacheDirectory) {
+    enabled = false;
+    directory = cacheDirectory;
+    driverString = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    if (directory.empty() || !GLExtensions::hasProgramBinary) return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "ERROR::SHADER_CACHE::INIT: Cannot create '" << directory << "': " << error.message() << std::endl;
+        return false;
+    }
+    enabled = true;
+    return true;
+}
+
+uint64_t ShaderCache::makeKey(const std::string& vertexSource, const std::string& fragmentSource,
+                              const std::string& defines) const {
+    uint64_t hash = 14695981039346656037ull;
+    const uint32_t version = FORMAT_VERSION;
+    hash = hashBytes(hash, &version, sizeof(version));
+    hash = hashString(hash, driverString);
+    hash = hashString(hash, defines);
+    hash = hashString(hash, vertexSource);
+    return hashString(hash, fragmentSource);
+}
+
+std::string ShaderCache::pathFor(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
+
+unsigned int ShaderCache::loadProgram(uint64_t key) {
+    if (!enabled) return 0;
+    std::FILE* file = std::fopen(pathFor(key).c_str(), "rb");
+    if (!file) {
+        ++misses;
+        return 0;
+    }
+    FileHeader header;
+    std::vector<char> blob;
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == FILE_MAGIC &&
+                 header.version == FORMAT_VERSION && header.key == key && header.length > 0;
+    if (valid) {
+        blob.resize(header.length);
+        valid = std::fread(blob.data(), 1, blob.size(), file) == blob.size();
+    }
+    std::fclose(file);
+    if (!valid) {
+        ++misses;
+        return 0;
+    }
+
+    // A binary from the same driver strings normally loads; GL still reports rejection through
+    // the link status (and may raise GL_INVALID_ENUM for an unknown format, which we drain).
+    GLuint program = glCreateProgram();
+    GLExtensions::programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    GLExtensions::programBinary(program, header.binaryFormat, blob.data(), static_cast<GLsizei>(blob.size()));
+    while (glGetError() != GL_NO_ERROR) {}
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        glDeleteProgram(program);
+        ++misses;
+        return 0;
+    }
+    ++hits;
+    return program;
+}
+
+bool ShaderCache::storeProgram(uint64_t key, unsigned int program) {
+    if (!enabled || program == 0) return false;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    std::vector<char> blob(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    GLExtensions::getProgramBinary(program, length, &written, &format, blob.data());
+    if (written <= 0) return false;
+
+    FileHeader header;
+    header.magic = FILE_MAGIC;
+    header.version = FORMAT_VERSION;
+    header.binaryFormat = format;
+    header.length = static_cast<uint32_t>(written);
+    header.key = key;
+
+    const std::string path = pathFor(key);
+    const std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "ERROR::SHADER_CACHE::STORE: Cannot write '" << temporaryPath << "'." << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              std::fwrite(blob.data(), 1, header.length, file) == header.length;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        std::cerr << "ERROR::SHADER_CACHE::STORE: Failed to write '" << path << "'." << std::endl;
+        return false;
+    }
+    ++stores;
+    return true;
+}
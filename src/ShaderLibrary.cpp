@@ -0,0 +1,164 @@
+// ShaderLibrary.cpp
+// Feature parsing, variant lookup and manifest prewarming.
+
+#include "MyFirstEngine/ShaderLibrary.h"
+#include "MyFirstEngine/Shader.h"
+#include "MyFirstEngine/Profiler.h" // For PROFILE_SCOPE
+#include <algorithm>                // For std::find
+#include <fstream>                  // For std::ifstream (manifest)
+#include <iostream>                 // For std::cerr (error output)
+#include <sstream>                  // For std::istringstream
+
+ShaderLibrary::ShaderLibrary() : cache(nullptr) {}
+
+ShaderLibrary::~ShaderLibrary() {
+    for (Variant& variant : variants) delete variant.shader;
+}
+
+int ShaderLibrary::findShader(const std::string& name) const {
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void ShaderLibrary::parseFeatures(const std::string& code, std::vector<std::string>& features) {
+    std::istringstream lines(code);
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream tokens(line);
+        std::string directive, pragma, feature;
+        tokens >> directive;
+        if (directive == "#") { // "# pragma" is valid GLSL too
+            tokens >> directive;
+            directive = "#" + directive;
+        }
+        if (directive != "#pragma" || !(tokens >> pragma) || pragma != "feature" || !(tokens >> feature)) continue;
+        if (std::find(features.begin(), features.end(), feature) == features.end()) features.push_back(feature);
+    }
+}
+
+bool ShaderLibrary::addShader(const std::string& name, const char* vertexPath, const char* fragmentPath) {
+    if (findShader(name) >= 0) {
+        std::cerr << "ERROR::SHADER_LIBRARY::ADD_SHADER: '" << name << "' was already added." << std::endl;
+        return false;
+    }
+    Source source;
+    source.name = name;
+    source.vertexPath = vertexPath;
+    source.fragmentPath = fragmentPath;
+    if (!Shader::loadSource(vertexPath, source.vertexCode) || !Shader::loadSource(fragmentPath, source.fragmentCode)) {
+        return false;
+    }
+    parseFeatures(source.vertexCode, source.features);
+    parseFeatures(source.fragmentCode, source.features);
+    if (source.features.size() > MAX_FEATURES) {
+        std::cerr << "ERROR::SHADER_LIBRARY::ADD_SHADER: '" << name << "' declares " << source.features.size()
+                  << " features; only the first " << MAX_FEATURES << " can be used." << std::endl;
+        source.features.resize(MAX_FEATURES);
+    }
+    sources.push_back(std::move(source));
+    return true;
+}
+
+uint32_t ShaderLibrary::getFeatureBit(const std::string& name, const std::string& feature) const {
+    const int index = findShader(name);
+    if (index >= 0) {
+        const std::vector<std::string>& features = sources[static_cast<size_t>(index)].features;
+        for (size_t i = 0; i < features.size(); ++i) {
+            if (features[i] == feature) return 1u << i;
+        }
+    }
+    std::cerr << "ERROR::SHADER_LIBRARY::GET_FEATURE_BIT: '" << name << "' has no feature '" << feature << "'." << std::endl;
+    return 0;
+}
+
+uint32_t ShaderLibrary::getAllFeatures(const std::string& name) const {
+    const int index = findShader(name);
+    if (index < 0) return 0;
+    const size_t count = sources[static_cast<size_t>(index)].features.size();
+    return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1u;
+}
+
+const std::vector<std::string>& ShaderLibrary::getFeatures(const std::string& name) const {
+    static const std::vector<std::string> none;
+    const int index = findShader(name);
+    return index >= 0 ? sources[static_cast<size_t>(index)].features : none;
+}
+
+uint32_t ShaderLibrary::getVariantIndex(const std::string& name, uint32_t featureMask) {
+    const int sourceIndex = findShader(name);
+    if (sourceIndex < 0) {
+        std::cerr << "ERROR::SHADER_LIBRARY::GET: No shader named '" << name << "'." << std::endl;
+        return INVALID_VARIANT;
+    }
+    featureMask &= getAllFeatures(name);
+    const uint64_t lookupKey = (static_cast<uint64_t>(sourceIndex) << 32) | featureMask;
+    auto it = variantLookup.find(lookupKey);
+    if (it != variantLookup.end()) return it->second;
+
+    // First request: build the defines and start the compile.
+    const Source& source = sources[static_cast<size_t>(sourceIndex)];
+    std::string defines;
+    std::string label = name;
+    for (size_t i = 0; i < source.features.size(); ++i) {
+        if (!(featureMask & (1u << i))) continue;
+        defines += "#define " + source.features[i] + " 1\n";
+        label += (label.size() == name.size() ? " [" : " ") + source.features[i];
+    }
+    if (label.size() != name.size()) label += "]";
+    label += " (" + source.vertexPath + " / " + source.fragmentPath + ")";
+
+    Shader* shader = new Shader(source.vertexCode, source.fragmentCode, defines, label, cache);
+    if (shader->ID == 0) {
+        delete shader;
+        return INVALID_VARIANT;
+    }
+    Variant variant;
+    variant.source = static_cast<uint32_t>(sourceIndex);
+    variant.featureMask = featureMask;
+    variant.shader = shader;
+    variants.push_back(variant);
+    const uint32_t index = static_cast<uint32_t>(variants.size() - 1);
+    variantLookup.emplace(lookupKey, index);
+    return index;
+}
+
+int ShaderLibrary::prewarm(const char* manifestPath) {
+    PROFILE_SCOPE("Shader Prewarm");
+    std::ifstream manifest(manifestPath);
+    if (!manifest) return -1;
+    int count = 0;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream tokens(line);
+        std::string name, feature;
+        if (!(tokens >> name)) continue;
+        if (!hasShader(name)) {
+            std::cerr << "ERROR::SHADER_LIBRARY::PREWARM: " << manifestPath << " lists unknown shader '" << name << "'." << std::endl;
+            continue;
+        }
+        uint32_t mask = 0;
+        while (tokens >> feature) mask |= getFeatureBit(name, feature);
+        getVariantIndex(name, mask);
+        ++count;
+    }
+    return count;
+}
+
+size_t ShaderLibrary::finishCompiles() {
+    PROFILE_SCOPE("Finish Shader Compiles");
+    // Programs the driver has already finished go first, so waiting on a slow one does not hold
+    // back the rest; then whatever is left is waited for in order. finalize() is a no-op for
+    // variants that are already done and returns their status.
+    for (Variant& variant : variants) {
+        if (variant.shader->isCompileComplete()) variant.shader->finalize();
+    }
+    size_t failed = 0;
+    for (Variant& variant : variants) {
+        if (!variant.shader->finalize()) ++failed;
+    }
+    return failed;
+}
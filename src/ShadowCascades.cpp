@@ -0,0 +1,136 @@
+// ShadowCascades.cpp
+// Cascade split placement, stable sphere fitting with texel snapping, and static cache tracking.
+
+#include "MyFirstEngine/ShadowCascades.h"
+#include "MyFirstEngine/Camera.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::floor, std::pow, std::sqrt
+
+ShadowCascades::ShadowCascades() : lightDirection(0.0f, -1.0f, 0.0f) {
+    for (uint32_t i = 0; i < MAX_CASCADES; ++i) {
+        cascades[i] = ShadowCascade{ 0.0f, 0.0f, BoundingSphere(), Mat4::identity(), Mat4::identity(), Frustum(), 0.0f, false };
+        staticDirty[i] = true;
+        fitted[i] = false;
+    }
+    lightRotation = computeLightRotation();
+}
+
+void ShadowCascades::setSettings(const ShadowSettings& newSettings) {
+    settings = newSettings;
+    settings.cascadeCount = std::min(std::max(settings.cascadeCount, 1u), MAX_CASCADES);
+    settings.resolution = std::max(settings.resolution, 16u);
+    settings.splitLambda = std::min(std::max(settings.splitLambda, 0.0f), 1.0f);
+    settings.cachePadding = std::max(settings.cachePadding, 0.0f);
+    invalidateAll();
+}
+
+void ShadowCascades::setLightDirection(const Vec3& direction) {
+    Vec3 normalized = Vec3(direction).normalize();
+    if (normalized.length() == 0.0f) return;
+    if (normalized.x == lightDirection.x && normalized.y == lightDirection.y && normalized.z == lightDirection.z) return;
+    lightDirection = normalized;
+    lightRotation = computeLightRotation();
+    invalidateAll();
+}
+
+Mat4 ShadowCascades::computeLightRotation() const {
+    // Any up vector not parallel to the light works; the map's orientation is arbitrary.
+    const Vec3 up = std::abs(lightDirection.y) > 0.99f ? Vec3(1.0f, 0.0f, 0.0f) : Vec3(0.0f, 1.0f, 0.0f);
+    return Mat4::lookAt(Vec3(0.0f, 0.0f, 0.0f), lightDirection, up);
+}
+
+void ShadowCascades::invalidateAll() {
+    for (uint32_t i = 0; i < MAX_CASCADES; ++i) {
+        staticDirty[i] = true;
+        fitted[i] = false;
+    }
+}
+
+void ShadowCascades::invalidateStatic(const AABB& bounds) {
+    for (uint32_t i = 0; i < settings.cascadeCount; ++i) {
+        if (cascades[i].cached && fitted[i] && cascades[i].casterFrustum.intersectsAABB(bounds)) staticDirty[i] = true;
+    }
+}
+
+void ShadowCascades::fitCascade(ShadowCascade& cascade, const Vec3& center, float radius) const {
+    // Snap the center to whole texels across the light direction, so every refit samples the
+    // scene at the same positions. Depth needs no snapping.
+    const float texelSize = 2.0f * radius / static_cast<float>(settings.resolution);
+    Vec3 lightCenter = Mat4::transformPoint(lightRotation, center);
+    lightCenter.x = std::floor(lightCenter.x / texelSize + 0.5f) * texelSize;
+    lightCenter.y = std::floor(lightCenter.y / texelSize + 0.5f) * texelSize;
+
+    // The light looks down -z: the sphere spans view depths -(z + r) to -(z - r).
+    const Mat4 projection = Mat4::orthographic(lightCenter.x - radius, lightCenter.x + radius, lightCenter.y - radius,
+                                               lightCenter.y + radius, -(lightCenter.z + radius), -(lightCenter.z - radius));
+    cascade.view = lightRotation;
+    cascade.viewProjection = projection * lightRotation;
+    cascade.bounds = BoundingSphere(Mat4::transformPoint(lightRotation.inverse(), lightCenter), radius);
+    cascade.texelSize = texelSize;
+    // Casters between the light and the box still cast into it: drop the near plane.
+    cascade.casterFrustum = Frustum::fromMatrix(cascade.viewProjection);
+    cascade.casterFrustum.planes[Frustum::Near] = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void ShadowCascades::update(Camera& camera, float aspectRatio) {
+    update(camera.getViewMatrix(), camera.getProjectionMatrix(aspectRatio));
+}
+
+void ShadowCascades::update(const Mat4& view, const Mat4& projection) {
+    // Near/far from P[10] = -(f+n)/(f-n), P[14] = -2fn/(f-n); P[0] and P[5] are the cotangents
+    // of the half field of view, so the frustum's corners at depth z are z * k off its axis.
+    const float* p = projection.elements;
+    float nearPlane = p[14] / (p[10] - 1.0f);
+    float farPlane = p[14] / (p[10] + 1.0f);
+    if (!(nearPlane > 0.0f) || !(farPlane > nearPlane)) {
+        nearPlane = 0.1f;
+        farPlane = 1000.0f;
+    }
+    farPlane = std::min(farPlane, std::max(settings.maxDistance, nearPlane * 2.0f));
+    const float kSquared = 1.0f / (p[0] * p[0]) + 1.0f / (p[5] * p[5]);
+
+    // The view matrix is rigid (R | t): the eye is -R^T * t and the camera looks down -R row 2.
+    const float* v = view.elements;
+    const Vec3 eye(-(v[0] * v[12] + v[1] * v[13] + v[2] * v[14]), -(v[4] * v[12] + v[5] * v[13] + v[6] * v[14]),
+                   -(v[8] * v[12] + v[9] * v[13] + v[10] * v[14]));
+    const Vec3 forward(-v[2], -v[6], -v[10]);
+
+    const uint32_t count = settings.cascadeCount;
+    float sliceNear = nearPlane;
+    for (uint32_t i = 0; i < count; ++i) {
+        // Practical split scheme: the logarithmic split keeps texels per pixel constant, the
+        // uniform one keeps distant cascades from getting too thin.
+        const float t = static_cast<float>(i + 1) / static_cast<float>(count);
+        const float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+        const float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+        const float sliceFar = i + 1 == count ? farPlane : settings.splitLambda * logSplit + (1.0f - settings.splitLambda) * uniformSplit;
+
+        // Smallest sphere around the slice: its center on the view axis at depth c, equidistant
+        // from the near and far corners, (c - n)^2 + n^2 k^2 = (f - c)^2 + f^2 k^2, unless the far
+        // corners alone bound it. Depends on the projection only, so the size never changes as
+        // the camera turns.
+        const float depth = std::min(0.5f * (sliceFar + sliceNear) * (1.0f + kSquared), sliceFar);
+        const float radius = std::sqrt((sliceFar - depth) * (sliceFar - depth) + sliceFar * sliceFar * kSquared);
+        const Vec3 center = eye + forward * depth;
+
+        ShadowCascade& cascade = cascades[i];
+        cascade.nearDepth = sliceNear;
+        cascade.farDepth = sliceFar;
+        cascade.cached = i >= settings.firstCachedCascade;
+        if (!cascade.cached) {
+            fitCascade(cascade, center, radius);
+        } else {
+            // Keep the cover while it still contains the slice's sphere and is not much too big
+            // (after a projection change); otherwise refit around the slice with padding.
+            const float coverRadius = radius * (1.0f + settings.cachePadding);
+            const bool contained = (center - cascade.bounds.center).length() + radius <= cascade.bounds.radius;
+            const bool oversized = cascade.bounds.radius > coverRadius * (1.0f + settings.cachePadding);
+            if (!fitted[i] || !contained || oversized) {
+                fitCascade(cascade, center, coverRadius);
+                fitted[i] = true;
+                staticDirty[i] = true;
+            }
+        }
+        sliceNear = sliceFar;
+    }
+}
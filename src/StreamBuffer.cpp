@@ -0,0 +1,157 @@
+// StreamBuffer.cpp
+// Implementation of the fence-synchronized streaming ring buffer.
+
+#include "MyFirstEngine/StreamBuffer.h"
+#include "MyFirstEngine/GLExtensions.h"
+#include "glad/glad.h" // For OpenGL functions
+#include <algorithm>   // For std::max
+#include <iostream>    // For std::cerr (error output)
+
+// Uploads go through the copy-write binding point so they never disturb the array buffer or
+// the element buffer (which is VAO state) that draw code has bound.
+static const GLenum STREAM_TARGET = GL_COPY_WRITE_BUFFER;
+
+StreamBuffer::StreamBuffer()
+    : buffer(0), persistent(false), mappedData(nullptr), bytesPerFrame(0),
+      frameIndex(0), frameOffset(0), stallCount(0) {
+    for (void*& fence : fences) fence = nullptr;
+}
+
+StreamBuffer::~StreamBuffer() {
+    destroyBuffer();
+    deleteRetiredBuffers();
+}
+
+bool StreamBuffer::init(size_t frameBytes) {
+    persistent = GLExtensions::hasBufferStorage;
+    return createBuffer(frameBytes);
+}
+
+bool StreamBuffer::createBuffer(size_t frameBytes) {
+    bytesPerFrame = frameBytes;
+    const GLsizeiptr totalBytes = static_cast<GLsizeiptr>(bytesPerFrame * FRAME_COUNT);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(STREAM_TARGET, buffer);
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLExtensions::bufferStorage(STREAM_TARGET, totalBytes, nullptr, flags);
+        mappedData = static_cast<char*>(glMapBufferRange(STREAM_TARGET, 0, totalBytes, flags));
+        if (!mappedData) {
+            // Some drivers expose the extension but refuse large persistent mappings.
+            std::cerr << "ERROR::STREAM_BUFFER::CREATE: Persistent mapping failed; using unsynchronized mapping." << std::endl;
+            glBindBuffer(STREAM_TARGET, 0);
+            glDeleteBuffers(1, &buffer);
+            persistent = false;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(STREAM_TARGET, buffer);
+        }
+    }
+    if (!persistent) {
+        glBufferData(STREAM_TARGET, totalBytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(STREAM_TARGET, 0);
+    frameOffset = 0;
+    return buffer != 0;
+}
+
+void StreamBuffer::retireBuffer() {
+    for (void*& fence : fences) {
+        if (fence) glDeleteSync(static_cast<GLsync>(fence));
+        fence = nullptr;
+    }
+    if (buffer != 0) {
+        if (mappedData) {
+            glBindBuffer(STREAM_TARGET, buffer);
+            glUnmapBuffer(STREAM_TARGET);
+            glBindBuffer(STREAM_TARGET, 0);
+            mappedData = nullptr;
+        }
+        retiredBuffers.push_back(buffer);
+        buffer = 0;
+    }
+}
+
+void StreamBuffer::destroyBuffer() {
+    retireBuffer();
+    deleteRetiredBuffers();
+}
+
+void StreamBuffer::deleteRetiredBuffers() {
+    // The driver keeps the storage alive until queued commands that read it have finished.
+    if (!retiredBuffers.empty()) glDeleteBuffers(static_cast<GLsizei>(retiredBuffers.size()), retiredBuffers.data());
+    retiredBuffers.clear();
+}
+
+void StreamBuffer::waitFence(void*& fence) {
+    if (!fence) return;
+    GLsync sync = static_cast<GLsync>(fence);
+    GLenum result = glClientWaitSync(sync, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        ++stallCount;
+        // Flush on the first wait so the fence is guaranteed to reach the GPU.
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do {
+            result = glClientWaitSync(sync, flags, 1000000000ull); // 1 s per attempt
+            flags = 0;
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "ERROR::STREAM_BUFFER::WAIT_FENCE: glClientWaitSync failed." << std::endl;
+    }
+    glDeleteSync(sync);
+    fence = nullptr;
+}
+
+void StreamBuffer::beginFrame() {
+    // Buffers replaced last frame: the caller rebinds its per-frame ranges from the new one.
+    deleteRetiredBuffers();
+    if (buffer == 0) return;
+    if (fences[frameIndex]) glDeleteSync(static_cast<GLsync>(fences[frameIndex]));
+    fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameIndex = (frameIndex + 1) % FRAME_COUNT;
+    waitFence(fences[frameIndex]);
+    frameOffset = 0;
+}
+
+StreamAllocation StreamBuffer::allocate(size_t size, size_t alignment) {
+    StreamAllocation allocation = { nullptr, 0, 0, 0 };
+    if (buffer == 0 || size == 0) return allocation;
+    alignment = std::max<size_t>(1, alignment);
+
+    size_t offset = (frameOffset + alignment - 1) & ~(alignment - 1);
+    if (offset + size > bytesPerFrame) {
+        // Region full: replace the buffer with a larger one. Its regions are all unused, so no
+        // fences are needed. The old buffer is only retired, not deleted: ranges bound from it
+        // earlier in this frame (the Renderer's uniform blocks) must stay bound.
+        const size_t newBytes = std::max(bytesPerFrame * 2, size + alignment);
+        retireBuffer();
+        if (!createBuffer(newBytes)) return allocation;
+        offset = 0;
+    }
+    frameOffset = offset + size;
+
+    const size_t bufferOffset = static_cast<size_t>(frameIndex) * bytesPerFrame + offset;
+    allocation.buffer = buffer;
+    allocation.offset = bufferOffset;
+    allocation.size = size;
+    if (persistent) {
+        allocation.data = mappedData + bufferOffset;
+    } else {
+        // Unsynchronized is safe: this region's fence was waited on in beginFrame().
+        glBindBuffer(STREAM_TARGET, buffer);
+        allocation.data = glMapBufferRange(STREAM_TARGET, static_cast<GLintptr>(bufferOffset), static_cast<GLsizeiptr>(size),
+                                           GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        glBindBuffer(STREAM_TARGET, 0);
+        if (!allocation.data) {
+            std::cerr << "ERROR::STREAM_BUFFER::ALLOCATE: glMapBufferRange failed." << std::endl;
+        }
+    }
+    return allocation;
+}
+
+void StreamBuffer::commit(const StreamAllocation& allocation) {
+    if (persistent || !allocation.data) return;
+    glBindBuffer(STREAM_TARGET, allocation.buffer);
+    glUnmapBuffer(STREAM_TARGET);
+    glBindBuffer(STREAM_TARGET, 0);
+}
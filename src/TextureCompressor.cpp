@@ -0,0 +1,572 @@
+// TextureCompressor.cpp
+// BC1/BC3/BC5/BC7 block encoders and decoders.
+
+#include "MyFirstEngine/TextureCompressor.h"
+#include "MyFirstEngine/ThreadPool.h"
+#include "SimpleMath.h" // For the SIMPLEMATH_SSE backend selection
+#include <algorithm>    // For std::min, std::max, std::swap
+#include <cmath>        // For std::sqrt, std::lround
+#include <cstring>      // For std::memcpy
+#include <limits>       // For std::numeric_limits
+
+// Block texels as floats, channel-major: channel c of texel i at values[c * 16 + i].
+struct BlockTexels {
+    alignas(16) float values[4 * 16];
+};
+
+// --- Nearest palette entry ---
+
+// For each of the 16 texels, the index of the closest of 'entries' palette colors (squared
+// distance over the first 'channels' channels; palette[e * 4 + c]). Returns the summed error.
+static float findNearest(const BlockTexels& texels, uint32_t channels, const float* palette, uint32_t entries, uint8_t* indices) {
+#if defined(SIMPLEMATH_SSE)
+    __m128 total = _mm_setzero_ps();
+    for (uint32_t group = 0; group < 16; group += 4) {
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128i bestIndex = _mm_setzero_si128();
+        for (uint32_t e = 0; e < entries; ++e) {
+            __m128 distance = _mm_setzero_ps();
+            for (uint32_t c = 0; c < channels; ++c) {
+                const __m128 d = _mm_sub_ps(_mm_load_ps(&texels.values[c * 16 + group]), _mm_set1_ps(palette[e * 4 + c]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+            }
+            const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+            best = _mm_min_ps(distance, best);
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(e))), _mm_andnot_si128(closer, bestIndex));
+        }
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), bestIndex);
+        for (uint32_t i = 0; i < 4; ++i) indices[group + i] = static_cast<uint8_t>(lanes[i]);
+        total = _mm_add_ps(total, best);
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+    float total = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        float best = std::numeric_limits<float>::max();
+        for (uint32_t e = 0; e < entries; ++e) {
+            float distance = 0.0f;
+            for (uint32_t c = 0; c < channels; ++c) {
+                const float d = texels.values[c * 16 + i] - palette[e * 4 + c];
+                distance += d * d;
+            }
+            if (distance < best) {
+                best = distance;
+                indices[i] = static_cast<uint8_t>(e);
+            }
+        }
+        total += best;
+    }
+    return total;
+#endif
+}
+
+// --- Shared helpers ---
+
+static void loadTexels(const uint8_t* texels, uint32_t channels, uint32_t firstChannel, BlockTexels& out) {
+    for (uint32_t c = 0; c < channels; ++c) {
+        for (uint32_t i = 0; i < 16; ++i) out.values[c * 16 + i] = texels[i * 4 + firstChannel + c];
+    }
+}
+
+// Principal axis of the texels (power iteration on the covariance) and their mean. Returns
+// false if the block is a single color (the axis is then zero).
+static bool principalAxis(const BlockTexels& texels, uint32_t channels, float* mean, float* axis) {
+    for (uint32_t c = 0; c < channels; ++c) {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < 16; ++i) sum += texels.values[c * 16 + i];
+        mean[c] = sum / 16.0f;
+    }
+    float covariance[4][4] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        float d[4];
+        for (uint32_t c = 0; c < channels; ++c) d[c] = texels.values[c * 16 + i] - mean[c];
+        for (uint32_t a = 0; a < channels; ++a) {
+            for (uint32_t b = a; b < channels; ++b) covariance[a][b] += d[a] * d[b];
+        }
+    }
+    for (uint32_t a = 0; a < channels; ++a) {
+        for (uint32_t b = 0; b < a; ++b) covariance[a][b] = covariance[b][a];
+    }
+    // Start from the channel with the largest spread; eight iterations are plenty for 16 points.
+    uint32_t widest = 0;
+    for (uint32_t c = 1; c < channels; ++c) {
+        if (covariance[c][c] > covariance[widest][widest]) widest = c;
+    }
+    if (covariance[widest][widest] < 1e-4f) {
+        for (uint32_t c = 0; c < channels; ++c) axis[c] = 0.0f;
+        return false;
+    }
+    for (uint32_t c = 0; c < channels; ++c) axis[c] = covariance[widest][c];
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (uint32_t a = 0; a < channels; ++a) {
+            for (uint32_t b = 0; b < channels; ++b) next[a] += covariance[a][b] * axis[b];
+            length += next[a] * next[a];
+        }
+        length = std::sqrt(length);
+        if (length < 1e-12f) break;
+        for (uint32_t c = 0; c < channels; ++c) axis[c] = next[c] / length;
+    }
+    return true;
+}
+
+// Endpoints at the extreme projections of the texels on 'axis', pulled in by 'inset' of the
+// range (the extremes are rarely hit exactly once quantized).
+static void axisEndpoints(const BlockTexels& texels, uint32_t channels, const float* mean, const float* axis,
+                          float inset, float* high, float* low) {
+    float minT = std::numeric_limits<float>::max(), maxT = -std::numeric_limits<float>::max();
+    for (uint32_t i = 0; i < 16; ++i) {
+        float t = 0.0f;
+        for (uint32_t c = 0; c < channels; ++c) t += (texels.values[c * 16 + i] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    const float shrink = (maxT - minT) * inset;
+    for (uint32_t c = 0; c < channels; ++c) {
+        high[c] = mean[c] + axis[c] * (maxT - shrink);
+        low[c] = mean[c] + axis[c] * (minT + shrink);
+    }
+}
+
+// Least-squares endpoints for fixed indices, where texel i is (1 - w) * a + w * b with
+// w = weights[indices[i]]. Returns false if the system is singular (all texels on one entry).
+static bool refitEndpoints(const BlockTexels& texels, uint32_t channels, const uint8_t* indices, const float* weights,
+                           float* a, float* b) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for (uint32_t i = 0; i < 16; ++i) {
+        const float w = weights[indices[i]];
+        const float v = 1.0f - w;
+        aa += v * v;
+        ab += v * w;
+        bb += w * w;
+        for (uint32_t c = 0; c < channels; ++c) {
+            ax[c] += v * texels.values[c * 16 + i];
+            bx[c] += w * texels.values[c * 16 + i];
+        }
+    }
+    const float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) return false;
+    const float inverse = 1.0f / determinant;
+    for (uint32_t c = 0; c < channels; ++c) {
+        a[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) * inverse, 0.0f), 255.0f);
+        b[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) * inverse, 0.0f), 255.0f);
+    }
+    return true;
+}
+
+// Little-endian bit packing for BC4 indices and BC7 blocks.
+static void writeBits(uint8_t* block, uint32_t& position, uint32_t value, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i, ++position) {
+        if (value & (1u << i)) block[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+    }
+}
+
+static uint32_t readBits(const uint8_t* block, uint32_t& position, uint32_t count) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; ++i, ++position) {
+        value |= static_cast<uint32_t>((block[position >> 3] >> (position & 7)) & 1u) << i;
+    }
+    return value;
+}
+
+// --- BC1 ---
+
+static uint16_t packColor565(const float* color) {
+    const long r = std::lround(color[0] * 31.0f / 255.0f);
+    const long g = std::lround(color[1] * 63.0f / 255.0f);
+    const long b = std::lround(color[2] * 31.0f / 255.0f);
+    return static_cast<uint16_t>((std::min(std::max(r, 0L), 31L) << 11) | (std::min(std::max(g, 0L), 63L) << 5) |
+                                 std::min(std::max(b, 0L), 31L));
+}
+
+static void unpackColor565(uint16_t color, int* rgb) {
+    const int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Four-color palette as decoders build it: color0, color1, 2/3 and 1/3 of the way to color0.
+static void paletteBC1(uint16_t color0, uint16_t color1, bool fourColor, int palette[4][3]) {
+    unpackColor565(color0, palette[0]);
+    unpackColor565(color1, palette[1]);
+    for (int c = 0; c < 3; ++c) {
+        if (fourColor) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+// Indices and error for quantized endpoints (color0 > color1, or equal for a flat block).
+static float evaluateBC1(const BlockTexels& texels, uint16_t color0, uint16_t color1, uint8_t* indices) {
+    if (color0 == color1) {
+        std::fill(indices, indices + 16, 0);
+        return std::numeric_limits<float>::max() / 2.0f; // Caller only uses this for flat blocks
+    }
+    int palette[4][3];
+    paletteBC1(color0, color1, true, palette);
+    float entries[4 * 4];
+    for (int e = 0; e < 4; ++e) {
+        for (int c = 0; c < 3; ++c) entries[e * 4 + c] = static_cast<float>(palette[e][c]);
+    }
+    return findNearest(texels, 3, entries, 4, indices);
+}
+
+static void encodeBC1(const uint8_t* texels, uint8_t* block) {
+    BlockTexels values;
+    loadTexels(texels, 3, 0, values);
+    float mean[4], axis[4], high[4], low[4];
+    uint16_t color0, color1;
+    uint8_t indices[16];
+    if (!principalAxis(values, 3, mean, axis)) {
+        color0 = color1 = packColor565(mean);
+        std::fill(indices, indices + 16, 0);
+    } else {
+        axisEndpoints(values, 3, mean, axis, 1.0f / 16.0f, high, low);
+        color0 = packColor565(high);
+        color1 = packColor565(low);
+        if (color0 < color1) std::swap(color0, color1);
+        float error = evaluateBC1(values, color0, color1, indices);
+        // One refit: palette order is color0, color1, 2/3 color0, 1/3 color0.
+        static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        if (color0 != color1 && refitEndpoints(values, 3, indices, weights, high, low)) {
+            uint16_t refit0 = packColor565(high), refit1 = packColor565(low);
+            if (refit0 < refit1) std::swap(refit0, refit1);
+            uint8_t refitIndices[16];
+            if (refit0 != refit1) {
+                const float refitError = evaluateBC1(values, refit0, refit1, refitIndices);
+                if (refitError < error) {
+                    color0 = refit0;
+                    color1 = refit1;
+                    std::memcpy(indices, refitIndices, sizeof(indices));
+                    error = refitError;
+                }
+            }
+        }
+        if (color0 == color1) std::fill(indices, indices + 16, 0);
+    }
+    uint32_t packed = 0;
+    for (uint32_t i = 0; i < 16; ++i) packed |= static_cast<uint32_t>(indices[i]) << (i * 2);
+    block[0] = static_cast<uint8_t>(color0);
+    block[1] = static_cast<uint8_t>(color0 >> 8);
+    block[2] = static_cast<uint8_t>(color1);
+    block[3] = static_cast<uint8_t>(color1 >> 8);
+    std::memcpy(block + 4, &packed, 4);
+}
+
+// 'alwaysFourColor' for the color half of BC3, which has no three-color mode.
+static void decodeBC1(const uint8_t* block, bool alwaysFourColor, uint8_t* texels) {
+    const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    int palette[4][3];
+    paletteBC1(color0, color1, alwaysFourColor || color0 > color1, palette);
+    uint32_t packed;
+    std::memcpy(&packed, block + 4, 4);
+    for (uint32_t i = 0; i < 16; ++i) {
+        const int* color = palette[(packed >> (i * 2)) & 3];
+        for (int c = 0; c < 3; ++c) texels[i * 4 + c] = static_cast<uint8_t>(color[c]);
+        texels[i * 4 + 3] = 255;
+    }
+}
+
+// --- BC4 (one channel; BC3 alpha and both BC5 channels) ---
+
+static void paletteBC4(int value0, int value1, int* palette) {
+    palette[0] = value0;
+    palette[1] = value1;
+    if (value0 > value1) {
+        for (int i = 2; i < 8; ++i) palette[i] = ((8 - i) * value0 + (i - 1) * value1) / 7;
+    } else {
+        for (int i = 2; i < 6; ++i) palette[i] = ((6 - i) * value0 + (i - 1) * value1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static void encodeBC4(const uint8_t* texels, uint32_t channel, uint8_t* block) {
+    BlockTexels values;
+    loadTexels(texels, 1, channel, values);
+    float low = 255.0f, high = 0.0f;
+    for (uint32_t i = 0; i < 16; ++i) {
+        low = std::min(low, values.values[i]);
+        high = std::max(high, values.values[i]);
+    }
+    const int value0 = static_cast<int>(high), value1 = static_cast<int>(low);
+    uint8_t indices[16] = {};
+    if (value0 > value1) {
+        int palette[8];
+        paletteBC4(value0, value1, palette);
+        float entries[8 * 4];
+        for (int e = 0; e < 8; ++e) entries[e * 4] = static_cast<float>(palette[e]);
+        findNearest(values, 1, entries, 8, indices);
+    }
+    std::memset(block, 0, 8);
+    block[0] = static_cast<uint8_t>(value0);
+    block[1] = static_cast<uint8_t>(value1);
+    uint32_t position = 16;
+    for (uint32_t i = 0; i < 16; ++i) writeBits(block, position, indices[i], 3);
+}
+
+static void decodeBC4(const uint8_t* block, uint32_t channel, uint8_t* texels) {
+    int palette[8];
+    paletteBC4(block[0], block[1], palette);
+    uint32_t position = 16;
+    for (uint32_t i = 0; i < 16; ++i) texels[i * 4 + channel] = static_cast<uint8_t>(palette[readBits(block, position, 3)]);
+}
+
+// --- BC7 mode 6 ---
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// 7-bit endpoint with the p-bit that brings it closest to 'color' (all four channels share it).
+static void quantizeBC7(const float* color, uint32_t* quantized, uint32_t& pBit) {
+    float bestError = std::numeric_limits<float>::max();
+    for (uint32_t p = 0; p < 2; ++p) {
+        uint32_t candidate[4];
+        float error = 0.0f;
+        for (uint32_t c = 0; c < 4; ++c) {
+            const long q = std::lround((color[c] - static_cast<float>(p)) / 2.0f);
+            candidate[c] = static_cast<uint32_t>(std::min(std::max(q, 0L), 127L));
+            const float d = static_cast<float>(candidate[c] * 2 + p) - color[c];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pBit = p;
+            std::memcpy(quantized, candidate, sizeof(candidate));
+        }
+    }
+}
+
+static void paletteBC7(const uint32_t* endpoint0, uint32_t p0, const uint32_t* endpoint1, uint32_t p1, int palette[16][4]) {
+    for (int c = 0; c < 4; ++c) {
+        const int e0 = static_cast<int>(endpoint0[c] * 2 + p0), e1 = static_cast<int>(endpoint1[c] * 2 + p1);
+        for (int i = 0; i < 16; ++i) palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6;
+    }
+}
+
+static float evaluateBC7(const BlockTexels& texels, const float* color0, const float* color1, uint32_t* endpoint0, uint32_t& p0,
+                         uint32_t* endpoint1, uint32_t& p1, uint8_t* indices) {
+    quantizeBC7(color0, endpoint0, p0);
+    quantizeBC7(color1, endpoint1, p1);
+    int palette[16][4];
+    paletteBC7(endpoint0, p0, endpoint1, p1, palette);
+    float entries[16 * 4];
+    for (int e = 0; e < 16; ++e) {
+        for (int c = 0; c < 4; ++c) entries[e * 4 + c] = static_cast<float>(palette[e][c]);
+    }
+    return findNearest(texels, 4, entries, 16, indices);
+}
+
+static void encodeBC7(const uint8_t* texels, uint8_t* block) {
+    BlockTexels values;
+    loadTexels(texels, 4, 0, values);
+    float mean[4], axis[4], color0[4], color1[4];
+    principalAxis(values, 4, mean, axis); // A flat block gets color0 == color1 == mean
+    axisEndpoints(values, 4, mean, axis, 0.0f, color0, color1);
+
+    uint32_t endpoint0[4], endpoint1[4], p0 = 0, p1 = 0;
+    uint8_t indices[16];
+    const float error = evaluateBC7(values, color0, color1, endpoint0, p0, endpoint1, p1, indices);
+    float weights[16];
+    for (int i = 0; i < 16; ++i) weights[i] = BC7_WEIGHTS[i] / 64.0f;
+    if (refitEndpoints(values, 4, indices, weights, color0, color1)) {
+        uint32_t refit0[4], refit1[4], refitP0 = 0, refitP1 = 0;
+        uint8_t refitIndices[16];
+        if (evaluateBC7(values, color0, color1, refit0, refitP0, refit1, refitP1, refitIndices) < error) {
+            std::memcpy(endpoint0, refit0, sizeof(endpoint0));
+            std::memcpy(endpoint1, refit1, sizeof(endpoint1));
+            p0 = refitP0;
+            p1 = refitP1;
+            std::memcpy(indices, refitIndices, sizeof(indices));
+        }
+    }
+    // The first index is stored without its top bit: swap the endpoints if it is set.
+    if (indices[0] & 8) {
+        std::swap(endpoint0, endpoint1);
+        std::swap(p0, p1);
+        for (uint8_t& index : indices) index = static_cast<uint8_t>(15 - index);
+    }
+
+    std::memset(block, 0, 16);
+    uint32_t position = 0;
+    writeBits(block, position, 1u << 6, 7); // Mode 6
+    for (uint32_t c = 0; c < 4; ++c) {
+        writeBits(block, position, endpoint0[c], 7);
+        writeBits(block, position, endpoint1[c], 7);
+    }
+    writeBits(block, position, p0, 1);
+    writeBits(block, position, p1, 1);
+    for (uint32_t i = 0; i < 16; ++i) writeBits(block, position, indices[i], i == 0 ? 3 : 4);
+}
+
+static bool decodeBC7(const uint8_t* block, uint8_t* texels) {
+    if ((block[0] & 0x7F) != (1u << 6)) { // Any mode but 6
+        for (uint32_t i = 0; i < 16; ++i) {
+            texels[i * 4 + 0] = 255;
+            texels[i * 4 + 1] = 0;
+            texels[i * 4 + 2] = 255;
+            texels[i * 4 + 3] = 255;
+        }
+        return false;
+    }
+    uint32_t position = 7;
+    uint32_t endpoint0[4], endpoint1[4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoint0[c] = readBits(block, position, 7);
+        endpoint1[c] = readBits(block, position, 7);
+    }
+    const uint32_t p0 = readBits(block, position, 1);
+    const uint32_t p1 = readBits(block, position, 1);
+    int palette[16][4];
+    paletteBC7(endpoint0, p0, endpoint1, p1, palette);
+    for (uint32_t i = 0; i < 16; ++i) {
+        const int* color = palette[readBits(block, position, i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c) texels[i * 4 + c] = static_cast<uint8_t>(color[c]);
+    }
+    return true;
+}
+
+// --- Public interface ---
+
+void TextureCompressor::encodeBlock(ImageFormat format, const uint8_t* texels, uint8_t* block) {
+    switch (format) {
+    case ImageFormat::RGBA8: // A "block" is one texel
+        std::memcpy(block, texels, 4);
+        break;
+    case ImageFormat::BC1:
+        encodeBC1(texels, block);
+        break;
+    case ImageFormat::BC3:
+        encodeBC4(texels, 3, block);
+        encodeBC1(texels, block + 8);
+        break;
+    case ImageFormat::BC5:
+        encodeBC4(texels, 0, block);
+        encodeBC4(texels, 1, block + 8);
+        break;
+    case ImageFormat::BC7:
+        encodeBC7(texels, block);
+        break;
+    }
+}
+
+bool TextureCompressor::decodeBlock(ImageFormat format, const uint8_t* block, uint8_t* texels) {
+    switch (format) {
+    case ImageFormat::RGBA8:
+        std::memcpy(texels, block, 4);
+        return true;
+    case ImageFormat::BC1:
+        decodeBC1(block, false, texels);
+        return true;
+    case ImageFormat::BC3:
+        decodeBC1(block + 8, true, texels);
+        decodeBC4(block, 3, texels);
+        return true;
+    case ImageFormat::BC5:
+        for (uint32_t i = 0; i < 16; ++i) {
+            texels[i * 4 + 2] = 0;
+            texels[i * 4 + 3] = 255;
+        }
+        decodeBC4(block, 0, texels);
+        decodeBC4(block + 8, 1, texels);
+        return true;
+    case ImageFormat::BC7:
+        return decodeBC7(block, texels);
+    }
+    return false;
+}
+
+bool TextureCompressor::compress(const Image& source, ImageFormat format, Image& out, ThreadPool* pool) {
+    if (source.format != ImageFormat::RGBA8) return false;
+    if (format == ImageFormat::RGBA8) {
+        out = source;
+        return true;
+    }
+    out.format = format;
+    out.levels.resize(source.levels.size());
+    const size_t blockBytes = Image::getBlockBytes(format);
+    for (uint32_t levelIndex = 0; levelIndex < source.getLevelCount(); ++levelIndex) {
+        const ImageLevel& level = source.levels[levelIndex];
+        ImageLevel& target = out.levels[levelIndex];
+        target.width = level.width;
+        target.height = level.height;
+        const uint32_t blocksWide = (level.width + 3) / 4, blocksHigh = (level.height + 3) / 4;
+        target.pixels.resize(static_cast<size_t>(blocksWide) * blocksHigh * blockBytes);
+
+        auto encodeRows = [&](size_t begin, size_t end, size_t) {
+            uint8_t texels[16 * 4];
+            for (size_t by = begin; by < end; ++by) {
+                for (uint32_t bx = 0; bx < blocksWide; ++bx) {
+                    // Gather the block, repeating the last row/column past the edge.
+                    for (uint32_t i = 0; i < 16; ++i) {
+                        const uint32_t x = std::min(bx * 4 + (i & 3), level.width - 1);
+                        const uint32_t y = std::min(static_cast<uint32_t>(by) * 4 + (i >> 2), level.height - 1);
+                        std::memcpy(&texels[i * 4], &level.pixels[(static_cast<size_t>(y) * level.width + x) * 4], 4);
+                    }
+                    encodeBlock(format, texels, &target.pixels[(by * blocksWide + bx) * blockBytes]);
+                }
+            }
+        };
+        if (pool) {
+            pool->parallelFor(blocksHigh, 4, encodeRows);
+        } else {
+            encodeRows(0, blocksHigh, 0);
+        }
+    }
+    return true;
+}
+
+bool TextureCompressor::decompress(const Image& source, Image& out, ThreadPool* pool) {
+    if (!source.isCompressed()) {
+        out = source;
+        return true;
+    }
+    Image decoded;
+    decoded.format = ImageFormat::RGBA8;
+    decoded.levels.resize(source.levels.size());
+    const size_t blockBytes = Image::getBlockBytes(source.format);
+    bool ok = true;
+    for (uint32_t levelIndex = 0; levelIndex < source.getLevelCount(); ++levelIndex) {
+        const ImageLevel& level = source.levels[levelIndex];
+        ImageLevel& target = decoded.levels[levelIndex];
+        target.width = level.width;
+        target.height = level.height;
+        target.pixels.resize(static_cast<size_t>(level.width) * level.height * 4);
+        const uint32_t blocksWide = (level.width + 3) / 4, blocksHigh = (level.height + 3) / 4;
+        if (level.pixels.size() < static_cast<size_t>(blocksWide) * blocksHigh * blockBytes) return false;
+
+        std::vector<uint8_t> rowFailed(blocksHigh, 0);
+        auto decodeRows = [&](size_t begin, size_t end, size_t) {
+            uint8_t texels[16 * 4];
+            for (size_t by = begin; by < end; ++by) {
+                for (uint32_t bx = 0; bx < blocksWide; ++bx) {
+                    if (!decodeBlock(source.format, &level.pixels[(by * blocksWide + bx) * blockBytes], texels)) rowFailed[by] = 1;
+                    for (uint32_t i = 0; i < 16; ++i) {
+                        const uint32_t x = bx * 4 + (i & 3), y = static_cast<uint32_t>(by) * 4 + (i >> 2);
+                        if (x < level.width && y < level.height) {
+                            std::memcpy(&target.pixels[(static_cast<size_t>(y) * level.width + x) * 4], &texels[i * 4], 4);
+                        }
+                    }
+                }
+            }
+        };
+        if (pool) {
+            pool->parallelFor(blocksHigh, 4, decodeRows);
+        } else {
+            decodeRows(0, blocksHigh, 0);
+        }
+        for (uint8_t failed : rowFailed) ok = ok && !failed;
+    }
+    out = std::move(decoded);
+    return ok;
+}
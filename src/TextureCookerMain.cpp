@@ -0,0 +1,122 @@
+// TextureCookerMain.cpp
+// Offline texture cooker: source images in, ready-to-upload cooked textures (.setex) out.
+//
+// Each input (PPM/PGM or TGA, see Image.h) gets its full mip chain built on the CPU and every
+// level encoded to the chosen block-compressed format on all cores (TextureCompressor.h). The
+// result is written next to the input (or into --out-dir) with the extension replaced by
+// .setex; TextureStreamer loads those directly, so at runtime there is no decoding, no mip
+// filtering and 4x (BC3/BC5/BC7) to 8x (BC1) less data to read and keep in VRAM than RGBA8.
+// The cooker only links the GL-free core library.
+//
+// Usage:
+//   SimpleEngineTextureCooker [--format=bc7] [--mips=1] [--threads=0] [--out-dir=dir] input...
+//   --format is one of rgba8, bc1 (opaque color), bc3 (color + alpha), bc5 (two-channel normal
+//     maps) or bc7 (color + alpha, best quality).
+//   --threads=0 uses one thread per core.
+// Per file, it prints the sizes, the encode time and the PSNR of level 0 against the source.
+
+#include "MyFirstEngine/Image.h"
+#include "MyFirstEngine/TextureCompressor.h"
+#include "MyFirstEngine/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct CookerOptions {
+    ImageFormat format = ImageFormat::BC7;
+    bool mips = true;
+    int threads = 0;
+    std::string outDir;
+    std::vector<std::string> inputs;
+};
+
+static bool parseOptions(int argc, char** argv, CookerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            options.inputs.push_back(arg);
+            continue;
+        }
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--format" && Image::parseFormat(value, options.format)) continue;
+        else if (key == "--mips") options.mips = std::atoi(value.c_str()) != 0;
+        else if (key == "--threads") options.threads = std::max(0, std::atoi(value.c_str()));
+        else if (key == "--out-dir") options.outDir = value;
+        else {
+            std::cerr << "Usage: SimpleEngineTextureCooker [--format=rgba8|bc1|bc3|bc5|bc7] [--mips=0|1] [--threads=N]"
+                         " [--out-dir=dir] input..." << std::endl;
+            return false;
+        }
+    }
+    if (options.inputs.empty()) {
+        std::cerr << "ERROR::TEXTURE_COOKER: No input files." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// PSNR over the channels the format keeps (RGB for BC1, RG for BC5, RGBA otherwise).
+static double computePSNR(const ImageLevel& source, const ImageLevel& decoded, ImageFormat format) {
+    const uint32_t channels = format == ImageFormat::BC1 ? 3 : (format == ImageFormat::BC5 ? 2 : 4);
+    double squaredError = 0.0;
+    for (size_t i = 0, n = static_cast<size_t>(source.width) * source.height; i < n; ++i) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            const double d = static_cast<double>(source.pixels[i * 4 + c]) - decoded.pixels[i * 4 + c];
+            squaredError += d * d;
+        }
+    }
+    const double mse = squaredError / (static_cast<double>(source.width) * source.height * channels);
+    return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+int main(int argc, char** argv) {
+    CookerOptions options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    ThreadPool pool(options.threads > 0 ? static_cast<size_t>(options.threads - 1) : ThreadPool::defaultWorkerCount());
+    int failures = 0;
+    for (const std::string& input : options.inputs) {
+        std::filesystem::path output(input);
+        output.replace_extension(".setex");
+        if (!options.outDir.empty()) output = std::filesystem::path(options.outDir) / output.filename();
+
+        Image source;
+        if (!source.load(input)) {
+            ++failures;
+            continue;
+        }
+        if (source.isCompressed()) {
+            std::cerr << "ERROR::TEXTURE_COOKER: '" << input << "' is already cooked." << std::endl;
+            ++failures;
+            continue;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        if (options.mips) source.generateMips();
+        Image cooked;
+        TextureCompressor::compress(source, options.format, cooked, &pool);
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        if (!options.outDir.empty()) std::filesystem::create_directories(options.outDir);
+        if (!cooked.saveCooked(output.string())) {
+            ++failures;
+            continue;
+        }
+        Image decoded;
+        TextureCompressor::decompress(cooked, decoded, &pool);
+        std::printf("%s -> %s: %ux%u, %u levels, %s, %.1f KB -> %.1f KB (%.1fx), %.1f ms, PSNR %.2f dB\n", input.c_str(),
+                    output.string().c_str(), cooked.getWidth(), cooked.getHeight(), cooked.getLevelCount(),
+                    Image::getFormatName(options.format), source.getByteSize() / 1024.0, cooked.getByteSize() / 1024.0,
+                    static_cast<double>(source.getByteSize()) / cooked.getByteSize(), milliseconds,
+                    computePSNR(source.levels[0], decoded.levels[0], options.format));
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,389 @@
+// TextureStreamer.cpp
+// Decode threads, residency planning and PBO-staged uploads.
+
+#include "MyFirstEngine/TextureStreamer.h"
+#include "MyFirstEngine/GLExtensions.h"      // For the compressed format flags
+#include "MyFirstEngine/Profiler.h"          // For PROFILE_SCOPE
+#include "MyFirstEngine/TextureCompressor.h" // For the fallback when a format is missing
+#include <algorithm>                // For std::sort, std::min, std::max
+#include <cmath>                    // For std::log2, std::floor
+#include <cstring>                  // For std::memcpy
+#include <iostream>                 // For std::cerr (error output)
+
+// Transitions allocate their GL texture up front, next to the one they replace, so only this
+// many run at once; the rest wait for a later update().
+static const size_t MAX_TRANSITIONS = 8;
+
+// GL internal format of each ImageFormat (linear, like the GL_RGBA8 path).
+static GLenum internalFormat(ImageFormat format) {
+    switch (format) {
+    case ImageFormat::RGBA8: return GL_RGBA8;
+    case ImageFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case ImageFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case ImageFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+    case ImageFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    return GL_RGBA8;
+}
+
+// Whether the context can sample 'format'; GLExtensions is loaded before any decode starts.
+static bool isFormatSupported(ImageFormat format) {
+    switch (format) {
+    case ImageFormat::BC1:
+    case ImageFormat::BC3: return GLExtensions::hasTextureCompressionS3TC;
+    case ImageFormat::BC7: return GLExtensions::hasTextureCompressionBPTC;
+    default: return true;
+    }
+}
+
+TextureStreamer::TextureStreamer()
+    : nextStagingBuffer(0), placeholderTexture(0), frame(1), stopping(false) {}
+
+TextureStreamer::~TextureStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread& thread : decodeThreads) thread.join();
+
+    for (std::unique_ptr<Texture>& texture : textures) {
+        if (texture->glTexture != 0) glDeleteTextures(1, &texture->glTexture);
+        if (texture->pendingTexture != 0) glDeleteTextures(1, &texture->pendingTexture);
+    }
+    for (StagingBuffer& staging : stagingBuffers) {
+        if (staging.fence) glDeleteSync(staging.fence);
+        if (staging.buffer != 0) glDeleteBuffers(1, &staging.buffer);
+    }
+    if (placeholderTexture != 0) glDeleteTextures(1, &placeholderTexture);
+}
+
+bool TextureStreamer::init() {
+    // 1x1 mid-gray, so textured objects stay visible (and lit) before their levels arrive.
+    glGenTextures(1, &placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, placeholderTexture);
+    const uint8_t gray[4] = { 160, 160, 160, 255 };
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (StagingBuffer& staging : stagingBuffers) {
+        glGenBuffers(1, &staging.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(PBO_SIZE), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (glGetError() != GL_NO_ERROR) {
+        std::cerr << "ERROR::TEXTURE_STREAMER::INIT: Failed to create the staging buffers." << std::endl;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < DECODE_THREADS; ++i) decodeThreads.emplace_back(&TextureStreamer::decodeLoop, this);
+    return true;
+}
+
+void TextureStreamer::decodeLoop() {
+    for (;;) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        DecodeResult result;
+        result.texture = job.texture;
+        result.ok = result.image.load(job.path);
+        // Source images get their mip chain here; cooked textures already carry it. A format the
+        // GL cannot sample is expanded to RGBA8, which keeps it working at 4-8x the memory.
+        if (result.ok && result.image.getLevelCount() == 1) result.image.generateMips();
+        if (result.ok && !isFormatSupported(result.image.format)) {
+            std::cerr << "ERROR::TEXTURE_STREAMER::DECODE: " << Image::getFormatName(result.image.format) << " is not supported by"
+                      << " this GL; '" << job.path << "' is decompressed to RGBA8." << std::endl;
+            result.ok = TextureCompressor::decompress(result.image, result.image);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        results.push_back(std::move(result));
+    }
+}
+
+TextureHandle TextureStreamer::load(const std::string& path) {
+    auto it = handlesByPath.find(path);
+    if (it != handlesByPath.end()) return it->second;
+
+    const TextureHandle handle = static_cast<TextureHandle>(textures.size());
+    std::unique_ptr<Texture> texture(new Texture());
+    texture->path = path;
+    textures.push_back(std::move(texture));
+    handlesByPath.emplace(path, handle);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(DecodeJob{ handle, path });
+    }
+    jobAvailable.notify_one();
+    return handle;
+}
+
+void TextureStreamer::request(TextureHandle handle, float screenPixels) {
+    if (handle >= textures.size()) return;
+    Texture& texture = *textures[handle];
+    if (texture.lastRequestFrame != frame) texture.requestedPixels = 0.0f;
+    texture.requestedPixels = std::max(texture.requestedPixels, screenPixels);
+    texture.lastRequestFrame = frame;
+}
+
+GLuint TextureStreamer::getGLTexture(TextureHandle handle) const {
+    if (handle >= textures.size() || textures[handle]->glTexture == 0) return placeholderTexture;
+    return textures[handle]->glTexture;
+}
+
+uint32_t TextureStreamer::getResidentLevel(TextureHandle handle) const {
+    if (handle >= textures.size()) return 0;
+    const Texture& texture = *textures[handle];
+    return texture.glTexture != 0 ? texture.residentLevel : texture.image.getLevelCount();
+}
+
+uint32_t TextureStreamer::getLevelCount(TextureHandle handle) const {
+    return handle < textures.size() ? textures[handle]->image.getLevelCount() : 0;
+}
+
+uint32_t TextureStreamer::wantedLevel(const Texture& texture) const {
+    if (texture.lastRequestFrame != frame || texture.requestedPixels <= 0.0f) return targetLevel(texture);
+    // About one texel per pixel: level = log2(texture size / screen size), rounded to the finer level.
+    const float size = static_cast<float>(std::max(texture.image.getWidth(), texture.image.getHeight()));
+    const float level = std::floor(std::log2(size / std::max(texture.requestedPixels, 1.0f)));
+    if (level <= 0.0f) return 0;
+    return std::min(static_cast<uint32_t>(level), texture.minResidentLevel);
+}
+
+uint32_t TextureStreamer::targetLevel(const Texture& texture) const {
+    if (texture.pendingTexture != 0) return texture.pendingLevel;
+    return texture.glTexture != 0 ? texture.residentLevel : texture.image.getLevelCount();
+}
+
+void TextureStreamer::startTransition(TextureHandle handle, uint32_t firstLevel) {
+    Texture& texture = *textures[handle];
+    const uint32_t levelCount = texture.image.getLevelCount();
+    glGenTextures(1, &texture.pendingTexture);
+    glBindTexture(GL_TEXTURE_2D, texture.pendingTexture);
+    const GLenum format = internalFormat(texture.image.format);
+    for (uint32_t level = firstLevel; level < levelCount; ++level) {
+        const ImageLevel& source = texture.image.levels[level];
+        const GLint target = static_cast<GLint>(level - firstLevel);
+        if (texture.image.isCompressed()) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, target, format, static_cast<GLsizei>(source.width), static_cast<GLsizei>(source.height),
+                                   0, static_cast<GLsizei>(source.pixels.size()), nullptr);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, target, GL_RGBA8, static_cast<GLsizei>(source.width), static_cast<GLsizei>(source.height), 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelCount - 1 - firstLevel));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    stats.committedBytes -= texture.glTexture != 0 ? texture.image.getByteSize(texture.residentLevel) : 0;
+    stats.committedBytes += texture.image.getByteSize(firstLevel);
+    texture.pendingLevel = firstLevel;
+    texture.uploadLevel = levelCount - 1; // Coarsest first
+    texture.uploadRow = 0;
+    transitions.push_back(handle);
+}
+
+bool TextureStreamer::makeRoom(size_t bytes) {
+    if (stats.committedBytes + bytes <= settings.vramBudgetBytes) return true;
+    // Least recently requested first; textures drawn this frame are never evicted for others.
+    std::vector<TextureHandle> candidates;
+    for (TextureHandle handle = 0; handle < textures.size(); ++handle) {
+        const Texture& texture = *textures[handle];
+        if (texture.state == State::Ready && texture.pendingTexture == 0 && texture.glTexture != 0 &&
+            texture.lastRequestFrame != frame && texture.residentLevel < texture.minResidentLevel) {
+            candidates.push_back(handle);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](TextureHandle a, TextureHandle b) {
+        return textures[a]->lastRequestFrame < textures[b]->lastRequestFrame;
+    });
+    for (TextureHandle handle : candidates) {
+        if (stats.committedBytes + bytes <= settings.vramBudgetBytes || transitions.size() >= MAX_TRANSITIONS) break;
+        startTransition(handle, textures[handle]->minResidentLevel);
+        ++stats.evictions;
+    }
+    return stats.committedBytes + bytes <= settings.vramBudgetBytes;
+}
+
+int TextureStreamer::acquireStagingBuffer() {
+    for (uint32_t i = 0; i < PBO_COUNT; ++i) {
+        const uint32_t index = (nextStagingBuffer + i) % PBO_COUNT;
+        StagingBuffer& staging = stagingBuffers[index];
+        if (staging.fence) {
+            GLint status = GL_UNSIGNALED;
+            glGetSynciv(staging.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+            if (status != GL_SIGNALED) continue;
+            glDeleteSync(staging.fence);
+            staging.fence = 0;
+        }
+        nextStagingBuffer = (index + 1) % PBO_COUNT;
+        return static_cast<int>(index);
+    }
+    return -1;
+}
+
+void TextureStreamer::stageUploads() {
+    size_t budget = settings.uploadBytesPerFrame;
+    std::vector<StagedUpload> staged;
+    while (budget > 0 && !transitions.empty()) {
+        const int index = acquireStagingBuffer();
+        if (index < 0) break; // Every PBO is still being read; try again next frame
+        StagingBuffer& staging = stagingBuffers[index];
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.buffer);
+        uint8_t* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(PBO_SIZE),
+                                                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (!mapped) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            break;
+        }
+
+        // Fill the PBO with rows (block rows for compressed formats) of the transitions in order,
+        // coarse levels first.
+        staged.clear();
+        size_t used = 0;
+        std::vector<TextureHandle> completed;
+        for (TextureHandle handle : transitions) {
+            Texture& texture = *textures[handle];
+            while (budget > 0) {
+                const Image& image = texture.image;
+                const uint32_t rowCount = image.getRowCount(texture.uploadLevel);
+                const size_t rowBytes = image.getRowBytes(texture.uploadLevel);
+                const size_t rows = std::min<size_t>({ rowCount - texture.uploadRow, (PBO_SIZE - used) / rowBytes,
+                                                       std::max<size_t>(budget / rowBytes, 1) });
+                if (rows == 0) break; // PBO full
+                const size_t bytes = rows * rowBytes;
+                std::memcpy(mapped + used, &image.levels[texture.uploadLevel].pixels[texture.uploadRow * rowBytes], bytes);
+                staged.push_back(StagedUpload{ texture.pendingTexture, static_cast<GLint>(texture.uploadLevel - texture.pendingLevel),
+                                               image.format, texture.uploadRow, static_cast<uint32_t>(rows),
+                                               image.levels[texture.uploadLevel].width, image.levels[texture.uploadLevel].height,
+                                               used, bytes });
+                used += bytes;
+                budget -= std::min(budget, bytes);
+                texture.uploadRow += static_cast<uint32_t>(rows);
+                if (texture.uploadRow < rowCount) continue;
+                if (texture.uploadLevel == texture.pendingLevel) {
+                    completed.push_back(handle);
+                    break;
+                }
+                --texture.uploadLevel;
+                texture.uploadRow = 0;
+            }
+            if (completed.empty() || completed.back() != handle) break; // PBO full or budget spent
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Offsets are into the bound PBO; the calls return without waiting for the copy.
+        // Compressed rows are 4 texels high; the last block row may cover fewer.
+        for (const StagedUpload& upload : staged) {
+            glBindTexture(GL_TEXTURE_2D, upload.texture);
+            const void* offset = reinterpret_cast<const void*>(upload.offset);
+            if (upload.format == ImageFormat::RGBA8) {
+                glTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, static_cast<GLint>(upload.row), static_cast<GLsizei>(upload.width),
+                                static_cast<GLsizei>(upload.rows), GL_RGBA, GL_UNSIGNED_BYTE, offset);
+            } else {
+                const uint32_t y = upload.row * 4;
+                glCompressedTexSubImage2D(GL_TEXTURE_2D, upload.level, 0, static_cast<GLint>(y), static_cast<GLsizei>(upload.width),
+                                          static_cast<GLsizei>(std::min(upload.rows * 4, upload.height - y)),
+                                          internalFormat(upload.format), static_cast<GLsizei>(upload.bytes), offset);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        staging.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stats.uploadedBytes += used;
+
+        // Fully staged transitions swap in now: later draws are ordered after the uploads.
+        for (TextureHandle handle : completed) {
+            Texture& texture = *textures[handle];
+            if (texture.glTexture != 0) glDeleteTextures(1, &texture.glTexture);
+            texture.glTexture = texture.pendingTexture;
+            texture.residentLevel = texture.pendingLevel;
+            texture.pendingTexture = 0;
+            transitions.erase(std::find(transitions.begin(), transitions.end(), handle));
+        }
+        if (staged.empty()) break;
+    }
+}
+
+void TextureStreamer::update() {
+    PROFILE_SCOPE("Texture Streaming");
+    stats.uploadedBytes = 0;
+
+    // --- 1. Finished decodes ---
+    std::vector<DecodeResult> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.swap(results);
+    }
+    for (DecodeResult& result : finished) {
+        Texture& texture = *textures[result.texture];
+        if (!result.ok) {
+            texture.state = State::Failed;
+            continue;
+        }
+        texture.image = std::move(result.image);
+        texture.state = State::Ready;
+        const uint32_t levelCount = texture.image.getLevelCount();
+        texture.minResidentLevel = levelCount - 1;
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            const ImageLevel& source = texture.image.levels[level];
+            if (std::max(source.width, source.height) <= settings.minResidentSize) {
+                texture.minResidentLevel = level;
+                break;
+            }
+        }
+        texture.residentLevel = levelCount;
+    }
+
+    // --- 2. Residency changes ---
+    // New textures get their coarse levels regardless of the budget (they are tiny); promotions
+    // go biggest request first, evicting others if needed.
+    std::vector<TextureHandle> promotions;
+    for (TextureHandle handle = 0; handle < textures.size(); ++handle) {
+        Texture& texture = *textures[handle];
+        if (texture.state != State::Ready || texture.pendingTexture != 0) continue;
+        if (texture.glTexture == 0) {
+            if (transitions.size() < MAX_TRANSITIONS) startTransition(handle, texture.minResidentLevel);
+        } else if (wantedLevel(texture) < texture.residentLevel) {
+            promotions.push_back(handle);
+        }
+    }
+    std::sort(promotions.begin(), promotions.end(), [this](TextureHandle a, TextureHandle b) {
+        return textures[a]->requestedPixels > textures[b]->requestedPixels;
+    });
+    for (TextureHandle handle : promotions) {
+        if (transitions.size() >= MAX_TRANSITIONS) break;
+        Texture& texture = *textures[handle];
+        const uint32_t level = wantedLevel(texture);
+        const size_t extra = texture.image.getByteSize(level) - texture.image.getByteSize(texture.residentLevel);
+        if (makeRoom(extra) && transitions.size() < MAX_TRANSITIONS) startTransition(handle, level);
+    }
+
+    // --- 3. Uploads ---
+    stageUploads();
+
+    // --- 4. Statistics ---
+    stats.textures = textures.size();
+    stats.decoding = stats.failed = stats.residentBytes = 0;
+    for (const std::unique_ptr<Texture>& texture : textures) {
+        if (texture->state == State::Decoding) ++stats.decoding;
+        if (texture->state == State::Failed) ++stats.failed;
+        if (texture->glTexture != 0) stats.residentBytes += texture->image.getByteSize(texture->residentLevel);
+        if (texture->pendingTexture != 0) stats.residentBytes += texture->image.getByteSize(texture->pendingLevel);
+    }
+    stats.transitions = transitions.size();
+    ++frame;
+}
@@ -0,0 +1,84 @@
+// ThreadPool.cpp
+// Implementation of the persistent worker pool.
+
+#include "MyFirstEngine/ThreadPool.h"
+#include <algorithm> // For std::max, std::min
+
+ThreadPool::ThreadPool(size_t workerCount)
+    : stopping(false), jobGeneration(0), jobFunction(nullptr), jobCount(0), jobBatchSize(1),
+      nextIndex(0), activeWorkers(0) {
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i + 1); // Index 0 is the calling thread
+    }
+}
+
+size_t ThreadPool::defaultWorkerCount() {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 0;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::runBatches(size_t threadIndex) {
+    for (;;) {
+        size_t begin = nextIndex.fetch_add(jobBatchSize, std::memory_order_relaxed);
+        if (begin >= jobCount) break;
+        size_t end = std::min(begin + jobBatchSize, jobCount);
+        (*jobFunction)(begin, end, threadIndex);
+    }
+}
+
+void ThreadPool::workerLoop(size_t threadIndex) {
+    unsigned long long seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeWorkers.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = jobGeneration;
+        }
+        runBatches(threadIndex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --activeWorkers;
+        }
+        jobFinished.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t minBatchSize, const RangeFunction& fn) {
+    if (count == 0) return;
+    minBatchSize = std::max<size_t>(1, minBatchSize);
+    // About four batches per thread keeps everyone busy when batches take uneven time.
+    const size_t threads = getThreadCount();
+    size_t batchSize = std::max(minBatchSize, (count + threads * 4 - 1) / (threads * 4));
+    if (workers.empty() || batchSize >= count) {
+        fn(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFunction = &fn;
+        jobCount = count;
+        jobBatchSize = batchSize;
+        nextIndex.store(0, std::memory_order_relaxed);
+        activeWorkers = workers.size();
+        ++jobGeneration;
+    }
+    wakeWorkers.notify_all();
+
+    runBatches(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [&] { return activeWorkers == 0; });
+    jobFunction = nullptr;
+}
@@ -8,11 +8,24 @@
 #include <GLFW/glfw3.h>
 
 // Engine-specific headers
+#include "MyFirstEngine/ECS.h"
 #include "MyFirstEngine/GameObject.h" 
+#include "MyFirstEngine/Transform.h"
+#include "MyFirstEngine/SceneGraph.h"
 #include "SimpleMath.h"               
 #include "MyFirstEngine/Renderer.h"
+#include "MyFirstEngine/MeshRenderer.h"
 #include "MyFirstEngine/Camera.h"
 #include "MyFirstEngine/Framebuffer.h"
+#include "MyFirstEngine/GLExtensions.h"
+#include "MyFirstEngine/FrustumCuller.h"
+#include "MyFirstEngine/LOD.h"
+#include "MyFirstEngine/Profiler.h"
+#include "MyFirstEngine/GpuProfiler.h"
+#include "MyFirstEngine/ProfilerWindow.h"
+#include "MyFirstEngine/Light.h"
+#include "MyFirstEngine/LightClusterer.h"
+#include "MyFirstEngine/ThreadPool.h"
 
 // ImGui Headers
 #include "imgui.h"
@@ -32,8 +45,23 @@ float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 unsigned int GameObject::nextID = 0;
-std::vector<GameObject> sceneGameObjects;
-GameObject* selectedGameObject = nullptr;
+World sceneWorld;             // Every scene object is an entity with Transform + GameObject components
+Entity selectedEntity;        // Generational handle; resolves to nothing once the entity is destroyed
+SceneGraph sceneGraph;        // Parent/child hierarchy + cached world matrices for sceneWorld's entities
+FrustumCuller sceneCuller;    // World bounds per scene graph slot, rebuilt every frame
+std::vector<uint32_t> visibleSlots; // Scene graph slots that passed frustum culling this frame
+LODSelector lodSelector;      // Picks LODGroup levels for the visible slots every frame
+bool showProfiler = true;     // "Profiler" window, toggled from the Inspector
+LightClusterer lightClusterer; // Bins the scene's Light components into view clusters every frame
+float ambientLight = 0.15f;   // Ambient term of the clustered lighting
+
+// World-space position of an entity (translation column of its cached world matrix).
+Vec3 getWorldPosition(Entity entity) {
+    if (!sceneGraph.contains(entity)) return Vec3(0.0f, 0.0f, 0.0f);
+    sceneGraph.update(sceneWorld); // Cheap: only recomputes subtrees edited since the last update
+    const float* m = sceneGraph.getWorldMatrix(entity).elements;
+    return Vec3(m[12], m[13], m[14]);
+}
 
 Framebuffer* sceneFramebuffer = nullptr;
 ImVec2 sceneViewSize(1.0f, 1.0f); // Start with minimal valid, will be updated
@@ -50,7 +78,7 @@ ImVec2 g_SceneViewContentMinRel;
 void PerformMousePicking(float mouseX_scene_content, float mouseY_scene_content, 
                          float sceneView_content_Width, float sceneView_content_Height,
                          const Mat4& viewMatrix, const Mat4& projectionMatrix) {
-    if (sceneGameObjects.empty() || sceneView_content_Width <= 0 || sceneView_content_Height <= 0) return;
+    if (sceneWorld.entityCount() == 0 || sceneView_content_Width <= 0 || sceneView_content_Height <= 0) return;
 
     // 1. Normalized Device Coordinates (NDC)
     float ndcX = (2.0f * mouseX_scene_content) / sceneView_content_Width - 1.0f;
@@ -78,28 +106,28 @@ void PerformMousePicking(float mouseX_scene_content, float mouseY_scene_content,
     
     Ray pickRay(ray_world_near_pt, (ray_world_far_pt - ray_world_near_pt).normalize());
     
-    GameObject* hitObject = nullptr;
+    Entity hitEntity;
     float closest_t = FLT_MAX;
 
-    for (size_t i = 0; i < sceneGameObjects.size(); ++i) {
-        Vec3 halfExtents = sceneGameObjects[i].transform.scale * 0.5f; 
-        AABB objectAABB(sceneGameObjects[i].transform.position, halfExtents); 
+    sceneGraph.update(sceneWorld);
+    const AABB unitBox(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.5f, 0.5f, 0.5f));
+    for (size_t slot = 0; slot < sceneGraph.size(); ++slot) {
+        AABB objectAABB = unitBox.transformed(sceneGraph.getWorldMatrixAt(slot));
         
         float t_intersection;
         if (intersectRayAABB(pickRay, objectAABB, t_intersection)) {
             if (t_intersection >= 0 && t_intersection < closest_t) {
                 closest_t = t_intersection;
-                hitObject = &sceneGameObjects[i];
+                hitEntity = sceneGraph.getEntityAt(slot);
             }
         }
     }
 
-    if (hitObject) {
-        selectedGameObject = hitObject;
-        std::cout << "Picked: " << selectedGameObject->name << " (ID: " << selectedGameObject->id << ")" << std::endl;
-        if (selectedGameObject) { 
-            editorCamera.setFocalPoint(selectedGameObject->transform.position);
-        }
+    if (!hitEntity.isNull()) {
+        selectedEntity = hitEntity;
+        const GameObject* go = sceneWorld.get<GameObject>(selectedEntity);
+        if (go) std::cout << "Picked: " << go->name << " (ID: " << go->id << ")" << std::endl;
+        editorCamera.setFocalPoint(getWorldPosition(selectedEntity));
     } else {
         std::cout << "Picked: Nothing" << std::endl;
     }
@@ -116,8 +144,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     ImGuiIO& io = ImGui::GetIO(); // ImGui's own callback (if chained) already ran
     if (action == GLFW_PRESS && key == GLFW_KEY_ESCAPE) glfwSetWindowShouldClose(window, true);
-    if (action == GLFW_PRESS && key == GLFW_KEY_F && sceneViewFocused && selectedGameObject) {
-        editorCamera.setFocalPoint(selectedGameObject->transform.position);
+    if (action == GLFW_PRESS && key == GLFW_KEY_F && sceneViewFocused) {
+        if (sceneWorld.isAlive(selectedEntity)) editorCamera.setFocalPoint(getWorldPosition(selectedEntity));
     }
 }
 
@@ -209,10 +237,26 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     if (sceneViewHovered) editorCamera.processMouseZoom(static_cast<float>(yoffset));
 }
 
-AABB::AABB(const GameObject& go) {
-    Vec3 halfExtents = go.transform.scale * 0.5f; 
-    min = go.transform.position - halfExtents;
-    max = go.transform.position + halfExtents;
+// Creates a scene entity with the default editor components and links it into the scene graph.
+// 'position' is local to 'parent' (world space for roots).
+Entity createGameObject(const std::string& name, const MeshRenderer& meshRenderer,
+                        const Vec3& position = Vec3(0.0f, 0.0f, 0.0f), Entity parent = Entity::null()) {
+    Entity entity = sceneWorld.create();
+    sceneWorld.add<Transform>(entity).position = position;
+    sceneWorld.add<GameObject>(entity, name);
+    sceneWorld.add<MeshRenderer>(entity, meshRenderer);
+    sceneGraph.addNode(entity, parent);
+    return entity;
+}
+
+// Entity with a Light (and no mesh), placed like any other scene object.
+Entity createLight(const std::string& name, const Light& light, const Vec3& position) {
+    Entity entity = sceneWorld.create();
+    sceneWorld.add<Transform>(entity).position = position;
+    sceneWorld.add<GameObject>(entity, name);
+    sceneWorld.add<Light>(entity, light);
+    sceneGraph.addNode(entity);
+    return entity;
 }
 
 int main() {
@@ -233,6 +277,7 @@ int main() {
     glfwSetScrollCallback(window, scroll_callback);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) { std::cerr << "Failed to initialize GLAD" << std::endl; glfwTerminate(); return -1; }
+    GLExtensions::load((GLADloadproc)glfwGetProcAddress); // Optional features (persistent buffers, ...)
 
     IMGUI_CHECKVERSION(); ImGui::CreateContext(); ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; io.ConfigFlags |= ImGuiConfigFlags_DockingEnable; io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
@@ -241,24 +286,40 @@ int main() {
     ImGui_ImplGlfw_InitForOpenGL(window, true); ImGui_ImplOpenGL3_Init("#version 330 core");
 
     Renderer renderer; if (!renderer.init()) { std::cerr << "Renderer init failed" << std::endl; /* cleanup */ return -1; }
+    ThreadPool frameWorkers; // Per-cluster culling of meshes with meshlets in renderer.flush()
     
-    sceneGameObjects.emplace_back("Triangle Alpha"); sceneGameObjects.back().transform.position = Vec3(0.0f, 0.0f, 0.0f);
-    sceneGameObjects.emplace_back("Cube Beta"); 
-        sceneGameObjects.back().transform.position = Vec3(1.5f, 0.0f, 0.0f); 
-        sceneGameObjects.back().transform.scale = Vec3(0.5f,0.5f,0.5f);
-        sceneGameObjects.back().transform.rotation = Vec3(0.0f, 45.0f, 30.0f);
-    sceneGameObjects.emplace_back("Ground Plane"); 
-        sceneGameObjects.back().transform.position = Vec3(0.0f, -0.75f, 0.0f); 
-        sceneGameObjects.back().transform.scale = Vec3(5.0f, 0.1f, 5.0f);
-
-    if (!sceneGameObjects.empty()) { selectedGameObject = &sceneGameObjects[0]; if (selectedGameObject) editorCamera.setFocalPoint(selectedGameObject->transform.position); }
+    const MaterialHandle defaultMaterial = renderer.getDefaultMaterial();
+    Entity triangleAlpha = createGameObject("Triangle Alpha", MeshRenderer(renderer.getBuiltinMesh(BuiltinMesh::Triangle), defaultMaterial),
+                                            Vec3(0.0f, 0.0f, 0.0f));
+    Entity cubeBeta = createGameObject("Cube Beta", MeshRenderer(renderer.getBuiltinMesh(BuiltinMesh::Cube), defaultMaterial),
+                                       Vec3(1.5f, 0.0f, 0.0f), triangleAlpha);
+        sceneWorld.get<Transform>(cubeBeta)->scale = Vec3(0.5f,0.5f,0.5f);
+        sceneWorld.get<Transform>(cubeBeta)->rotation = Quat::fromEuler(Vec3(0.0f, 45.0f, 30.0f));
+    Entity groundPlane = createGameObject("Ground Plane", MeshRenderer(renderer.getBuiltinMesh(BuiltinMesh::Plane), defaultMaterial),
+                                          Vec3(0.0f, -0.75f, 0.0f));
+        sceneWorld.get<Transform>(groundPlane)->scale = Vec3(5.0f, 0.1f, 5.0f);
+    createLight("Point Light", Light::point(Vec3(1.0f, 0.85f, 0.6f), 4.0f, 6.0f), Vec3(0.5f, 1.5f, 1.5f));
+    createLight("Spot Light", Light::spot(Vec3(0.5f, 0.7f, 1.0f), 8.0f, 6.0f, Vec3(0.0f, -1.0f, 0.0f), 20.0f, 35.0f),
+                Vec3(-1.5f, 2.5f, 0.0f));
+
+    sceneGraph.markAllDirty(); // Transforms were edited after the nodes were added
+    selectedEntity = triangleAlpha; editorCamera.setFocalPoint(getWorldPosition(selectedEntity));
     sceneFramebuffer = new Framebuffer(static_cast<int>(sceneViewSize.x), static_cast<int>(sceneViewSize.y));
+    GpuProfiler gpuProfiler; if (!gpuProfiler.init()) std::cerr << "GPU profiler init failed; GPU timings disabled" << std::endl;
+    Profiler& profiler = Profiler::get();
 
     while (!glfwWindowShouldClose(window)) {
+        profiler.beginFrame();
+        gpuProfiler.beginFrame(profiler.getFrameIndex());
+        {
+        PROFILE_SCOPE("Input");
         glfwPollEvents();
         float cf = static_cast<float>(glfwGetTime()); deltaTime = cf - lastFrame; lastFrame = cf;
         processKeyboardInput(window);
+        }
 
+        {
+        PROFILE_SCOPE("ImGui Build");
         ImGui_ImplOpenGL3_NewFrame(); ImGui_ImplGlfw_NewFrame(); ImGui::NewFrame();
         
         ImGuiViewport* vp = ImGui::GetMainViewport(); ImGui::SetNextWindowPos(vp->WorkPos); ImGui::SetNextWindowSize(vp->WorkSize); ImGui::SetNextWindowViewport(vp->ID);
@@ -268,28 +329,68 @@ int main() {
         ImGui::DockSpace(ImGui::GetID("MyDockSpace"), ImVec2(0.0f,0.0f), ImGuiDockNodeFlags_PassthruCentralNode); ImGui::End();
 
         ImGui::Begin("Hierarchy");
-        for (size_t i = 0; i < sceneGameObjects.size(); ++i) {
-            ImGui::PushID(static_cast<int>(sceneGameObjects[i].id));
-            bool is_sel = (selectedGameObject == &sceneGameObjects[i]);
-            if (ImGui::Selectable(sceneGameObjects[i].name.c_str(), is_sel)) {
-                selectedGameObject = &sceneGameObjects[i];
-                if (selectedGameObject) editorCamera.setFocalPoint(selectedGameObject->transform.position);
+        Entity clickedEntity, dragSource, dropTarget;
+        for (size_t slot = 0; slot < sceneGraph.size(); ++slot) { // Depth-first order, indented by depth
+            Entity entity = sceneGraph.getEntityAt(slot);
+            GameObject* go = sceneWorld.get<GameObject>(entity);
+            if (!go) continue;
+            ImGui::PushID(static_cast<int>(go->id));
+            float indent = 12.0f * static_cast<float>(sceneGraph.getDepthAt(slot));
+            if (indent > 0.0f) ImGui::Indent(indent);
+            bool is_sel = (selectedEntity == entity);
+            if (ImGui::Selectable(go->name.c_str(), is_sel)) clickedEntity = entity;
+            if (ImGui::BeginDragDropSource()) { // Drag an object onto another one to reparent it
+                ImGui::SetDragDropPayload("SCENE_ENTITY", &entity, sizeof(Entity));
+                ImGui::Text("%s", go->name.c_str());
+                ImGui::EndDragDropSource();
+            }
+            if (ImGui::BeginDragDropTarget()) {
+                if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SCENE_ENTITY")) {
+                    dragSource = *static_cast<const Entity*>(payload->Data); dropTarget = entity;
+                }
+                ImGui::EndDragDropTarget();
             }
             if (is_sel) ImGui::SetItemDefaultFocus();
+            if (indent > 0.0f) ImGui::Unindent(indent);
             ImGui::PopID();
+        }
+        if (!dragSource.isNull()) sceneGraph.setParent(dragSource, dropTarget); // Applied after the loop: it reorders slots
+        if (!clickedEntity.isNull()) {
+            selectedEntity = clickedEntity;
+            editorCamera.setFocalPoint(getWorldPosition(selectedEntity));
         } ImGui::End();
 
         ImGui::Begin("Inspector");
-        if (selectedGameObject) {
-            ImGui::Text("Name: %s (ID: %u)", selectedGameObject->name.c_str(), selectedGameObject->id); ImGui::Separator();
+        GameObject* selectedGO = sceneWorld.get<GameObject>(selectedEntity);
+        Transform* selectedTransform = sceneWorld.get<Transform>(selectedEntity);
+        if (selectedGO && selectedTransform) {
+            ImGui::Text("Name: %s (ID: %u)", selectedGO->name.c_str(), selectedGO->id); ImGui::Separator();
             ImGui::Text("Transform");
-            if (ImGui::DragFloat3("Position##Insp", &selectedGameObject->transform.position.x, 0.01f)) editorCamera.setFocalPoint(selectedGameObject->transform.position);
-            ImGui::DragFloat3("Rotation##Insp", &selectedGameObject->transform.rotation.x, 1.0f); 
-            ImGui::DragFloat3("Scale##Insp", &selectedGameObject->transform.scale.x, 0.01f);
-            selectedGameObject->transform.scale.x = std::max(0.001f,selectedGameObject->transform.scale.x); selectedGameObject->transform.scale.y = std::max(0.001f,selectedGameObject->transform.scale.y); selectedGameObject->transform.scale.z = std::max(0.001f,selectedGameObject->transform.scale.z);
+            bool moved = ImGui::DragFloat3("Position##Insp", &selectedTransform->position.x, 0.01f);
+            Vec3 eulerDegrees = selectedTransform->rotation.toEulerDegrees();
+            bool changed = ImGui::DragFloat3("Rotation##Insp", &eulerDegrees.x, 1.0f); 
+            if (changed) selectedTransform->rotation = Quat::fromEuler(eulerDegrees);
+            changed |= ImGui::DragFloat3("Scale##Insp", &selectedTransform->scale.x, 0.01f);
+            selectedTransform->scale.x = std::max(0.001f,selectedTransform->scale.x); selectedTransform->scale.y = std::max(0.001f,selectedTransform->scale.y); selectedTransform->scale.z = std::max(0.001f,selectedTransform->scale.z);
+            if (moved || changed) sceneGraph.markDirty(selectedEntity);
+            if (moved) editorCamera.setFocalPoint(getWorldPosition(selectedEntity));
+            if (!sceneGraph.getParent(selectedEntity).isNull() && ImGui::Button("Unparent")) sceneGraph.setParent(selectedEntity, Entity::null());
+            if (Light* light = sceneWorld.get<Light>(selectedEntity)) {
+                ImGui::Separator(); ImGui::Text(light->type == LightType::Spot ? "Spot Light" : "Point Light");
+                ImGui::ColorEdit3("Color##Light", &light->color.x); ImGui::DragFloat("Intensity##Light", &light->intensity, 0.05f, 0.0f, 100.0f);
+                ImGui::DragFloat("Range##Light", &light->range, 0.05f, 0.1f, 100.0f);
+                if (light->type == LightType::Spot) { ImGui::SliderFloat("Inner Cone##Light", &light->innerConeDegrees, 0.0f, light->outerConeDegrees); ImGui::SliderFloat("Outer Cone##Light", &light->outerConeDegrees, 1.0f, 89.0f); }
+            }
         } else { ImGui::Text("No object selected."); }
         ImGui::Separator(); ImGui::Text("EditorCam"); ImGui::Text("P:%.1f,%.1f,%.1f F:%.1f,%.1f,%.1f",editorCamera.position.x,editorCamera.position.y,editorCamera.position.z,editorCamera.focalPoint.x,editorCamera.focalPoint.y,editorCamera.focalPoint.z);
         ImGui::SliderFloat("FOV",&editorCamera.fov,1,120);
+        LODSettings lodSettings = lodSelector.getSettings();
+        ImGui::SliderFloat("LOD Pixel Error",&lodSettings.maxPixelError,0.25f,8.0f); ImGui::SliderFloat("LOD Fade (s)",&lodSettings.fadeDuration,0.0f,1.0f);
+        lodSelector.setSettings(lodSettings);
+        ImGui::SliderFloat("Ambient",&ambientLight,0.0f,1.0f);
+        ImGui::Checkbox("Show Profiler",&showProfiler);
+        if (sceneFramebuffer) ImGui::Text("Scene FB: %dx%d of %dx%d (%u allocs)", sceneFramebuffer->getWidth(), sceneFramebuffer->getHeight(),
+                                          sceneFramebuffer->getCapacityWidth(), sceneFramebuffer->getCapacityHeight(), sceneFramebuffer->getAllocationCount());
         ImGui::End();
 
         ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f,0.0f));
@@ -302,39 +403,88 @@ int main() {
             sceneViewHovered = ImGui::IsWindowHovered(ImGuiHoveredFlags_RootAndChildWindows);
             ImVec2 cws = ImGui::GetContentRegionAvail();
             if (cws.x > 0 && cws.y > 0) {
-                if (cws.x != sceneViewSize.x || cws.y != sceneViewSize.y) {
-                    sceneViewSize = cws; 
-                    if (sceneFramebuffer) sceneFramebuffer->resize(static_cast<int>(cws.x), static_cast<int>(cws.y));
+                sceneViewSize = cws;
+                // Called every frame: a no-op unless the capacity must grow, or the lazy shrink is due.
+                if (sceneFramebuffer) sceneFramebuffer->resize(static_cast<int>(cws.x), static_cast<int>(cws.y));
+                if (sceneFramebuffer && sceneFramebuffer->getColorTexture()!=0) {
+                    // Only the bottom-left logical sub-rect holds the scene (V flipped for ImGui).
+                    const float uMax = sceneFramebuffer->getUVMaxX(), vMax = sceneFramebuffer->getUVMaxY();
+                    ImGui::Image((ImTextureID)sceneFramebuffer->getColorTexture(), sceneViewSize, ImVec2(0,vMax), ImVec2(uMax,0));
                 }
-                if (sceneFramebuffer && sceneFramebuffer->getColorTexture()!=0) 
-                    ImGui::Image((ImTextureID)sceneFramebuffer->getColorTexture(), sceneViewSize, ImVec2(0,1), ImVec2(1,0));
             } 
         }
         ImGui::End(); ImGui::PopStyleVar();
         
         ImGui::ShowDemoWindow();
+        if (showProfiler) drawProfilerWindow(profiler, &showProfiler);
+        }
 
         if (sceneFramebuffer && sceneFramebuffer->getWidth()>0 && sceneFramebuffer->getHeight()>0) {
-            sceneFramebuffer->bind(); glEnable(GL_DEPTH_TEST);
+            PROFILE_SCOPE("Scene Pass");
+            sceneFramebuffer->bind(); gpuProfiler.beginScope("Scene Pass"); glEnable(GL_DEPTH_TEST);
             glClearColor(0.1f,0.12f,0.15f,1.0f); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             Mat4 vM = editorCamera.getViewMatrix();
             float sar = static_cast<float>(sceneFramebuffer->getWidth())/std::max(1.0f,static_cast<float>(sceneFramebuffer->getHeight()));
             Mat4 pM = editorCamera.getProjectionMatrix(sar);
-            for (const auto& go : sceneGameObjects) {
-                Mat4 transMatrix = Mat4::translate(go.transform.position);
-                Mat4 rotMatrix   = Mat4::rotateEuler(go.transform.rotation); 
-                Mat4 scaleMatrix = Mat4::scale(go.transform.scale);
-                Mat4 modelMatrix = transMatrix * rotMatrix * scaleMatrix; 
-                renderer.draw(modelMatrix, vM, pM);
-            } sceneFramebuffer->unbind();
+            sceneGraph.update(sceneWorld); // Only subtrees marked dirty since last frame are recomputed
+            const Mat4* worldMatrices = sceneGraph.getWorldMatrices();
+            sceneCuller.resize(sceneGraph.size());
+            {
+            PROFILE_SCOPE("Culling");
+            for (size_t slot = 0; slot < sceneGraph.size(); ++slot) {
+                const MeshRenderer* meshRenderer = sceneWorld.get<MeshRenderer>(sceneGraph.getEntityAt(slot));
+                if (!meshRenderer) { sceneCuller.setBounds(slot, BoundingSphere()); continue; }
+                const MeshBounds& bounds = renderer.getMeshManager().getBounds(meshRenderer->mesh);
+                sceneCuller.setBounds(slot, bounds.box, bounds.sphere, worldMatrices[slot]);
+            }
+            sceneCuller.cull(Frustum::fromMatrix(pM * vM), visibleSlots);
+            }
+            {
+            PROFILE_SCOPE("LOD Selection");
+            lodSelector.setView(editorCamera.position, editorCamera.fov, sceneFramebuffer->getHeight());
+            lodSelector.updateVisible(sceneWorld, sceneGraph, visibleSlots, deltaTime);
+            }
+            renderer.beginFrame(vM, pM);
+            {
+            PROFILE_SCOPE("Light Clustering");
+            lightClusterer.setView(vM, pM, sceneFramebuffer->getWidth(), sceneFramebuffer->getHeight());
+            lightClusterer.gatherLights(sceneWorld, sceneGraph);
+            lightClusterer.build();
+            renderer.setAmbientLight(Vec3(ambientLight, ambientLight, ambientLight));
+            renderer.setLights(lightClusterer);
+            }
+            for (uint32_t slot : visibleSlots) {
+                const Entity entity = sceneGraph.getEntityAt(slot);
+                const MeshRenderer* meshRenderer = sceneWorld.get<MeshRenderer>(entity);
+                if (!meshRenderer) continue;
+                const LODGroup* lod = sceneWorld.get<LODGroup>(entity);
+                if (lod && lod->isFading()) {
+                    renderer.submit(lod->previousMesh(), meshRenderer->material, worldMatrices[slot], lod->outgoingFade());
+                    renderer.submit(meshRenderer->mesh, meshRenderer->material, worldMatrices[slot], lod->incomingFade());
+                } else {
+                    renderer.submit(meshRenderer->mesh, meshRenderer->material, worldMatrices[slot]);
+                }
+            }
+            renderer.flush(&frameWorkers); gpuProfiler.endScope(); sceneFramebuffer->unbind();
         }
+        {
+        PROFILE_SCOPE("ImGui Render");
         ImGui::Render();
         int dw, dh; glfwGetFramebufferSize(window, &dw, &dh); glViewport(0,0,dw,dh);
+        GpuProfileScope gpuScope(gpuProfiler, "ImGui Render");
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
         if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+            // Other viewports render in their own GL contexts, where this context's queries do not exist: CPU only.
+            PROFILE_SCOPE("Platform Windows");
             GLFWwindow* bctx = glfwGetCurrentContext(); ImGui::UpdatePlatformWindows(); ImGui::RenderPlatformWindowsDefault(); glfwMakeContextCurrent(bctx);
         }
+        gpuProfiler.endFrame();
+        {
+        PROFILE_SCOPE("Swap Buffers");
         glfwSwapBuffers(window);
+        }
+        profiler.endFrame();
     }
     delete sceneFramebuffer;
     ImGui_ImplOpenGL3_Shutdown(); ImGui_ImplGlfw_Shutdown(); ImGui::DestroyContext();